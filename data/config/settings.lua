@@ -13,6 +13,8 @@ settings.video_settings.ui_theme = "Royal Silk"
 settings.audio_settings = {}
 settings.audio_settings.music_vol = 0.7
 settings.audio_settings.sound_vol = 0.8
+settings.audio_settings.pcm_cache = true
+settings.audio_settings.sound_mixer = true
 
 settings.key_settings = {}
 settings.key_settings.up = 1073741906
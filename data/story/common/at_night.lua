@@ -6,6 +6,8 @@ setfenv(1, ns);
 local Script = nil
 local night_layer = nil
 
+local night_color = vt_video.Color(0.0, 0.0, 0.24, 0.6);
+
 -- add a evening light layer
 function Initialize(battle_instance)
     Script = battle_instance:GetScriptSupervisor();
@@ -13,14 +15,7 @@ function Initialize(battle_instance)
     -- Load a white empty image
     night_layer = Script:CreateImage("");
     night_layer:SetDimensions(1024.0, 768.0);
-end
-
-local night_color = vt_video.Color(0.0, 0.0, 0.24, 0.6);
 
-function DrawForeground()
-    -- Useful for the map mode
-    Script:SetDrawFlag(vt_video.GameVideo.VIDEO_X_LEFT);
-    Script:SetDrawFlag(vt_video.GameVideo.VIDEO_Y_TOP);
-    VideoManager:Move(0.0, 0.0);
-    night_layer:Draw(night_color);
+    -- The layer never changes, so the engine draws it without calling the script.
+    Script:AddRetainedDraw(vt_mode_manager.ScriptSupervisor.SCRIPT_DRAW_FOREGROUND, night_layer, 0.0, 0.0, night_color);
 end
@@ -16,31 +16,20 @@ function Initialize(battle_instance)
     Battle:TriggerBattleParticleEffect("data/visuals/particle_effects/rain.lua", 512.0, 768.0);
     ripples = Script:CreateAnimation("data/battles/battle_scenes/ripples.lua");
     ripples:SetDimensions(256.0, 153.6); -- 256.0 * 0.6
+
+    -- The engine updates and draws the ripples without calling the script.
+    local white_color = vt_video.Color(1.0, 1.0, 1.0, 1.0);
+    local background = vt_mode_manager.ScriptSupervisor.SCRIPT_DRAW_BACKGROUND;
+    Script:AddRetainedDraw(background, ripples, 235.0, 340.0, white_color);
+    Script:AddRetainedDraw(background, ripples, 235.0, 596.0, white_color);
+    Script:AddRetainedDraw(background, ripples, 491.0, 340.0, white_color);
+    Script:AddRetainedDraw(background, ripples, 491.0, 596.0, white_color);
 end
 
 --function Restart()
 
 --end
 
-function Update()
-    ripples:Update();
-end
-
-local white_color = vt_video.Color(1.0, 1.0, 1.0, 1.0);
-
-function DrawBackground()
-    if (ripples ~= nil) then
-        VideoManager:Move(235.0, 340.0);
-        ripples:Draw(white_color);
-        VideoManager:Move(235.0, 596.0);
-        ripples:Draw(white_color);
-        VideoManager:Move(491.0, 340.0);
-        ripples:Draw(white_color);
-        VideoManager:Move(491.0, 596.0);
-        ripples:Draw(white_color);
-    end
-end
-
 --function DrawPostEffects()
 
 --end
@@ -73,8 +73,11 @@ local Map = nil
 local Script = nil
 local Effects = nil
 
+local show_event = nil
+
 function Initialize(map_instance)
     Map = map_instance;
+    show_event = GlobalManager:GetGameEvents():GetEventHandle("story", "layna_forest_crystal_appearance");
 
     Script = Map:GetScriptSupervisor();
     Effects = Map:GetEffectSupervisor();
@@ -108,11 +111,11 @@ end
 
 function Update()
     -- Only show the image if requested by the events
-    if (GlobalManager:GetGameEvents():DoesEventExist("story", "layna_forest_crystal_appearance") == false) then
+    if (GlobalManager:GetGameEvents():DoesEventExist(show_event) == false) then
         return;
     end
 
-    if (GlobalManager:GetGameEvents():GetEventValue("story", "layna_forest_crystal_appearance") == 0) then
+    if (GlobalManager:GetGameEvents():GetEventValue(show_event) == 0) then
         return;
     end
 
@@ -126,7 +129,7 @@ function Update()
     if (display_time > 17000) then
         display_time = 0;
         -- Disable the event at the end of it
-        GlobalManager:GetGameEvents():SetEventValue("story", "layna_forest_crystal_appearance", 0);
+        GlobalManager:GetGameEvents():SetEventValue(show_event, 0);
         return;
     end
 
@@ -298,11 +301,11 @@ local flash_color = vt_video.Color(1.0, 1.0, 1.0, 1.0);
 
 function DrawPostEffects()
     -- Only show the image if requested by the events
-    if (GlobalManager:GetGameEvents():DoesEventExist("story", "layna_forest_crystal_appearance") == false) then
+    if (GlobalManager:GetGameEvents():DoesEventExist(show_event) == false) then
         return;
     end
 
-    if (GlobalManager:GetGameEvents():GetEventValue("story", "layna_forest_crystal_appearance") == 0) then
+    if (GlobalManager:GetGameEvents():GetEventValue(show_event) == 0) then
         return;
     end
 
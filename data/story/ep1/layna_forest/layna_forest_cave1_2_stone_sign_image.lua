@@ -17,8 +17,11 @@ local display_time = 0;
 local Map = {};
 local Script = {};
 
+local show_event = nil
+
 function Initialize(map_instance)
     Map = map_instance;
+    show_event = GlobalManager:GetGameEvents():GetEventHandle("story", "layna_forest_cave1_2_show_sign_image");
 
     Script = Map:GetScriptSupervisor();
     stone_sign = Script:CreateImage("data/story/ep1/layna_forest/stone_sign.png");
@@ -27,11 +30,11 @@ end
 
 function Update()
     -- Only show the image if requested by the events
-    if (GlobalManager:GetGameEvents():DoesEventExist("story", "layna_forest_cave1_2_show_sign_image") == false) then
+    if (GlobalManager:GetGameEvents():DoesEventExist(show_event) == false) then
         return;
     end
 
-    if (GlobalManager:GetGameEvents():GetEventValue("story", "layna_forest_cave1_2_show_sign_image") == 0) then
+    if (GlobalManager:GetGameEvents():GetEventValue(show_event) == 0) then
         return;
     end
 
@@ -44,7 +47,7 @@ function Update()
     if (display_time > 8000) then
         display_time = 0
         -- Disable the event at the end of it
-        GlobalManager:GetGameEvents():SetEventValue("story", "layna_forest_cave1_2_show_sign_image", 0);
+        GlobalManager:GetGameEvents():SetEventValue(show_event, 0);
     end
 
 
@@ -55,11 +58,11 @@ local stone_sign_color = vt_video.Color(1.0, 1.0, 1.0, 0.9);
 
 function DrawPostEffects()
     -- Only show the image if requested by the events
-    if (GlobalManager:GetGameEvents():DoesEventExist("story", "layna_forest_cave1_2_show_sign_image") == false) then
+    if (GlobalManager:GetGameEvents():DoesEventExist(show_event) == false) then
         return;
     end
 
-    if (GlobalManager:GetGameEvents():GetEventValue("story", "layna_forest_cave1_2_show_sign_image") == 0) then
+    if (GlobalManager:GetGameEvents():GetEventValue(show_event) == 0) then
         return;
     end
 
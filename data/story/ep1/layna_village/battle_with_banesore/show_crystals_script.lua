@@ -22,8 +22,11 @@ local script_triggered = false;
 local Map = nil
 local Script = nil
 
+local show_event = nil
+
 function Initialize(map_instance)
     Map = map_instance;
+    show_event = GlobalManager:GetGameEvents():GetEventHandle("scripts_events", "layna_village_riverbank_show_crystals");
 
     Script = Map:GetScriptSupervisor();
 
@@ -45,11 +48,11 @@ end
 
 function Update()
     -- Only show the image if requested by the events
-    if (GlobalManager:GetGameEvents():DoesEventExist("scripts_events", "layna_village_riverbank_show_crystals") == false) then
+    if (GlobalManager:GetGameEvents():DoesEventExist(show_event) == false) then
         return;
     end
 
-    if (GlobalManager:GetGameEvents():GetEventValue("scripts_events", "layna_village_riverbank_show_crystals") == 0) then
+    if (GlobalManager:GetGameEvents():GetEventValue(show_event) == 0) then
         return;
     end
 
@@ -93,7 +96,7 @@ function Update()
     if (display_time > 8000) then
         display_time = 0
         -- Disable the event at the end of it
-        GlobalManager:GetGameEvents():SetEventValue("scripts_events", "layna_village_riverbank_show_crystals", 0);
+        GlobalManager:GetGameEvents():SetEventValue(show_event, 0);
     end
 end
 
@@ -103,11 +106,11 @@ local red_crystal_color = vt_video.Color(1.0, 0.0, 0.0, 1.0);
 
 function DrawPostEffects()
     -- Only show the image if requested by the events
-    if (GlobalManager:GetGameEvents():DoesEventExist("scripts_events", "layna_village_riverbank_show_crystals") == false) then
+    if (GlobalManager:GetGameEvents():DoesEventExist(show_event) == false) then
         return;
     end
 
-    if (GlobalManager:GetGameEvents():GetEventValue("scripts_events", "layna_village_riverbank_show_crystals") == 0) then
+    if (GlobalManager:GetGameEvents():GetEventValue(show_event) == 0) then
         return;
     end
 
@@ -14,8 +14,11 @@ local smoke_sound_triggered = false;
 local Map = nil
 local Script = nil
 
+local show_event = nil
+
 function Initialize(map_instance)
     Map = map_instance;
+    show_event = GlobalManager:GetGameEvents():GetEventHandle("scripts_events", "layna_village_riverbank_smoke");
 
     Script = Map:GetScriptSupervisor();
     Effects = Map:GetEffectSupervisor();
@@ -33,11 +36,11 @@ local flash_color = vt_video.Color(1.0, 1.0, 1.0, 1.0);
 
 function Update()
     -- Only show the image if requested by the events
-    if (GlobalManager:GetGameEvents():DoesEventExist("scripts_events", "layna_village_riverbank_smoke") == false) then
+    if (GlobalManager:GetGameEvents():DoesEventExist(show_event) == false) then
         return;
     end
 
-    if (GlobalManager:GetGameEvents():GetEventValue("scripts_events", "layna_village_riverbank_smoke") == 0) then
+    if (GlobalManager:GetGameEvents():GetEventValue(show_event) == 0) then
         return;
     end
 
@@ -55,7 +58,7 @@ function Update()
     if (display_time > 4300) then
         display_time = 0
         -- Disable the event at the end of it
-        GlobalManager:GetGameEvents():SetEventValue("scripts_events", "layna_village_riverbank_smoke", 0);
+        GlobalManager:GetGameEvents():SetEventValue(show_event, 0);
     end
 
     -- The flash alpha
@@ -84,11 +87,11 @@ local cloud_color = vt_video.Color(1.0, 1.0, 1.0, 1.0);
 
 function DrawForeground()
     -- Only show the image if requested by the events
-    if (GlobalManager:GetGameEvents():DoesEventExist("scripts_events", "layna_village_riverbank_smoke") == false) then
+    if (GlobalManager:GetGameEvents():DoesEventExist(show_event) == false) then
         return;
     end
 
-    if (GlobalManager:GetGameEvents():GetEventValue("scripts_events", "layna_village_riverbank_smoke") == 0) then
+    if (GlobalManager:GetGameEvents():GetEventValue(show_event) == 0) then
         return;
     end
 
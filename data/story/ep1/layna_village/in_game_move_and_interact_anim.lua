@@ -32,8 +32,11 @@ local Map = nil
 local Script = nil
 local Effects = nil
 
+local show_event = nil
+
 function Initialize(map_instance)
     Map = map_instance;
+    show_event = GlobalManager:GetGameEvents():GetEventHandle("game", "show_move_interact_info");
 
     Script = Map:GetScriptSupervisor();
     Effects = Map:GetEffectSupervisor();
@@ -80,11 +83,11 @@ end
 
 function Update()
     -- Only show the image if requested by the events
-    if (GlobalManager:GetGameEvents():DoesEventExist("game", "show_move_interact_info") == false) then
+    if (GlobalManager:GetGameEvents():DoesEventExist(show_event) == false) then
         return;
     end
 
-    if (GlobalManager:GetGameEvents():GetEventValue("game", "show_move_interact_info") == 0) then
+    if (GlobalManager:GetGameEvents():GetEventValue(show_event) == 0) then
         return;
     end
 
@@ -105,11 +108,11 @@ end
 
 function DrawPostEffects()
     -- Only show the image if requested by the events
-    if (GlobalManager:GetGameEvents():DoesEventExist("game", "show_move_interact_info") == false) then
+    if (GlobalManager:GetGameEvents():DoesEventExist(show_event) == false) then
         return;
     end
 
-    if (GlobalManager:GetGameEvents():GetEventValue("game", "show_move_interact_info") == 0) then
+    if (GlobalManager:GetGameEvents():GetEventValue(show_event) == 0) then
         return;
     end
 
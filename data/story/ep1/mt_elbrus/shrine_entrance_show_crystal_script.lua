@@ -24,8 +24,11 @@ local script_triggered = false;
 local Map = nil
 local Script = nil
 
+local show_event = nil
+
 function Initialize(map_instance)
     Map = map_instance;
+    show_event = GlobalManager:GetGameEvents():GetEventHandle("scripts_events", "shrine_entrance_show_crystal");
 
     Script = Map:GetScriptSupervisor();
 
@@ -45,11 +48,11 @@ end
 
 function Update()
     -- Only show the image if requested by the events
-    if (GlobalManager:GetGameEvents():DoesEventExist("scripts_events", "shrine_entrance_show_crystal") == false) then
+    if (GlobalManager:GetGameEvents():DoesEventExist(show_event) == false) then
         return;
     end
 
-    if (GlobalManager:GetGameEvents():GetEventValue("scripts_events", "shrine_entrance_show_crystal") == 0) then
+    if (GlobalManager:GetGameEvents():GetEventValue(show_event) == 0) then
         return;
     end
 
@@ -96,7 +99,7 @@ function Update()
     if (display_time > 15000) then
         display_time = 0
         -- Disable the event at the end of it
-        GlobalManager:GetGameEvents():SetEventValue("scripts_events", "shrine_entrance_show_crystal", 0);
+        GlobalManager:GetGameEvents():SetEventValue(show_event, 0);
     end
 end
 
@@ -106,11 +109,11 @@ local ancient_sign_color = vt_video.Color(1.0, 1.0, 1.0, 1.0);
 
 function DrawPostEffects()
     -- Only show the image if requested by the events
-    if (GlobalManager:GetGameEvents():DoesEventExist("scripts_events", "shrine_entrance_show_crystal") == false) then
+    if (GlobalManager:GetGameEvents():DoesEventExist(show_event) == false) then
         return;
     end
 
-    if (GlobalManager:GetGameEvents():GetEventValue("scripts_events", "shrine_entrance_show_crystal") == 0) then
+    if (GlobalManager:GetGameEvents():GetEventValue(show_event) == 0) then
         return;
     end
 
@@ -370,10 +370,17 @@ void BindCommonCode()
 
         luabind::module(vt_script::ScriptManager->GetGlobalState(), "vt_global")
         [
+            luabind::class_<EventHandle>("EventHandle")
+            .def("IsValid", &EventHandle::IsValid),
+
             luabind::class_<GameEvents>("GameEvents")
-            .def("DoesEventExist", &GameEvents::DoesEventExist)
-            .def("GetEventValue", &GameEvents::GetEventValue)
-            .def("SetEventValue", &GameEvents::SetEventValue)
+            .def("DoesEventExist", (bool (GameEvents:: *)(const std::string&, const std::string&) const) &GameEvents::DoesEventExist)
+            .def("DoesEventExist", (bool (GameEvents:: *)(const EventHandle&) const) &GameEvents::DoesEventExist)
+            .def("GetEventValue", (int32_t (GameEvents:: *)(const std::string&, const std::string&) const) &GameEvents::GetEventValue)
+            .def("GetEventValue", (int32_t (GameEvents:: *)(const EventHandle&) const) &GameEvents::GetEventValue)
+            .def("SetEventValue", (void (GameEvents:: *)(const std::string&, const std::string&, int32_t)) &GameEvents::SetEventValue)
+            .def("SetEventValue", (void (GameEvents:: *)(const EventHandle&, int32_t)) &GameEvents::SetEventValue)
+            .def("GetEventHandle", &GameEvents::GetEventHandle)
         ];
 
         luabind::module(vt_script::ScriptManager->GetGlobalState(), "vt_global")
@@ -0,0 +1,130 @@
+////////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2018 by Bertram (Valyria Tear)
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+////////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file   flat_id_map.h
+*** \author Yohann Ferreira, yohann ferreira orange fr
+*** \brief  Header file for the hash map keyed by interned string ids
+*** ***************************************************************************/
+
+#ifndef __FLAT_ID_MAP_HEADER__
+#define __FLAT_ID_MAP_HEADER__
+
+#include <cstdint>
+#include <vector>
+
+namespace vt_common
+{
+
+/** ****************************************************************************
+*** \brief An open addressing hash map from a non-zero id to a value
+***
+*** The entries are stored contiguously, in insertion order, and an index table
+*** of power of 2 size maps the ids to them with linear probing. The entries
+*** can't be removed one by one, only cleared all at once.
+*** ***************************************************************************/
+template <typename T>
+class FlatIdMap
+{
+public:
+    struct Entry {
+        Entry(uint32_t entry_key, const T& entry_value) :
+            key(entry_key),
+            value(entry_value)
+        {}
+
+        uint32_t key;
+        T value;
+    };
+
+    FlatIdMap() :
+        _shift(32)
+    {}
+
+    //! \brief Returns the value of the id, or nullptr when not found.
+    T* Find(uint32_t key) {
+        uint32_t slot = _FindSlot(key);
+        return (_index.empty() || _index[slot] == 0) ? nullptr : &_entries[_index[slot] - 1].value;
+    }
+
+    const T* Find(uint32_t key) const {
+        return const_cast<FlatIdMap*>(this)->Find(key);
+    }
+
+    bool Contains(uint32_t key) const {
+        return Find(key) != nullptr;
+    }
+
+    /** \brief Adds a value for the id, or returns the value already there
+    *** \return The value of the id. The reference is invalidated by the next insertion.
+    **/
+    T& Insert(uint32_t key, const T& value) {
+        if(T* existing = Find(key))
+            return *existing;
+
+        // Keep the index at most half full.
+        if((_entries.size() + 1) * 2 > _index.size())
+            _Rehash(_index.empty() ? 16 : static_cast<uint32_t>(_index.size()) * 2);
+
+        _entries.push_back(Entry(key, value));
+        _index[_FindSlot(key)] = static_cast<uint32_t>(_entries.size());
+        return _entries.back().value;
+    }
+
+    void Clear() {
+        _entries.clear();
+        _index.clear();
+        _shift = 32;
+    }
+
+    uint32_t Size() const {
+        return static_cast<uint32_t>(_entries.size());
+    }
+
+    //! \brief Returns the entries, in insertion order.
+    const std::vector<Entry>& GetEntries() const {
+        return _entries;
+    }
+
+private:
+    std::vector<Entry> _entries;
+
+    //! \brief The hash table slots, holding an entry index + 1, or 0 when empty
+    std::vector<uint32_t> _index;
+
+    //! \brief 32 - log2 of the index size, to keep the high bits of the hash
+    uint32_t _shift;
+
+    //! \brief Returns the slot holding the id, or the empty slot where it would be added.
+    uint32_t _FindSlot(uint32_t key) const {
+        if(_index.empty())
+            return 0;
+
+        const uint32_t mask = static_cast<uint32_t>(_index.size()) - 1;
+        // Fibonacci hashing spreads the consecutive ids over the table.
+        uint32_t slot = (key * 2654435769u) >> _shift;
+        while(_index[slot] != 0 && _entries[_index[slot] - 1].key != key)
+            slot = (slot + 1) & mask;
+        return slot;
+    }
+
+    void _Rehash(uint32_t size) {
+        _index.assign(size, 0);
+        _shift = 32;
+        for(uint32_t s = size; s > 1; s >>= 1)
+            --_shift;
+
+        for(uint32_t i = 0; i < _entries.size(); ++i)
+            _index[_FindSlot(_entries[i].key)] = i + 1;
+    }
+};
+
+} // namespace vt_common
+
+#endif // __FLAT_ID_MAP_HEADER__
@@ -570,6 +570,134 @@ bool GlobalCharacter::SaveCharacter(WriteScriptDescriptor& file)
     return true;
 }
 
+bool GlobalCharacter::LoadCharacter(SaveGameReader& file)
+{
+    Enable(file.ReadBool());
+
+    // Read in all of the character's stats data
+    SetExperienceLevel(file.ReadUInt32());
+    _unspent_experience_points = file.ReadUInt32();
+    SetTotalExperiencePoints(file.ReadUInt32());
+    _experience_for_next_level = file.ReadInt32();
+
+    SetMaxHitPoints(file.ReadUInt32());
+    SetHitPoints(file.ReadUInt32());
+    SetMaxSkillPoints(file.ReadUInt32());
+    SetSkillPoints(file.ReadUInt32());
+
+    SetPhysAtk(file.ReadUInt32());
+    SetMagAtk(file.ReadUInt32());
+    SetPhysDef(file.ReadUInt32());
+    SetMagDef(file.ReadUInt32());
+    SetStamina(file.ReadUInt32());
+    SetEvade(file.ReadFloat());
+
+    // Equip the objects on the character as long as valid equipment IDs were read
+    uint32_t equip_id = file.ReadUInt32();
+    if(equip_id != 0)
+        EquipWeapon(std::make_shared<GlobalWeapon>(equip_id));
+
+    // Head, torso, arm and leg armors
+    for(uint32_t i = 0; i < 4; ++i) {
+        equip_id = file.ReadUInt32();
+        if(equip_id != 0)
+            EquipArmor(std::make_shared<GlobalArmor>(equip_id));
+    }
+
+    std::vector<uint32_t> skill_ids;
+    file.ReadUIntVector(skill_ids);
+    for(uint32_t i = 0; i < skill_ids.size(); ++i)
+        AddSkill(skill_ids[i]);
+
+    ResetObtainedSkillNodes();
+    std::vector<uint32_t> skill_node_ids;
+    file.ReadUIntVector(skill_node_ids);
+    SetObtainedSkillNodes(skill_node_ids);
+
+    uint32_t current_character_location = file.ReadUInt32();
+    if (current_character_location != std::numeric_limits<uint32_t>::max()) {
+        SetSkillNodeLocation(current_character_location);
+
+        // Add the current node position as obtained if it is not in the data
+        if (!IsSkillNodeObtained(current_character_location))
+            _obtained_skill_nodes.push_back(current_character_location);
+    }
+
+    ResetActiveStatusEffects();
+    uint32_t number_effects = file.ReadUInt32();
+    for(uint32_t i = 0; i < number_effects && !file.IsErrorDetected(); ++i) {
+        int32_t status_effect = file.ReadInt32();
+        int32_t intensity = file.ReadInt32();
+        uint32_t duration = file.ReadUInt32();
+        uint32_t elapsed_time = file.ReadUInt32();
+
+        // Check the status effect and intensity validity
+        if (status_effect <= (int32_t)GLOBAL_STATUS_INVALID || status_effect >= (int32_t)GLOBAL_STATUS_TOTAL)
+            continue;
+        if (intensity <= GLOBAL_INTENSITY_INVALID || intensity >= GLOBAL_INTENSITY_TOTAL)
+            continue;
+
+        SetActiveStatusEffect((GLOBAL_STATUS)status_effect,
+                              (GLOBAL_INTENSITY)intensity,
+                              duration, elapsed_time);
+    }
+
+    return !file.IsErrorDetected();
+}
+
+void GlobalCharacter::SaveCharacter(SaveGameWriter& file)
+{
+    file.WriteBool(IsEnabled());
+
+    file.WriteUInt32(GetExperienceLevel());
+    file.WriteUInt32(GetUnspentExperiencePoints());
+    file.WriteUInt32(GetTotalExperiencePoints());
+    file.WriteInt32(GetExperienceForNextLevel());
+
+    // The values stored are the unmodified ones.
+    file.WriteUInt32(GetMaxHitPoints());
+    file.WriteUInt32(GetHitPoints());
+    file.WriteUInt32(GetMaxSkillPoints());
+    file.WriteUInt32(GetSkillPoints());
+
+    file.WriteUInt32(GetPhysAtkBase());
+    file.WriteUInt32(GetMagAtkBase());
+    file.WriteUInt32(GetPhysDefBase());
+    file.WriteUInt32(GetMagDefBase());
+    file.WriteUInt32(GetStaminaBase());
+    file.WriteFloat(GetEvadeBase());
+
+    file.WriteUInt32(GetEquippedWeapon() ? GetEquippedWeapon()->GetID() : 0);
+    const GLOBAL_OBJECT armor_types[] = { GLOBAL_OBJECT_HEAD_ARMOR, GLOBAL_OBJECT_TORSO_ARMOR,
+                                          GLOBAL_OBJECT_ARM_ARMOR, GLOBAL_OBJECT_LEG_ARMOR };
+    for(uint32_t i = 0; i < 4; ++i) {
+        std::shared_ptr<GlobalArmor> armor = GetEquippedArmor(armor_types[i]);
+        file.WriteUInt32(armor ? armor->GetID() : 0);
+    }
+
+    // The equipment skills will be reloaded through equipment.
+    file.WriteUIntVector(GetPermanentSkills());
+    file.WriteUIntVector(GetObtainedSkillNodes());
+    file.WriteUInt32(GetSkillNodeLocation());
+
+    uint32_t number_effects = 0;
+    for(uint32_t i = 0; i < _active_status_effects.size(); ++i) {
+        if (_active_status_effects[i].IsActive())
+            ++number_effects;
+    }
+    file.WriteUInt32(number_effects);
+    for(uint32_t i = 0; i < _active_status_effects.size(); ++i) {
+        const ActiveStatusEffect& effect = _active_status_effects[i];
+        if (!effect.IsActive())
+            continue;
+
+        file.WriteInt32((int32_t)effect.GetEffect());
+        file.WriteInt32((int32_t)effect.GetIntensity());
+        file.WriteUInt32(effect.GetEffectTime());
+        file.WriteUInt32(effect.GetElapsedTime());
+    }
+}
+
 bool GlobalCharacter::AddExperiencePoints(uint32_t xp)
 {
     _total_experience_points += xp;
@@ -17,6 +17,8 @@
 #include "common/global/status_effects/global_active_effect.h"
 #include "global_attack_point.h"
 
+#include "common/global/global_save.h"
+
 #include <memory>
 #include <map>
 
@@ -78,6 +80,12 @@ public:
     **/
     bool SaveCharacter(vt_script::WriteScriptDescriptor& file);
 
+    //! \brief Loads the character data from a binary save game section.
+    bool LoadCharacter(SaveGameReader& file);
+
+    //! \brief Writes the character data to a binary save game section.
+    void SaveCharacter(SaveGameWriter& file);
+
     //! \brief Tells whether a character is in the visible game formation
     void Enable(bool enable) {
         _enabled = enable;
@@ -221,4 +221,37 @@ void CharacterHandler::SaveCharacters(vt_script::WriteScriptDescriptor& file)
     file.WriteLine("},"); // characters
 }
 
+bool CharacterHandler::LoadCharacters(SaveGameReader& file)
+{
+    // The characters are saved in the party order
+    uint32_t number_characters = file.ReadUInt32();
+    for(uint32_t i = 0; i < number_characters && !file.IsErrorDetected(); ++i) {
+        uint32_t id = file.ReadUInt32();
+        GlobalCharacter* character = new GlobalCharacter(id, false);
+        if (character->LoadCharacter(file)) {
+            AddCharacter(character);
+        }
+        else {
+            delete character;
+            PRINT_ERROR << "Invalid character id " << id << " in " << file.GetFilename() << std::endl;
+            return false;
+        }
+    }
+
+    if (_characters.empty()) {
+        PRINT_ERROR << "No characters were added by save game file: " << file.GetFilename() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void CharacterHandler::SaveCharacters(SaveGameWriter& file)
+{
+    file.WriteUInt32(static_cast<uint32_t>(_ordered_characters.size()));
+    for(uint32_t i = 0; i < _ordered_characters.size(); ++i) {
+        file.WriteUInt32(_ordered_characters[i]->GetID());
+        _ordered_characters[i]->SaveCharacter(file);
+    }
+}
+
 } // namespace vt_global
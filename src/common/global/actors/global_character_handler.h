@@ -15,6 +15,7 @@
 
 #include "script/script_read.h"
 #include "script/script_write.h"
+#include "common/global/global_save.h"
 
 #include <map>
 
@@ -104,6 +105,10 @@ public:
     bool LoadCharacters(vt_script::ReadScriptDescriptor& file);
     void SaveCharacters(vt_script::WriteScriptDescriptor& file);
 
+    //! \brief Loads and saves the characters in a binary save game section
+    bool LoadCharacters(SaveGameReader& file);
+    void SaveCharacters(SaveGameWriter& file);
+
 private:
     /** \brief A map containing all characters that the player has discovered
     *** This map contains all characters that the player has met with, regardless of whether or not they are in the active party.
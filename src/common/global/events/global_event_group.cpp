@@ -18,33 +18,24 @@ extern bool GLOBAL_DEBUG;
 
 void GlobalEventGroup::AddNewEvent(const std::string &event_name, int32_t event_value)
 {
-    if(DoesEventExist(event_name)) {
+    uint32_t event_id = vt_common::GetStringInterner().Intern(event_name);
+    if(DoesEventExist(event_id)) {
         IF_PRINT_WARNING(GLOBAL_DEBUG) << "an event with the desired name \"" << event_name << "\" already existed in this group: "
                                        << _group_name << std::endl;
         return;
     }
-    _events.insert(std::make_pair(event_name, event_value));
+    _events.Insert(event_id, event_value);
 }
 
-int32_t GlobalEventGroup::GetEvent(const std::string &event_name)
+int32_t GlobalEventGroup::GetEvent(const std::string &event_name) const
 {
-    std::map<std::string, int32_t>::iterator event_iter = _events.find(event_name);
-    if(event_iter == _events.end()) {
+    const int32_t *value = _events.Find(vt_common::GetStringInterner().Find(event_name));
+    if(value == nullptr) {
         IF_PRINT_WARNING(GLOBAL_DEBUG) << "an event with the specified name \"" << event_name << "\" did not exist in this group: "
                                        << _group_name << std::endl;
         return 0;
     }
-    return event_iter->second;
-}
-
-void GlobalEventGroup::SetEvent(const std::string &event_name, int32_t event_value)
-{
-    std::map<std::string, int32_t>::iterator event_iter = _events.find(event_name);
-    if(event_iter == _events.end()) {
-        AddNewEvent(event_name, event_value);
-        return;
-    }
-    event_iter->second = event_value;
+    return *value;
 }
 
 } // namespace vt_global
@@ -11,8 +11,10 @@
 #ifndef __GLOBAL_EVENT_GROUP_HEADER__
 #define __GLOBAL_EVENT_GROUP_HEADER__
 
+#include "common/flat_id_map.h"
+#include "common/string_interner.h"
+
 #include <string>
-#include <map>
 
 namespace vt_global
 {
@@ -36,6 +38,8 @@ namespace vt_global
 *** event group could represent all of the events that occured on a particular
 *** map, for instance.
 ***
+*** The event names are interned, and the events are looked up by name id.
+***
 *** \note Other parts of the code should not have a need to construct objects of
 *** this class. The GameGlobal class maintains a container of GlobalEventGroup
 *** objects and provides methods to allow the creation, modification, and
@@ -54,9 +58,13 @@ public:
     *** \param event_name The name of the event to check for
     *** \return True if the event name was found in the group, false if it was not
     **/
-    bool DoesEventExist(const std::string &event_name) {
-        if(_events.find(event_name) != _events.end()) return true;
-        else return false;
+    bool DoesEventExist(const std::string &event_name) const {
+        return DoesEventExist(vt_common::GetStringInterner().Find(event_name));
+    }
+
+    //! \brief Queries whether or not an event exists in the group, from its interned name id
+    bool DoesEventExist(uint32_t event_id) const {
+        return _events.Contains(event_id);
     }
 
     /** \brief Adds a new event to the group
@@ -72,14 +80,27 @@ public:
     *** \return The value of the event, or 0 if there is no event corresponding to
     *** the requested event named
     **/
-    int32_t GetEvent(const std::string &event_name);
+    int32_t GetEvent(const std::string &event_name) const;
+
+    //! \brief Retrieves the value of an event from its interned name id, or 0 if there is no such event.
+    int32_t GetEvent(uint32_t event_id) const {
+        const int32_t *value = _events.Find(event_id);
+        return value ? *value : 0;
+    }
 
     /** \brief Sets the value for an existing event
     *** \param event_name The name of the event whose value should be changed
     *** \param event_value The value to set for the event.
     *** \note If the event by the given name is not found, the event group will be created.
     **/
-    void SetEvent(const std::string &event_name, int32_t event_value);
+    void SetEvent(const std::string &event_name, int32_t event_value) {
+        SetEvent(vt_common::GetStringInterner().Intern(event_name), event_value);
+    }
+
+    //! \brief Sets the value of an event from its interned name id, adding the event when needed.
+    void SetEvent(uint32_t event_id, int32_t event_value) {
+        _events.Insert(event_id, event_value) = event_value;
+    }
 
     //! \brief Returns a copy of the name of this group
     std::string GetGroupName() const {
@@ -87,7 +108,7 @@ public:
     }
 
     //! \brief Returns an immutable reference to the private _events container
-    const std::map<std::string, int32_t>& GetEvents() const {
+    const vt_common::FlatIdMap<int32_t>& GetEvents() const {
         return _events;
     }
 
@@ -95,12 +116,12 @@ private:
     //! \brief The name given to this group of events
     std::string _group_name;
 
-    /** \brief The map container for all the events in the group
-    *** The string is the name of the event, which is unique within the group. The integer value
+    /** \brief The container for all the events in the group
+    *** The key is the interned name of the event, which is unique within the group. The integer value
     *** represents the event's state and can take on multiple meanings depending on the context
     *** of this specific event.
     **/
-    std::map<std::string, int32_t> _events;
+    vt_common::FlatIdMap<int32_t> _events;
 }; // class GlobalEventGroup
 
 } // namespace vt_global
@@ -12,6 +12,7 @@
 
 using namespace vt_utils;
 using namespace vt_script;
+using namespace vt_common;
 
 namespace vt_global
 {
@@ -28,52 +29,46 @@ GameEvents::~GameEvents()
 void GameEvents::Clear()
 {
     // Delete all event groups
-    for(std::map<std::string, GlobalEventGroup *>::iterator it = _event_groups.begin(); it != _event_groups.end(); ++it) {
-        delete(it->second);
+    for(uint32_t i = 0; i < _event_groups.Size(); ++i) {
+        delete(_event_groups.GetEntries()[i].value);
     }
-    _event_groups.clear();
+    _event_groups.Clear();
 }
 
 bool GameEvents::DoesEventExist(const std::string& group_name, const std::string& event_name) const
 {
-    std::map<std::string, GlobalEventGroup *>::const_iterator group_iter = _event_groups.find(group_name);
-    if(group_iter == _event_groups.end())
-        return false;
-
-    std::map<std::string, int32_t>::const_iterator event_iter = group_iter->second->GetEvents().find(event_name);
-    if(event_iter == group_iter->second->GetEvents().end())
-        return false;
-
-    return true;
+    // Only look the names up, as interning every name checked would grow the interner.
+    const StringInterner& interner = GetStringInterner();
+    return DoesEventExist(EventHandle(interner.Find(group_name), interner.Find(event_name)));
 }
 
 int32_t GameEvents::GetEventValue(const std::string& group_name, const std::string& event_name) const
 {
-    std::map<std::string, GlobalEventGroup *>::const_iterator group_iter = _event_groups.find(group_name);
-    if(group_iter == _event_groups.end())
-        return 0;
-
-    std::map<std::string, int32_t>::const_iterator event_iter = group_iter->second->GetEvents().find(event_name);
-    if(event_iter == group_iter->second->GetEvents().end())
-        return 0;
-
-    return event_iter->second;
+    const StringInterner& interner = GetStringInterner();
+    return GetEventValue(EventHandle(interner.Find(group_name), interner.Find(event_name)));
 }
 
 void GameEvents::SetEventValue(const std::string& group_name,
                                const std::string& event_name,
                                int32_t event_value)
 {
-    GlobalEventGroup* geg = nullptr;
-    std::map<std::string, GlobalEventGroup *>::const_iterator group_iter = _event_groups.find(group_name);
-    if(group_iter == _event_groups.end()) {
-        geg = new GlobalEventGroup(group_name);
-        _event_groups.insert(std::make_pair(group_name, geg));
-    } else {
-        geg = group_iter->second;
+    SetEventValue(GetEventHandle(group_name, event_name), event_value);
+}
+
+EventHandle GameEvents::GetEventHandle(const std::string& group_name, const std::string& event_name) const
+{
+    StringInterner& interner = GetStringInterner();
+    return EventHandle(interner.Intern(group_name), interner.Intern(event_name));
+}
+
+void GameEvents::SetEventValue(const EventHandle& handle, int32_t event_value)
+{
+    if(!handle.IsValid()) {
+        PRINT_WARNING << "Invalid event handle" << std::endl;
+        return;
     }
 
-    geg->SetEvent(event_name, event_value);
+    _GetOrAddEventGroup(handle.group_id)->SetEvent(handle.event_id, event_value);
 }
 
 void GameEvents::SaveEvents(WriteScriptDescriptor& file)
@@ -85,14 +80,14 @@ void GameEvents::SaveEvents(WriteScriptDescriptor& file)
 
     file.InsertNewLine();
     file.WriteLine("event_groups = {");
-    for(auto it = _event_groups.begin(); it != _event_groups.end(); ++it) {
-        GlobalEventGroup* event_group = it->second;
+    for(uint32_t j = 0; j < _event_groups.Size(); ++j) {
+        GlobalEventGroup* event_group = _event_groups.GetEntries()[j].value;
 
         file.WriteLine("\t" + event_group->GetGroupName() + " = {");
 
-        uint32_t i = 0;
-        for(auto it = event_group->GetEvents().begin(); it != event_group->GetEvents().end(); ++it) {
-            if(it == event_group->GetEvents().begin())
+        const std::vector<FlatIdMap<int32_t>::Entry>& events = event_group->GetEvents().GetEntries();
+        for(uint32_t i = 0; i < events.size(); ++i) {
+            if(i == 0)
                 file.WriteLine("\t\t", false);
             else
                 file.WriteLine(", ", false);
@@ -103,9 +98,8 @@ void GameEvents::SaveEvents(WriteScriptDescriptor& file)
                 file.WriteLine("\t\t", false);
             }
 
-            file.WriteLine("[\"" + it->first + "\"] = " + NumberToString(it->second), false);
-
-            ++i;
+            file.WriteLine("[\"" + GetStringInterner().GetString(events[i].key) + "\"] = "
+                           + NumberToString(events[i].value), false);
         }
         file.WriteLine("\n\t},");
 
@@ -151,6 +145,40 @@ void GameEvents::LoadEvents(ReadScriptDescriptor& file)
     file.CloseTable(); // event_groups
 }
 
+void GameEvents::SaveEvents(SaveGameWriter& file)
+{
+    const StringInterner& interner = GetStringInterner();
+    file.WriteUInt32(_event_groups.Size());
+    for(uint32_t i = 0; i < _event_groups.Size(); ++i) {
+        GlobalEventGroup* event_group = _event_groups.GetEntries()[i].value;
+        file.WriteString(event_group->GetGroupName());
+
+        const std::vector<FlatIdMap<int32_t>::Entry>& events = event_group->GetEvents().GetEntries();
+        file.WriteUInt32(static_cast<uint32_t>(events.size()));
+        for(uint32_t j = 0; j < events.size(); ++j) {
+            file.WriteString(interner.GetString(events[j].key));
+            file.WriteInt32(events[j].value);
+        }
+    }
+}
+
+void GameEvents::LoadEvents(SaveGameReader& file)
+{
+    uint32_t number_groups = file.ReadUInt32();
+    for(uint32_t i = 0; i < number_groups && !file.IsErrorDetected(); ++i) {
+        std::string group_name = file.ReadString();
+        _AddNewEventGroup(group_name);
+        // new_group is guaranteed not to be nullptr
+        GlobalEventGroup* new_group = _GetEventGroup(group_name);
+
+        uint32_t number_events = file.ReadUInt32();
+        for(uint32_t j = 0; j < number_events && !file.IsErrorDetected(); ++j) {
+            std::string event_name = file.ReadString();
+            new_group->AddNewEvent(event_name, file.ReadInt32());
+        }
+    }
+}
+
 void GameEvents::_AddNewEventGroup(const std::string& group_name)
 {
     if(_DoesEventGroupExist(group_name)) {
@@ -159,18 +187,27 @@ void GameEvents::_AddNewEventGroup(const std::string& group_name)
         return;
     }
 
-    GlobalEventGroup* geg = new GlobalEventGroup(group_name);
-    _event_groups.insert(std::make_pair(group_name, geg));
+    _GetOrAddEventGroup(GetStringInterner().Intern(group_name));
 }
 
 GlobalEventGroup* GameEvents::_GetEventGroup(const std::string& group_name) const
 {
-    std::map<std::string, GlobalEventGroup *>::const_iterator group_iter = _event_groups.find(group_name);
-    if(group_iter == _event_groups.end()) {
+    GlobalEventGroup* group = _FindEventGroup(GetStringInterner().Find(group_name));
+    if(group == nullptr) {
         PRINT_WARNING << "could not find any event group by the requested name: " << group_name << std::endl;
         return nullptr;
     }
-    return (group_iter->second);
+    return group;
+}
+
+GlobalEventGroup* GameEvents::_GetOrAddEventGroup(uint32_t group_id)
+{
+    GlobalEventGroup* group = _FindEventGroup(group_id);
+    if(group == nullptr) {
+        group = new GlobalEventGroup(GetStringInterner().GetString(group_id));
+        _event_groups.Insert(group_id, group);
+    }
+    return group;
 }
 
 } // namespace vt_global
@@ -13,6 +13,7 @@
 
 #include "script/script_read.h"
 #include "script/script_write.h"
+#include "common/global/global_save.h"
 
 #include "global_event_group.h"
 
@@ -20,6 +21,29 @@
 namespace vt_global
 {
 
+/** \brief Refers to an event from the interned ids of its group and name
+*** The scripts and map objects checking an event every frame keep a handle,
+*** so that no string is hashed or compared on each check.
+**/
+struct EventHandle {
+    EventHandle() :
+        group_id(vt_common::INVALID_STRING_ID),
+        event_id(vt_common::INVALID_STRING_ID)
+    {}
+
+    EventHandle(uint32_t group, uint32_t event) :
+        group_id(group),
+        event_id(event)
+    {}
+
+    bool IsValid() const {
+        return group_id != vt_common::INVALID_STRING_ID && event_id != vt_common::INVALID_STRING_ID;
+    }
+
+    uint32_t group_id;
+    uint32_t event_id;
+};
+
 //! \brief Handle in-game events dictionary.
 class GameEvents
 {
@@ -53,6 +77,28 @@ public:
     **/
     void SetEventValue(const std::string& group_name, const std::string& event_name, int32_t event_value);
 
+    /** \brief Returns the handle of an event, to check it repeatedly
+    *** \param group_name The name of the event group where the event is contained
+    *** \param event_name The name of the event
+    *** \note The event doesn't need to exist, and the handle stays valid across game loads.
+    **/
+    EventHandle GetEventHandle(const std::string& group_name, const std::string& event_name) const;
+
+    //! \brief Determines if the event of the given handle exists.
+    bool DoesEventExist(const EventHandle& handle) const {
+        const GlobalEventGroup* group = _FindEventGroup(handle.group_id);
+        return group && group->DoesEventExist(handle.event_id);
+    }
+
+    //! \brief Returns the value of the event of the given handle, or 0 if the event was not found.
+    int32_t GetEventValue(const EventHandle& handle) const {
+        const GlobalEventGroup* group = _FindEventGroup(handle.group_id);
+        return group ? group->GetEvent(handle.event_id) : 0;
+    }
+
+    //! \brief Sets the value of the event of the given handle, creating the event and its group when necessary.
+    void SetEventValue(const EventHandle& handle, int32_t event_value);
+
     /** \brief A helper function to GameGlobal::SaveGame() that writes a group of event data to the saved game file
     *** \param file A reference to the open and valid file where to write the event data
     *** This method will need to be called once for each GlobalEventGroup contained by this class.
@@ -64,15 +110,30 @@ public:
     **/
     void LoadEvents(vt_script::ReadScriptDescriptor& file);
 
+    //! \brief Writes the event groups to a binary save game section
+    void SaveEvents(SaveGameWriter& file);
+
+    //! \brief Loads the event groups from a binary save game section
+    void LoadEvents(SaveGameReader& file);
+
 private:
     /** \brief Queries whether or not an event group of a given name exists
     *** \param group_name The name of the event group to check for
     *** \return True if the event group name was found, false if it was not
     **/
     bool _DoesEventGroupExist(const std::string& group_name) const {
-        return (_event_groups.find(group_name) != _event_groups.end());
+        return _event_groups.Contains(vt_common::GetStringInterner().Find(group_name));
+    }
+
+    //! \brief Returns the event group of the given interned name id, or nullptr if it doesn't exist.
+    GlobalEventGroup* _FindEventGroup(uint32_t group_id) const {
+        GlobalEventGroup* const* group = _event_groups.Find(group_id);
+        return group ? *group : nullptr;
     }
 
+    //! \brief Returns the event group of the given interned name id, creating it when necessary.
+    GlobalEventGroup* _GetOrAddEventGroup(uint32_t group_id);
+
     /** \brief Adds a new event group for the class to manage
     *** \param group_name The name of the new event group to add
     *** \note If an event group  by the given name already exists, the function will abort
@@ -89,9 +150,9 @@ private:
     GlobalEventGroup* _GetEventGroup(const std::string& group_name) const;
 
     /** \brief The container which stores all of the groups of events that have occured in the game
-    *** The name of each GlobalEventGroup object serves as its key in this map data structure.
+    *** The interned name of each GlobalEventGroup object serves as its key in this map data structure.
     **/
-    std::map<std::string, GlobalEventGroup*> _event_groups;
+    vt_common::FlatIdMap<GlobalEventGroup*> _event_groups;
 };
 
 } // namespace vt_global
@@ -21,6 +21,8 @@
 
 #include "common/app_settings.h"
 
+#include <chrono>
+
 using namespace vt_utils;
 using namespace vt_common;
 
@@ -37,7 +39,12 @@ bool GLOBAL_DEBUG = false;
 GameGlobal::GameGlobal() :
     _game_slot_id(std::numeric_limits<uint32_t>::max()),
     _drunes(0),
-    _max_experience_level(100)
+    _max_experience_level(100),
+    _weapon_skills_script("data/skills/weapon.lua", "skills"),
+    _magic_skills_script("data/skills/magic.lua", "skills"),
+    _special_skills_script("data/skills/special.lua", "skills"),
+    _bare_hands_skills_script("data/skills/barehands.lua", "skills"),
+    _enemies_script("data/entities/enemies.lua", "enemies")
 {
     IF_PRINT_DEBUG(GLOBAL_DEBUG) << "GameGlobal constructor invoked" << std::endl;
 }
@@ -46,6 +53,9 @@ GameGlobal::~GameGlobal()
 {
     IF_PRINT_DEBUG(GLOBAL_DEBUG) << "GameGlobal destructor invoked" << std::endl;
 
+    // Don't lose an autosave still being written.
+    _save_write_thread.Shutdown();
+
     ClearAllData();
 
     _CloseGlobalScripts();
@@ -66,17 +76,10 @@ void GameGlobal::_CloseGlobalScripts() {
 
     _inventory_handler.CloseScripts();
 
-    _weapon_skills_script.CloseTable();
-    _weapon_skills_script.CloseFile();
-
-    _magic_skills_script.CloseTable();
-    _magic_skills_script.CloseFile();
-
-    _special_skills_script.CloseTable();
-    _special_skills_script.CloseFile();
-
-    _bare_hands_skills_script.CloseTable();
-    _bare_hands_skills_script.CloseFile();
+    _weapon_skills_script.Close();
+    _magic_skills_script.Close();
+    _special_skills_script.Close();
+    _bare_hands_skills_script.Close();
 
     _status_effects_script.CloseTable();
     _status_effects_script.CloseFile();
@@ -84,8 +87,7 @@ void GameGlobal::_CloseGlobalScripts() {
     _characters_script.CloseTable();
     _characters_script.CloseFile();
 
-    _enemies_script.CloseTable();
-    _enemies_script.CloseFile();
+    _enemies_script.Close();
 
     _map_sprites_script.CloseFile();
     _map_objects_script.CloseFile();
@@ -94,23 +96,18 @@ void GameGlobal::_CloseGlobalScripts() {
 
 bool GameGlobal::_LoadGlobalScripts()
 {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
     // Open up the persistent script files
     if(!_global_script.OpenFile("data/global.lua"))
         return false;
 
+    // The object, skill and enemy definitions are only checked, and run when first used.
     if (!_inventory_handler.LoadScripts())
         return false;
 
-    if(!_weapon_skills_script.OpenFile("data/skills/weapon.lua") || !_weapon_skills_script.OpenTable("skills"))
-        return false;
-
-    if(!_magic_skills_script.OpenFile("data/skills/magic.lua") || !_magic_skills_script.OpenTable("skills"))
-       return false;
-
-    if(!_special_skills_script.OpenFile("data/skills/special.lua") || !_special_skills_script.OpenTable("skills"))
-        return false;
-
-    if(!_bare_hands_skills_script.OpenFile("data/skills/barehands.lua") || !_bare_hands_skills_script.OpenTable("skills"))
+    if(!_weapon_skills_script.Check() || !_magic_skills_script.Check()
+            || !_special_skills_script.Check() || !_bare_hands_skills_script.Check())
         return false;
 
     if(!_status_effects_script.OpenFile("data/entities/status_effects/status_effects.lua") || !_status_effects_script.OpenTable("status_effects"))
@@ -119,7 +116,7 @@ bool GameGlobal::_LoadGlobalScripts()
     if(!_characters_script.OpenFile("data/entities/characters.lua") || !_characters_script.OpenTable("characters"))
         return false;
 
-    if(!_enemies_script.OpenFile("data/entities/enemies.lua") || !_enemies_script.OpenTable("enemies"))
+    if(!_enemies_script.Check())
         return false;
 
     if(!_map_sprites_script.OpenFile("data/entities/map_sprites.lua") || !_map_sprites_script.OpenTable("sprites"))
@@ -140,6 +137,9 @@ bool GameGlobal::_LoadGlobalScripts()
     if (!_skill_graph.Initialize("data/config/skill_graph.lua"))
         return false;
 
+    IF_PRINT_DEBUG(GLOBAL_DEBUG) << "Global scripts loaded in "
+                                 << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count()
+                                 << " ms" << std::endl;
     return true;
 }
 
@@ -190,11 +190,10 @@ bool GameGlobal::AutoSave(const std::string& map_data_file,
                           uint32_t x_position, uint32_t y_position)
 {
     // Don't autosave when the save slot was not yet chosen
-    if (GetGameSlotId() == std::numeric_limits<uint32_t>::max())
+    if (GetGameSlotId() >= SystemManager->GetGameSaveSlots())
         return false;
 
-    std::ostringstream filename;
-    filename << GetUserDataPath() + "saved_game_" << GetGameSlotId() << "_autosave.lua";
+    std::string filename = GetSaveGameFilename(GetGameSlotId(), true);
 
     // Make the map location known globally to other code that may need to know this information
     std::string previous_map_data = _map_data_handler.GetMapDataFilename();
@@ -205,13 +204,22 @@ bool GameGlobal::AutoSave(const std::string& map_data_file,
     _map_data_handler.SetMapScriptFilename(map_script_file);
     _map_data_handler.SetSaveStamina(stamina);
 
-    bool save_completed = SaveGame(filename.str(), GetGameSlotId(), x_position, y_position);
+    // Only the encoding is done here, which makes it a snapshot of the game state.
+    SaveGameWriter file;
+    SaveGamePreview preview;
+    _WriteSaveGame(file, preview, x_position, y_position);
 
     // Restore previous map data
     _map_data_handler.SetMapDataFilename(previous_map_data);
     _map_data_handler.SetMapScriptFilename(previous_map_script);
 
-    return save_completed;
+    std::vector<uint8_t> data;
+    file.TakeData(data);
+    _save_game_index.SetPreview(filename, preview, data);
+    _save_write_thread.Write(filename, data);
+    WriteSaveGameIndex();
+
+    return true;
 }
 
 bool GameGlobal::SaveGame(const std::string& filename,
@@ -222,45 +230,99 @@ bool GameGlobal::SaveGame(const std::string& filename,
     if (slot_id >= SystemManager->GetGameSaveSlots())
         return false;
 
-    WriteScriptDescriptor file;
-    if(file.OpenFile(filename) == false) {
+    // Make sure an older autosave of the slot isn't written afterwards.
+    _save_write_thread.Flush();
+
+    SaveGameWriter file;
+    SaveGamePreview preview;
+    _WriteSaveGame(file, preview, x_position, y_position);
+
+    if(!file.SaveFile(filename))
         return false;
+
+    _save_game_index.SetPreview(filename, preview, file.GetData());
+    WriteSaveGameIndex();
+
+    // Store the game slot the game is coming from.
+    _game_slot_id = slot_id;
+
+    return true;
+}
+
+bool GameGlobal::LoadGame(const std::string &filename, uint32_t slot_id)
+{
+    _save_write_thread.Flush();
+
+    // The save games of the former versions are imported, and written in the binary format when saving.
+    if(!IsBinarySaveGame(filename)) {
+        if(!_ImportLuaSaveGame(filename))
+            return false;
+
+        _game_slot_id = slot_id;
+        return true;
     }
 
-    // Open the save_game1 table
-    file.WriteLine("save_game1 = {");
+    SaveGameReader file;
+    if(!file.OpenFile(filename)) {
+        PRINT_ERROR << "Couldn't open the savegame " << filename << std::endl;
+        return false;
+    }
 
-    // Save simple play data
-    file.InsertNewLine();
-    file.WriteLine("play_hours = " + NumberToString(SystemManager->GetPlayHours()) + ",");
-    file.WriteLine("play_minutes = " + NumberToString(SystemManager->GetPlayMinutes()) + ",");
-    file.WriteLine("play_seconds = " + NumberToString(SystemManager->GetPlaySeconds()) + ",");
-    file.WriteLine("drunes = " + NumberToString(_drunes) + ",");
+    // The current game is only cleared once the save game is known to be loadable.
+    if(!file.HasSection(SAVE_SECTION_CHARACTERS)) {
+        PRINT_ERROR << "Couldn't open the savegame characters data in " << filename << std::endl;
+        return false;
+    }
 
-    _map_data_handler.Save(file, x_position, y_position);
+    ClearAllData();
 
-    _inventory_handler.SaveInventory(file);
+    const SaveGamePreview& preview = file.GetPreview();
+    SystemManager->SetPlayTime(preview.play_hours, preview.play_minutes, preview.play_seconds);
+    _drunes = preview.drunes;
 
-    _character_handler.SaveCharacters(file);
+    if(file.OpenSection(SAVE_SECTION_MAP_DATA)) {
+        _map_data_handler.Load(file);
+        file.CloseSection();
+    }
 
-    _game_events.SaveEvents(file);
+    if(file.OpenSection(SAVE_SECTION_INVENTORY)) {
+        _inventory_handler.LoadInventory(file);
+        file.CloseSection();
+    }
 
-    _game_quests.SaveQuests(file);
+    file.OpenSection(SAVE_SECTION_CHARACTERS);
+    bool characters_loaded = _character_handler.LoadCharacters(file);
+    file.CloseSection();
+    if(!characters_loaded)
+        return false;
 
-    _worldmap_handler.SavePlayerSaveGameWorldMap(file);
+    if(file.OpenSection(SAVE_SECTION_EVENTS)) {
+        _game_events.LoadEvents(file);
+        file.CloseSection();
+    }
 
-    _shop_data_handler.SaveShopData(file);
+    if(file.OpenSection(SAVE_SECTION_QUESTS)) {
+        _game_quests.LoadQuests(file);
+        file.CloseSection();
+    }
 
-    if(file.IsErrorDetected()) {
-        IF_PRINT_WARNING(GLOBAL_DEBUG) << "One or more errors occurred while writing the save game file - they are listed below:" << std::endl
-            << file.GetErrorMessages() << std::endl;
-        file.ClearErrors();
+    if(file.OpenSection(SAVE_SECTION_WORLD_MAP)) {
+        _worldmap_handler.LoadPlayerSaveGameWorldMap(file);
+        file.CloseSection();
+    }
+    else {
+        PRINT_WARNING << "The save game file doesn't provide world map information" << std::endl;
     }
 
-    file.InsertNewLine();
-    file.WriteLine("} -- save_game1"); //save_game1
+    if(file.OpenSection(SAVE_SECTION_SHOP_DATA)) {
+        _shop_data_handler.LoadShopData(file);
+        file.CloseSection();
+    }
 
-    file.CloseFile();
+    if(file.IsErrorDetected()) {
+        PRINT_WARNING << "One or more errors occurred while reading the save game file: "
+                      << filename << std::endl;
+    }
 
     // Store the game slot the game is coming from.
     _game_slot_id = slot_id;
@@ -268,20 +330,20 @@ bool GameGlobal::SaveGame(const std::string& filename,
     return true;
 }
 
-bool GameGlobal::LoadGame(const std::string &filename, uint32_t slot_id)
+bool GameGlobal::_ImportLuaSaveGame(const std::string &filename)
 {
     ReadScriptDescriptor file;
     if(!file.OpenFile(filename))
         return false;
 
-    ClearAllData();
-
     // open the namespace that the save game is encapsulated in.
     if (!file.OpenTable("save_game1")) {
         PRINT_ERROR << "Couldn't open the savegame " << filename << std::endl;
         return false;
     }
 
+    ClearAllData();
+
     _map_data_handler.Load(file);
 
     uint8_t hours, minutes, seconds;
@@ -315,10 +377,75 @@ bool GameGlobal::LoadGame(const std::string &filename, uint32_t slot_id)
 
     file.CloseFile();
 
-    // Store the game slot the game is coming from.
-    _game_slot_id = slot_id;
-
     return true;
 }
 
+void GameGlobal::WriteSaveGameIndex()
+{
+    if(!_save_game_index.IsModified())
+        return;
+
+    // Written after the save games queued before, so that it never describes a file not written yet.
+    std::vector<uint8_t> data;
+    _save_game_index.WriteData(data);
+    _save_write_thread.Write(SaveGameIndex::GetFilename(), data);
+}
+
+void GameGlobal::_WriteSaveGame(SaveGameWriter& file, SaveGamePreview& preview,
+                                uint32_t x_position, uint32_t y_position)
+{
+    // Save the data shown in the save menu first, so that it can be read alone
+    preview = SaveGamePreview();
+    preview.play_hours = SystemManager->GetPlayHours();
+    preview.play_minutes = SystemManager->GetPlayMinutes();
+    preview.play_seconds = SystemManager->GetPlaySeconds();
+    preview.drunes = _drunes;
+    preview.map_data_filename = _map_data_handler.GetMapDataFilename();
+    preview.map_script_filename = _map_data_handler.GetMapScriptFilename();
+
+    const std::vector<GlobalCharacter *>& characters = *_character_handler.GetOrderedCharacters();
+    for(uint32_t i = 0; i < characters.size() && i < SAVE_PREVIEW_CHARACTERS; ++i) {
+        SaveGamePreviewCharacter character;
+        character.id = characters[i]->GetID();
+        character.experience_level = characters[i]->GetExperienceLevel();
+        character.total_experience_points = characters[i]->GetTotalExperiencePoints();
+        character.unspent_experience_points = characters[i]->GetUnspentExperiencePoints();
+        character.experience_points_next = characters[i]->GetExperienceForNextLevel();
+        character.max_hit_points = characters[i]->GetMaxHitPoints();
+        character.hit_points = characters[i]->GetHitPoints();
+        character.max_skill_points = characters[i]->GetMaxSkillPoints();
+        character.skill_points = characters[i]->GetSkillPoints();
+        preview.characters.push_back(character);
+    }
+    file.WritePreview(preview);
+
+    file.BeginSection(SAVE_SECTION_MAP_DATA);
+    _map_data_handler.Save(file, x_position, y_position);
+    file.EndSection();
+
+    file.BeginSection(SAVE_SECTION_INVENTORY);
+    _inventory_handler.SaveInventory(file);
+    file.EndSection();
+
+    file.BeginSection(SAVE_SECTION_CHARACTERS);
+    _character_handler.SaveCharacters(file);
+    file.EndSection();
+
+    file.BeginSection(SAVE_SECTION_EVENTS);
+    _game_events.SaveEvents(file);
+    file.EndSection();
+
+    file.BeginSection(SAVE_SECTION_QUESTS);
+    _game_quests.SaveQuests(file);
+    file.EndSection();
+
+    file.BeginSection(SAVE_SECTION_WORLD_MAP);
+    _worldmap_handler.SavePlayerSaveGameWorldMap(file);
+    file.EndSection();
+
+    file.BeginSection(SAVE_SECTION_SHOP_DATA);
+    _shop_data_handler.SaveShopData(file);
+    file.EndSection();
+}
+
 } // namespace vt_global
@@ -28,6 +28,8 @@
 #include "objects/global_armor.h"
 #include "objects/global_weapon.h"
 
+#include "global_definition_script.h"
+#include "global_save.h"
 #include "global_skills.h"
 
 #include "events/global_events.h"
@@ -100,11 +102,26 @@ public:
     **/
     bool SaveGame(const std::string &filename, uint32_t slot_id, uint32_t x_position = 0, uint32_t y_position = 0);
 
-    //! \brief Attempts an autosave on the current slot, using given map and location.
+    /** \brief Attempts an autosave on the current slot, using given map and location.
+    *** The game state is captured right away, but written to disk in the background.
+    **/
     bool AutoSave(const std::string& map_data_file, const std::string& map_script_file,
                   uint32_t stamina,
                   uint32_t x_position = 0, uint32_t y_position = 0);
 
+    //! \brief Waits for the autosaves being written. To be called before reading the save game files.
+    void WaitForSaveGames() {
+        _save_write_thread.Flush();
+    }
+
+    //! \brief Gives access to the cached previews of the save games, as shown in the save menu.
+    SaveGameIndex& GetSaveGameIndex() {
+        return _save_game_index;
+    }
+
+    //! \brief Writes the save games index in the background, when it was modified.
+    void WriteSaveGameIndex();
+
     //! \brief Gets the last load/save position.
     uint32_t GetGameSlotId() const {
         return _game_slot_id;
@@ -140,19 +157,19 @@ public:
     bool DoesEnemyExist(uint32_t enemy_id);
 
     vt_script::ReadScriptDescriptor& GetWeaponSkillsScript() {
-        return _weapon_skills_script;
+        return _weapon_skills_script.Get();
     }
 
     vt_script::ReadScriptDescriptor& GetMagicSkillsScript() {
-        return _magic_skills_script;
+        return _magic_skills_script.Get();
     }
 
     vt_script::ReadScriptDescriptor& GetSpecialSkillsScript() {
-        return _special_skills_script;
+        return _special_skills_script.Get();
     }
 
     vt_script::ReadScriptDescriptor& GetBareHandsSkillsScript() {
-        return _bare_hands_skills_script;
+        return _bare_hands_skills_script.Get();
     }
 
     vt_script::ReadScriptDescriptor& GetStatusEffectsScript() {
@@ -164,7 +181,7 @@ public:
     }
 
     vt_script::ReadScriptDescriptor& GetEnemiesScript() {
-        return _enemies_script;
+        return _enemies_script.Get();
     }
 
     vt_script::ReadScriptDescriptor& GetMapSpriteScript() {
@@ -230,6 +247,12 @@ private:
     //! \brief The slot id the game was loaded from/saved to, or 0 if none.
     uint32_t _game_slot_id;
 
+    //! \brief Writes the autosaves to disk in the background.
+    SaveGameWriteThread _save_write_thread;
+
+    //! \brief The cached previews of the save games
+    SaveGameIndex _save_game_index;
+
     //! \brief The amount of financial resources (drunes) that the party currently has
     uint32_t _drunes;
 
@@ -269,16 +292,16 @@ private:
     vt_script::ReadScriptDescriptor _global_script;
 
     //! \brief Contains data and functional definitions for all weapon skills
-    vt_script::ReadScriptDescriptor _weapon_skills_script;
+    DefinitionScript _weapon_skills_script;
 
     //! \brief Contains data and functional definitions for all magic skills
-    vt_script::ReadScriptDescriptor _magic_skills_script;
+    DefinitionScript _magic_skills_script;
 
     //! \brief Contains data and functional definitions for all special skills
-    vt_script::ReadScriptDescriptor _special_skills_script;
+    DefinitionScript _special_skills_script;
 
     //! \brief Contains data and functional definitions for all bare hands skills
-    vt_script::ReadScriptDescriptor _bare_hands_skills_script;
+    DefinitionScript _bare_hands_skills_script;
 
     //! \brief Contains functional definitions for all status effects
     vt_script::ReadScriptDescriptor _status_effects_script;
@@ -287,7 +310,7 @@ private:
     vt_script::ReadScriptDescriptor _characters_script;
 
     //! \brief Contains data and functional definitions for enemies
-    vt_script::ReadScriptDescriptor _enemies_script;
+    DefinitionScript _enemies_script;
 
     //! \brief Contains data and functional definitions for sprites seen in game maps
     vt_script::ReadScriptDescriptor _map_sprites_script;
@@ -299,6 +322,17 @@ private:
     vt_script::ReadScriptDescriptor _map_treasures_script;
     //@}
 
+    /** \brief Loads all global data from a save game of the former versions, written in Lua.
+    *** \return True if the game was successfully loaded, false if it was not
+    **/
+    bool _ImportLuaSaveGame(const std::string &filename);
+
+    /** \brief Encodes all global data in a save game.
+    *** \param preview Filled with the preview written at the beginning of the save game
+    **/
+    void _WriteSaveGame(SaveGameWriter& file, SaveGamePreview& preview,
+                        uint32_t x_position, uint32_t y_position);
+
     //! \brief Loads every persistent scripts, used at the global initialization time.
     bool _LoadGlobalScripts();
 
@@ -0,0 +1,80 @@
+////////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2018 by Bertram (Valyria Tear)
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+////////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file   global_definition_script.cpp
+*** \author Yohann Ferreira, yohann ferreira orange fr
+*** \brief  Source file for the definition scripts opened on first use
+*** ***************************************************************************/
+
+#include "global_definition_script.h"
+
+#include "utils/utils_common.h"
+#include "utils/utils_files.h"
+
+#include <chrono>
+
+using namespace vt_script;
+using namespace vt_utils;
+
+namespace vt_global
+{
+
+extern bool GLOBAL_DEBUG;
+
+DefinitionScript::DefinitionScript(const std::string& filename, const std::string& table_name) :
+    _filename(filename),
+    _table_name(table_name),
+    _loaded(false)
+{
+}
+
+bool DefinitionScript::Check() const
+{
+    if(DoesFileExist(_filename))
+        return true;
+
+    PRINT_ERROR << "Missing definition script: " << _filename << std::endl;
+    return false;
+}
+
+ReadScriptDescriptor& DefinitionScript::Get()
+{
+    if(_loaded)
+        return _script;
+    _loaded = true;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    if(!_script.OpenFile(_filename)) {
+        PRINT_ERROR << "Couldn't open the definition script: " << _filename << std::endl;
+        return _script;
+    }
+    if(!_script.OpenTable(_table_name)) {
+        PRINT_ERROR << "No '" << _table_name << "' table in the definition script: " << _filename << std::endl;
+        _script.CloseFile();
+        return _script;
+    }
+
+    IF_PRINT_DEBUG(GLOBAL_DEBUG) << "Loaded " << _filename << " on first use in "
+                                 << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count()
+                                 << " ms" << std::endl;
+    return _script;
+}
+
+void DefinitionScript::Close()
+{
+    if(_script.IsFileOpen()) {
+        _script.CloseTable();
+        _script.CloseFile();
+    }
+    _loaded = false;
+}
+
+} // namespace vt_global
@@ -0,0 +1,78 @@
+////////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2018 by Bertram (Valyria Tear)
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+////////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file   global_definition_script.h
+*** \author Yohann Ferreira, yohann ferreira orange fr
+*** \brief  Header file for the definition scripts opened on first use
+*** ***************************************************************************/
+
+#ifndef __GLOBAL_DEFINITION_SCRIPT_HEADER__
+#define __GLOBAL_DEFINITION_SCRIPT_HEADER__
+
+#include "script/script_read.h"
+
+namespace vt_global
+{
+
+/** ****************************************************************************
+*** \brief A script of object, skill or enemy definitions, run on first use
+***
+*** The definition files are large, and a game session only uses a part of
+*** them: running each of them at boot time delays the boot menu. The id ranges
+*** already tell which file defines an id, so the file is only checked at boot
+*** time, and run the first time a definition is read from it. The objects,
+*** skills and enemies are then created from the definitions table, kept open.
+*** ***************************************************************************/
+class DefinitionScript
+{
+public:
+    /** \param filename The definition script file
+    *** \param table_name The table holding the definitions, by id
+    **/
+    DefinitionScript(const std::string& filename, const std::string& table_name);
+
+    ~DefinitionScript() {
+        Close();
+    }
+
+    //! \brief Tells whether the script file exists, without running it.
+    bool Check() const;
+
+    /** \brief Returns the script, with its definitions table open
+    *** The script is run on the first call. When it couldn't be, the returned
+    *** script isn't open, and its reads only fail.
+    **/
+    vt_script::ReadScriptDescriptor& Get();
+
+    //! \brief Closes the script, to run it again on next use, e.g. once the language changed.
+    void Close();
+
+    bool IsLoaded() const {
+        return _loaded;
+    }
+
+    const std::string& GetFilename() const {
+        return _filename;
+    }
+
+private:
+    vt_script::ReadScriptDescriptor _script;
+
+    std::string _filename;
+
+    std::string _table_name;
+
+    //! \brief Whether the script was run already, even unsuccessfully, so that it isn't tried each time
+    bool _loaded;
+};
+
+} // namespace vt_global
+
+#endif // __GLOBAL_DEFINITION_SCRIPT_HEADER__
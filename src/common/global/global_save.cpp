@@ -0,0 +1,826 @@
+////////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2018 by Bertram (Valyria Tear)
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+////////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file   global_save.cpp
+*** \author Yohann Ferreira, yohann ferreira orange fr
+*** \brief  Implementation of the binary save game format
+*** ***************************************************************************/
+
+#include "global_save.h"
+
+#include "common/app_settings.h"
+
+#include "utils/utils_common.h"
+#include "utils/utils_files.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+using namespace vt_utils;
+using namespace vt_common;
+
+namespace vt_global
+{
+
+extern bool GLOBAL_DEBUG;
+
+//! \brief The size of the magic, format version and preview size at the beginning of the file
+const size_t SAVE_GAME_HEADER_SIZE = 12;
+
+//! \brief The maximum size of the preview block, to avoid reading a corrupted file at length
+const uint32_t SAVE_PREVIEW_MAX_SIZE = 64 * 1024;
+
+//! \brief Reads a little endian 32-bit number.
+static uint32_t _ReadLittleEndian(const uint8_t *data)
+{
+    return static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8)
+           | (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24);
+}
+
+//! \brief Checks the file magic and version, and returns the preview size, or 0 on error.
+static uint32_t _CheckHeader(const uint8_t *header, const std::string& filename)
+{
+    if(memcmp(header, SAVE_GAME_MAGIC, sizeof(SAVE_GAME_MAGIC)) != 0)
+        return 0;
+
+    uint32_t version = _ReadLittleEndian(header + 4);
+    if(version == 0 || version > SAVE_GAME_VERSION) {
+        PRINT_WARNING << "The save game " << filename << " was made with a newer game version (format "
+                      << version << ")" << std::endl;
+        return 0;
+    }
+
+    uint32_t preview_size = _ReadLittleEndian(header + 8);
+    if(preview_size == 0 || preview_size > SAVE_PREVIEW_MAX_SIZE) {
+        PRINT_WARNING << "Invalid preview in the save game " << filename << std::endl;
+        return 0;
+    }
+    return preview_size;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// SaveGameWriter class methods
+////////////////////////////////////////////////////////////////////////////////
+
+SaveGameWriter::SaveGameWriter() :
+    SaveGameWriter(SAVE_GAME_MAGIC, SAVE_GAME_VERSION)
+{
+}
+
+SaveGameWriter::SaveGameWriter(const char *magic, uint32_t version) :
+    _section_size_offset(0)
+{
+    _data.reserve(16 * 1024);
+    _data.insert(_data.end(), magic, magic + sizeof(SAVE_GAME_MAGIC));
+    WriteUInt32(version);
+}
+
+void SaveGameWriter::WritePreview(const SaveGamePreview& preview)
+{
+    if(_data.size() != SAVE_GAME_HEADER_SIZE - 4) {
+        PRINT_WARNING << "The preview must be written first" << std::endl;
+        return;
+    }
+
+    size_t size_offset = _data.size();
+    WriteUInt32(0);
+    _WritePreviewData(preview);
+    _WriteSizeAt(size_offset);
+}
+
+void SaveGameWriter::_WritePreviewData(const SaveGamePreview& preview)
+{
+    WriteUInt32(preview.play_hours);
+    WriteUInt32(preview.play_minutes);
+    WriteUInt32(preview.play_seconds);
+    WriteUInt32(preview.drunes);
+    WriteString(preview.map_data_filename);
+    WriteString(preview.map_script_filename);
+
+    uint32_t number_characters = std::min(static_cast<uint32_t>(preview.characters.size()), SAVE_PREVIEW_CHARACTERS);
+    WriteUInt32(number_characters);
+    for(uint32_t i = 0; i < number_characters; ++i) {
+        const SaveGamePreviewCharacter& character = preview.characters[i];
+        WriteUInt32(character.id);
+        WriteUInt32(character.experience_level);
+        WriteUInt32(character.total_experience_points);
+        WriteUInt32(character.unspent_experience_points);
+        WriteInt32(character.experience_points_next);
+        WriteUInt32(character.max_hit_points);
+        WriteUInt32(character.hit_points);
+        WriteUInt32(character.max_skill_points);
+        WriteUInt32(character.skill_points);
+    }
+}
+
+void SaveGameWriter::BeginSection(SAVE_SECTION section)
+{
+    if(_section_size_offset != 0) {
+        PRINT_WARNING << "The previous section wasn't ended" << std::endl;
+        EndSection();
+    }
+
+    WriteUInt32(section);
+    _section_size_offset = _data.size();
+    WriteUInt32(0);
+}
+
+void SaveGameWriter::EndSection()
+{
+    if(_section_size_offset == 0)
+        return;
+
+    _WriteSizeAt(_section_size_offset);
+    _section_size_offset = 0;
+}
+
+void SaveGameWriter::WriteUInt8(uint8_t value)
+{
+    _data.push_back(value);
+}
+
+void SaveGameWriter::WriteUInt32(uint32_t value)
+{
+    _data.push_back(static_cast<uint8_t>(value));
+    _data.push_back(static_cast<uint8_t>(value >> 8));
+    _data.push_back(static_cast<uint8_t>(value >> 16));
+    _data.push_back(static_cast<uint8_t>(value >> 24));
+}
+
+void SaveGameWriter::WriteInt32(int32_t value)
+{
+    WriteUInt32(static_cast<uint32_t>(value));
+}
+
+void SaveGameWriter::WriteFloat(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    WriteUInt32(bits);
+}
+
+void SaveGameWriter::WriteBool(bool value)
+{
+    WriteUInt8(value ? 1 : 0);
+}
+
+void SaveGameWriter::WriteString(const std::string& value)
+{
+    WriteUInt32(static_cast<uint32_t>(value.size()));
+    _data.insert(_data.end(), value.begin(), value.end());
+}
+
+void SaveGameWriter::WriteUIntVector(const std::vector<uint32_t>& values)
+{
+    WriteUInt32(static_cast<uint32_t>(values.size()));
+    for(uint32_t i = 0; i < values.size(); ++i)
+        WriteUInt32(values[i]);
+}
+
+bool SaveGameWriter::SaveFile(const std::string& filename) const
+{
+    if(_section_size_offset != 0) {
+        PRINT_WARNING << "The last section wasn't ended: " << filename << std::endl;
+        return false;
+    }
+
+    return WriteSaveGameFile(filename, _data);
+}
+
+void SaveGameWriter::_WriteSizeAt(size_t offset)
+{
+    uint32_t size = static_cast<uint32_t>(_data.size() - offset - 4);
+    _data[offset] = static_cast<uint8_t>(size);
+    _data[offset + 1] = static_cast<uint8_t>(size >> 8);
+    _data[offset + 2] = static_cast<uint8_t>(size >> 16);
+    _data[offset + 3] = static_cast<uint8_t>(size >> 24);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// SaveGameReader class methods
+////////////////////////////////////////////////////////////////////////////////
+
+SaveGameReader::SaveGameReader() :
+    _position(0),
+    _end(0),
+    _error(false)
+{
+}
+
+bool SaveGameReader::OpenFile(const std::string& filename)
+{
+    if(!_LoadFile(filename)) {
+        PRINT_WARNING << "Couldn't open the save game: " << filename << std::endl;
+        return false;
+    }
+
+    if(_data.size() < SAVE_GAME_HEADER_SIZE)
+        return false;
+
+    uint32_t preview_size = _CheckHeader(_data.data(), filename);
+    if(preview_size == 0 || preview_size > _data.size() - SAVE_GAME_HEADER_SIZE)
+        return false;
+
+    _position = SAVE_GAME_HEADER_SIZE;
+    _end = SAVE_GAME_HEADER_SIZE + preview_size;
+    _ReadPreview(_preview);
+    if(_error) {
+        PRINT_WARNING << "Invalid preview in the save game " << filename << std::endl;
+        return false;
+    }
+
+    // Index the sections, so that they can be read in any order.
+    size_t offset = SAVE_GAME_HEADER_SIZE + preview_size;
+    while(_data.size() - offset >= 8) {
+        SectionLocation location;
+        location.id = _ReadLittleEndian(&_data[offset]);
+        location.size = _ReadLittleEndian(&_data[offset + 4]);
+        location.offset = offset + 8;
+        if(location.size > _data.size() - location.offset) {
+            PRINT_WARNING << "The save game " << filename << " is truncated" << std::endl;
+            return false;
+        }
+        _sections.push_back(location);
+        offset = location.offset + location.size;
+    }
+
+    _position = 0;
+    _end = 0;
+    return true;
+}
+
+bool SaveGameReader::OpenSection(SAVE_SECTION section)
+{
+    for(uint32_t i = 0; i < _sections.size(); ++i) {
+        if(_sections[i].id != static_cast<uint32_t>(section))
+            continue;
+
+        _position = _sections[i].offset;
+        _end = _sections[i].offset + _sections[i].size;
+        return true;
+    }
+    return false;
+}
+
+void SaveGameReader::CloseSection()
+{
+    _position = 0;
+    _end = 0;
+}
+
+bool SaveGameReader::HasSection(SAVE_SECTION section) const
+{
+    for(uint32_t i = 0; i < _sections.size(); ++i) {
+        if(_sections[i].id == static_cast<uint32_t>(section))
+            return true;
+    }
+    return false;
+}
+
+uint8_t SaveGameReader::ReadUInt8()
+{
+    if(!_CanRead(1))
+        return 0;
+    return _data[_position++];
+}
+
+uint32_t SaveGameReader::ReadUInt32()
+{
+    if(!_CanRead(4))
+        return 0;
+    uint32_t value = _ReadLittleEndian(&_data[_position]);
+    _position += 4;
+    return value;
+}
+
+int32_t SaveGameReader::ReadInt32()
+{
+    return static_cast<int32_t>(ReadUInt32());
+}
+
+float SaveGameReader::ReadFloat()
+{
+    uint32_t bits = ReadUInt32();
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+bool SaveGameReader::ReadBool()
+{
+    return ReadUInt8() != 0;
+}
+
+std::string SaveGameReader::ReadString()
+{
+    uint32_t size = ReadUInt32();
+    if(!_CanRead(size))
+        return std::string();
+
+    std::string value(reinterpret_cast<const char *>(&_data[_position]), size);
+    _position += size;
+    return value;
+}
+
+void SaveGameReader::ReadUIntVector(std::vector<uint32_t>& values)
+{
+    values.clear();
+    uint32_t number_values = ReadUInt32();
+    // Don't trust the count before knowing the values are there.
+    if(!_CanRead(static_cast<size_t>(number_values) * 4))
+        return;
+
+    values.reserve(number_values);
+    for(uint32_t i = 0; i < number_values; ++i)
+        values.push_back(ReadUInt32());
+}
+
+bool SaveGameReader::_LoadFile(const std::string& filename)
+{
+    _filename = filename;
+    _data.clear();
+    _sections.clear();
+    _preview = SaveGamePreview();
+    _position = 0;
+    _end = 0;
+    _error = false;
+
+    std::ifstream file(filename.c_str(), std::ios::binary);
+    if(!file.is_open())
+        return false;
+
+    file.seekg(0, std::ios::end);
+    std::streamoff file_size = file.tellg();
+    file.seekg(0, std::ios::beg);
+    if(file_size <= 0)
+        return file_size == 0;
+
+    _data.resize(static_cast<size_t>(file_size));
+    if(!file.read(reinterpret_cast<char *>(_data.data()), file_size)) {
+        _data.clear();
+        return false;
+    }
+    return true;
+}
+
+bool SaveGameReader::_CanRead(size_t size)
+{
+    if(_position <= _end && _end - _position >= size)
+        return true;
+
+    if(!_error) {
+        IF_PRINT_WARNING(GLOBAL_DEBUG) << "Read past the end of a section in the save game: "
+                                       << _filename << std::endl;
+    }
+    _error = true;
+    _position = _end;
+    return false;
+}
+
+void SaveGameReader::_ReadPreview(SaveGamePreview& preview)
+{
+    preview.play_hours = ReadUInt32();
+    preview.play_minutes = ReadUInt32();
+    preview.play_seconds = ReadUInt32();
+    preview.drunes = ReadUInt32();
+    preview.map_data_filename = ReadString();
+    preview.map_script_filename = ReadString();
+
+    uint32_t number_characters = ReadUInt32();
+    if(number_characters > SAVE_PREVIEW_CHARACTERS) {
+        _error = true;
+        return;
+    }
+
+    preview.characters.resize(number_characters);
+    for(uint32_t i = 0; i < number_characters; ++i) {
+        SaveGamePreviewCharacter& character = preview.characters[i];
+        character.id = ReadUInt32();
+        character.experience_level = ReadUInt32();
+        character.total_experience_points = ReadUInt32();
+        character.unspent_experience_points = ReadUInt32();
+        character.experience_points_next = ReadInt32();
+        character.max_hit_points = ReadUInt32();
+        character.hit_points = ReadUInt32();
+        character.max_skill_points = ReadUInt32();
+        character.skill_points = ReadUInt32();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// SaveGameWriteThread class methods
+////////////////////////////////////////////////////////////////////////////////
+
+void SaveGameWriteThread::Shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if(!_running)
+            return;
+        _running = false;
+    }
+    _condition.notify_all();
+    // The thread writes what is still queued before ending.
+    _thread.join();
+}
+
+void SaveGameWriteThread::Write(const std::string& filename, std::vector<uint8_t>& data)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // Drop a save game of the same file which is still waiting, since it is outdated.
+    // The new one is queued last, so that it is still written after what was queued before it.
+    for(uint32_t i = 0; i < _pending.size(); ++i) {
+        if(_pending[i].filename == filename) {
+            _pending.erase(_pending.begin() + i);
+            break;
+        }
+    }
+    _pending.push_back(PendingSaveGame());
+    _pending.back().filename = filename;
+    _pending.back().data.swap(data);
+    data.clear();
+
+    if(!_running) {
+        _running = true;
+        _thread = std::thread(&SaveGameWriteThread::_Run, this);
+    }
+    _condition.notify_all();
+}
+
+void SaveGameWriteThread::Flush()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while(!_pending.empty() || _writing)
+        _condition.wait(lock);
+}
+
+void SaveGameWriteThread::_Run()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while(_running || !_pending.empty()) {
+        if(_pending.empty()) {
+            _condition.wait(lock);
+            continue;
+        }
+
+        PendingSaveGame save_game;
+        save_game.filename.swap(_pending.front().filename);
+        save_game.data.swap(_pending.front().data);
+        _pending.erase(_pending.begin());
+        _writing = true;
+
+        lock.unlock();
+        if(!WriteSaveGameFile(save_game.filename, save_game.data))
+            PRINT_WARNING << "The save game couldn't be written: " << save_game.filename << std::endl;
+        lock.lock();
+
+        _writing = false;
+        _condition.notify_all();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// SaveGameIndex class methods
+////////////////////////////////////////////////////////////////////////////////
+
+//! \brief The maximum number of indexed save games and map locations, to avoid reading a corrupted index at length
+const uint32_t SAVE_INDEX_MAX_ENTRIES = 1024;
+
+//! \brief Returns the size of a file, or 0 if it can't be opened.
+static uint32_t _GetFileSize(const std::string& filename)
+{
+    std::ifstream file(filename.c_str(), std::ios::binary | std::ios::ate);
+    if(!file.is_open())
+        return 0;
+    std::streamoff file_size = file.tellg();
+    return file_size > 0 ? static_cast<uint32_t>(file_size) : 0;
+}
+
+//! \brief Returns the FNV-1a checksum of a save game content.
+static uint32_t _ComputeChecksum(const std::vector<uint8_t>& data)
+{
+    uint32_t checksum = 2166136261u;
+    for(size_t i = 0; i < data.size(); ++i) {
+        checksum ^= data[i];
+        checksum *= 16777619u;
+    }
+    return checksum;
+}
+
+SaveGameIndex::SaveGameIndex() :
+    _loaded(false),
+    _modified(false)
+{
+}
+
+bool SaveGameIndex::GetPreview(const std::string& filename, SaveGamePreview& preview)
+{
+    _Load();
+
+    Entry* entry = _FindEntry(filename);
+    if(!entry)
+        return false;
+
+    uint32_t file_mod_time = static_cast<uint32_t>(GetFileModTime(filename));
+    if(entry->file_mod_time == 0) {
+        // The save game was written after its preview was cached: check its content is the one described.
+        SaveGameReader file;
+        if(!file._LoadFile(filename) || file._data.size() != entry->file_size
+                || _ComputeChecksum(file._data) != entry->file_checksum)
+            return false;
+        entry->file_mod_time = file_mod_time;
+        _modified = true;
+    }
+    else if(entry->file_mod_time != file_mod_time) {
+        return false;
+    }
+
+    preview = entry->preview;
+    return true;
+}
+
+void SaveGameIndex::SetPreview(const std::string& filename, const SaveGamePreview& preview, const std::vector<uint8_t>& data)
+{
+    _Load();
+
+    Entry* entry = _FindEntry(filename);
+    if(!entry) {
+        _entries.push_back(Entry());
+        entry = &_entries.back();
+        entry->filename = filename;
+    }
+
+    entry->file_size = static_cast<uint32_t>(data.size());
+    entry->file_checksum = _ComputeChecksum(data);
+    // Known once the file is written, which may happen on another thread.
+    entry->file_mod_time = 0;
+    entry->preview = preview;
+    _modified = true;
+}
+
+void SaveGameIndex::SetPreview(const std::string& filename, const SaveGamePreview& preview)
+{
+    _Load();
+
+    Entry* entry = _FindEntry(filename);
+    if(!entry) {
+        _entries.push_back(Entry());
+        entry = &_entries.back();
+        entry->filename = filename;
+    }
+
+    // The modification time is known, so the checksum is never needed.
+    entry->file_size = _GetFileSize(filename);
+    entry->file_checksum = 0;
+    entry->file_mod_time = static_cast<uint32_t>(GetFileModTime(filename));
+    entry->preview = preview;
+    _modified = true;
+}
+
+void SaveGameIndex::RemovePreview(const std::string& filename)
+{
+    _Load();
+
+    for(uint32_t i = 0; i < _entries.size(); ++i) {
+        if(_entries[i].filename != filename)
+            continue;
+
+        _entries.erase(_entries.begin() + i);
+        _modified = true;
+        return;
+    }
+}
+
+bool SaveGameIndex::GetLocation(const std::string& map_script_filename, SaveGameLocation& location)
+{
+    _Load();
+
+    for(uint32_t i = 0; i < _locations.size(); ++i) {
+        if(_locations[i].map_script_filename == map_script_filename) {
+            location = _locations[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+void SaveGameIndex::SetLocation(const SaveGameLocation& location)
+{
+    _Load();
+
+    for(uint32_t i = 0; i < _locations.size(); ++i) {
+        if(_locations[i].map_script_filename != location.map_script_filename)
+            continue;
+
+        if(_locations[i].map_name != location.map_name
+                || _locations[i].map_image_filename != location.map_image_filename) {
+            _locations[i] = location;
+            _modified = true;
+        }
+        return;
+    }
+
+    _locations.push_back(location);
+    _modified = true;
+}
+
+void SaveGameIndex::WriteData(std::vector<uint8_t>& data)
+{
+    _Load();
+
+    SaveGameWriter file(SAVE_INDEX_MAGIC, SAVE_INDEX_VERSION);
+
+    file.WriteUInt32(static_cast<uint32_t>(_locations.size()));
+    for(uint32_t i = 0; i < _locations.size(); ++i) {
+        file.WriteString(_locations[i].map_script_filename);
+        file.WriteString(_locations[i].map_name);
+        file.WriteString(_locations[i].map_image_filename);
+    }
+
+    file.WriteUInt32(static_cast<uint32_t>(_entries.size()));
+    for(uint32_t i = 0; i < _entries.size(); ++i) {
+        file.WriteString(_entries[i].filename);
+        file.WriteUInt32(_entries[i].file_size);
+        file.WriteUInt32(_entries[i].file_checksum);
+        file.WriteUInt32(_entries[i].file_mod_time);
+        file._WritePreviewData(_entries[i].preview);
+    }
+
+    file.TakeData(data);
+    _modified = false;
+}
+
+std::string SaveGameIndex::GetFilename()
+{
+    return GetUserDataPath() + "save_games.idx";
+}
+
+void SaveGameIndex::_Load()
+{
+    if(_loaded)
+        return;
+    _loaded = true;
+
+    const std::string filename = GetFilename();
+    if(!DoesFileExist(filename))
+        return;
+
+    SaveGameReader file;
+    if(!file._LoadFile(filename) || file._data.size() < 8
+            || memcmp(file._data.data(), SAVE_INDEX_MAGIC, sizeof(SAVE_INDEX_MAGIC)) != 0
+            || _ReadLittleEndian(&file._data[4]) != SAVE_INDEX_VERSION) {
+        IF_PRINT_WARNING(GLOBAL_DEBUG) << "Ignoring the invalid save games index: " << filename << std::endl;
+        return;
+    }
+    file._position = 8;
+    file._end = file._data.size();
+
+    uint32_t number_locations = file.ReadUInt32();
+    if(number_locations > SAVE_INDEX_MAX_ENTRIES)
+        file._error = true;
+    for(uint32_t i = 0; i < number_locations && !file.IsErrorDetected(); ++i) {
+        SaveGameLocation location;
+        location.map_script_filename = file.ReadString();
+        location.map_name = file.ReadString();
+        location.map_image_filename = file.ReadString();
+        _locations.push_back(location);
+    }
+
+    uint32_t number_entries = file.ReadUInt32();
+    if(number_entries > SAVE_INDEX_MAX_ENTRIES)
+        file._error = true;
+    for(uint32_t i = 0; i < number_entries && !file.IsErrorDetected(); ++i) {
+        Entry entry;
+        entry.filename = file.ReadString();
+        entry.file_size = file.ReadUInt32();
+        entry.file_checksum = file.ReadUInt32();
+        entry.file_mod_time = file.ReadUInt32();
+        file._ReadPreview(entry.preview);
+        _entries.push_back(entry);
+    }
+
+    if(file.IsErrorDetected()) {
+        IF_PRINT_WARNING(GLOBAL_DEBUG) << "Ignoring the invalid save games index: " << filename << std::endl;
+        _locations.clear();
+        _entries.clear();
+    }
+}
+
+SaveGameIndex::Entry* SaveGameIndex::_FindEntry(const std::string& filename)
+{
+    for(uint32_t i = 0; i < _entries.size(); ++i) {
+        if(_entries[i].filename == filename)
+            return &_entries[i];
+    }
+    return nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Save game files functions
+////////////////////////////////////////////////////////////////////////////////
+
+bool WriteSaveGameFile(const std::string& filename, const std::vector<uint8_t>& data)
+{
+    const std::string temporary_filename = filename + ".tmp";
+    {
+        std::ofstream file(temporary_filename.c_str(), std::ios::binary | std::ios::trunc);
+        if(!file.is_open()) {
+            PRINT_WARNING << "Couldn't write the save game: " << temporary_filename << std::endl;
+            return false;
+        }
+
+        file.write(reinterpret_cast<const char *>(data.data()), data.size());
+        file.close();
+        if(file.fail()) {
+            PRINT_WARNING << "Couldn't write the save game: " << temporary_filename << std::endl;
+            remove(temporary_filename.c_str());
+            return false;
+        }
+    }
+
+#ifdef _WIN32
+    // rename() doesn't replace an existing file there.
+    remove(filename.c_str());
+#endif
+    if(rename(temporary_filename.c_str(), filename.c_str()) != 0) {
+        PRINT_WARNING << "Couldn't replace the save game: " << filename << std::endl;
+        remove(temporary_filename.c_str());
+        return false;
+    }
+    return true;
+}
+
+//! \brief Returns the save game filename of a slot, without extension.
+static std::string _GetSaveGameBasename(uint32_t slot_id, bool autosave)
+{
+    std::ostringstream filename;
+    filename << GetUserDataPath() + "saved_game_" << slot_id;
+    if(autosave)
+        filename << "_autosave";
+    return filename.str();
+}
+
+std::string GetSaveGameFilename(uint32_t slot_id, bool autosave)
+{
+    return _GetSaveGameBasename(slot_id, autosave) + ".sav";
+}
+
+std::string FindSaveGameFilename(uint32_t slot_id, bool autosave)
+{
+    std::string filename = GetSaveGameFilename(slot_id, autosave);
+    if(DoesFileExist(filename))
+        return filename;
+
+    // The save games of former versions, imported when loaded.
+    std::string lua_filename = _GetSaveGameBasename(slot_id, autosave) + ".lua";
+    if(DoesFileExist(lua_filename))
+        return lua_filename;
+
+    return filename;
+}
+
+bool IsBinarySaveGame(const std::string& filename)
+{
+    std::ifstream file(filename.c_str(), std::ios::binary);
+    char magic[sizeof(SAVE_GAME_MAGIC)];
+    if(!file.read(magic, sizeof(magic)))
+        return false;
+
+    return memcmp(magic, SAVE_GAME_MAGIC, sizeof(SAVE_GAME_MAGIC)) == 0;
+}
+
+bool ReadSaveGamePreview(const std::string& filename, SaveGamePreview& preview)
+{
+    std::ifstream file(filename.c_str(), std::ios::binary);
+    uint8_t header[SAVE_GAME_HEADER_SIZE];
+    if(!file.read(reinterpret_cast<char *>(header), sizeof(header)))
+        return false;
+
+    uint32_t preview_size = _CheckHeader(header, filename);
+    if(preview_size == 0)
+        return false;
+
+    // Only the preview block is read, not the game data following it.
+    SaveGameReader reader;
+    reader._filename = filename;
+    reader._data.resize(preview_size);
+    if(!file.read(reinterpret_cast<char *>(reader._data.data()), preview_size))
+        return false;
+
+    reader._end = preview_size;
+    reader._ReadPreview(preview);
+    return !reader.IsErrorDetected();
+}
+
+} // namespace vt_global
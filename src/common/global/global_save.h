@@ -0,0 +1,436 @@
+////////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2018 by Bertram (Valyria Tear)
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+////////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file   global_save.h
+*** \author Yohann Ferreira, yohann ferreira orange fr
+*** \brief  Header file for the binary save game format
+***
+*** A save game file is made of:
+*** - The file magic and format version,
+*** - A small preview block, holding what the save menu shows about the game,
+*** - The game data sections, each prefixed with its id and size in bytes.
+***
+*** All the numbers are stored in little endian. The sections unknown to a game
+*** version are skipped, so that a section can be added without breaking the
+*** older saves.
+***
+*** The former Lua save games are still loaded, and get converted when saving.
+***
+*** The previews of the save game files are also cached in a small index file,
+*** so that the save menu doesn't have to open each save game and map script.
+*** ***************************************************************************/
+
+#ifndef __GLOBAL_SAVE_HEADER__
+#define __GLOBAL_SAVE_HEADER__
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace vt_global
+{
+
+//! \brief The first bytes of a binary save game file
+const char SAVE_GAME_MAGIC[4] = { 'V', 'T', 'S', 'G' };
+
+//! \brief The current save game format version. Increase it when changing the content of a section.
+const uint32_t SAVE_GAME_VERSION = 1;
+
+//! \brief The first bytes of the save games index file
+const char SAVE_INDEX_MAGIC[4] = { 'V', 'T', 'S', 'I' };
+
+//! \brief The current save games index format version
+const uint32_t SAVE_INDEX_VERSION = 2;
+
+//! \brief The number of characters stored in the preview, as shown in the save menu
+const uint32_t SAVE_PREVIEW_CHARACTERS = 4;
+
+//! \brief The ids of the save game sections. Never reuse the id of a removed section.
+enum SAVE_SECTION {
+    SAVE_SECTION_INVALID    = 0,
+    SAVE_SECTION_MAP_DATA   = 1,
+    SAVE_SECTION_INVENTORY  = 2,
+    SAVE_SECTION_CHARACTERS = 3,
+    SAVE_SECTION_EVENTS     = 4,
+    SAVE_SECTION_QUESTS     = 5,
+    SAVE_SECTION_WORLD_MAP  = 6,
+    SAVE_SECTION_SHOP_DATA  = 7
+};
+
+//! \brief The data shown about a character in the save menu
+struct SaveGamePreviewCharacter {
+    SaveGamePreviewCharacter() :
+        id(0),
+        experience_level(0),
+        total_experience_points(0),
+        unspent_experience_points(0),
+        experience_points_next(0),
+        max_hit_points(0),
+        hit_points(0),
+        max_skill_points(0),
+        skill_points(0)
+    {}
+
+    uint32_t id;
+    uint32_t experience_level;
+    uint32_t total_experience_points;
+    uint32_t unspent_experience_points;
+    int32_t experience_points_next;
+    uint32_t max_hit_points;
+    uint32_t hit_points;
+    uint32_t max_skill_points;
+    uint32_t skill_points;
+};
+
+//! \brief The data shown about a save game in the save menu, stored at the beginning of the file
+struct SaveGamePreview {
+    SaveGamePreview() :
+        play_hours(0),
+        play_minutes(0),
+        play_seconds(0),
+        drunes(0)
+    {}
+
+    uint32_t play_hours;
+    uint32_t play_minutes;
+    uint32_t play_seconds;
+    uint32_t drunes;
+
+    std::string map_data_filename;
+    std::string map_script_filename;
+
+    //! \brief The first characters of the party, up to SAVE_PREVIEW_CHARACTERS
+    std::vector<SaveGamePreviewCharacter> characters;
+};
+
+/** ****************************************************************************
+*** \brief Writes a binary save game in memory, then to a file
+***
+*** The preview has to be written first, then the sections.
+*** ***************************************************************************/
+class SaveGameWriter
+{
+public:
+    SaveGameWriter();
+
+    void WritePreview(const SaveGamePreview& preview);
+
+    //! \brief Starts a section. Its size is known once it is ended.
+    void BeginSection(SAVE_SECTION section);
+
+    void EndSection();
+
+    void WriteUInt8(uint8_t value);
+    void WriteUInt32(uint32_t value);
+    void WriteInt32(int32_t value);
+    void WriteFloat(float value);
+    void WriteBool(bool value);
+    void WriteString(const std::string& value);
+    void WriteUIntVector(const std::vector<uint32_t>& values);
+
+    /** \brief Writes the save game to a file
+    *** \return false if the file couldn't be written
+    **/
+    bool SaveFile(const std::string& filename) const;
+
+    const std::vector<uint8_t>& GetData() const {
+        return _data;
+    }
+
+    //! \brief Moves the written data out, e.g. to write it on another thread.
+    void TakeData(std::vector<uint8_t>& data) {
+        data.swap(_data);
+        _data.clear();
+    }
+
+private:
+    std::vector<uint8_t> _data;
+
+    //! \brief The offset of the size of the current section, or 0 when none is begun
+    size_t _section_size_offset;
+
+    //! \brief Starts a file of another format, with its own magic and version.
+    SaveGameWriter(const char *magic, uint32_t version);
+
+    //! \brief Writes a preview, without its size.
+    void _WritePreviewData(const SaveGamePreview& preview);
+
+    //! \brief Writes a size at an offset of the data, once known.
+    void _WriteSizeAt(size_t offset);
+
+    friend class SaveGameIndex;
+};
+
+/** ****************************************************************************
+*** \brief Reads a binary save game
+***
+*** A read past the end of the open section returns 0 or an empty string,
+*** and sets the error flag.
+*** ***************************************************************************/
+class SaveGameReader
+{
+public:
+    SaveGameReader();
+
+    /** \brief Loads a save game file and reads its preview
+    *** \return false if the file isn't a valid binary save game
+    **/
+    bool OpenFile(const std::string& filename);
+
+    const SaveGamePreview& GetPreview() const {
+        return _preview;
+    }
+
+    const std::string& GetFilename() const {
+        return _filename;
+    }
+
+    /** \brief Restricts the reads to a section
+    *** \return false if the save game has no such section
+    **/
+    bool OpenSection(SAVE_SECTION section);
+
+    void CloseSection();
+
+    //! \brief Tells whether the save game has a section, without changing the reads.
+    bool HasSection(SAVE_SECTION section) const;
+
+    uint8_t ReadUInt8();
+    uint32_t ReadUInt32();
+    int32_t ReadInt32();
+    float ReadFloat();
+    bool ReadBool();
+    std::string ReadString();
+    void ReadUIntVector(std::vector<uint32_t>& values);
+
+    bool IsErrorDetected() const {
+        return _error;
+    }
+
+private:
+    std::string _filename;
+
+    std::vector<uint8_t> _data;
+
+    //! \brief The read position, and the end of what can be read
+    size_t _position;
+    size_t _end;
+
+    bool _error;
+
+    SaveGamePreview _preview;
+
+    //! \brief The offset and size of each section found in the file, by section id
+    struct SectionLocation {
+        uint32_t id;
+        size_t offset;
+        size_t size;
+    };
+    std::vector<SectionLocation> _sections;
+
+    //! \brief Loads the whole file content, without checking it.
+    bool _LoadFile(const std::string& filename);
+
+    //! \brief Tells whether the given number of bytes can be read, and sets the error flag otherwise.
+    bool _CanRead(size_t size);
+
+    //! \brief Reads a preview, once the read is restricted to it.
+    void _ReadPreview(SaveGamePreview& preview);
+
+    friend bool ReadSaveGamePreview(const std::string& filename, SaveGamePreview& preview);
+    friend class SaveGameIndex;
+};
+
+//! \brief The in-game location of a map, as shown in the save menu
+struct SaveGameLocation {
+    std::string map_script_filename;
+
+    //! \brief The untranslated map name
+    std::string map_name;
+
+    //! \brief The location image, shown as the save game thumbnail. Empty when the map has none.
+    std::string map_image_filename;
+};
+
+/** ****************************************************************************
+*** \brief Caches the previews of the save game files
+***
+*** The index is a small file of the user data folder, kept up to date when
+*** saving, so that the save menu can show every slot without opening the save
+*** games, nor the map scripts their location is read from.
+***
+*** Each preview is stored with the size, checksum and modification time of its
+*** save game, and is ignored once the file changed behind the game's back. The index is
+*** only used from the main thread.
+*** ***************************************************************************/
+class SaveGameIndex
+{
+public:
+    SaveGameIndex();
+
+    /** \brief Returns the cached preview of a save game file
+    *** \return false if the file isn't indexed, or changed since
+    **/
+    bool GetPreview(const std::string& filename, SaveGamePreview& preview);
+
+    /** \brief Caches the preview of a save game file
+    *** \param data The encoded save game, as it will be written
+    **/
+    void SetPreview(const std::string& filename, const SaveGamePreview& preview, const std::vector<uint8_t>& data);
+
+    //! \brief Caches the preview of a save game file already on disk.
+    void SetPreview(const std::string& filename, const SaveGamePreview& preview);
+
+    //! \brief Forgets the preview of a save game file, e.g. when it is deleted.
+    void RemovePreview(const std::string& filename);
+
+    /** \brief Returns the cached location of a map
+    *** \return false if the map location isn't known yet
+    **/
+    bool GetLocation(const std::string& map_script_filename, SaveGameLocation& location);
+
+    //! \brief Caches the location of a map, as read from its script.
+    void SetLocation(const SaveGameLocation& location);
+
+    //! \brief Tells whether the index changed since it was last loaded or written.
+    bool IsModified() const {
+        return _modified;
+    }
+
+    //! \brief Encodes the index, and marks it as written.
+    void WriteData(std::vector<uint8_t>& data);
+
+    //! \brief Returns the index file, in the user data folder.
+    static std::string GetFilename();
+
+private:
+    struct Entry {
+        Entry() :
+            file_size(0),
+            file_checksum(0),
+            file_mod_time(0)
+        {}
+
+        std::string filename;
+        uint32_t file_size;
+
+        //! \brief The save game content checksum, checked until its modification time is known
+        uint32_t file_checksum;
+
+        //! \brief The save game modification time, or 0 when not known yet.
+        uint32_t file_mod_time;
+
+        SaveGamePreview preview;
+    };
+
+    std::vector<Entry> _entries;
+
+    std::vector<SaveGameLocation> _locations;
+
+    //! \brief Whether the index file was read already
+    bool _loaded;
+
+    bool _modified;
+
+    //! \brief Reads the index file on first use. A missing or invalid index is simply rebuilt.
+    void _Load();
+
+    Entry* _FindEntry(const std::string& filename);
+};
+
+/** ****************************************************************************
+*** \brief Writes save games to disk on a background thread
+***
+*** The save games are encoded on the main thread, which makes them a snapshot of
+*** the game state, and only written to disk by the thread. A save game waiting to
+*** be written is replaced by a newer one for the same file.
+*** ***************************************************************************/
+class SaveGameWriteThread
+{
+public:
+    SaveGameWriteThread():
+        _running(false),
+        _writing(false)
+    {}
+
+    ~SaveGameWriteThread() {
+        Shutdown();
+    }
+
+    //! \brief Writes the save games still queued, and stops the thread.
+    void Shutdown();
+
+    /** \brief Queues a save game to write
+    *** \param filename The save game file
+    *** \param data The encoded save game, taken over
+    **/
+    void Write(const std::string& filename, std::vector<uint8_t>& data);
+
+    //! \brief Waits until every queued save game is written.
+    void Flush();
+
+private:
+    struct PendingSaveGame {
+        std::string filename;
+        std::vector<uint8_t> data;
+    };
+
+    std::mutex _mutex;
+
+    //! \brief Signaled when a save game is queued or written
+    std::condition_variable _condition;
+
+    std::thread _thread;
+
+    //! \brief Protected by the mutex
+    bool _running;
+
+    //! \brief Whether the thread is writing a save game. Protected by the mutex.
+    bool _writing;
+
+    //! \brief The save games to write, in queuing order. Protected by the mutex.
+    std::vector<PendingSaveGame> _pending;
+
+    //! \brief The writing thread loop.
+    void _Run();
+};
+
+/** \brief Writes a save game file atomically
+*** The data is written to a temporary file first, then renamed over the previous
+*** save game, so that an interrupted write never loses it.
+*** \return false if the file couldn't be written
+**/
+bool WriteSaveGameFile(const std::string& filename, const std::vector<uint8_t>& data);
+
+/** \brief Returns the file a save game slot is written to
+*** \param slot_id The save slot, starting from 0
+*** \param autosave Whether it is the slot autosave
+**/
+std::string GetSaveGameFilename(uint32_t slot_id, bool autosave = false);
+
+/** \brief Returns the file of a save game slot to read from
+*** This is the binary save game when it exists, or else the former Lua save game, if any.
+**/
+std::string FindSaveGameFilename(uint32_t slot_id, bool autosave = false);
+
+//! \brief Tells whether the file starts with the binary save game magic.
+bool IsBinarySaveGame(const std::string& filename);
+
+/** \brief Reads only the preview of a binary save game
+*** \return false if the file isn't a valid binary save game
+**/
+bool ReadSaveGamePreview(const std::string& filename, SaveGamePreview& preview);
+
+} // namespace vt_global
+
+#endif // __GLOBAL_SAVE_HEADER__
@@ -111,6 +111,51 @@ bool MapDataHandler::Save(vt_script::WriteScriptDescriptor& file,
     return true;
 }
 
+bool MapDataHandler::Load(SaveGameReader& file)
+{
+    Clear();
+
+    _map_data_filename = file.ReadString();
+    _map_script_filename = file.ReadString();
+    _x_save_map_position = file.ReadUInt32();
+    _y_save_map_position = file.ReadUInt32();
+    _save_stamina = file.ReadUInt32();
+
+    // Load home map data, if any
+    if (file.ReadBool()) {
+        std::string home_map_data = file.ReadString();
+        std::string home_map_script = file.ReadString();
+        float x_pos = file.ReadFloat();
+        float y_pos = file.ReadFloat();
+
+        _home_map = vt_map::MapLocation(home_map_data,
+                                        home_map_script,
+                                        x_pos, y_pos);
+    }
+
+    return !file.IsErrorDetected();
+}
+
+void MapDataHandler::Save(SaveGameWriter& file,
+                          uint32_t x_position,
+                          uint32_t y_position)
+{
+    file.WriteString(_map_data_filename);
+    file.WriteString(_map_script_filename);
+    //! \note Coords are in map tiles
+    file.WriteUInt32(x_position);
+    file.WriteUInt32(y_position);
+    file.WriteUInt32(_save_stamina);
+
+    file.WriteBool(_home_map.IsValid());
+    if (_home_map.IsValid()) {
+        file.WriteString(_home_map.GetMapDataFilename());
+        file.WriteString(_home_map.GetMapScriptFilename());
+        file.WriteFloat(_home_map.GetMapPosition().x);
+        file.WriteFloat(_home_map.GetMapPosition().y);
+    }
+}
+
 void MapDataHandler::SetMap(const std::string &map_data_filename,
                             const std::string &map_script_filename,
                             const std::string &map_image_filename,
@@ -14,6 +14,7 @@
 #include "utils/ustring.h"
 #include "script/script_read.h"
 #include "script/script_write.h"
+#include "common/global/global_save.h"
 
 #include "modes/map/map_location.h"
 #include "engine/video/image.h"
@@ -40,6 +41,14 @@ public:
               uint32_t x_position,
               uint32_t y_position);
 
+    //! \brief Loads game map related data from a binary save game section
+    bool Load(SaveGameReader& file);
+
+    //! \brief Saves map related data in a binary save game section
+    void Save(SaveGameWriter& file,
+              uint32_t x_position,
+              uint32_t y_position);
+
     //! \brief Tells whether the map mode minimap should be shown, if any.
     bool ShouldShowMinimap() const {
         return _show_minimap;
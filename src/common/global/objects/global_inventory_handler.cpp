@@ -12,11 +12,24 @@
 
 #include "script/script_read.h"
 
+#include <algorithm>
+
 using namespace vt_script;
 
 namespace vt_global
 {
 
+InventoryHandler::InventoryHandler() :
+    _items_script("data/inventory/items.lua", "items"),
+    _weapons_script("data/inventory/weapons.lua", "weapons"),
+    _head_armor_script("data/inventory/head_armor.lua", "armor"),
+    _torso_armor_script("data/inventory/torso_armor.lua", "armor"),
+    _arm_armor_script("data/inventory/arm_armor.lua", "armor"),
+    _leg_armor_script("data/inventory/leg_armor.lua", "armor"),
+    _spirits_script("data/inventory/spirits.lua", "spirits")
+{
+}
+
 InventoryHandler::~InventoryHandler()
 {
     CloseScripts();
@@ -24,86 +37,108 @@ InventoryHandler::~InventoryHandler()
 
 bool InventoryHandler::LoadScripts()
 {
-    // Open up the persistent script files
-    if(!_items_script.OpenFile("data/inventory/items.lua") || !_items_script.OpenTable("items"))
-        return false;
-
-    if(!_weapons_script.OpenFile("data/inventory/weapons.lua") || !_weapons_script.OpenTable("weapons"))
-        return false;
-
-    if(!_head_armor_script.OpenFile("data/inventory/head_armor.lua") || !_head_armor_script.OpenTable("armor"))
-        return false;
-
-    if(!_torso_armor_script.OpenFile("data/inventory/torso_armor.lua") || !_torso_armor_script.OpenTable("armor"))
-        return false;
-
-    if(!_arm_armor_script.OpenFile("data/inventory/arm_armor.lua") || !_arm_armor_script.OpenTable("armor"))
-        return false;
-
-    if(!_leg_armor_script.OpenFile("data/inventory/leg_armor.lua") || !_leg_armor_script.OpenTable("armor"))
-        return false;
-
-    if(!_spirits_script.OpenFile("data/inventory/spirits.lua") || !_spirits_script.OpenTable("spirits"))
-        return false;
-
-    return true;
+    // Only check the persistent script files, run on first use
+    return _items_script.Check() && _weapons_script.Check()
+           && _head_armor_script.Check() && _torso_armor_script.Check()
+           && _arm_armor_script.Check() && _leg_armor_script.Check()
+           && _spirits_script.Check();
 }
 
 void InventoryHandler::CloseScripts()
 {
     // Close all persistent script files
-    _items_script.CloseTable();
-    _items_script.CloseFile();
-
-    _weapons_script.CloseTable();
-    _weapons_script.CloseFile();
-
-    _head_armor_script.CloseTable();
-    _head_armor_script.CloseFile();
-
-    _torso_armor_script.CloseTable();
-    _torso_armor_script.CloseFile();
-
-    _arm_armor_script.CloseTable();
-    _arm_armor_script.CloseFile();
-
-    _leg_armor_script.CloseTable();
-    _leg_armor_script.CloseFile();
-
-    _spirits_script.CloseTable();
-    _spirits_script.CloseFile();
+    _items_script.Close();
+    _weapons_script.Close();
+    _head_armor_script.Close();
+    _torso_armor_script.Close();
+    _arm_armor_script.Close();
+    _leg_armor_script.Close();
+    _spirits_script.Close();
 }
 
 void InventoryHandler::ClearAllData()
 {
-    _inventory.clear();
-    _inventory_items.clear();
-    _inventory_weapons.clear();
-    _inventory_head_armors.clear();
-    _inventory_torso_armors.clear();
-    _inventory_arm_armors.clear();
-    _inventory_leg_armors.clear();
-    _inventory_spirits.clear();
-    _inventory_key_items.clear();
+    _objects.clear();
+    _object_slots.clear();
+    _all_ids.clear();
+    for(uint32_t i = 0; i < INVENTORY_CATEGORY_TOTAL; ++i)
+        _category_ids[i].clear();
+    _key_item_ids.clear();
 }
 
-std::vector<std::shared_ptr<GlobalArmor>>& InventoryHandler::GetInventoryArmors(GLOBAL_OBJECT object_type)
+InventoryView<GlobalArmor> InventoryHandler::GetInventoryArmors(GLOBAL_OBJECT object_type) const
 {
     switch(object_type) {
     default:
         PRINT_WARNING << "Invalid object type provided. Returning default container" << std::endl;
         /* Falls through. */
     case GLOBAL_OBJECT_HEAD_ARMOR:
-        return _inventory_head_armors;
+        return InventoryView<GlobalArmor>(*this, _category_ids[INVENTORY_CATEGORY_HEAD_ARMORS]);
     case GLOBAL_OBJECT_TORSO_ARMOR:
-        return _inventory_torso_armors;
+        return InventoryView<GlobalArmor>(*this, _category_ids[INVENTORY_CATEGORY_TORSO_ARMORS]);
     case GLOBAL_OBJECT_ARM_ARMOR:
-        return _inventory_arm_armors;
+        return InventoryView<GlobalArmor>(*this, _category_ids[INVENTORY_CATEGORY_ARM_ARMORS]);
     case GLOBAL_OBJECT_LEG_ARMOR:
-        return _inventory_leg_armors;
+        return InventoryView<GlobalArmor>(*this, _category_ids[INVENTORY_CATEGORY_LEG_ARMORS]);
     }
 }
 
+const std::shared_ptr<GlobalObject>& InventoryHandler::GetInventoryObject(uint32_t id) const
+{
+    static const std::shared_ptr<GlobalObject> no_object;
+
+    auto it = _object_slots.find(id);
+    if (it == _object_slots.end())
+        return no_object;
+    return _objects[it->second];
+}
+
+//! \brief Adds an id to a sorted id vector.
+static void _InsertSortedID(std::vector<uint32_t>& ids, uint32_t id)
+{
+    ids.insert(std::lower_bound(ids.begin(), ids.end(), id), id);
+}
+
+//! \brief Removes an id from a sorted id vector, if present.
+static void _EraseSortedID(std::vector<uint32_t>& ids, uint32_t id)
+{
+    auto it = std::lower_bound(ids.begin(), ids.end(), id);
+    if (it != ids.end() && *it == id)
+        ids.erase(it);
+}
+
+InventoryHandler::INVENTORY_CATEGORY InventoryHandler::_GetCategory(uint32_t obj_id)
+{
+    if ((obj_id > 0 && obj_id <= MAX_ITEM_ID) ||
+        (obj_id > MAX_SPIRIT_ID && obj_id <= MAX_KEY_ITEM_ID))
+        return INVENTORY_CATEGORY_ITEMS;
+    else if (obj_id > MAX_ITEM_ID && obj_id <= MAX_WEAPON_ID)
+        return INVENTORY_CATEGORY_WEAPONS;
+    else if (obj_id > MAX_WEAPON_ID && obj_id <= MAX_HEAD_ARMOR_ID)
+        return INVENTORY_CATEGORY_HEAD_ARMORS;
+    else if (obj_id > MAX_HEAD_ARMOR_ID && obj_id <= MAX_TORSO_ARMOR_ID)
+        return INVENTORY_CATEGORY_TORSO_ARMORS;
+    else if (obj_id > MAX_TORSO_ARMOR_ID && obj_id <= MAX_ARM_ARMOR_ID)
+        return INVENTORY_CATEGORY_ARM_ARMORS;
+    else if (obj_id > MAX_ARM_ARMOR_ID && obj_id <= MAX_LEG_ARMOR_ID)
+        return INVENTORY_CATEGORY_LEG_ARMORS;
+    else if (obj_id > MAX_LEG_ARMOR_ID && obj_id <= MAX_SPIRIT_ID)
+        return INVENTORY_CATEGORY_SPIRITS;
+    return INVENTORY_CATEGORY_INVALID;
+}
+
+void InventoryHandler::_AddObject(const std::shared_ptr<GlobalObject>& object, INVENTORY_CATEGORY category)
+{
+    uint32_t obj_id = object->GetID();
+    _object_slots[obj_id] = static_cast<uint32_t>(_objects.size());
+    _objects.push_back(object);
+
+    _InsertSortedID(_all_ids, obj_id);
+    _InsertSortedID(_category_ids[category], obj_id);
+    if (object->IsKeyItem())
+        _InsertSortedID(_key_item_ids, obj_id);
+}
+
 void InventoryHandler::AddToInventory(uint32_t obj_id, uint32_t obj_count)
 {
     // Don't add object instance without at least one actual item.
@@ -111,57 +146,33 @@ void InventoryHandler::AddToInventory(uint32_t obj_id, uint32_t obj_count)
         return;
 
     // If the object is already in the inventory, increment the count of the object.
-    if (_inventory.find(obj_id) != _inventory.end()) {
-        _inventory[obj_id]->IncrementCount(obj_count);
+    const std::shared_ptr<GlobalObject>& object = GetInventoryObject(obj_id);
+    if (object != nullptr) {
+        object->IncrementCount(obj_count);
         return;
     }
 
     // Otherwise, create a new object instance and add it to the inventory.
-    std::shared_ptr<GlobalObject> new_object = nullptr;
-    if ((obj_id > 0 && obj_id <= MAX_ITEM_ID) ||
-        (obj_id > MAX_SPIRIT_ID && obj_id <= MAX_KEY_ITEM_ID)) {
-        auto new_item = std::make_shared<GlobalItem>(obj_id, obj_count);
-        new_object = new_item;
-        _inventory.insert(std::make_pair(obj_id, new_object));
-        _inventory_items.push_back(new_item);
-    } else if ((obj_id > MAX_ITEM_ID) && (obj_id <= MAX_WEAPON_ID)) {
-        auto new_wpn = std::make_shared<GlobalWeapon>(obj_id, obj_count);
-        new_object = new_wpn;
-        _inventory.insert(std::make_pair(obj_id, new_wpn));
-        _inventory_weapons.push_back(new_wpn);
-    } else if ((obj_id > MAX_WEAPON_ID) && (obj_id <= MAX_HEAD_ARMOR_ID)) {
-        auto new_arm = std::make_shared<GlobalArmor>(obj_id, obj_count);
-        new_object = new_arm;
-        _inventory.insert(std::make_pair(obj_id, new_arm));
-        _inventory_head_armors.push_back(new_arm);
-    } else if ((obj_id > MAX_HEAD_ARMOR_ID) && (obj_id <= MAX_TORSO_ARMOR_ID)) {
-        auto new_arm = std::make_shared<GlobalArmor>(obj_id, obj_count);
-        new_object = new_arm;
-        _inventory.insert(std::make_pair(obj_id, new_arm));
-        _inventory_torso_armors.push_back(new_arm);
-    } else if ((obj_id > MAX_TORSO_ARMOR_ID) && (obj_id <= MAX_ARM_ARMOR_ID)) {
-        auto new_arm = std::make_shared<GlobalArmor>(obj_id, obj_count);
-        new_object = new_arm;
-        _inventory.insert(std::make_pair(obj_id, new_arm));
-        _inventory_arm_armors.push_back(new_arm);
-    } else if ((obj_id > MAX_ARM_ARMOR_ID) && (obj_id <= MAX_LEG_ARMOR_ID)) {
-        auto new_arm = std::make_shared<GlobalArmor>(obj_id, obj_count);
-        new_object = new_arm;
-        _inventory.insert(std::make_pair(obj_id, new_arm));
-        _inventory_leg_armors.push_back(new_arm);
-    } else if ((obj_id > MAX_LEG_ARMOR_ID) && (obj_id <= MAX_SPIRIT_ID)) {
-        auto new_spirit = std::make_shared<GlobalSpirit>(obj_id, obj_count);
-        new_object = new_spirit;
-        _inventory.insert(std::make_pair(obj_id, new_spirit));
-        _inventory_spirits.push_back(new_spirit);
-    } else {
+    INVENTORY_CATEGORY category = _GetCategory(obj_id);
+    switch (category) {
+    case INVENTORY_CATEGORY_ITEMS:
+        _AddObject(std::make_shared<GlobalItem>(obj_id, obj_count), category);
+        break;
+    case INVENTORY_CATEGORY_WEAPONS:
+        _AddObject(std::make_shared<GlobalWeapon>(obj_id, obj_count), category);
+        break;
+    case INVENTORY_CATEGORY_HEAD_ARMORS:
+    case INVENTORY_CATEGORY_TORSO_ARMORS:
+    case INVENTORY_CATEGORY_ARM_ARMORS:
+    case INVENTORY_CATEGORY_LEG_ARMORS:
+        _AddObject(std::make_shared<GlobalArmor>(obj_id, obj_count), category);
+        break;
+    case INVENTORY_CATEGORY_SPIRITS:
+        _AddObject(std::make_shared<GlobalSpirit>(obj_id, obj_count), category);
+        break;
+    default:
         PRINT_WARNING << "attempted to add invalid object to inventory with id: " << obj_id << std::endl;
-    }
-
-    // Update the key items list.
-    if (new_object != nullptr &&
-        new_object->IsKeyItem()) {
-        _inventory_key_items.push_back(new_object);
+        break;
     }
 }
 
@@ -181,172 +192,129 @@ void InventoryHandler::AddToInventory(const std::shared_ptr<GlobalObject>& objec
     }
 
     // If an instance of the same object is already inside the inventory, just increment the count.
-    if (_inventory.find(obj_id) != _inventory.end()) {
-        _inventory[obj_id]->IncrementCount(obj_count);
+    const std::shared_ptr<GlobalObject>& inventory_object = GetInventoryObject(obj_id);
+    if (inventory_object != nullptr) {
+        inventory_object->IncrementCount(obj_count);
         return;
     }
 
-    // Figure out which type of object this is, cast it to the correct type, and add it to the inventory
-    if((obj_id > 0 && obj_id <= MAX_ITEM_ID) ||
-       (obj_id > MAX_SPIRIT_ID && obj_id <= MAX_KEY_ITEM_ID)) {
-        auto new_obj = std::dynamic_pointer_cast<GlobalItem>(object);
-        _inventory.insert(std::make_pair(obj_id, new_obj));
-        _inventory_items.push_back(new_obj);
-    } else if((obj_id > MAX_ITEM_ID) && (obj_id <= MAX_WEAPON_ID)) {
-        auto new_obj = std::dynamic_pointer_cast<GlobalWeapon>(object);
-        _inventory.insert(std::make_pair(obj_id, new_obj));
-        _inventory_weapons.push_back(new_obj);
-    } else if((obj_id > MAX_WEAPON_ID) && (obj_id <= MAX_HEAD_ARMOR_ID)) {
-        auto new_obj = std::dynamic_pointer_cast<GlobalArmor>(object);
-        _inventory.insert(std::make_pair(obj_id, new_obj));
-        _inventory_head_armors.push_back(new_obj);
-    } else if((obj_id > MAX_HEAD_ARMOR_ID) && (obj_id <= MAX_TORSO_ARMOR_ID)) {
-        auto new_obj = std::dynamic_pointer_cast<GlobalArmor>(object);
-        _inventory.insert(std::make_pair(obj_id, new_obj));
-        _inventory_torso_armors.push_back(new_obj);
-    } else if((obj_id > MAX_TORSO_ARMOR_ID) && (obj_id <= MAX_ARM_ARMOR_ID)) {
-        auto new_obj = std::dynamic_pointer_cast<GlobalArmor>(object);
-        _inventory.insert(std::make_pair(obj_id, new_obj));
-        _inventory_arm_armors.push_back(new_obj);
-    } else if((obj_id > MAX_ARM_ARMOR_ID) && (obj_id <= MAX_LEG_ARMOR_ID)) {
-        auto new_obj = std::dynamic_pointer_cast<GlobalArmor>(object);
-        _inventory.insert(std::make_pair(obj_id, new_obj));
-        _inventory_leg_armors.push_back(new_obj);
-    } else if((obj_id > MAX_LEG_ARMOR_ID) && (obj_id <= MAX_SPIRIT_ID)) {
-        auto new_obj = std::dynamic_pointer_cast<GlobalSpirit>(object);
-        _inventory.insert(std::make_pair(obj_id, new_obj));
-        _inventory_spirits.push_back(new_obj);
-    } else {
+    // The object id tells its category, which the object type must match, as the views cast to it.
+    INVENTORY_CATEGORY category = _GetCategory(obj_id);
+    bool valid_type = false;
+    switch (category) {
+    case INVENTORY_CATEGORY_ITEMS:
+        valid_type = (std::dynamic_pointer_cast<GlobalItem>(object) != nullptr);
+        break;
+    case INVENTORY_CATEGORY_WEAPONS:
+        valid_type = (std::dynamic_pointer_cast<GlobalWeapon>(object) != nullptr);
+        break;
+    case INVENTORY_CATEGORY_HEAD_ARMORS:
+    case INVENTORY_CATEGORY_TORSO_ARMORS:
+    case INVENTORY_CATEGORY_ARM_ARMORS:
+    case INVENTORY_CATEGORY_LEG_ARMORS:
+        valid_type = (std::dynamic_pointer_cast<GlobalArmor>(object) != nullptr);
+        break;
+    case INVENTORY_CATEGORY_SPIRITS:
+        valid_type = (std::dynamic_pointer_cast<GlobalSpirit>(object) != nullptr);
+        break;
+    default:
+        break;
+    }
+
+    if (!valid_type) {
         PRINT_WARNING << "attempted to add invalid object to inventory with id: " << obj_id << std::endl;
         return;
     }
 
-    // Updates the key items list.
-    if (object->IsKeyItem()) {
-        _inventory_key_items.push_back(object);
-    }
+    _AddObject(object, category);
 }
 
 void InventoryHandler::RemoveFromInventory(uint32_t obj_id)
 {
-    auto it = _inventory.find(obj_id);
-    if (it == _inventory.end()) {
+    auto it = _object_slots.find(obj_id);
+    if (it == _object_slots.end()) {
         PRINT_WARNING << "attempted to remove an object from inventory that didn't exist with id: " << obj_id << std::endl;
         return;
     }
 
-    // Check whether the item is a key item to remove.
-    auto object = it->second;
-    if (object != nullptr && object->IsKeyItem()) {
-        for (auto it2 = _inventory_key_items.begin(); it2 != _inventory_key_items.end(); ++it2) {
-
-            if ((*it2)->GetID() != obj_id)
-                continue;
-
-            _inventory_key_items.erase(it2);
-            break;
-        }
-    }
-
-    // Use the id value to figure out what type of object it is, and remove it from the object vector
-    if((obj_id > 0 && obj_id <= MAX_ITEM_ID) ||
-       (obj_id > MAX_SPIRIT_ID && obj_id <= MAX_KEY_ITEM_ID)) {
-        if(_RemoveFromInventory(obj_id, _inventory_items) == false)
-            PRINT_WARNING << "object to remove was not found in inventory items: " << obj_id << std::endl;
-    } else if((obj_id > MAX_ITEM_ID) && (obj_id <= MAX_WEAPON_ID)) {
-        if(_RemoveFromInventory(obj_id, _inventory_weapons) == false)
-            PRINT_WARNING << "object to remove was not found in inventory weapons: " << obj_id << std::endl;
-    } else if((obj_id > MAX_WEAPON_ID) && (obj_id <= MAX_HEAD_ARMOR_ID)) {
-        if(_RemoveFromInventory(obj_id, _inventory_head_armors) == false)
-            PRINT_WARNING << "object to remove was not found in inventory head armor: " << obj_id << std::endl;
-    } else if((obj_id > MAX_HEAD_ARMOR_ID) && (obj_id <= MAX_TORSO_ARMOR_ID)) {
-        if(_RemoveFromInventory(obj_id, _inventory_torso_armors) == false)
-            PRINT_WARNING << "object to remove was not found in inventory torso armor: " << obj_id << std::endl;
-    } else if((obj_id > MAX_TORSO_ARMOR_ID) && (obj_id <= MAX_ARM_ARMOR_ID)) {
-        if(_RemoveFromInventory(obj_id, _inventory_arm_armors) == false)
-            PRINT_WARNING << "object to remove was not found in inventory arm armor: " << obj_id << std::endl;
-    } else if((obj_id > MAX_ARM_ARMOR_ID) && (obj_id <= MAX_LEG_ARMOR_ID)) {
-        if(_RemoveFromInventory(obj_id, _inventory_leg_armors) == false)
-            PRINT_WARNING << "object to remove was not found in inventory leg armor: " << obj_id << std::endl;
-    } else if((obj_id > MAX_LEG_ARMOR_ID) && (obj_id <= MAX_SPIRIT_ID)) {
-        if(_RemoveFromInventory(obj_id, _inventory_spirits) == false)
-            PRINT_WARNING << "object to remove was not found in inventory spirits: " << obj_id << std::endl;
-    } else {
-        PRINT_WARNING << "attempted to remove an object from inventory with an invalid id: " << obj_id << std::endl;
+    // Remove the object from the category views.
+    _EraseSortedID(_all_ids, obj_id);
+    _EraseSortedID(_category_ids[_GetCategory(obj_id)], obj_id);
+    _EraseSortedID(_key_item_ids, obj_id);
+
+    // Move the last object into the freed slot.
+    uint32_t slot = it->second;
+    _object_slots.erase(it);
+    if (slot + 1 < _objects.size()) {
+        _objects[slot] = _objects.back();
+        _object_slots[_objects[slot]->GetID()] = slot;
     }
+    _objects.pop_back();
 }
 
 std::shared_ptr<GlobalObject> InventoryHandler::GetGlobalObject(uint32_t obj_id)
 {
-    if (_inventory.find(obj_id) == _inventory.end()) {
+    const std::shared_ptr<GlobalObject>& object = GetInventoryObject(obj_id);
+    if (object == nullptr) {
         return nullptr;
     }
 
+    // Copy the object as its actual type.
     std::shared_ptr<GlobalObject> return_object = nullptr;
-    // Use the id value to figure out what type of object it is, and remove it from the object vector
-    if((obj_id > 0 && obj_id <= MAX_ITEM_ID) ||
-       (obj_id > MAX_SPIRIT_ID && obj_id <= MAX_KEY_ITEM_ID)) {
-        return_object = _GetFromInventory(obj_id, _inventory_items);
-        if(return_object == nullptr)
-            PRINT_WARNING << "object to retrieve was not found in inventory items: " << obj_id << std::endl;
-    } else if((obj_id > MAX_ITEM_ID) && (obj_id <= MAX_WEAPON_ID)) {
-        return_object = _GetFromInventory(obj_id, _inventory_weapons);
-        if(return_object == nullptr)
-            PRINT_WARNING << "object to retrieve was not found in inventory weapons: " << obj_id << std::endl;
-    } else if((obj_id > MAX_WEAPON_ID) && (obj_id <= MAX_HEAD_ARMOR_ID)) {
-        return_object = _GetFromInventory(obj_id, _inventory_head_armors);
-        if(return_object == nullptr)
-            PRINT_WARNING << "object to retrieve was not found in inventory head armor: " << obj_id << std::endl;
-    } else if((obj_id > MAX_HEAD_ARMOR_ID) && (obj_id <= MAX_TORSO_ARMOR_ID)) {
-        return_object = _GetFromInventory(obj_id, _inventory_torso_armors);
-        if(return_object == nullptr)
-            PRINT_WARNING << "object to retrieve was not found in inventory torso armor: " << obj_id << std::endl;
-    } else if((obj_id > MAX_TORSO_ARMOR_ID) && (obj_id <= MAX_ARM_ARMOR_ID)) {
-        return_object = _GetFromInventory(obj_id, _inventory_arm_armors);
-        if(return_object == nullptr)
-            PRINT_WARNING << "object to retrieve was not found in inventory arm armor: " << obj_id << std::endl;
-    } else if((obj_id > MAX_ARM_ARMOR_ID) && (obj_id <= MAX_LEG_ARMOR_ID)) {
-        return_object = _GetFromInventory(obj_id, _inventory_leg_armors);
-        if(return_object == nullptr)
-            PRINT_WARNING << "object to retrieve was not found in inventory leg armor: " << obj_id << std::endl;
-    } else if((obj_id > MAX_LEG_ARMOR_ID) && (obj_id <= MAX_SPIRIT_ID)) {
-        return_object = _GetFromInventory(obj_id, _inventory_spirits);
-        if(return_object == nullptr)
-            PRINT_WARNING << "object to retrieve was not found in inventory spirits: " << obj_id << std::endl;
-    } else {
+    switch (_GetCategory(obj_id)) {
+    case INVENTORY_CATEGORY_ITEMS:
+        return_object = std::make_shared<GlobalItem>(static_cast<const GlobalItem&>(*object));
+        break;
+    case INVENTORY_CATEGORY_WEAPONS:
+        return_object = std::make_shared<GlobalWeapon>(static_cast<const GlobalWeapon&>(*object));
+        break;
+    case INVENTORY_CATEGORY_HEAD_ARMORS:
+    case INVENTORY_CATEGORY_TORSO_ARMORS:
+    case INVENTORY_CATEGORY_ARM_ARMORS:
+    case INVENTORY_CATEGORY_LEG_ARMORS:
+        return_object = std::make_shared<GlobalArmor>(static_cast<const GlobalArmor&>(*object));
+        break;
+    case INVENTORY_CATEGORY_SPIRITS:
+        return_object = std::make_shared<GlobalSpirit>(static_cast<const GlobalSpirit&>(*object));
+        break;
+    default:
         PRINT_WARNING << "attempted to retrieve an object from inventory with an invalid id: " << obj_id << std::endl;
+        return nullptr;
     }
 
+    return_object->SetCount(1);
     return return_object;
 }
 
 void InventoryHandler::IncrementItemCount(uint32_t obj_id, uint32_t count)
 {
     // Do nothing if the item does not exist in the inventory
-    if(_inventory.find(obj_id) == _inventory.end()) {
+    const std::shared_ptr<GlobalObject>& object = GetInventoryObject(obj_id);
+    if(object == nullptr) {
         PRINT_WARNING << "attempted to increment count for an object that was not present in the inventory: " << obj_id << std::endl;
         return;
     }
 
-    _inventory[obj_id]->IncrementCount(count);
+    object->IncrementCount(count);
 }
 
 void InventoryHandler::DecrementItemCount(uint32_t obj_id, uint32_t count)
 {
     // Do nothing if the item does not exist in the inventory
-    if(_inventory.find(obj_id) == _inventory.end()) {
+    const std::shared_ptr<GlobalObject>& object = GetInventoryObject(obj_id);
+    if(object == nullptr) {
         PRINT_WARNING << "attempted to decrement count for an object that was not present in the inventory: " << obj_id << std::endl;
         return;
     }
 
     // Print a warning if the amount to decrement by exceeds the object's current count
-    if(count > _inventory[obj_id]->GetCount()) {
+    if(count > object->GetCount()) {
         PRINT_WARNING << "amount to decrement count by exceeded available count: " << obj_id << std::endl;
     }
 
     // Decrement the number of objects so long as the number to decrement by does not equal or exceed the count
-    if(count < _inventory[obj_id]->GetCount())
-        _inventory[obj_id]->DecrementCount(count);
+    if(count < object->GetCount())
+        object->DecrementCount(count);
     // Otherwise remove the object from the inventory completely
     else
         RemoveFromInventory(obj_id);
@@ -357,13 +325,13 @@ void InventoryHandler::SaveInventory(vt_script::WriteScriptDescriptor& file)
     // Save the inventory (object id + object count pairs)
     // NOTE: This does not save any weapons/armor that are equipped on the characters. That data
     // is stored alongside the character data when it is saved
-    _SaveInventory(file, "items", _inventory_items);
-    _SaveInventory(file, "weapons", _inventory_weapons);
-    _SaveInventory(file, "head_armor", _inventory_head_armors);
-    _SaveInventory(file, "torso_armor", _inventory_torso_armors);
-    _SaveInventory(file, "arm_armor", _inventory_arm_armors);
-    _SaveInventory(file, "leg_armor", _inventory_leg_armors);
-    _SaveInventory(file, "spirits", _inventory_spirits);
+    _SaveInventory(file, "items", GetInventoryItems());
+    _SaveInventory(file, "weapons", GetInventoryWeapons());
+    _SaveInventory(file, "head_armor", GetInventoryArmors(GLOBAL_OBJECT_HEAD_ARMOR));
+    _SaveInventory(file, "torso_armor", GetInventoryArmors(GLOBAL_OBJECT_TORSO_ARMOR));
+    _SaveInventory(file, "arm_armor", GetInventoryArmors(GLOBAL_OBJECT_ARM_ARMOR));
+    _SaveInventory(file, "leg_armor", GetInventoryArmors(GLOBAL_OBJECT_LEG_ARMOR));
+    _SaveInventory(file, "spirits", GetInventorySpirits());
 }
 
 void InventoryHandler::LoadInventory(vt_script::ReadScriptDescriptor& file)
@@ -397,4 +365,40 @@ void InventoryHandler::_LoadInventory(ReadScriptDescriptor& file, const std::str
     }
 }
 
+void InventoryHandler::LoadInventory(SaveGameReader& file)
+{
+    ClearAllData();
+
+    // The object ids tell their category: the categories are simply read in the saving order.
+    _LoadInventory(file); // items
+    _LoadInventory(file); // weapons
+    _LoadInventory(file); // head_armor
+    _LoadInventory(file); // torso_armor
+    _LoadInventory(file); // arm_armor
+    _LoadInventory(file); // leg_armor
+    _LoadInventory(file); // spirits
+}
+
+void InventoryHandler::SaveInventory(SaveGameWriter& file)
+{
+    // NOTE: As with the Lua save games, the equipped weapons/armor are saved with the characters.
+    _SaveInventory(file, GetInventoryItems());
+    _SaveInventory(file, GetInventoryWeapons());
+    _SaveInventory(file, GetInventoryArmors(GLOBAL_OBJECT_HEAD_ARMOR));
+    _SaveInventory(file, GetInventoryArmors(GLOBAL_OBJECT_TORSO_ARMOR));
+    _SaveInventory(file, GetInventoryArmors(GLOBAL_OBJECT_ARM_ARMOR));
+    _SaveInventory(file, GetInventoryArmors(GLOBAL_OBJECT_LEG_ARMOR));
+    _SaveInventory(file, GetInventorySpirits());
+}
+
+void InventoryHandler::_LoadInventory(SaveGameReader& file)
+{
+    uint32_t number_objects = file.ReadUInt32();
+    for (uint32_t i = 0; i < number_objects && !file.IsErrorDetected(); ++i) {
+        uint32_t object_id = file.ReadUInt32();
+        uint32_t count = file.ReadUInt32();
+        AddToInventory(object_id, count);
+    }
+}
+
 } // namespace vt_global
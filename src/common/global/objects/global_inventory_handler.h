@@ -17,19 +17,81 @@
 #include "global_weapon.h"
 
 #include "script/script_write.h"
+#include "common/global/global_definition_script.h"
+#include "common/global/global_save.h"
+
+#include <unordered_map>
+#include <vector>
 
 namespace vt_global
 {
 
-class InventoryHandler
+class InventoryHandler;
+
+/** ****************************************************************************
+*** \brief A read-only view over an inventory category
+***
+*** The view refers to the object ids of the category, sorted by id, and looks
+*** the objects up in the inventory. It is cheap to copy and reflects the
+*** changes made to the inventory, but its indices shift when objects are added
+*** or removed.
+*** ***************************************************************************/
+template <class T>
+class InventoryView
 {
 public:
-    InventoryHandler()
+    InventoryView(const InventoryHandler& handler, const std::vector<uint32_t>& object_ids) :
+        _handler(&handler),
+        _object_ids(&object_ids)
+    {}
+
+    //! \brief Views the objects of a category as a base type, e.g. as GlobalObject.
+    template <class U>
+    InventoryView(const InventoryView<U>& view) :
+        _handler(view._handler),
+        _object_ids(view._object_ids)
     {}
 
+    uint32_t size() const {
+        return static_cast<uint32_t>(_object_ids->size());
+    }
+
+    bool empty() const {
+        return _object_ids->empty();
+    }
+
+    //! \brief Returns the id of the object at the given position.
+    uint32_t GetObjectID(uint32_t index) const {
+        return (*_object_ids)[index];
+    }
+
+    //! \brief Returns the inventory object at the given position, without copying its pointer.
+    const std::shared_ptr<GlobalObject>& GetObject(uint32_t index) const;
+
+    //! \brief Returns the inventory object at the given position, as its category type.
+    std::shared_ptr<T> at(uint32_t index) const {
+        return std::static_pointer_cast<T>(GetObject(index));
+    }
+
+private:
+    const InventoryHandler* _handler;
+
+    //! \brief The object ids of the category, sorted.
+    const std::vector<uint32_t>* _object_ids;
+
+    template <class U> friend class InventoryView;
+};
+
+class InventoryHandler
+{
+public:
+    InventoryHandler();
+
     ~InventoryHandler();
 
-    //! \brief Handles lua script loading. This provides access to the lua data.
+    /** \brief Handles lua script loading. This provides access to the lua data.
+    *** The scripts are only checked there, and run when first used.
+    **/
     bool LoadScripts();
     void CloseScripts();
 
@@ -97,7 +159,7 @@ public:
     *** \return True if the object was found in the inventor, or false if it was not found
     **/
     bool IsItemInInventory(uint32_t id) {
-        return (_inventory.find(id) != _inventory.end());
+        return (_object_slots.find(id) != _object_slots.end());
     }
 
     /** \brief Gives how many of a given item is in the inventory
@@ -105,124 +167,139 @@ public:
     *** \return The number of the object found in the inventory
     **/
     uint32_t HowManyObjectsInInventory(uint32_t id) {
-        return (_inventory.find(id) != _inventory.end()) ? _inventory.at(id)->GetCount() : 0;
+        const std::shared_ptr<GlobalObject>& object = GetInventoryObject(id);
+        return object ? object->GetCount() : 0;
     }
 
+    /** \brief Returns the object stored in the inventory, not a copy
+    *** \param id The id of the object (item, weapon, armor, etc.) to look for
+    *** \return The inventory object, or nullptr if it isn't in the inventory
+    **/
+    const std::shared_ptr<GlobalObject>& GetInventoryObject(uint32_t id) const;
+
     void LoadInventory(vt_script::ReadScriptDescriptor& file);
     void SaveInventory(vt_script::WriteScriptDescriptor& file);
 
-    std::map<uint32_t, std::shared_ptr<GlobalObject>>& GetInventory() {
-        return _inventory;
+    //! \brief Loads and saves the inventory in a binary save game section
+    void LoadInventory(SaveGameReader& file);
+    void SaveInventory(SaveGameWriter& file);
+
+    /** \brief Inventory category views
+    *** The objects of each category are given sorted by id. The views stay valid as long as the handler.
+    **/
+    //@{
+    InventoryView<GlobalObject> GetInventory() const {
+        return InventoryView<GlobalObject>(*this, _all_ids);
     }
 
-    std::vector<std::shared_ptr<GlobalItem>>& GetInventoryItems() {
-        return _inventory_items;
+    InventoryView<GlobalItem> GetInventoryItems() const {
+        return InventoryView<GlobalItem>(*this, _category_ids[INVENTORY_CATEGORY_ITEMS]);
     }
 
-    std::vector<std::shared_ptr<GlobalWeapon>>& GetInventoryWeapons() {
-        return _inventory_weapons;
+    InventoryView<GlobalWeapon> GetInventoryWeapons() const {
+        return InventoryView<GlobalWeapon>(*this, _category_ids[INVENTORY_CATEGORY_WEAPONS]);
     }
 
     //! \brief Returns the armor inventory depending on the item type.
-    std::vector<std::shared_ptr<GlobalArmor>>& GetInventoryArmors(GLOBAL_OBJECT object_type);
+    InventoryView<GlobalArmor> GetInventoryArmors(GLOBAL_OBJECT object_type) const;
 
-    std::vector<std::shared_ptr<GlobalSpirit>>& GetInventorySpirits() {
-        return _inventory_spirits;
+    InventoryView<GlobalSpirit> GetInventorySpirits() const {
+        return InventoryView<GlobalSpirit>(*this, _category_ids[INVENTORY_CATEGORY_SPIRITS]);
     }
 
-    std::vector<std::shared_ptr<GlobalObject>>& GetInventoryKeyItems() {
-        return _inventory_key_items;
+    InventoryView<GlobalObject> GetInventoryKeyItems() const {
+        return InventoryView<GlobalObject>(*this, _key_item_ids);
     }
+    //@}
 
     vt_script::ReadScriptDescriptor &GetItemsScript() {
-        return _items_script;
+        return _items_script.Get();
     }
 
     vt_script::ReadScriptDescriptor &GetWeaponsScript() {
-        return _weapons_script;
+        return _weapons_script.Get();
     }
 
     vt_script::ReadScriptDescriptor &GetHeadArmorScript() {
-        return _head_armor_script;
+        return _head_armor_script.Get();
     }
 
     vt_script::ReadScriptDescriptor &GetTorsoArmorScript() {
-        return _torso_armor_script;
+        return _torso_armor_script.Get();
     }
 
     vt_script::ReadScriptDescriptor &GetArmArmorScript() {
-        return _arm_armor_script;
+        return _arm_armor_script.Get();
     }
 
     vt_script::ReadScriptDescriptor &GetLegArmorScript() {
-        return _leg_armor_script;
+        return _leg_armor_script.Get();
     }
 
     vt_script::ReadScriptDescriptor &GetSpiritsScript() {
-        return _spirits_script;
+        return _spirits_script.Get();
     }
 
 private:
-
-    /** \brief Retains a list of all of the objects currently stored in the player's inventory
-    *** This map is used to quickly check if an item is in the inventory or not. The key to the map is the object's
-    *** identification number. When an object is added to the inventory, if it already exists then the object counter
+    //! \brief The inventory categories, given by the object id ranges
+    enum INVENTORY_CATEGORY {
+        INVENTORY_CATEGORY_INVALID = -1,
+        INVENTORY_CATEGORY_ITEMS = 0,
+        INVENTORY_CATEGORY_WEAPONS = 1,
+        INVENTORY_CATEGORY_HEAD_ARMORS = 2,
+        INVENTORY_CATEGORY_TORSO_ARMORS = 3,
+        INVENTORY_CATEGORY_ARM_ARMORS = 4,
+        INVENTORY_CATEGORY_LEG_ARMORS = 5,
+        INVENTORY_CATEGORY_SPIRITS = 6,
+        INVENTORY_CATEGORY_TOTAL = 7
+    };
+
+    /** \brief The objects currently stored in the player's inventory, each one stored once
+    *** When an object is added to the inventory, if it already exists then the object counter
     *** is simply increased instead of adding an entire new class object. When the object count becomes zero, the object
-    *** is removed from the inventory. Duplicates of all objects are retained in the various inventory containers below.
+    *** is removed from the inventory, and the last object is moved into its slot.
     **/
-    std::map<uint32_t, std::shared_ptr<GlobalObject>> _inventory;
+    std::vector<std::shared_ptr<GlobalObject>> _objects;
 
-    /** \brief Inventory containers
-    *** These vectors contain the inventory of the entire party. The vectors are sorted according to the player's personal preferences.
-    *** When a new object is added to the inventory, by default it will be placed at the end of the vector.
+    //! \brief The slot of each object in _objects, by object id
+    std::unordered_map<uint32_t, uint32_t> _object_slots;
+
+    /** \brief Inventory category views
+    *** The ids of the objects of the entire inventory, of each category, and of the key items,
+    *** which can be of any category. These vectors are kept sorted when objects are added or removed.
     **/
     //@{
-    std::vector<std::shared_ptr<GlobalItem>>    _inventory_items;
-    std::vector<std::shared_ptr<GlobalWeapon>>  _inventory_weapons;
-    std::vector<std::shared_ptr<GlobalArmor>>   _inventory_head_armors;
-    std::vector<std::shared_ptr<GlobalArmor>>   _inventory_torso_armors;
-    std::vector<std::shared_ptr<GlobalArmor>>   _inventory_arm_armors;
-    std::vector<std::shared_ptr<GlobalArmor>>   _inventory_leg_armors;
-    std::vector<std::shared_ptr<GlobalSpirit>>  _inventory_spirits;
-
-    //! \brief The key items can be any kind of items.
-    std::vector<std::shared_ptr<GlobalObject>> _inventory_key_items;
+    std::vector<uint32_t> _all_ids;
+    std::vector<uint32_t> _category_ids[INVENTORY_CATEGORY_TOTAL];
+    std::vector<uint32_t> _key_item_ids;
     //@}
 
     //! \brief Contains data definitions for all items
-    vt_script::ReadScriptDescriptor _items_script;
+    DefinitionScript _items_script;
 
     //! \brief Contains data definitions for all weapons
-    vt_script::ReadScriptDescriptor _weapons_script;
+    DefinitionScript _weapons_script;
 
     //! \brief Contains data definitions for all armor that are equipped on the head
-    vt_script::ReadScriptDescriptor _head_armor_script;
+    DefinitionScript _head_armor_script;
 
     //! \brief Contains data definitions for all armor that are equipped on the torso
-    vt_script::ReadScriptDescriptor _torso_armor_script;
+    DefinitionScript _torso_armor_script;
 
     //! \brief Contains data definitions for all armor that are equipped on the arms
-    vt_script::ReadScriptDescriptor _arm_armor_script;
+    DefinitionScript _arm_armor_script;
 
     //! \brief Contains data definitions for all armor that are equipped on the legs
-    vt_script::ReadScriptDescriptor _leg_armor_script;
+    DefinitionScript _leg_armor_script;
 
     //! \brief Contains data definitions for all spirits
-    vt_script::ReadScriptDescriptor _spirits_script;
+    DefinitionScript _spirits_script;
 
-    /** \brief A helper template function that finds and removes an object from the inventory
-    *** \param obj_id The ID of the object to remove from the inventory
-    *** \param inv The vector container of the appropriate inventory type
-    *** \return True if the object was successfully removed, or false if it was not
-    **/
-    template <class T> bool _RemoveFromInventory(uint32_t obj_id, std::vector<std::shared_ptr<T>>& inv);
+    //! \brief Returns the inventory category of an object id.
+    static INVENTORY_CATEGORY _GetCategory(uint32_t obj_id);
 
-    /** \brief A helper template function that finds and returns a copy of an object from the inventory
-    *** \param obj_id The ID of the object to obtain from the inventory
-    *** \param inv The vector container of the appropriate inventory type
-    *** \return A pointer to the newly created copy of the object, or nullptr if the object could not be found
-    **/
-    template <class T> std::shared_ptr<T> _GetFromInventory(uint32_t obj_id, const std::vector<std::shared_ptr<T>>& inv);
+    //! \brief Stores a new object, of the given category, and adds it to the category views.
+    void _AddObject(const std::shared_ptr<GlobalObject>& object, INVENTORY_CATEGORY category);
 
     /** \brief A helper function to GameGlobal::SaveGame() that stores the contents of a type of inventory to the saved game file
     *** \param file A reference to the open and valid file where to write the inventory list
@@ -232,7 +309,7 @@ private:
     **/
     template <class T> void _SaveInventory(vt_script::WriteScriptDescriptor& file,
                                            const std::string& category_name,
-                                           const std::vector<std::shared_ptr<T>>& inv);
+                                           const InventoryView<T>& inv);
 
     /** \brief A helper function to GameGlobal::LoadGame() that restores the contents of the inventory from a saved game file
     *** \param file A reference to the open and valid file from where to read the inventory list
@@ -240,41 +317,23 @@ private:
     **/
     void _LoadInventory(vt_script::ReadScriptDescriptor& file, const std::string& category_name);
 
-};
+    //! \brief Binary save game version of the inventory category saving, as object id + count pairs
+    template <class T> void _SaveInventory(SaveGameWriter& file,
+                                           const InventoryView<T>& inv);
 
-template <class T> bool InventoryHandler::_RemoveFromInventory(uint32_t obj_id,
-                                                               std::vector<std::shared_ptr<T>>& inv)
-{
-    for (auto i = inv.begin(); i != inv.end(); i++) {
-        if ((*i)->GetID() == obj_id) {
-            inv.erase(i);
-            _inventory.erase(obj_id);
-            return true;
-        }
-    }
+    //! \brief Binary save game version of the inventory category loading
+    void _LoadInventory(SaveGameReader& file);
 
-    return false;
-}
+};
 
-template <class T> std::shared_ptr<T> InventoryHandler::_GetFromInventory(uint32_t obj_id,
-                                                                          const std::vector<std::shared_ptr<T>>& inv)
+template <class T> const std::shared_ptr<GlobalObject>& InventoryView<T>::GetObject(uint32_t index) const
 {
-    for (auto it = inv.begin(); it != inv.end(); ++it) {
-
-        if ((*it)->GetID() != obj_id)
-            continue;
-
-        auto return_object = std::make_shared<T>(**it);
-        return_object->SetCount(1);
-        return return_object;
-    }
-
-    return nullptr;
+    return _handler->GetInventoryObject((*_object_ids)[index]);
 }
 
 template <class T> void InventoryHandler::_SaveInventory(vt_script::WriteScriptDescriptor& file,
                                                          const std::string& category_name,
-                                                         const std::vector<std::shared_ptr<T>>& inv)
+                                                         const InventoryView<T>& inv)
 {
     if (file.IsFileOpen() == false) {
         PRINT_WARNING << "failed because the argument file was not open" << std::endl;
@@ -286,7 +345,7 @@ template <class T> void InventoryHandler::_SaveInventory(vt_script::WriteScriptD
 
     for (uint32_t i = 0; i < inv.size(); i++) {
         // Don't save inventory items with 0 count
-        if (inv[i]->GetCount() == 0)
+        if (inv.GetObject(i)->GetCount() == 0)
             continue;
 
         if (i == 0)
@@ -300,14 +359,34 @@ template <class T> void InventoryHandler::_SaveInventory(vt_script::WriteScriptD
             file.WriteLine("\t", false);
         }
 
-        file.WriteLine("[" + vt_utils::NumberToString(inv[i]->GetID()) + "] = " +
-                       vt_utils::NumberToString(inv[i]->GetCount()), false);
+        file.WriteLine("[" + vt_utils::NumberToString(inv.GetObjectID(i)) + "] = " +
+                       vt_utils::NumberToString(inv.GetObject(i)->GetCount()), false);
     }
 
     file.InsertNewLine();
     file.WriteLine("},");
 }
 
+template <class T> void InventoryHandler::_SaveInventory(SaveGameWriter& file,
+                                                         const InventoryView<T>& inv)
+{
+    // Don't save inventory items with 0 count
+    uint32_t number_objects = 0;
+    for (uint32_t i = 0; i < inv.size(); ++i) {
+        if (inv.GetObject(i)->GetCount() > 0)
+            ++number_objects;
+    }
+
+    file.WriteUInt32(number_objects);
+    for (uint32_t i = 0; i < inv.size(); ++i) {
+        if (inv.GetObject(i)->GetCount() == 0)
+            continue;
+
+        file.WriteUInt32(inv.GetObjectID(i));
+        file.WriteUInt32(inv.GetObject(i)->GetCount());
+    }
+}
+
 } // namespace vt_global
 
 #endif // __GLOBAL_INVENTORY_HANDLER_HEADER__
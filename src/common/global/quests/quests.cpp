@@ -239,6 +239,42 @@ void GameQuests::SaveQuests(WriteScriptDescriptor& file)
     file.InsertNewLine();
 }
 
+void GameQuests::LoadQuests(SaveGameReader& file)
+{
+    uint32_t number_entries = file.ReadUInt32();
+    for(uint32_t i = 0; i < number_entries && !file.IsErrorDetected(); ++i) {
+        std::string quest_id = file.ReadString();
+        uint32_t quest_log_number = file.ReadUInt32();
+        bool is_read = file.ReadBool();
+
+        if(!_AddQuestLog(quest_id, quest_log_number, is_read))
+        {
+            PRINT_WARNING << "save file has duplicate quest log id entries" << std::endl;
+            return;
+        }
+    }
+}
+
+void GameQuests::SaveQuests(SaveGameWriter& file)
+{
+    uint32_t number_entries = 0;
+    for(auto itr = _quest_log_entries.begin(); itr != _quest_log_entries.end(); ++itr) {
+        if(itr->second != nullptr)
+            ++number_entries;
+    }
+
+    file.WriteUInt32(number_entries);
+    for(auto itr = _quest_log_entries.begin(); itr != _quest_log_entries.end(); ++itr) {
+        const QuestLogEntry* quest_log_entry = itr->second;
+        if(quest_log_entry == nullptr)
+            continue;
+
+        file.WriteString(quest_log_entry->GetQuestId());
+        file.WriteUInt32(quest_log_entry->GetQuestLogNumber());
+        file.WriteBool(quest_log_entry->IsRead());
+    }
+}
+
 bool GameQuests::_AddQuestLog(const std::string& quest_id,
                               uint32_t quest_log_number,
                               bool is_read)
@@ -16,6 +16,7 @@
 
 #include "script/script_read.h"
 #include "script/script_write.h"
+#include "common/global/global_save.h"
 
 #include <string>
 #include <vector>
@@ -83,6 +84,10 @@ public:
     **/
     void SaveQuests(vt_script::WriteScriptDescriptor& file);
 
+    //! \brief Loads and saves the Quest Log entries in a binary save game section
+    void LoadQuests(SaveGameReader& file);
+    void SaveQuests(SaveGameWriter& file);
+
 private:
     /** \brief The container which stores the quest log entries in the game. the quest log key
     *** acts as the key for this quest
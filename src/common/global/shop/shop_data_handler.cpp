@@ -128,4 +128,47 @@ void ShopDataHandler::SaveShopData(vt_script::WriteScriptDescriptor& file)
     file.InsertNewLine();
 }
 
+//! \brief Reads a map of item id + count pairs from a binary save game.
+static void _LoadShopItems(SaveGameReader& file, std::map<uint32_t, uint32_t>& items)
+{
+    uint32_t number_items = file.ReadUInt32();
+    for (uint32_t i = 0; i < number_items && !file.IsErrorDetected(); ++i) {
+        uint32_t item_id = file.ReadUInt32();
+        items[item_id] = file.ReadUInt32();
+    }
+}
+
+//! \brief Writes a map of item id + count pairs to a binary save game.
+static void _SaveShopItems(SaveGameWriter& file, const std::map<uint32_t, uint32_t>& items)
+{
+    file.WriteUInt32(static_cast<uint32_t>(items.size()));
+    for (auto it = items.begin(); it != items.end(); ++it) {
+        file.WriteUInt32(it->first);
+        file.WriteUInt32(it->second);
+    }
+}
+
+void ShopDataHandler::LoadShopData(SaveGameReader& file)
+{
+    uint32_t number_shops = file.ReadUInt32();
+    for (uint32_t i = 0; i < number_shops && !file.IsErrorDetected(); ++i) {
+        std::string shop_id = file.ReadString();
+
+        ShopData shop_data;
+        _LoadShopItems(file, shop_data._available_buy);
+        _LoadShopItems(file, shop_data._available_trade);
+        _shop_data[shop_id] = shop_data;
+    }
+}
+
+void ShopDataHandler::SaveShopData(SaveGameWriter& file)
+{
+    file.WriteUInt32(static_cast<uint32_t>(_shop_data.size()));
+    for (auto it = _shop_data.begin(); it != _shop_data.end(); ++it) {
+        file.WriteString(it->first);
+        _SaveShopItems(file, it->second._available_buy);
+        _SaveShopItems(file, it->second._available_trade);
+    }
+}
+
 } // namespace vt_global
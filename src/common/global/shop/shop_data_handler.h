@@ -15,6 +15,7 @@
 
 #include "script/script_read.h"
 #include "script/script_write.h"
+#include "common/global/global_save.h"
 
 #include <string>
 #include <map>
@@ -51,6 +52,10 @@ public:
     **/
     void SaveShopData(vt_script::WriteScriptDescriptor& file);
 
+    //! \brief Loads and saves the shop data in a binary save game section
+    void LoadShopData(SaveGameReader& file);
+    void SaveShopData(SaveGameWriter& file);
+
 private:
     //! \brief A map of the curent shop data.
     //! shop_id, corresponding shop data
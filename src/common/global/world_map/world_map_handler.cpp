@@ -209,4 +209,37 @@ void WorldMapHandler::SavePlayerSaveGameWorldMap(vt_script::WriteScriptDescripto
     file.InsertNewLine();
 }
 
+void WorldMapHandler::LoadPlayerSaveGameWorldMap(SaveGameReader& file)
+{
+    std::string world_map_id = file.ReadString();
+    SetCurrentWorldMap(world_map_id);
+
+    uint32_t number_locations = file.ReadUInt32();
+    for(uint32_t i = 0; i < number_locations && !file.IsErrorDetected(); ++i) {
+        SetWorldLocationVisible(file.ReadString(), true);
+    }
+
+    std::string current_location = file.ReadString();
+    if (!current_location.empty())
+        SetCurrentLocationId(current_location);
+}
+
+void WorldMapHandler::SavePlayerSaveGameWorldMap(SaveGameWriter& file)
+{
+    file.WriteString(_current_world_map_id);
+
+    if (_current_world_map) {
+        const WorldMapLocations& world_map_locations = _current_world_map->GetVisibleWorldMapLocations();
+        file.WriteUInt32(static_cast<uint32_t>(world_map_locations.size()));
+        for(auto iter = world_map_locations.begin(); iter != world_map_locations.end(); ++iter) {
+            file.WriteString(iter->first);
+        }
+    }
+    else {
+        file.WriteUInt32(0);
+    }
+
+    file.WriteString(GetCurrentLocationId());
+}
+
 } // namespace vt_global
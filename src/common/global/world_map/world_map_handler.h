@@ -15,6 +15,7 @@
 
 #include "script/script_read.h"
 #include "script/script_write.h"
+#include "common/global/global_save.h"
 #include "engine/video/image.h"
 #include "utils/ustring.h"
 
@@ -101,6 +102,10 @@ public:
     //! \param file Reference to open and valid file for writting the data
     void SavePlayerSaveGameWorldMap(vt_script::WriteScriptDescriptor& file);
 
+    //! \brief Loads and saves the world map information in a binary save game section
+    void LoadPlayerSaveGameWorldMap(SaveGameReader& file);
+    void SavePlayerSaveGameWorldMap(SaveGameWriter& file);
+
 private:
     //! \brief The container which stores all the available world maps information
     std::map<std::string, WorldMap> _world_map_info;
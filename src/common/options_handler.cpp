@@ -1319,6 +1319,10 @@ bool GameOptionsMenuHandler::_SaveSettingsFile(const std::string& filename)
     settings_lua.WriteComment("Music and sounds volumes: [0.0 - 1.0]");
     settings_lua.WriteFloat("music_vol", AudioManager->GetMusicVolume());
     settings_lua.WriteFloat("sound_vol", AudioManager->GetSoundVolume());
+    settings_lua.WriteComment("Whether the decoded short sounds are cached on disk, for faster loading.");
+    settings_lua.WriteBool("pcm_cache", AudioManager->IsPcmCacheEnabled());
+    settings_lua.WriteComment("Whether the short sounds are mixed together in software, sparing the audio sources.");
+    settings_lua.WriteBool("sound_mixer", AudioManager->IsSoundMixerEnabled());
     settings_lua.EndTable(); // audio_settings
 
     // input
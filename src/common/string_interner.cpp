@@ -0,0 +1,105 @@
+////////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2018 by Bertram (Valyria Tear)
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+////////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file   string_interner.cpp
+*** \author Yohann Ferreira, yohann ferreira orange fr
+*** \brief  Source file for the game string interner
+*** ***************************************************************************/
+
+#include "common/string_interner.h"
+
+namespace vt_common
+{
+
+//! \brief The initial number of hash table slots
+const uint32_t STRING_INTERNER_INITIAL_SLOTS = 256;
+
+//! \brief The 32 bits FNV-1a hash of a string
+static uint32_t _HashString(const std::string& str)
+{
+    uint32_t hash = 2166136261u;
+    for(size_t i = 0; i < str.size(); ++i) {
+        hash ^= static_cast<uint8_t>(str[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+StringInterner::StringInterner() :
+    _slots(STRING_INTERNER_INITIAL_SLOTS, INVALID_STRING_ID)
+{}
+
+uint32_t StringInterner::Intern(const std::string& str)
+{
+    uint32_t hash = _HashString(str);
+    uint32_t slot = _FindSlot(str, hash);
+    if(_slots[slot] != INVALID_STRING_ID)
+        return _slots[slot];
+
+    _strings.push_back(str);
+    _hashes.push_back(hash);
+    uint32_t id = static_cast<uint32_t>(_strings.size());
+
+    // Keep the table at most half full, so that the probe sequences stay short.
+    if(_strings.size() * 2 > _slots.size())
+        _Grow();
+    else
+        _slots[slot] = id;
+
+    return id;
+}
+
+uint32_t StringInterner::Find(const std::string& str) const
+{
+    return _slots[_FindSlot(str, _HashString(str))];
+}
+
+const std::string& StringInterner::GetString(uint32_t id) const
+{
+    static const std::string empty_string;
+    if(id == INVALID_STRING_ID || id > _strings.size())
+        return empty_string;
+    return _strings[id - 1];
+}
+
+uint32_t StringInterner::_FindSlot(const std::string& str, uint32_t hash) const
+{
+    const uint32_t mask = static_cast<uint32_t>(_slots.size()) - 1;
+    uint32_t slot = hash & mask;
+    // Linear probing: the table is never full, so an empty slot is always found.
+    while(_slots[slot] != INVALID_STRING_ID) {
+        uint32_t index = _slots[slot] - 1;
+        if(_hashes[index] == hash && _strings[index] == str)
+            return slot;
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+void StringInterner::_Grow()
+{
+    _slots.assign(_slots.size() * 2, INVALID_STRING_ID);
+
+    const uint32_t mask = static_cast<uint32_t>(_slots.size()) - 1;
+    for(uint32_t index = 0; index < _strings.size(); ++index) {
+        uint32_t slot = _hashes[index] & mask;
+        while(_slots[slot] != INVALID_STRING_ID)
+            slot = (slot + 1) & mask;
+        _slots[slot] = index + 1;
+    }
+}
+
+StringInterner& GetStringInterner()
+{
+    static StringInterner interner;
+    return interner;
+}
+
+} // namespace vt_common
@@ -0,0 +1,81 @@
+////////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2018 by Bertram (Valyria Tear)
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+////////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file   string_interner.h
+*** \author Yohann Ferreira, yohann ferreira orange fr
+*** \brief  Header file for the game string interner
+***
+*** Interning gives each distinct string a small integer id, so that the
+*** containers looked up every frame, such as the game events, compare and hash
+*** integers instead of strings.
+*** ***************************************************************************/
+
+#ifndef __STRING_INTERNER_HEADER__
+#define __STRING_INTERNER_HEADER__
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace vt_common
+{
+
+//! \brief The id of no string. The valid ids start from 1.
+const uint32_t INVALID_STRING_ID = 0;
+
+/** ****************************************************************************
+*** \brief Gives a stable id to each distinct string
+***
+*** The strings are stored in an open addressing hash table, and are never
+*** removed: an id stays valid, and refers to the same string, for the whole
+*** game run. The interner is only used from the main thread.
+*** ***************************************************************************/
+class StringInterner
+{
+public:
+    StringInterner();
+
+    //! \brief Returns the id of the string, adding it when it isn't interned yet.
+    uint32_t Intern(const std::string& str);
+
+    //! \brief Returns the id of the string, or INVALID_STRING_ID when it isn't interned.
+    uint32_t Find(const std::string& str) const;
+
+    //! \brief Returns the string of an id, or an empty string for an invalid id.
+    const std::string& GetString(uint32_t id) const;
+
+    uint32_t GetNumberStrings() const {
+        return static_cast<uint32_t>(_strings.size());
+    }
+
+private:
+    //! \brief The interned strings, by id - 1. A deque keeps the returned references valid.
+    std::deque<std::string> _strings;
+
+    //! \brief The hash of each interned string, by id - 1, so that growing the table doesn't hash them again
+    std::vector<uint32_t> _hashes;
+
+    //! \brief The hash table slots, holding a string id, or INVALID_STRING_ID when empty. Its size is a power of 2.
+    std::vector<uint32_t> _slots;
+
+    //! \brief Returns the slot holding the string, or the empty slot where it would be added.
+    uint32_t _FindSlot(const std::string& str, uint32_t hash) const;
+
+    //! \brief Doubles the number of slots, and adds the strings again.
+    void _Grow();
+};
+
+//! \brief Returns the interner shared by the game code.
+StringInterner& GetStringInterner();
+
+} // namespace vt_common
+
+#endif // __STRING_INTERNER_HEADER__
@@ -29,6 +29,11 @@
 #include "utils/utils_strings.h"
 #include "utils/utils_files.h"
 
+// The OpenAL Soft extensions, used for headless rendering
+#ifndef __APPLE__
+#include "alext.h"
+#endif
+
 using namespace vt_utils;
 using namespace vt_system;
 using namespace vt_audio::private_audio;
@@ -39,14 +44,33 @@ namespace vt_audio
 AudioEngine *AudioManager = nullptr;
 bool AUDIO_DEBUG = false;
 bool AUDIO_ENABLE = true;
+bool AUDIO_HEADLESS = false;
+
+#ifdef ALC_SOFT_loopback
+//! \brief The loopback functions, only available through alcGetProcAddress()
+static LPALCLOOPBACKOPENDEVICESOFT alcLoopbackOpenDeviceSOFT = nullptr;
+static LPALCISRENDERFORMATSUPPORTEDSOFT alcIsRenderFormatSupportedSOFT = nullptr;
+static LPALCRENDERSAMPLESSOFT alcRenderSamplesSOFT = nullptr;
+#endif
 
 AudioEngine::AudioEngine() :
     _sound_volume(1.0f),
     _music_volume(1.0f),
     _device(0),
     _context(0),
+    _headless(false),
+    _loopback(false),
+    _headless_time_remainder(0),
     _max_sources(MAX_DEFAULT_AUDIO_SOURCES),
-    _active_music(nullptr)
+    _active_music(nullptr),
+    _stolen_sources(0),
+    _shared_buffers_memory(0),
+    _audio_cache_memory_limit(DEFAULT_AUDIO_CACHE_MEMORY_LIMIT),
+    _pcm_cache_enabled(true),
+    _sound_mixer_enabled(true),
+    _shared_buffer_hits(0),
+    _shared_buffer_misses(0),
+    _audio_cache_evictions(0)
 {}
 
 bool AudioEngine::SingletonInitialize()
@@ -54,6 +78,47 @@ bool AudioEngine::SingletonInitialize()
     if(!AUDIO_ENABLE)
         return true;
 
+    if(AUDIO_HEADLESS) {
+        if(!_OpenHeadlessDevice())
+            return false;
+    } else if(!_OpenBestDevice()) {
+        return false;
+    }
+
+    alcMakeContextCurrent(_context);
+    CheckALError(); // Clear errors
+    CheckALCError(); // Clear errors
+
+    // The mixer source is created first, so that it doesn't miss when the sources run out.
+    if(_mixer.Initialize())
+        _stream_thread.SetMixer(&_mixer);
+
+    // Create as many sources as possible (we fix an upper bound of MAX_DEFAULT_AUDIO_SOURCES)
+    ALuint source;
+    for(uint16_t i = 0; i < _max_sources; ++i) {
+        alGenSources(1, &source);
+        if(CheckALError()) {
+            _max_sources = i;
+            break;
+        }
+        _audio_sources.push_back(new private_audio::AudioSource(source));
+    }
+
+    // The sources are given from the front.
+    _free_sources.assign(_audio_sources.rbegin(), _audio_sources.rend());
+
+    if(_max_sources == 0) {
+        PRINT_ERROR << "failed to create at least one OpenAL audio source" << std::endl;
+        return false;
+    }
+
+    _stream_thread.Initialize();
+
+    return true;
+} // bool AudioEngine::SingletonInitialize()
+
+bool AudioEngine::_OpenBestDevice()
+{
     const ALCchar *best_device = 0; // Will store the name of the 'best' device for audio playback
     ALCint highest_version = 0; // The highest version number found
     CheckALError(); // Clears errors
@@ -122,28 +187,63 @@ bool AudioEngine::SingletonInitialize()
         return false;
     }
 
-    alcMakeContextCurrent(_context);
-    CheckALError(); // Clear errors
-    CheckALCError(); // Clear errors
+    return true;
+}
 
-    // Create as many sources as possible (we fix an upper bound of MAX_DEFAULT_AUDIO_SOURCES)
-    ALuint source;
-    for(uint16_t i = 0; i < _max_sources; ++i) {
-        alGenSources(1, &source);
-        if(CheckALError()) {
-            _max_sources = i;
-            break;
+bool AudioEngine::_OpenHeadlessDevice()
+{
+    CheckALError(); // Clears errors
+    CheckALCError(); // Clears errors
+
+#ifdef ALC_SOFT_loopback
+    if(alcIsExtensionPresent(nullptr, "ALC_SOFT_loopback") == AL_TRUE) {
+        alcLoopbackOpenDeviceSOFT = reinterpret_cast<LPALCLOOPBACKOPENDEVICESOFT>(alcGetProcAddress(nullptr, "alcLoopbackOpenDeviceSOFT"));
+        alcIsRenderFormatSupportedSOFT = reinterpret_cast<LPALCISRENDERFORMATSUPPORTEDSOFT>(alcGetProcAddress(nullptr, "alcIsRenderFormatSupportedSOFT"));
+        alcRenderSamplesSOFT = reinterpret_cast<LPALCRENDERSAMPLESSOFT>(alcGetProcAddress(nullptr, "alcRenderSamplesSOFT"));
+    }
+
+    if(alcLoopbackOpenDeviceSOFT && alcIsRenderFormatSupportedSOFT && alcRenderSamplesSOFT) {
+        _device = alcLoopbackOpenDeviceSOFT(nullptr);
+        if(_device != nullptr
+                && alcIsRenderFormatSupportedSOFT(_device, HEADLESS_AUDIO_FREQUENCY, ALC_STEREO_SOFT, ALC_SHORT_SOFT) == ALC_TRUE) {
+            const ALCint attributes[] = {
+                ALC_FORMAT_CHANNELS_SOFT, ALC_STEREO_SOFT,
+                ALC_FORMAT_TYPE_SOFT, ALC_SHORT_SOFT,
+                ALC_FREQUENCY, static_cast<ALCint>(HEADLESS_AUDIO_FREQUENCY),
+                0
+            };
+            _context = alcCreateContext(_device, attributes);
+            if(_context != nullptr) {
+                _headless = true;
+                _loopback = true;
+                return true;
+            }
         }
-        _audio_sources.push_back(new private_audio::AudioSource(source));
+
+        IF_PRINT_WARNING(AUDIO_DEBUG) << "failed to set up an OpenAL loopback device: " << CreateALCErrorString() << std::endl;
+        if(_device != nullptr)
+            alcCloseDevice(_device);
+        _device = nullptr;
     }
+#endif
 
-    if(_max_sources == 0) {
-        PRINT_ERROR << "failed to create at least one OpenAL audio source" << std::endl;
+    // Fall back to the OpenAL Soft null output, which plays in real-time but outputs nothing.
+    _device = alcOpenDevice("No Output");
+    if(CheckALCError() || _device == nullptr) {
+        PRINT_ERROR << "failed to open a headless OpenAL device: " << CreateALCErrorString() << std::endl;
         return false;
     }
 
+    _context = alcCreateContext(_device, nullptr);
+    if(CheckALCError() || _context == nullptr) {
+        PRINT_ERROR << "failed to create an OpenAL context: " << CreateALCErrorString() << std::endl;
+        alcCloseDevice(_device);
+        return false;
+    }
+
+    _headless = true;
     return true;
-} // bool AudioEngine::SingletonInitialize()
+}
 
 AudioEngine::~AudioEngine()
 {
@@ -156,11 +256,20 @@ AudioEngine::~AudioEngine()
     }
     _audio_cache.clear();
 
-    // Delete all audio sources
+    // The streams still attached are released before their sources get deleted.
+    _stream_thread.Shutdown();
+    _preloader.Shutdown();
+    _mixer.Shutdown();
+    _mixed_audio.clear();
+
+    // Delete all audio sources, after having the descriptors still holding one forget it.
     for(std::vector<AudioSource *>::iterator i = _audio_sources.begin(); i != _audio_sources.end(); ++i) {
+        if((*i)->owner)
+            (*i)->owner->_source = nullptr;
         delete(*i);
     }
     _audio_sources.clear();
+    _free_sources.clear();
 
     // We shouldn't have any descriptors registered left,
     // except when some scripts have created its own descriptors and didn't free them.
@@ -199,6 +308,13 @@ AudioEngine::~AudioEngine()
         }
     }
 
+    // The shared buffers are normally all released with their descriptors.
+    for(std::map<std::string, SharedAudioBuffer>::iterator it = _shared_buffers.begin();
+            it != _shared_buffers.end(); ++it) {
+        delete[] it->second.buffer;
+    }
+    _shared_buffers.clear();
+
     alcMakeContextCurrent(0);
     alcDestroyContext(_context);
     alcCloseDevice(_device);
@@ -214,6 +330,74 @@ void AudioEngine::Update()
             (*i)->owner->_Update();
         }
     }
+
+    // The mixed sounds are stopped once the mixer played them.
+    uint32_t voice = 0;
+    while(_mixer.PopEndedVoice(voice)) {
+        std::map<uint32_t, AudioDescriptor *>::iterator it = _mixed_audio.find(voice);
+        // The voice may have been stopped already.
+        if(it == _mixed_audio.end())
+            continue;
+
+        it->second->_mixer_voice = 0;
+        it->second->_state = AUDIO_STATE_STOPPED;
+        _mixed_audio.erase(it);
+    }
+
+    // Update the fading of the mixed sounds, which can stop them.
+    if(!_mixed_audio.empty()) {
+        std::vector<AudioDescriptor *> mixed_audio;
+        for(std::map<uint32_t, AudioDescriptor *>::iterator it = _mixed_audio.begin(); it != _mixed_audio.end(); ++it)
+            mixed_audio.push_back(it->second);
+        for(uint32_t i = 0; i < mixed_audio.size(); ++i) {
+            if(mixed_audio[i]->_mixer_voice != 0)
+                mixed_audio[i]->_Update();
+        }
+    }
+
+    // The virtual audio list changes when audio gets a source back, so update a copy of it.
+    if(_virtual_audio.empty())
+        return;
+    std::vector<AudioDescriptor *> virtual_audio = _virtual_audio;
+    for(uint32_t i = 0; i < virtual_audio.size(); ++i) {
+        // Only update the audio still virtual, as it may have been stopped by a previous one.
+        if(virtual_audio[i]->IsVirtual())
+            virtual_audio[i]->_Update();
+    }
+}
+
+bool AudioEngine::RenderSamples(int16_t *buffer, uint32_t number_frames)
+{
+#ifdef ALC_SOFT_loopback
+    if(!_loopback)
+        return false;
+
+    alcRenderSamplesSOFT(_device, buffer, static_cast<ALCsizei>(number_frames));
+    return true;
+#else
+    (void)buffer;
+    (void)number_frames;
+    return false;
+#endif
+}
+
+void AudioEngine::UpdateHeadless(uint32_t time)
+{
+    if(!AUDIO_ENABLE || !_loopback)
+        return;
+
+    // Keep the part of a sample which couldn't be rendered yet for the next update.
+    uint32_t number_frames = (time * HEADLESS_AUDIO_FREQUENCY + _headless_time_remainder) / 1000;
+    _headless_time_remainder = (time * HEADLESS_AUDIO_FREQUENCY + _headless_time_remainder) % 1000;
+
+    // Render in chunks, so that the buffer doesn't grow with a long frame.
+    const uint32_t chunk_frames = 1024;
+    _headless_buffer.resize(chunk_frames * 2);
+    while(number_frames > 0) {
+        uint32_t frames = number_frames < chunk_frames ? number_frames : chunk_frames;
+        RenderSamples(&_headless_buffer[0], frames);
+        number_frames -= frames;
+    }
 }
 
 void AudioEngine::SetSoundVolume(float volume)
@@ -228,9 +412,12 @@ void AudioEngine::SetSoundVolume(float volume)
         _sound_volume = volume;
     }
 
+    // The mixed sounds volume is updated as well, so that playing sounds follow the change.
     for(std::vector<SoundDescriptor *>::iterator i = _registered_sounds.begin(); i != _registered_sounds.end(); ++i) {
         if((*i)->_source != nullptr) {
             alSourcef((*i)->_source->source, AL_GAIN, _sound_volume * (*i)->GetVolume());
+        } else if((*i)->_mixer_voice != 0) {
+            _mixer.SetVolume((*i)->_mixer_voice, _sound_volume * (*i)->GetVolume());
         }
     }
 }
@@ -585,24 +772,71 @@ void AudioEngine::DEBUG_PrintInfo()
         PRINT_WARNING << c[0];
         c++;
     }
-}
+    PRINT_WARNING << std::endl;
+
+    PRINT_WARNING << "Free sources:                " << _free_sources.size() << std::endl;
+    PRINT_WARNING << "Virtual audio:               " << _virtual_audio.size() << std::endl;
+    PRINT_WARNING << "Stolen sources:              " << _stolen_sources << std::endl;
+    PRINT_WARNING << "Cached audio files:          " << _audio_cache.size() << std::endl;
+    PRINT_WARNING << "Shared decoded buffers:      " << _shared_buffers.size() << std::endl;
+    PRINT_WARNING << "Decoded audio memory:        " << _shared_buffers_memory / 1024 << " / "
+                  << _audio_cache_memory_limit / 1024 << " KiB" << std::endl;
+    PRINT_WARNING << "Shared buffer hits/misses:   " << _shared_buffer_hits << " / "
+                  << _shared_buffer_misses << std::endl;
+    PRINT_WARNING << "Cache evictions:             " << _audio_cache_evictions << std::endl;
+    PRINT_WARNING << "Preloaded audio files:       " << _preloader.GetNumberPreloaded() << std::endl;
+    PRINT_WARNING << "Stream underruns:            " << _stream_thread.GetNumberUnderruns() << std::endl;
+    PRINT_WARNING << "Sound mixer:                 " << (_mixer.IsInitialized() ? "enabled" : "disabled")
+                  << ", " << _mixer.GetNumberVoices() << " voices" << std::endl;
+    if(_headless)
+        PRINT_WARNING << "Headless device:             " << (_loopback ? "loopback" : "null output") << std::endl;
+}
+
+private_audio::AudioSource* AudioEngine::_AcquireAudioSource(AudioDescriptor *requester)
+{
+    if(_free_sources.empty()) {
+        // Find the source to take: one held by stopped audio if any,
+        // or else the one of the least important playing audio.
+        AudioDescriptor *victim = nullptr;
+        for(std::vector<AudioSource *>::iterator i = _audio_sources.begin(); i != _audio_sources.end(); ++i) {
+            AudioDescriptor *descriptor = (*i)->owner;
+            if(descriptor == nullptr || descriptor == requester)
+                continue;
 
-private_audio::AudioSource* AudioEngine::_AcquireAudioSource()
-{
-    // Find and return the first source that does not have an owner
-    for(std::vector<AudioSource *>::iterator i = _audio_sources.begin(); i != _audio_sources.end(); ++i) {
-        AudioDescriptor* descriptor = (*i)->owner;
-        if(descriptor == nullptr) {
-            return *i;
-        }
-        else if (descriptor->GetState() == AUDIO_STATE_UNLOADED) {
-            // Test whether the sound is unloaded, meaning the source is available
-            return *i;
+            AUDIO_STATE state = descriptor->_state;
+            if(state == AUDIO_STATE_STOPPED || state == AUDIO_STATE_UNLOADED) {
+                victim = descriptor;
+                break;
+            }
+
+            // Paused audio can't keep track of its position without its source.
+            if(state == AUDIO_STATE_PAUSED || !descriptor->_IsLessImportantThan(requester))
+                continue;
+
+            if(victim == nullptr || descriptor->_IsLessImportantThan(victim))
+                victim = descriptor;
         }
+
+        // Return nullptr when all the sources are used by more important audio
+        if(victim == nullptr)
+            return nullptr;
+
+        if(victim->_state == AUDIO_STATE_STOPPED || victim->_state == AUDIO_STATE_UNLOADED)
+            victim->_ReleaseSource();
+        else
+            victim->_Virtualize();
+        ++_stolen_sources;
     }
 
-    // Return nullptr in the (extremely rare) case that all sources are owned and actively playing or paused
-    return nullptr;
+    AudioSource *source = _free_sources.back();
+    _free_sources.pop_back();
+    return source;
+}
+
+void AudioEngine::_ReleaseAudioSource(private_audio::AudioSource *source)
+{
+    source->Reset();
+    _free_sources.push_back(source);
 }
 
 
@@ -640,7 +874,119 @@ bool AudioEngine::_LoadAudio(const std::string &filename, bool is_music, vt_mode
     }
 
     _audio_cache.insert(std::make_pair(filename, AudioCacheElement(SDL_GetTicks(), audio)));
+
+    _EnforceAudioCacheMemoryLimit(filename);
     return true;
 }
 
+void AudioEngine::PreloadAudio(const std::vector<std::string> &music_filenames,
+                               const std::vector<std::string> &sound_filenames)
+{
+    if(!AUDIO_ENABLE)
+        return;
+
+    _preloader.Clear();
+
+    // Music is streamed, so only its cached descriptors are ready.
+    std::vector<std::string> music_files;
+    for(uint32_t i = 0; i < music_filenames.size(); ++i) {
+        if(_audio_cache.find(music_filenames[i]) == _audio_cache.end())
+            music_files.push_back(music_filenames[i]);
+    }
+    // Sounds already decoded don't need to be again.
+    std::vector<std::string> sound_files;
+    for(uint32_t i = 0; i < sound_filenames.size(); ++i) {
+        if(_audio_cache.find(sound_filenames[i]) == _audio_cache.end()
+                && _shared_buffers.find(sound_filenames[i]) == _shared_buffers.end())
+            sound_files.push_back(sound_filenames[i]);
+    }
+
+    _preloader.Preload(music_files, false);
+    _preloader.Preload(sound_files, true, _pcm_cache_enabled);
+}
+
+void AudioEngine::SetAudioCacheMemoryLimit(uint32_t limit)
+{
+    _audio_cache_memory_limit = limit;
+    _EnforceAudioCacheMemoryLimit(std::string());
+}
+
+AudioBuffer* AudioEngine::_RetainSharedBuffer(const std::string &filename, MixerSoundPtr &mixer_sound)
+{
+    std::map<std::string, SharedAudioBuffer>::iterator it = _shared_buffers.find(filename);
+    if(it == _shared_buffers.end()) {
+        ++_shared_buffer_misses;
+        return nullptr;
+    }
+
+    ++_shared_buffer_hits;
+    ++it->second.reference_count;
+    mixer_sound = it->second.mixer_sound;
+    return it->second.buffer;
+}
+
+void AudioEngine::_AddSharedBuffer(const std::string &filename, AudioBuffer *buffer, uint32_t data_size,
+                                   const MixerSoundPtr &mixer_sound)
+{
+    if(_shared_buffers.find(filename) != _shared_buffers.end()) {
+        IF_PRINT_WARNING(AUDIO_DEBUG) << "a shared buffer already exists for file: " << filename << std::endl;
+        return;
+    }
+
+    // The mixer format data is counted as well.
+    if(mixer_sound != nullptr)
+        data_size += static_cast<uint32_t>(mixer_sound->samples.size() * sizeof(float));
+
+    _shared_buffers.insert(std::make_pair(filename, SharedAudioBuffer(buffer, data_size, mixer_sound)));
+    _shared_buffers_memory += data_size;
+}
+
+void AudioEngine::_ReleaseSharedBuffer(const std::string &filename)
+{
+    std::map<std::string, SharedAudioBuffer>::iterator it = _shared_buffers.find(filename);
+    if(it == _shared_buffers.end()) {
+        IF_PRINT_WARNING(AUDIO_DEBUG) << "no shared buffer to release for file: " << filename << std::endl;
+        return;
+    }
+
+    if(--it->second.reference_count > 0)
+        return;
+
+    _shared_buffers_memory -= it->second.data_size;
+    delete[] it->second.buffer;
+    _shared_buffers.erase(it);
+}
+
+void AudioEngine::_EnforceAudioCacheMemoryLimit(const std::string &kept_filename)
+{
+    while(_shared_buffers_memory > _audio_cache_memory_limit) {
+        // Find the least recently used audio that nothing else is using.
+        std::map<std::string, AudioCacheElement>::iterator lru = _audio_cache.end();
+        std::map<std::string, AudioCacheElement>::iterator it = _audio_cache.begin();
+        for(; it != _audio_cache.end(); ++it) {
+            AudioDescriptor *audio = it->second.audio;
+            if(it->first == kept_filename || !audio->GetGameModeOwners()->empty())
+                continue;
+            if(audio->GetState() != AUDIO_STATE_STOPPED || audio == _active_music)
+                continue;
+            // Only the statically loaded audio can give back decoded memory,
+            // and only when no other descriptor shares its buffer.
+            std::map<std::string, SharedAudioBuffer>::const_iterator shared = _shared_buffers.find(it->first);
+            if(shared == _shared_buffers.end() || shared->second.reference_count > 1)
+                continue;
+
+            if(lru == _audio_cache.end() || it->second.last_update_time < lru->second.last_update_time)
+                lru = it;
+        }
+
+        if(lru == _audio_cache.end())
+            return;
+
+        IF_PRINT_DEBUG(AUDIO_DEBUG) << "evicting cached audio: " << lru->first << std::endl;
+        delete lru->second.audio;
+        _audio_cache.erase(lru);
+        ++_audio_cache_evictions;
+    }
+}
+
 } // namespace vt_audio
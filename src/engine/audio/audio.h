@@ -29,6 +29,7 @@
 
 #include "audio_descriptor.h"
 #include "audio_effects.h"
+#include "audio_preloader.h"
 
 #include <map>
 
@@ -47,12 +48,45 @@ extern bool AUDIO_DEBUG;
 //! \brief Enable whether the audio engine should function
 extern bool AUDIO_ENABLE;
 
+//! \brief Whether the audio engine renders into memory instead of using an audio device
+extern bool AUDIO_HEADLESS;
+
 namespace private_audio
 {
 
 //! \brief The maximum default number of audio sources that the engine tries to create
 const uint16_t MAX_DEFAULT_AUDIO_SOURCES = 64;
 
+//! \brief The default memory budget of the decoded audio data kept in OpenAL buffers, in bytes
+const uint32_t DEFAULT_AUDIO_CACHE_MEMORY_LIMIT = 32 * 1024 * 1024;
+
+//! \brief The sample rate of the headless rendering, in Hz. The samples are stereo, 16 bits.
+const uint32_t HEADLESS_AUDIO_FREQUENCY = 44100;
+
+/** ****************************************************************************
+*** \brief An OpenAL buffer holding the whole decoded data of a statically loaded file
+***
+*** Every audio descriptor statically loading the same file references the same buffer,
+*** which is deleted once the last of them frees its audio.
+*** ***************************************************************************/
+class SharedAudioBuffer
+{
+public:
+    SharedAudioBuffer(AudioBuffer *buf, uint32_t size, const MixerSoundPtr &mixer) :
+        buffer(buf), data_size(size), mixer_sound(mixer), reference_count(1) {}
+
+    //! \brief The buffer, allocated as an array of one buffer like the other descriptor buffers
+    AudioBuffer *buffer;
+
+    //! \brief The size of the decoded data in the buffer and in the mixer format, in bytes
+    uint32_t data_size;
+
+    //! \brief The decoded data in the software mixer format, for short sounds
+    MixerSoundPtr mixer_sound;
+
+    //! \brief The number of audio descriptors using the buffer
+    uint32_t reference_count;
+};
 
 
 //! \brief A container class for an element of the LRU audio cache managed by the AudioEngine class
@@ -103,6 +137,42 @@ public:
     //! \brief Updates various parts of the audio state, such as streaming buffers
     void Update();
 
+    /** \brief Tells whether the engine renders into memory instead of using an audio device
+    ***
+    *** Headless audio uses an OpenAL loopback device when the ALC_SOFT_loopback extension
+    *** is available, or else the OpenAL Soft null output device.
+    **/
+    bool IsHeadless() const {
+        return _headless;
+    }
+
+    //! \brief Tells whether the samples are rendered on demand, through RenderSamples()
+    bool IsLoopback() const {
+        return _loopback;
+    }
+
+    /** \brief Renders audio samples of the loopback device
+    *** \param buffer Receives the interleaved stereo 16 bits samples, at HEADLESS_AUDIO_FREQUENCY
+    *** \param number_frames The number of samples to render, for each channel
+    *** \return False if the engine isn't using a loopback device
+    ***
+    *** The audio only plays as fast as it is rendered, so this lets the audio time go by
+    *** as fast, or as slowly, as wanted.
+    **/
+    bool RenderSamples(int16_t *buffer, uint32_t number_frames);
+
+    /** \brief Renders and discards the samples of the given amount of time, when headless
+    *** \param time The time to render, in milliseconds
+    ***
+    *** Called every frame by the main loop, so that the headless audio keeps up with the game time.
+    **/
+    void UpdateHeadless(uint32_t time);
+
+    //! \brief Returns the number of times a stream source ran out of buffers before they were refilled
+    uint32_t GetNumberStreamUnderruns() const {
+        return _stream_thread.GetNumberUnderruns();
+    }
+
     float GetSoundVolume() const {
         return _sound_volume;
     }
@@ -288,6 +358,66 @@ public:
     **/
     void RemoveGameModeOwner(vt_mode_manager::GameMode *gm);
 
+    /** \brief Prepares audio files on a background thread, before they get loaded
+    *** \param music_filenames The music files, which will be streamed
+    *** \param sound_filenames The sound files, which will be decoded
+    ***
+    *** Loading those files afterwards only takes the prepared data over, e.g. when a new map
+    *** is loaded after the map transition fade. Files already in the cache aren't prepared again.
+    *** The files prepared by a previous call and never loaded are discarded.
+    **/
+    void PreloadAudio(const std::vector<std::string> &music_filenames,
+                      const std::vector<std::string> &sound_filenames);
+
+    //! \brief Discards the prepared audio files which weren't loaded.
+    void ClearPreloadedAudio() {
+        _preloader.Clear();
+    }
+
+    /** \brief Sets the memory budget of the decoded audio kept in OpenAL buffers
+    *** \param limit The budget in bytes
+    ***
+    *** When the budget is exceeded, the least recently used cached audio which isn't owned
+    *** by any game mode and isn't playing is evicted until the decoded audio fits again.
+    **/
+    void SetAudioCacheMemoryLimit(uint32_t limit);
+
+    uint32_t GetAudioCacheMemoryLimit() const {
+        return _audio_cache_memory_limit;
+    }
+
+    //! \brief Returns the memory used by the decoded audio kept in OpenAL buffers, in bytes
+    uint32_t GetAudioCacheMemorySize() const {
+        return _shared_buffers_memory;
+    }
+
+    /** \brief Sets whether the decoded short sounds are cached on disk
+    ***
+    *** When enabled, the decoded data of short Ogg sounds is saved in the user data folder,
+    *** and loaded from there the next times instead of being decoded again.
+    **/
+    void SetPcmCacheEnabled(bool enabled) {
+        _pcm_cache_enabled = enabled;
+    }
+
+    bool IsPcmCacheEnabled() const {
+        return _pcm_cache_enabled;
+    }
+
+    /** \brief Sets whether the short one-shot sounds are mixed in software
+    ***
+    *** When enabled, the short sounds which aren't looping nor positioned are mixed
+    *** together and streamed to a single source, instead of each using its own source.
+    *** This only applies to the sounds loaded afterwards.
+    **/
+    void SetSoundMixerEnabled(bool enabled) {
+        _sound_mixer_enabled = enabled;
+    }
+
+    bool IsSoundMixerEnabled() const {
+        return _sound_mixer_enabled;
+    }
+
     /** \name Error Detection and Processing methods
     *** Code external to the audio engine should not need to make use of the following methods,
     *** as error detection is routinely done by the engine itself.
@@ -346,6 +476,18 @@ private:
     //! \brief The current OpenAL context that the audio engine is using
     ALCcontext *_context;
 
+    //! \brief Whether the device renders into memory
+    bool _headless;
+
+    //! \brief Whether the headless device is a loopback device, whose samples are rendered on demand
+    bool _loopback;
+
+    //! \brief The headless rendering time which didn't make a whole sample yet, in milliseconds x frequency
+    uint32_t _headless_time_remainder;
+
+    //! \brief The buffer receiving the discarded headless samples
+    std::vector<int16_t> _headless_buffer;
+
     //! \brief Holds the most recently fetched OpenAL error code
     ALenum _al_error_code;
 
@@ -368,6 +510,27 @@ private:
     //! \brief Contains all available audio sources
     std::vector<private_audio::AudioSource *> _audio_sources;
 
+    //! \brief The sources without owner, used as a stack
+    std::vector<private_audio::AudioSource *> _free_sources;
+
+    //! \brief The audio playing virtually, without a source
+    std::vector<AudioDescriptor *> _virtual_audio;
+
+    //! \brief The number of sources taken from other audio, shown by DEBUG_PrintInfo()
+    uint32_t _stolen_sources;
+
+    //! \brief The thread decoding and queuing the buffers of the streamed audio
+    private_audio::AudioStreamThread _stream_thread;
+
+    //! \brief Prepares the audio files about to be loaded
+    private_audio::AudioPreloader _preloader;
+
+    //! \brief Mixes the short sounds in software, on the streaming thread
+    private_audio::AudioMixer _mixer;
+
+    //! \brief The audio played by the mixer, indexed by mixer voice
+    std::map<uint32_t, AudioDescriptor *> _mixed_audio;
+
     /** \brief Lists of pointers to all audio descriptor objects which have been created by the user
     *** These lists are kept so that when the global sound or music volume levels are changed, all
     *** sound and music objects will also have their volumes updated.
@@ -391,10 +554,69 @@ private:
     **/
     std::map<std::string, private_audio::AudioCacheElement> _audio_cache;
 
+    //! \brief The decoded buffers of the statically loaded files, indexed by filename
+    std::map<std::string, private_audio::SharedAudioBuffer> _shared_buffers;
+
+    //! \brief The total size of the data held by the shared buffers, in bytes
+    uint32_t _shared_buffers_memory;
+
+    //! \brief The memory budget of the shared buffers, in bytes
+    uint32_t _audio_cache_memory_limit;
+
+    //! \brief Whether the decoded short sounds are cached on disk
+    bool _pcm_cache_enabled;
+
+    //! \brief Whether the short one-shot sounds are mixed in software
+    bool _sound_mixer_enabled;
+
+    //! \brief Audio cache statistics, shown by DEBUG_PrintInfo()
+    //@{
+    uint32_t _shared_buffer_hits;
+    uint32_t _shared_buffer_misses;
+    uint32_t _audio_cache_evictions;
+    //@}
+
     /** \brief Acquires an available audio source that may be used
+    *** \param requester The audio requesting the source
     *** \return A pointer to the available source, or nullptr if no available source could be found
+    ***
+    *** When no source is free, a source is taken from stopped audio or from the least important
+    *** playing audio, as long as it is less important than the requester. The latter keeps on
+    *** playing virtually.
+    **/
+    private_audio::AudioSource *_AcquireAudioSource(AudioDescriptor *requester);
+
+    //! \brief Resets a source and makes it available again.
+    void _ReleaseAudioSource(private_audio::AudioSource *source);
+
+    /** \brief Gets the shared buffer already holding the decoded data of a file
+    *** \param mixer_sound Set to the decoded data in the mixer format, if any
+    *** \return The buffer, now referenced once more, or nullptr if the file isn't decoded yet
+    **/
+    private_audio::AudioBuffer *_RetainSharedBuffer(const std::string &filename, private_audio::MixerSoundPtr &mixer_sound);
+
+    /** \brief Shares a newly filled buffer holding the decoded data of a file
+    *** \param data_size The size of the buffer data, in bytes
+    *** \param mixer_sound The decoded data in the mixer format, if any
+    **/
+    void _AddSharedBuffer(const std::string &filename, private_audio::AudioBuffer *buffer, uint32_t data_size,
+                          const private_audio::MixerSoundPtr &mixer_sound);
+
+    //! \brief Releases a reference of the shared buffer of a file, deleting the buffer when unused
+    void _ReleaseSharedBuffer(const std::string &filename);
+
+    /** \brief Evicts the least recently used cached audio until the memory budget is honoured
+    *** \param kept_filename A filename which must not be evicted, as it is about to be used.
+    **/
+    void _EnforceAudioCacheMemoryLimit(const std::string &kept_filename);
+
+    //! \brief Opens the available audio device of the highest OpenAL version, and its context
+    bool _OpenBestDevice();
+
+    /** \brief Opens a loopback device, or the null output device when loopback isn't supported
+    *** \return False if no headless device could be opened
     **/
-    private_audio::AudioSource *_AcquireAudioSource();
+    bool _OpenHeadlessDevice();
 
     /** \brief A helper function to LoadSound and LoadMusic that takes care of the messy details of cache managment
     *** \param filename The filename of the audio to load
@@ -0,0 +1,201 @@
+////////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2018 by Bertram (Valyria Tear)
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+////////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file   audio_benchmark.cpp
+*** \author Yohann Ferreira, yohann ferreira orange fr
+*** \brief  Implementation of the headless audio engine benchmark
+*** ***************************************************************************/
+
+#include "audio_benchmark.h"
+
+#include "audio.h"
+
+#include <chrono>
+#include <ctime>
+#include <iostream>
+#include <thread>
+
+namespace vt_audio
+{
+
+namespace private_audio
+{
+
+//! \brief The audio time each music is played for, in seconds
+const float AUDIO_BENCHMARK_MUSIC_TIME = 30.0f;
+
+//! \brief The audio time between two sounds played over the music, in seconds
+const float AUDIO_BENCHMARK_SOUND_INTERVAL = 0.25f;
+
+//! \brief The number of samples rendered at once, for each channel
+const uint32_t AUDIO_BENCHMARK_CHUNK_FRAMES = 1024;
+
+typedef std::chrono::steady_clock BenchmarkClock;
+
+//! \brief Returns the seconds elapsed since the given time point.
+static double _GetSecondsSince(const BenchmarkClock::time_point &start)
+{
+    return std::chrono::duration<double>(BenchmarkClock::now() - start).count();
+}
+
+//! \brief Returns the CPU time used by the process so far, every thread included, in seconds.
+static double _GetCPUSeconds()
+{
+    return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+}
+
+/** \brief Fully decodes each file once, and prints the decoding throughput
+*** This doesn't use the decoded sound cache, so that the actual decoding is measured.
+**/
+static void _BenchmarkDecoding(const std::vector<std::string> &filenames)
+{
+    std::vector<uint8_t> data(AUDIO_BENCHMARK_CHUNK_FRAMES * 4);
+    double audio_seconds = 0.0;
+    double decoded_bytes = 0.0;
+    uint32_t number_files = 0;
+
+    BenchmarkClock::time_point start = BenchmarkClock::now();
+    for(uint32_t i = 0; i < filenames.size(); ++i) {
+        AudioInput *input = CreateAudioInput(filenames[i]);
+        if(input == nullptr)
+            continue;
+        if(!input->Initialize()) {
+            std::cerr << "Couldn't open audio file: " << filenames[i] << std::endl;
+            delete input;
+            continue;
+        }
+
+        data.resize(AUDIO_BENCHMARK_CHUNK_FRAMES * input->GetSampleSize());
+        bool end = false;
+        while(!end) {
+            if(input->Read(&data[0], AUDIO_BENCHMARK_CHUNK_FRAMES, end) == 0)
+                break;
+        }
+
+        audio_seconds += input->GetPlayTime();
+        decoded_bytes += input->GetDataSize();
+        ++number_files;
+        delete input;
+    }
+    double wall_seconds = _GetSecondsSince(start);
+
+    std::cout << "Decoded files:               " << number_files << std::endl;
+    std::cout << "Decoded audio:               " << audio_seconds << " s in " << wall_seconds << " s" << std::endl;
+    if(wall_seconds > 0.0) {
+        std::cout << "Decoding throughput:         " << audio_seconds / wall_seconds << "x real-time, "
+                  << decoded_bytes / wall_seconds / (1024.0 * 1024.0) << " MiB/s" << std::endl;
+    }
+}
+
+/** \brief Renders the audio playing for AUDIO_BENCHMARK_MUSIC_TIME, playing the sounds in turn meanwhile
+*** \param sounds_played Incremented for each sound played
+*** \param audio_seconds Incremented by the audio time rendered
+**/
+static void _PlayBenchmarkSounds(const std::vector<SoundDescriptor *> &sounds, float speed,
+                                 const BenchmarkClock::time_point &start,
+                                 uint32_t &sounds_played, double &audio_seconds)
+{
+    std::vector<int16_t> samples(AUDIO_BENCHMARK_CHUNK_FRAMES * 2);
+    float play_time = 0.0f;
+    float next_sound_time = 0.0f;
+    while(play_time < AUDIO_BENCHMARK_MUSIC_TIME) {
+        if(!sounds.empty() && play_time >= next_sound_time) {
+            sounds[sounds_played % sounds.size()]->Play();
+            ++sounds_played;
+            next_sound_time += AUDIO_BENCHMARK_SOUND_INTERVAL;
+        }
+
+        AudioManager->Update();
+        AudioManager->RenderSamples(&samples[0], AUDIO_BENCHMARK_CHUNK_FRAMES);
+        play_time += static_cast<float>(AUDIO_BENCHMARK_CHUNK_FRAMES) / HEADLESS_AUDIO_FREQUENCY;
+        audio_seconds += static_cast<double>(AUDIO_BENCHMARK_CHUNK_FRAMES) / HEADLESS_AUDIO_FREQUENCY;
+
+        // Don't go faster than the requested speed, as the streaming thread works in real-time.
+        double ahead = audio_seconds / speed - _GetSecondsSince(start);
+        if(ahead > 0.0)
+            std::this_thread::sleep_for(std::chrono::duration<double>(ahead));
+    }
+}
+
+} // namespace private_audio
+
+using namespace private_audio;
+
+bool RunAudioBenchmark(const std::vector<std::string> &music_filenames,
+                       const std::vector<std::string> &sound_filenames,
+                       float speed)
+{
+    if(AudioManager == nullptr || !AudioManager->IsLoopback()) {
+        std::cerr << "The audio benchmark needs an OpenAL loopback device (ALC_SOFT_loopback)" << std::endl;
+        return false;
+    }
+    if(speed <= 0.0f)
+        speed = DEFAULT_AUDIO_BENCHMARK_SPEED;
+
+    std::cout << std::endl << "===== Audio decoding" << std::endl;
+    std::vector<std::string> filenames = music_filenames;
+    filenames.insert(filenames.end(), sound_filenames.begin(), sound_filenames.end());
+    _BenchmarkDecoding(filenames);
+
+    // Load every sound statically, as the game modes do.
+    std::vector<SoundDescriptor *> sounds;
+    for(uint32_t i = 0; i < sound_filenames.size(); ++i) {
+        SoundDescriptor *sound = new SoundDescriptor();
+        if(sound->LoadAudio(sound_filenames[i]))
+            sounds.push_back(sound);
+        else
+            delete sound;
+    }
+
+    std::cout << std::endl << "===== Audio playback at " << speed << "x real-time" << std::endl;
+    const uint32_t underruns_start = AudioManager->GetNumberStreamUnderruns();
+    const double cpu_start = _GetCPUSeconds();
+    double audio_seconds = 0.0;
+    uint32_t sounds_played = 0;
+    BenchmarkClock::time_point start = BenchmarkClock::now();
+
+    for(uint32_t i = 0; i < music_filenames.size(); ++i) {
+        // The music is streamed without the music descriptor fading, which needs the game timers.
+        SoundDescriptor music;
+        music.SetPriority(AUDIO_PRIORITY_HIGH);
+        music.SetLooping(true);
+        if(!music.LoadAudio(music_filenames[i], AUDIO_LOAD_STREAM_FILE) || !music.Play()) {
+            std::cerr << "Couldn't play music file: " << music_filenames[i] << std::endl;
+            continue;
+        }
+
+        _PlayBenchmarkSounds(sounds, speed, start, sounds_played, audio_seconds);
+
+        music.Stop();
+        music.FreeAudio();
+    }
+
+    // Without music, the sounds are played over silence.
+    if(music_filenames.empty() && !sounds.empty())
+        _PlayBenchmarkSounds(sounds, speed, start, sounds_played, audio_seconds);
+
+    const double wall_seconds = _GetSecondsSince(start);
+    const double cpu_seconds = _GetCPUSeconds() - cpu_start;
+
+    for(uint32_t i = 0; i < sounds.size(); ++i)
+        delete sounds[i];
+
+    std::cout << "Played audio:                " << audio_seconds << " s in " << wall_seconds << " s" << std::endl;
+    std::cout << "Sounds played:               " << sounds_played << std::endl;
+    std::cout << "Stream underruns:            " << AudioManager->GetNumberStreamUnderruns() - underruns_start << std::endl;
+    if(audio_seconds > 0.0) {
+        std::cout << "CPU time per audio second:   " << cpu_seconds * 1000.0 / audio_seconds << " ms" << std::endl;
+    }
+    std::cout << std::endl;
+
+    return true;
+}
+
+} // namespace vt_audio
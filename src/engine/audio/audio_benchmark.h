@@ -0,0 +1,47 @@
+////////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2018 by Bertram (Valyria Tear)
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+////////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file   audio_benchmark.h
+*** \author Yohann Ferreira, yohann ferreira orange fr
+*** \brief  Header file for the headless audio engine benchmark
+***
+*** The benchmark measures the decoding throughput of a set of audio files, then
+*** plays them on the headless loopback device faster than real-time to measure
+*** the stream underruns and the CPU time spent per second of audio.
+*** ***************************************************************************/
+
+#ifndef __AUDIO_BENCHMARK_HEADER__
+#define __AUDIO_BENCHMARK_HEADER__
+
+#include <string>
+#include <vector>
+
+namespace vt_audio
+{
+
+//! \brief How many times faster than real-time the benchmark plays the audio, by default.
+const float DEFAULT_AUDIO_BENCHMARK_SPEED = 8.0f;
+
+/** \brief Runs the audio benchmark, and prints its results on the standard output
+*** \param music_filenames The music files, each streamed in turn
+*** \param sound_filenames The sound files, loaded statically and played regularly over the music,
+*** or over silence when no music is given
+*** \param speed How many times faster than real-time the audio is played
+*** \return False if the audio engine doesn't render to a loopback device
+***
+*** \note The audio engine must have been initialized with AUDIO_HEADLESS set.
+**/
+bool RunAudioBenchmark(const std::vector<std::string> &music_filenames,
+                       const std::vector<std::string> &sound_filenames,
+                       float speed = DEFAULT_AUDIO_BENCHMARK_SPEED);
+
+} // namespace vt_audio
+
+#endif // __AUDIO_BENCHMARK_HEADER__
@@ -25,12 +25,14 @@
 #include "audio_descriptor.h"
 
 #include "audio.h"
+#include "audio_pcm_cache.h"
 #include "engine/system.h"
 
 #include "utils/utils_common.h"
 #include "utils/utils_strings.h"
 
 #include <cstring>
+#include <cmath>
 
 using namespace vt_audio::private_audio;
 
@@ -119,7 +121,16 @@ AudioDescriptor::AudioDescriptor() :
     _volume(1.0f),
     _fade_effect_time(0.0f),
     _original_volume(0.0f),
-    _stream_buffer_size(0)
+    _stream_buffer_size(0),
+    _priority(AUDIO_PRIORITY_NORMAL),
+    _virtual(false),
+    _virtual_sample(0),
+    _virtual_time(0),
+    _stream_attached(false),
+    _stream_position(0),
+    _stream_play_id(0),
+    _stream_ended_id(0),
+    _mixer_voice(0)
 {
     _position[0] = 0.0f;
     _position[1] = 0.0f;
@@ -144,7 +155,16 @@ AudioDescriptor::AudioDescriptor(const AudioDescriptor &copy) :
     _volume(copy._volume),
     _fade_effect_time(copy._fade_effect_time),
     _original_volume(copy._original_volume),
-    _stream_buffer_size(0)
+    _stream_buffer_size(0),
+    _priority(copy._priority),
+    _virtual(false),
+    _virtual_sample(0),
+    _virtual_time(0),
+    _stream_attached(false),
+    _stream_position(0),
+    _stream_play_id(0),
+    _stream_ended_id(0),
+    _mixer_voice(0)
 {
     _position[0] = 0.0f;
     _position[1] = 0.0f;
@@ -170,28 +190,27 @@ bool AudioDescriptor::LoadAudio(const std::string &filename, AUDIO_LOAD load_typ
     // Clean out any audio resources being used before trying to set new ones
     FreeAudio();
 
-    // Load the input file for the audio
-    if(filename.size() <= 3) {  // Name of file is at least 3 letters (so the extension is in there)
-        IF_PRINT_WARNING(AUDIO_DEBUG) << "file name argument is too short: " << filename << std::endl;
-        return false;
-    }
-    // Convert the file extension to uppercase and use it to create the proper input type
-    std::string file_extension = filename.substr(filename.size() - 3, 3);
-    file_extension = vt_utils::Upcase(file_extension);
+    // Use the input prepared in the background, when the file was preloaded
+    std::vector<uint8_t> preloaded_data;
+    _input = AudioManager->_preloader.TakeInput(filename, load_type == AUDIO_LOAD_STATIC, preloaded_data);
 
-    // Based on the extension of the file, load properly one
-    if(file_extension.compare("WAV") == 0) {
-        _input = new WavFile(filename);
-    } else if(file_extension.compare("OGG") == 0) {
-        _input = new OggFile(filename);
-    } else {
-        IF_PRINT_WARNING(AUDIO_DEBUG) << "failed due to unsupported input file extension: " << file_extension << std::endl;
-        return false;
+    // Otherwise, use the previously decoded data of short sounds when still valid
+    bool pcm_cached = false;
+    if(_input == nullptr && load_type == AUDIO_LOAD_STATIC && AudioManager->IsPcmCacheEnabled()) {
+        _input = OpenPcmCacheFile(filename);
+        pcm_cached = (_input != nullptr);
     }
 
-    if(_input->Initialize() == false) {
-        IF_PRINT_WARNING(AUDIO_DEBUG) << "failed to load and initialize audio file: " << filename << std::endl;
-        return false;
+    // Or load the input file for the audio
+    if(_input == nullptr) {
+        _input = CreateAudioInput(filename);
+        if(_input == nullptr)
+            return false;
+
+        if(_input->Initialize() == false) {
+            IF_PRINT_WARNING(AUDIO_DEBUG) << "failed to load and initialize audio file: " << filename << std::endl;
+            return false;
+        }
     }
 
     // Retreive audio data properties from the newly initialized input
@@ -211,28 +230,49 @@ bool AudioDescriptor::LoadAudio(const std::string &filename, AUDIO_LOAD load_typ
 
     // Load the audio data depending upon the load type requested
     if(load_type == AUDIO_LOAD_STATIC) {
-        // For static sounds just 1 buffer is needed. We create it as an array here, so that
-        // later we can delete it with a call of delete[], similar to the streaming cases
-        _buffer = new AudioBuffer[1];
-
-        // Create space in memory for the audio data to be read and passed to the OpenAL buffer
-        _data = new uint8_t[_input->GetDataSize()];
-        bool all_data_read = false;
-        if(_input->Read(_data, _input->GetTotalNumberSamples(), all_data_read) != _input->GetTotalNumberSamples()) {
-            IF_PRINT_WARNING(AUDIO_DEBUG) << "failed to read entire audio data stream for file: " << filename << std::endl;
-            return false;
-        }
-
-        // Pass the buffer data to the OpenAL buffer
-        _buffer->FillBuffer(_data, _format, _input->GetDataSize(), _input->GetSamplesPerSecond());
-        delete[] _data;
-        _data = nullptr;
+        // Reuse the decoded data when the file is already loaded by another descriptor.
+        _buffer = AudioManager->_RetainSharedBuffer(filename, _mixer_sound);
+        if(_buffer == nullptr) {
+            // Short sounds are also kept in the mixer format, to be mixed in software when played.
+            bool mixable = IsSound() && AudioManager->IsSoundMixerEnabled()
+                           && _input->GetDataSize() <= MIXER_MAX_SOUND_SIZE;
+
+            // For static sounds just 1 buffer is needed. We create it as an array here, so that
+            // later we can delete it with a call of delete[], similar to the streaming cases
+            AudioBuffer *buffer = new AudioBuffer[1];
+
+            if(!preloaded_data.empty()) {
+                // The data was already decoded in the background
+                buffer->FillBuffer(&preloaded_data[0], _format, _input->GetDataSize(), _input->GetSamplesPerSecond());
+                if(mixable)
+                    _mixer_sound = MixerSound::Create(_input, &preloaded_data[0]);
+            } else {
+                // Create space in memory for the audio data to be read and passed to the OpenAL buffer
+                _data = new uint8_t[_input->GetDataSize()];
+                bool all_data_read = false;
+                if(_input->Read(_data, _input->GetTotalNumberSamples(), all_data_read) != _input->GetTotalNumberSamples()) {
+                    IF_PRINT_WARNING(AUDIO_DEBUG) << "failed to read entire audio data stream for file: " << filename << std::endl;
+                    delete[] buffer;
+                    return false;
+                }
+
+                // Pass the buffer data to the OpenAL buffer
+                buffer->FillBuffer(_data, _format, _input->GetDataSize(), _input->GetSamplesPerSecond());
+                if(mixable)
+                    _mixer_sound = MixerSound::Create(_input, _data);
+
+                // Spare the decoding next time
+                if(!pcm_cached && AudioManager->IsPcmCacheEnabled())
+                    SavePcmCacheFile(_input, _data);
+                delete[] _data;
+                _data = nullptr;
+            }
 
-        // Attempt to acquire a source for the new audio to use
-        _AcquireSource();
-        if(_source == nullptr) {
-            IF_PRINT_WARNING(AUDIO_DEBUG) << "could not acquire audio source for new audio file: " << filename << std::endl;
+            AudioManager->_AddSharedBuffer(filename, buffer, _input->GetDataSize(), _mixer_sound);
+            _buffer = buffer;
         }
+
+        // Static audio only gets a source when played.
     } // if (load_type == AUDIO_LOAD_STATIC)
 
     // Stream the audio from the file data
@@ -243,11 +283,7 @@ bool AudioDescriptor::LoadAudio(const std::string &filename, AUDIO_LOAD load_typ
 
         _data = new uint8_t[_stream_buffer_size * _input->GetSampleSize()];
 
-        // Attempt to acquire a source for the new audio to use
-        _AcquireSource();
-        if(_source == nullptr) {
-            IF_PRINT_WARNING(AUDIO_DEBUG) << "could not acquire audio source for new audio file: " << filename << std::endl;
-        }
+        // The stream is handed to the streaming thread once played.
     } // else if (load_type == AUDIO_LOAD_STREAM_FILE)
 
     // Allocate memory for the audio data to remain in and stream it from that location
@@ -263,11 +299,7 @@ bool AudioDescriptor::LoadAudio(const std::string &filename, AUDIO_LOAD load_typ
         _input = new AudioMemory(temp_input);
         delete temp_input;
 
-        // Attempt to acquire a source for the new audio to use
-        _AcquireSource();
-        if(_source == nullptr) {
-            IF_PRINT_WARNING(AUDIO_DEBUG) << "could not acquire audio source for new audio file: " << filename << std::endl;
-        }
+        // The stream is handed to the streaming thread once played.
     } // else if (load_type == AUDIO_LOAD_STREAM_MEMORY) {
 
     else {
@@ -287,20 +319,23 @@ void AudioDescriptor::FreeAudio()
     // First, remove any effects.
     RemoveEffects();
 
-    if(_source != nullptr)
+    if(_source != nullptr || _mixer_voice != 0)
         Stop();
+    _StopVirtual();
+    _mixer_sound.reset();
 
     _state = AUDIO_STATE_UNLOADED;
     _offset = 0;
 
-    // If the source is still attached to a sound, reset to the default parameters the source
-    if(_source != nullptr) {
-        _source->Reset();
-        _source = nullptr;
-    }
+    // If the source is still attached to a sound, give it back with its default parameters
+    _ReleaseSource();
 
     if(_buffer != nullptr) {
-        delete[] _buffer;
+        // The static buffers are shared between the descriptors of a same file.
+        if(_stream == nullptr && _input != nullptr)
+            AudioManager->_ReleaseSharedBuffer(_input->GetFilename());
+        else
+            delete[] _buffer;
         _buffer = nullptr;
     }
 
@@ -328,18 +363,62 @@ bool AudioDescriptor::Play()
     if(_state == AUDIO_STATE_PLAYING)
         return true;
 
+    // Resumes the timeline of a paused virtual audio.
+    if(_virtual) {
+        if(_state == AUDIO_STATE_PAUSED)
+            _virtual_time = SDL_GetTicks();
+        _state = AUDIO_STATE_PLAYING;
+        return true;
+    }
+
+    // Resumes a paused mixed sound.
+    if(_mixer_voice != 0) {
+        AudioManager->_mixer.Resume(_mixer_voice);
+        _state = AUDIO_STATE_PLAYING;
+        return true;
+    }
+
     if(!_source) {
+        if(_buffer == nullptr) {
+            IF_PRINT_WARNING(AUDIO_DEBUG) << "no audio data was loaded" << std::endl;
+            return false;
+        }
+
+        // Static audio starts from the position seeked while stopped, or else from the beginning.
+        uint32_t start_sample = _offset;
+
+        // Inaudible sounds don't need to hold a source.
+        if(IsSound() && _GetAudibility() < AUDIBILITY_THRESHOLD) {
+            _StartVirtual(start_sample);
+            return true;
+        }
+
+        // Short one-shot sounds are mixed in software, sparing the sources.
+        if(start_sample == 0 && _CanBeMixed()) {
+            _mixer_voice = AudioManager->_mixer.Play(_mixer_sound, _volume * AudioManager->GetSoundVolume());
+            AudioManager->_mixed_audio[_mixer_voice] = this;
+            _state = AUDIO_STATE_PLAYING;
+            return true;
+        }
+
         _AcquireSource();
         if(!_source) {
-            IF_PRINT_WARNING(AUDIO_DEBUG) << "did not have access to valid AudioSource" << std::endl;
-            return false;
+            // Every source is used by more important audio, so wait for one to be freed.
+            IF_PRINT_WARNING(AUDIO_DEBUG) << "no source available, playing the audio virtually: " << GetFilename() << std::endl;
+            _StartVirtual(start_sample);
+            return true;
         }
-        _SetSourceProperties();
+
+        if(_stream == nullptr && start_sample > 0)
+            alSourcei(_source->source, AL_SAMPLE_OFFSET, start_sample);
     }
 
-    if(_stream && _stream->GetEndOfStream()) {
-        _stream->Seek(_offset);
-        _PrepareStreamingBuffers();
+    // Streamed audio is played by the streaming thread,
+    // which also restarts it from the last seeked position if it ended.
+    if(_IsStreamAttached()) {
+        _SendStreamCommand(STREAM_PLAY, ++_stream_play_id, _offset);
+        _state = AUDIO_STATE_PLAYING;
+        return true;
     }
 
     // Temp: Checks if there is already an AL error in the buffer. If it is, print error and clear buffer.
@@ -360,11 +439,33 @@ void AudioDescriptor::Stop()
     if(_state == AUDIO_STATE_STOPPED || _state == AUDIO_STATE_UNLOADED)
         return;
 
+    // Like a stopped source, static audio plays again from the beginning.
+    if(_stream == nullptr)
+        _offset = 0;
+
+    if(_virtual) {
+        _StopVirtual();
+        _state = AUDIO_STATE_STOPPED;
+        return;
+    }
+
+    if(_mixer_voice != 0) {
+        _StopMixerVoice();
+        _state = AUDIO_STATE_STOPPED;
+        return;
+    }
+
     if(!_source) {
         IF_PRINT_WARNING(AUDIO_DEBUG) << "did not have access to valid AudioSource" << std::endl;
         return;
     }
 
+    if(_IsStreamAttached()) {
+        _SendStreamCommand(STREAM_STOP);
+        _state = AUDIO_STATE_STOPPED;
+        return;
+    }
+
     // Temp: Checks if there is already an AL error in the buffer. If it is, print error and clear buffer.
     if(AudioManager->CheckALError()) {
         IF_PRINT_WARNING(AUDIO_DEBUG) << "audio error occured some time before stopping source: " << AudioManager->CreateALErrorString() << std::endl;
@@ -375,18 +476,39 @@ void AudioDescriptor::Stop()
         IF_PRINT_WARNING(AUDIO_DEBUG) << "stopping the source failed: " << AudioManager->CreateALErrorString() << std::endl;
     }
     _state = AUDIO_STATE_STOPPED;
+
+    // Static audio gets a source back whenever played again.
+    _ReleaseSource();
 }
 
 void AudioDescriptor::Pause()
 {
-    if(_state == AUDIO_STATE_PAUSED || _state == AUDIO_STATE_UNLOADED)
+    if(_state == AUDIO_STATE_PAUSED || _state == AUDIO_STATE_UNLOADED || _state == AUDIO_STATE_STOPPED)
+        return;
+
+    if(_virtual) {
+        _virtual_sample = _GetVirtualSample();
+        _state = AUDIO_STATE_PAUSED;
+        return;
+    }
+
+    if(_mixer_voice != 0) {
+        AudioManager->_mixer.Pause(_mixer_voice);
+        _state = AUDIO_STATE_PAUSED;
         return;
+    }
 
     if(_source == nullptr) {
         IF_PRINT_WARNING(AUDIO_DEBUG) << "did not have access to valid AudioSource" << std::endl;
         return;
     }
 
+    if(_IsStreamAttached()) {
+        _SendStreamCommand(STREAM_PAUSE);
+        _state = AUDIO_STATE_PAUSED;
+        return;
+    }
+
     alSourcePause(_source->source);
     if(AudioManager->CheckALError()) {
         IF_PRINT_WARNING(AUDIO_DEBUG) << "pausing the source failed: " << AudioManager->CreateALErrorString() << std::endl;
@@ -404,8 +526,24 @@ void AudioDescriptor::Resume()
 
 void AudioDescriptor::Rewind()
 {
-    if(_source == nullptr) {
-        IF_PRINT_WARNING(AUDIO_DEBUG) << "did not have access to valid AudioSource" << std::endl;
+    if(_virtual) {
+        _virtual_sample = 0;
+        _virtual_time = SDL_GetTicks();
+        return;
+    }
+
+    if(_mixer_voice != 0) {
+        AudioManager->_mixer.Seek(_mixer_voice, 0);
+        return;
+    }
+
+    // Audio without a source will start from the beginning anyway.
+    if(_source == nullptr)
+        return;
+
+    // Streamed audio buffers only hold a part of the audio, so rewind the stream itself.
+    if(_IsStreamAttached()) {
+        _SendStreamCommand(STREAM_SEEK, 0, 0);
         return;
     }
 
@@ -421,7 +559,9 @@ void AudioDescriptor::SetLooping(bool loop)
         return;
 
     _looping = loop;
-    if(_stream != nullptr) {
+    if(_IsStreamAttached()) {
+        _SendStreamCommand(STREAM_SET_LOOPING, _looping ? 1 : 0);
+    } else if(_stream != nullptr) {
         _stream->SetLooping(_looping);
     } else if(_source != nullptr) {
         if(_looping)
@@ -437,7 +577,10 @@ void AudioDescriptor::SetLoopStart(uint32_t loop_start)
         IF_PRINT_WARNING(AUDIO_DEBUG) << "the audio data was not loaded with streaming properties, this operation is not permitted" << std::endl;
         return;
     }
-    _stream->SetLoopStart(loop_start);
+    if(_IsStreamAttached())
+        _SendStreamCommand(STREAM_SET_LOOP_START, loop_start);
+    else
+        _stream->SetLoopStart(loop_start);
 }
 
 void AudioDescriptor::SetLoopEnd(uint32_t loop_end)
@@ -446,7 +589,10 @@ void AudioDescriptor::SetLoopEnd(uint32_t loop_end)
         IF_PRINT_WARNING(AUDIO_DEBUG) << "the audio data was not loaded with streaming properties, this operation is not permitted" << std::endl;
         return;
     }
-    _stream->SetLoopEnd(loop_end);
+    if(_IsStreamAttached())
+        _SendStreamCommand(STREAM_SET_LOOP_END, loop_end);
+    else
+        _stream->SetLoopEnd(loop_end);
 }
 
 void AudioDescriptor::SeekSample(uint32_t sample)
@@ -460,9 +606,15 @@ void AudioDescriptor::SeekSample(uint32_t sample)
 
     _offset = sample;
 
-    if(_stream) {
+    if(_virtual) {
+        _virtual_sample = _offset;
+        _virtual_time = SDL_GetTicks();
+    } else if(_mixer_voice != 0) {
+        AudioManager->_mixer.Seek(_mixer_voice, _offset);
+    } else if(_IsStreamAttached()) {
+        _SendStreamCommand(STREAM_SEEK, 0, _offset);
+    } else if(_stream) {
         _stream->Seek(_offset);
-        _PrepareStreamingBuffers();
     } else if(_source != nullptr) {
         alSourcei(_source->source, AL_SAMPLE_OFFSET, _offset);
         if(AudioManager->CheckALError()) {
@@ -473,7 +625,15 @@ void AudioDescriptor::SeekSample(uint32_t sample)
 
 uint32_t AudioDescriptor::GetCurrentSampleNumber() const
 {
-    if(_stream) {
+    if(_virtual) {
+        uint32_t total_samples = _input->GetTotalNumberSamples();
+        uint32_t sample = _GetVirtualSample();
+        if(sample >= total_samples)
+            return _looping && total_samples > 0 ? sample % total_samples : total_samples;
+        return sample;
+    } else if(_IsStreamAttached()) {
+        return _stream_position.load();
+    } else if(_stream) {
         return _stream->GetCurrentSamplePosition();
     } else if(_source != nullptr) {
         int32_t sample = 0;
@@ -505,11 +665,17 @@ void AudioDescriptor::SeekSecond(float second)
     }
 
     _offset = pos;
-    if(_stream) {
+    if(_virtual) {
+        _virtual_sample = _offset;
+        _virtual_time = SDL_GetTicks();
+    } else if(_mixer_voice != 0) {
+        AudioManager->_mixer.Seek(_mixer_voice, _offset);
+    } else if(_IsStreamAttached()) {
+        _SendStreamCommand(STREAM_SEEK, 0, _offset);
+    } else if(_stream) {
         _stream->Seek(_offset);
-        _PrepareStreamingBuffers();
     } else if(_source != nullptr) {
-        alSourcei(_source->source, AL_SEC_OFFSET, _offset);
+        alSourcei(_source->source, AL_SAMPLE_OFFSET, _offset);
         if(AudioManager->CheckALError()) {
             IF_PRINT_WARNING(AUDIO_DEBUG) << "setting a source's offset failed: " << AudioManager->CreateALErrorString() << std::endl;
         }
@@ -729,8 +895,23 @@ void AudioDescriptor::_Update()
     // If the last set state was the playing state, we have to double check
     // with the OpenAL source to make sure that the audio is still playing.
     // If the descriptor no longer has a source, we can stop
-    if(!_source) {
+    if(_virtual) {
+        // Virtual audio ends once its timeline is over, or gets a source back once audible.
+        if(!_looping && _GetVirtualSample() >= _input->GetTotalNumberSamples()) {
+            _StopVirtual();
+            _state = AUDIO_STATE_STOPPED;
+        } else if(!IsSound() || _GetAudibility() >= AUDIBILITY_THRESHOLD) {
+            _Devirtualize();
+        }
+    } else if(_mixer_voice != 0) {
+        // Mixed sounds are stopped by the audio engine once the mixer reports their end.
+    } else if(!_source) {
         _state = AUDIO_STATE_STOPPED;
+    } else if(_IsStreamAttached()) {
+        // A streamed source can stop for a moment when it runs out of buffers,
+        // so only the streaming thread can tell when the playback really ended.
+        if(_stream_ended_id.load() == _stream_play_id)
+            _state = AUDIO_STATE_STOPPED;
     } else {
         ALint source_state;
         alGetSourcei(_source->source, AL_SOURCE_STATE, &source_state);
@@ -739,9 +920,16 @@ void AudioDescriptor::_Update()
         }
         if(source_state != AL_PLAYING) {
             _state = AUDIO_STATE_STOPPED;
+            _ReleaseSource();
         }
     }
 
+    // Sounds which can't be heard anymore give their source away.
+    if(_source != nullptr && _state != AUDIO_STATE_STOPPED
+            && IsSound() && _GetAudibility() < AUDIBILITY_THRESHOLD) {
+        _Virtualize();
+    }
+
     // Handle the fade in/out states
     _HandleFadeStates();
 
@@ -757,60 +945,6 @@ void AudioDescriptor::_Update()
             ++it;
         }
     }
-
-    // Only streaming audio that is being played requires periodic updates
-    if(!_stream)
-        return;
-
-    ALint queued = 0;
-    alGetSourcei(_source->source, AL_BUFFERS_QUEUED, &queued);
-    if(AudioManager->CheckALError()) {
-        IF_PRINT_WARNING(AUDIO_DEBUG) << "getting queued sources failed: " << AudioManager->CreateALErrorString() << std::endl;
-    }
-
-    // If there are no more buffers and the end of stream was reached, stop the sound
-    if(queued != 0 && _stream->GetEndOfStream()) {
-        _state = AUDIO_STATE_STOPPED;
-        return;
-    }
-
-    ALint buffers_processed = 0;
-    alGetSourcei(_source->source, AL_BUFFERS_PROCESSED, &buffers_processed);
-    if(AudioManager->CheckALError()) {
-        IF_PRINT_WARNING(AUDIO_DEBUG) << "getting processed sources failed: " << AudioManager->CreateALErrorString() << std::endl;
-    }
-
-    // If any buffers have finished playing, attempt to refill them
-    if(buffers_processed > 0) {
-        ALuint buffer_finished;
-        alSourceUnqueueBuffers(_source->source, 1, &buffer_finished);
-        if(AudioManager->CheckALError()) {
-            IF_PRINT_WARNING(AUDIO_DEBUG) << "unqueuing a source failed: " << AudioManager->CreateALErrorString() << std::endl;
-        }
-
-        uint32_t size = _stream->FillBuffer(_data, _stream_buffer_size);
-        if(size > 0) {  // Make sure that there is data available to fill
-            alBufferData(buffer_finished, _format, _data, size * _input->GetSampleSize(), _input->GetSamplesPerSecond());
-            if(AudioManager->CheckALError()) {
-                IF_PRINT_WARNING(AUDIO_DEBUG) << "buffering data failed: " << AudioManager->CreateALErrorString() << std::endl;
-            }
-            alSourceQueueBuffers(_source->source, 1, &buffer_finished);
-            if(AudioManager->CheckALError()) {
-                IF_PRINT_WARNING(AUDIO_DEBUG) << "queueing a source failed: " << AudioManager->CreateALErrorString() << std::endl;
-            }
-        }
-
-        // This ensures that if a streaming audio piece is stopped because the buffers ran out
-        // of audio data for the source to play, the audio will be automatically replayed again.
-        ALint state;
-        alGetSourcei(_source->source, AL_SOURCE_STATE, &state);
-        if(state != AL_PLAYING) {
-            alSourcePlay(_source->source);
-            if(AudioManager->CheckALError()) {
-                IF_PRINT_WARNING(AUDIO_DEBUG) << "playing a source failed: " << AudioManager->CreateALErrorString() << std::endl;
-            }
-        }
-    }
 } // void AudioDescriptor::_Update()
 
 
@@ -876,18 +1010,16 @@ void AudioDescriptor::_AcquireSource()
         return;
     }
 
-    _source = AudioManager->_AcquireAudioSource();
-    if(_source == nullptr) {
-        IF_PRINT_WARNING(AUDIO_DEBUG) << "could not acquire audio source for new audio file: " << _input->GetFilename() << std::endl;
+    _source = AudioManager->_AcquireAudioSource(this);
+    if(_source == nullptr)
         return;
-    }
 
     _source->owner = this;
     _SetSourceProperties();
     if(_stream == nullptr)
         alSourcei(_source->source, AL_BUFFER, _buffer->buffer);
     else
-        _PrepareStreamingBuffers();
+        AudioManager->_stream_thread.AttachStream(this);
 }
 
 
@@ -911,8 +1043,15 @@ void AudioDescriptor::_SetSourceProperties()
         IF_PRINT_WARNING(AUDIO_DEBUG) << "changing volume on a source failed: " << AudioManager->CreateALErrorString() << std::endl;
     }
 
+    // Sources are shared, so the spatial properties are set back each time (ignored for stereo audio)
+    alSourcefv(_source->source, AL_POSITION, _position);
+    alSourcefv(_source->source, AL_VELOCITY, _velocity);
+    alSourcefv(_source->source, AL_DIRECTION, _direction);
+
     // Set looping (source has looping disabled by default, so only need to check the true case)
-    if(_stream != nullptr) {
+    if(_IsStreamAttached()) {
+        _SendStreamCommand(STREAM_SET_LOOPING, _looping ? 1 : 0);
+    } else if(_stream != nullptr) {
         _stream->SetLooping(_looping);
     } else if(_source != nullptr) {
         if(_looping) {
@@ -926,47 +1065,154 @@ void AudioDescriptor::_SetSourceProperties()
 
 
 
-void AudioDescriptor::_PrepareStreamingBuffers()
+void AudioDescriptor::_ReleaseSource()
 {
-    if(_stream == nullptr) {
-        IF_PRINT_WARNING(AUDIO_DEBUG) << "_stream pointer was nullptr, meaning this function should never have been called" << std::endl;
+    if(_source == nullptr)
+        return;
+
+    // Take the stream back from the streaming thread before the source is reused.
+    if(_IsStreamAttached())
+        AudioManager->_stream_thread.DetachStream(this);
+
+    AudioManager->_ReleaseAudioSource(_source);
+    _source = nullptr;
+}
+
+float AudioDescriptor::_GetAudibility() const
+{
+    float gain = _volume * (IsSound() ? AudioManager->GetSoundVolume() : AudioManager->GetMusicVolume());
+
+    // Stereo audio isn't positioned.
+    if(_format != AL_FORMAT_MONO8 && _format != AL_FORMAT_MONO16)
+        return gain;
+
+    // Follows the default OpenAL inverse distance model, with a reference distance of 1.
+    float listener[ALFLOAT3D];
+    AudioManager->GetListenerPosition(listener);
+    float distance = 0.0f;
+    for(uint32_t i = 0; i < ALFLOAT3D; ++i)
+        distance += (_position[i] - listener[i]) * (_position[i] - listener[i]);
+    distance = sqrtf(distance);
+
+    if(distance > 1.0f)
+        gain /= distance;
+    return gain;
+}
+
+bool AudioDescriptor::_IsLessImportantThan(const AudioDescriptor *other) const
+{
+    if(_priority != other->_priority)
+        return _priority < other->_priority;
+    return _GetAudibility() < other->_GetAudibility();
+}
+
+bool AudioDescriptor::_CanBeMixed() const
+{
+    if(_mixer_sound == nullptr || _looping || !AudioManager->IsSoundMixerEnabled())
+        return false;
+
+    // Positioned sounds are left to OpenAL.
+    for(uint32_t i = 0; i < ALFLOAT3D; ++i) {
+        if(_position[i] != 0.0f)
+            return false;
+    }
+    return AudioManager->_mixer.IsInitialized();
+}
+
+void AudioDescriptor::_StopMixerVoice()
+{
+    if(_mixer_voice == 0)
         return;
+
+    AudioManager->_mixer.Stop(_mixer_voice);
+    AudioManager->_mixed_audio.erase(_mixer_voice);
+    _mixer_voice = 0;
+}
+
+void AudioDescriptor::_StartVirtual(uint32_t sample)
+{
+    _virtual_sample = sample;
+    _virtual_time = SDL_GetTicks();
+    _state = AUDIO_STATE_PLAYING;
+
+    if(!_virtual) {
+        _virtual = true;
+        AudioManager->_virtual_audio.push_back(this);
     }
+}
 
-    if(_source == nullptr) {
-        IF_PRINT_WARNING(AUDIO_DEBUG) << "failed because no source was available for this object to utilize" << std::endl;
+void AudioDescriptor::_Virtualize()
+{
+    uint32_t sample = GetCurrentSampleNumber();
+    _ReleaseSource();
+
+    AUDIO_STATE state = _state;
+    _StartVirtual(sample);
+    // Keep the fading states
+    _state = state;
+}
+
+void AudioDescriptor::_Devirtualize()
+{
+    uint32_t total_samples = _input->GetTotalNumberSamples();
+    uint32_t sample = _GetVirtualSample();
+    if(total_samples > 0)
+        sample %= total_samples;
+
+    // The stream must be at the right position before being handed to the streaming thread.
+    if(_stream != nullptr)
+        _stream->Seek(sample);
+
+    _AcquireSource();
+    if(_source == nullptr)
+        return;
+
+    _StopVirtual();
+
+    if(_IsStreamAttached()) {
+        _SendStreamCommand(STREAM_PLAY, ++_stream_play_id, sample);
         return;
     }
 
-    bool was_playing = false;
+    alSourcei(_source->source, AL_SAMPLE_OFFSET, sample);
+    alSourcePlay(_source->source);
     if(AudioManager->CheckALError()) {
-        IF_PRINT_WARNING(AUDIO_DEBUG) << "OpenAL error detected: " << AudioManager->CreateALErrorString() << std::endl;
+        IF_PRINT_WARNING(AUDIO_DEBUG) << "resuming a virtual audio failed: " << AudioManager->CreateALErrorString() << std::endl;
     }
+}
 
-    // Stop the audio if it is playing and detatch the buffer from the source
-    if(_state == AUDIO_STATE_PLAYING) {
-        was_playing = true;
-        Stop();
-    }
-    alSourcei(_source->source, AL_BUFFER, 0);
+void AudioDescriptor::_StopVirtual()
+{
+    if(!_virtual)
+        return;
 
-    // Fill each buffer with audio data
-    for(uint32_t i = 0; i < NUMBER_STREAMING_BUFFERS; i++) {
-        uint32_t read = _stream->FillBuffer(_data, _stream_buffer_size);
-        if(read > 0) {
-            _buffer[i].FillBuffer(_data, _format, read * _input->GetSampleSize(), _input->GetSamplesPerSecond());
-            if(_source != nullptr)
-                alSourceQueueBuffers(_source->source, 1, &_buffer[i].buffer);
+    _virtual = false;
+    std::vector<AudioDescriptor *>& virtual_audio = AudioManager->_virtual_audio;
+    for(uint32_t i = 0; i < virtual_audio.size(); ++i) {
+        if(virtual_audio[i] == this) {
+            virtual_audio[i] = virtual_audio.back();
+            virtual_audio.pop_back();
+            return;
         }
     }
+}
 
-    if(AudioManager->CheckALError()) {
-        IF_PRINT_WARNING(AUDIO_DEBUG) << "failed to fill all buffers: " << AudioManager->CreateALErrorString() << std::endl;
-    }
+uint32_t AudioDescriptor::_GetVirtualSample() const
+{
+    if(_input == nullptr)
+        return 0;
 
-    if(was_playing) {
-        Play();
-    }
+    if(_state == AUDIO_STATE_PAUSED)
+        return _virtual_sample;
+
+    uint64_t elapsed_samples = static_cast<uint64_t>(SDL_GetTicks() - _virtual_time)
+                               * _input->GetSamplesPerSecond() / 1000;
+    return _virtual_sample + static_cast<uint32_t>(elapsed_samples);
+}
+
+void AudioDescriptor::_SendStreamCommand(STREAM_COMMAND type, uint32_t value, uint32_t sample)
+{
+    AudioManager->_stream_thread.SendCommand(type, this, value, sample);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1008,6 +1254,8 @@ void SoundDescriptor::SetVolume(float volume)
 
     if(_source) {
         alSourcef(_source->source, AL_GAIN, sound_volume);
+    } else if(_mixer_voice != 0) {
+        AudioManager->_mixer.SetVolume(_mixer_voice, sound_volume);
     }
 }
 
@@ -1030,6 +1278,7 @@ MusicDescriptor::MusicDescriptor() :
     AudioDescriptor()
 {
     _looping = true;
+    _priority = AUDIO_PRIORITY_HIGH;
     AudioManager->_registered_music.push_back(this);
 }
 
@@ -27,6 +27,7 @@
 #include "audio_input.h"
 #include "audio_stream.h"
 #include "audio_effects.h"
+#include "audio_mixer.h"
 
 // OpenAL includes
 #ifdef __APPLE__
@@ -37,6 +38,7 @@
 #include "alc.h"
 #endif
 
+#include <atomic>
 #include <vector>
 
 namespace vt_mode_manager {
@@ -74,6 +76,16 @@ enum AUDIO_LOAD {
     AUDIO_LOAD_STREAM_MEMORY  = 2
 };
 
+/** \brief The priorities deciding which audio keeps playing on a source when they are all used
+*** When no source is free, a playing audio of lower priority, or of same priority but less
+*** audible, gives its source to the audio requesting one.
+**/
+enum AUDIO_PRIORITY {
+    AUDIO_PRIORITY_LOW     = 0,
+    AUDIO_PRIORITY_NORMAL  = 1,
+    AUDIO_PRIORITY_HIGH    = 2
+};
+
 //! \brief ALfloat per 3D OpenAL sound vectors (position, direction, velocity)
 const uint32_t ALFLOAT3D = 3;
 typedef ALfloat ALfloatArray[ALFLOAT3D];
@@ -89,6 +101,9 @@ const uint32_t DEFAULT_BUFFER_SIZE = 8192;
 //! \brief The number of buffers to use for streaming audio descriptors
 const uint32_t NUMBER_STREAMING_BUFFERS = 4;
 
+//! \brief The gain under which a playing sound is considered inaudible and doesn't need a source
+const float AUDIBILITY_THRESHOLD = 0.01f;
+
 /** ****************************************************************************
 *** \brief Represents an OpenAL buffer
 ***
@@ -206,6 +221,7 @@ public:
 class AudioDescriptor
 {
     friend class AudioEngine;
+    friend class private_audio::AudioStreamThread;
 
 public:
     AudioDescriptor();
@@ -300,6 +316,28 @@ public:
     //! \brief Gets the current sample number (track offset)
     uint32_t GetCurrentSampleNumber() const;
 
+    //! \brief Returns the duration of the loaded audio, in seconds
+    float GetPlayTime() const {
+        return _input ? _input->GetPlayTime() : 0.0f;
+    }
+
+    AUDIO_PRIORITY GetPriority() const {
+        return _priority;
+    }
+
+    //! \brief Sets the priority used to keep a source when they are all used.
+    void SetPriority(AUDIO_PRIORITY priority) {
+        _priority = priority;
+    }
+
+    /** \brief Tells whether the audio is played without a source.
+    *** Virtual audio keeps advancing its playback position without being heard,
+    *** until it becomes audible and a source can be given to it.
+    **/
+    bool IsVirtual() const {
+        return _virtual;
+    }
+
     //! \brief Returns the volume level for this audio
     float GetVolume() const {
         return _volume;
@@ -426,6 +464,19 @@ protected:
     //! \brief Size of the streaming buffer, if the audio was loaded for streaming
     uint32_t _stream_buffer_size;
 
+    //! \brief The priority used to keep a source when they are all used
+    AUDIO_PRIORITY _priority;
+
+    /** \name Virtual playback members
+    *** The position of virtual audio is _virtual_sample plus the samples elapsed
+    *** since _virtual_time, unless it is paused.
+    **/
+    //@{
+    bool _virtual;
+    uint32_t _virtual_sample;
+    uint32_t _virtual_time;
+    //@}
+
     //! \brief The 3D orientation properties of the audio
     //@{
     ALfloat _position[ALFLOAT3D];
@@ -445,6 +496,35 @@ protected:
     //! \brief Holds all active audio effects for this descriptor
     std::vector<private_audio::AudioEffect *> _audio_effects;
 
+    /** \name Streaming thread shared state
+    *** Once attached to the streaming thread, the stream, input data and buffers
+    *** of streamed audio are only touched by that thread until it is detached.
+    **/
+    //@{
+    //! \brief Whether the stream is owned by the streaming thread.
+    std::atomic<bool> _stream_attached;
+
+    //! \brief The stream sample position, as last published by the streaming thread.
+    std::atomic<uint32_t> _stream_position;
+
+    //! \brief Incremented each time the stream is played. Only used by the main thread.
+    uint32_t _stream_play_id;
+
+    //! \brief The play id of the last stream playback which reached its end.
+    std::atomic<uint32_t> _stream_ended_id;
+    //@}
+
+    /** \name Software mixer members
+    *** Short one-shot sounds may be played by the software mixer instead of a source.
+    **/
+    //@{
+    //! \brief The decoded data in the mixer format, shared with the other descriptors of the file
+    private_audio::MixerSoundPtr _mixer_sound;
+
+    //! \brief The mixer voice playing the audio, or 0 when not mixed
+    uint32_t _mixer_voice;
+    //@}
+
     /** \brief Sets the local volume control for this particular audio piece
     *** \param volume The volume level to set, ranging from [0.0f, 1.0f]
     *** This should be thought of as a helper function to the SetVolume methods
@@ -464,9 +544,10 @@ private:
     void _HandleFadeStates();
 
     /** \brief Acquires an audio source for playback
-    *** This function is called whenever an audio piece is loaded and whenever the Play operation is specified on
-    *** the audio, but the audio currently does not have a source. It is not guaranteed that the source acquisition
-    *** will be successful, as all other sources may be occupied by other audio.
+    *** This function is called whenever the Play operation is specified on the audio, but the audio currently
+    *** does not have a source. When no source is free, the source of less important audio is taken. It is not
+    *** guaranteed that the source acquisition will be successful, as all other sources may be occupied by
+    *** more important audio.
     **/
     void _AcquireSource();
 
@@ -477,11 +558,45 @@ private:
     **/
     void _SetSourceProperties();
 
-    /** \brief Prepares streaming buffers when a new source is acquired or after a seeking operation.
-    *** This is a special case, since the already queued buffers must be unqueued, and the new
-    *** ones must be refilled. This function should only be called for streaming audio.
+    //! \brief Gives the source back to the audio engine, if any.
+    void _ReleaseSource();
+
+    //! \brief Tells whether the audio can be played by the software mixer instead of a source.
+    bool _CanBeMixed() const;
+
+    //! \brief Stops the mixer voice playing the audio, if any.
+    void _StopMixerVoice();
+
+    //! \brief Returns the estimated gain the audio is heard with, including the distance to the listener.
+    float _GetAudibility() const;
+
+    //! \brief Tells whether the audio should lose its source before the other one.
+    bool _IsLessImportantThan(const AudioDescriptor *other) const;
+
+    /** \brief Starts or keeps on playing the audio without a source
+    *** \param sample The sample position from which the virtual playback starts
     **/
-    void _PrepareStreamingBuffers();
+    void _StartVirtual(uint32_t sample);
+
+    //! \brief Gives away the source of the playing audio, which keeps on playing virtually.
+    void _Virtualize();
+
+    //! \brief Tries to get a source back for virtual audio and resumes the real playback.
+    void _Devirtualize();
+
+    //! \brief Stops the virtual playback, if any.
+    void _StopVirtual();
+
+    //! \brief Returns the virtual playback position, not wrapped around when looping.
+    uint32_t _GetVirtualSample() const;
+
+    //! \brief Returns whether the stream is owned by the streaming thread.
+    bool _IsStreamAttached() const {
+        return _stream_attached.load(std::memory_order_acquire);
+    }
+
+    //! \brief Sends a command about this descriptor stream to the streaming thread.
+    void _SendStreamCommand(private_audio::STREAM_COMMAND type, uint32_t value = 0, uint32_t sample = 0);
 }; // class AudioDescriptor
 
 
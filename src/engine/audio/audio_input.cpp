@@ -25,6 +25,7 @@
 #include "audio_input.h"
 
 #include "utils/utils_common.h"
+#include "utils/utils_strings.h"
 
 #include <cstring>
 #include <SDL_endian.h>
@@ -481,6 +482,26 @@ uint32_t AudioMemory::Read(uint8_t *buffer, uint32_t size, bool &end)
     return read;
 }
 
+AudioInput *CreateAudioInput(const std::string &filename)
+{
+    if(filename.size() <= 3) {  // Name of file is at least 3 letters (so the extension is in there)
+        IF_PRINT_WARNING(AUDIO_DEBUG) << "file name argument is too short: " << filename << std::endl;
+        return nullptr;
+    }
+    // Convert the file extension to uppercase and use it to create the proper input type
+    std::string file_extension = filename.substr(filename.size() - 3, 3);
+    file_extension = vt_utils::Upcase(file_extension);
+
+    // Based on the extension of the file, load properly one
+    if(file_extension.compare("WAV") == 0)
+        return new WavFile(filename);
+    else if(file_extension.compare("OGG") == 0)
+        return new OggFile(filename);
+
+    IF_PRINT_WARNING(AUDIO_DEBUG) << "failed due to unsupported input file extension: " << file_extension << std::endl;
+    return nullptr;
+}
+
 } // namespace private_audio
 
 } // namespace vt_audio
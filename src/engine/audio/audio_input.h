@@ -280,6 +280,11 @@ private:
     uint32_t _data_position;
 }; // class AudioMemory : public AudioInput
 
+/** \brief Creates the audio input fitting the file extension (WAV or OGG)
+*** \return The input, not initialized yet, or nullptr if the file isn't supported
+**/
+AudioInput *CreateAudioInput(const std::string &filename);
+
 } // namespace private_audio
 
 } // namespace vt_audio
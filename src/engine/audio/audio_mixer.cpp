@@ -0,0 +1,382 @@
+////////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2018 by Bertram (Valyria Tear)
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+////////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file   audio_mixer.cpp
+*** \author Yohann Ferreira, yohann ferreira orange fr
+*** \brief  Implementation of the software mixer of short sounds
+*** ***************************************************************************/
+
+#include "audio_mixer.h"
+
+#include "audio_input.h"
+
+#include "utils/utils_common.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace vt_audio
+{
+
+extern bool AUDIO_DEBUG;
+
+namespace private_audio
+{
+
+////////////////////////////////////////////////////////////////////////////////
+// MixerSound class methods
+////////////////////////////////////////////////////////////////////////////////
+
+MixerSoundPtr MixerSound::Create(const AudioInput *input, const uint8_t *data)
+{
+    const uint32_t number_channels = input->GetNumberChannels();
+    const uint32_t bits_per_sample = input->GetBitsPerSample();
+    if((number_channels != 1 && number_channels != 2) || (bits_per_sample != 8 && bits_per_sample != 16)
+            || input->GetSamplesPerSecond() == 0 || data == nullptr)
+        return MixerSoundPtr();
+
+    std::shared_ptr<MixerSound> sound = std::make_shared<MixerSound>();
+    sound->number_channels = number_channels;
+    sound->samples_per_second = input->GetSamplesPerSecond();
+    sound->number_frames = input->GetDataSize() / input->GetSampleSize();
+
+    const uint32_t number_samples = sound->number_frames * number_channels;
+    sound->samples.resize(number_samples);
+    float *samples = sound->samples.data();
+
+    if(bits_per_sample == 16) {
+        // The decoded data may not be aligned for 16-bit reads.
+        std::vector<int16_t> values(number_samples);
+        memcpy(values.data(), data, number_samples * sizeof(int16_t));
+        for(uint32_t i = 0; i < number_samples; ++i)
+            samples[i] = values[i] * (1.0f / 32768.0f);
+    } else {
+        // 8-bit samples are unsigned.
+        for(uint32_t i = 0; i < number_samples; ++i)
+            samples[i] = (static_cast<float>(data[i]) - 128.0f) * (1.0f / 128.0f);
+    }
+
+    return sound;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// AudioMixer class methods
+////////////////////////////////////////////////////////////////////////////////
+
+bool AudioMixer::Initialize()
+{
+    if(_initialized)
+        return true;
+
+    alGetError();
+    alGenSources(1, &_source);
+    if(alGetError() != AL_NO_ERROR) {
+        IF_PRINT_WARNING(AUDIO_DEBUG) << "couldn't create the mixer source" << std::endl;
+        _source = 0;
+        return false;
+    }
+
+    alGenBuffers(MIXER_NUMBER_BUFFERS, _buffers);
+    if(alGetError() != AL_NO_ERROR) {
+        IF_PRINT_WARNING(AUDIO_DEBUG) << "couldn't create the mixer buffers" << std::endl;
+        alDeleteSources(1, &_source);
+        _source = 0;
+        return false;
+    }
+
+    // The mixed sounds aren't positioned: keep the source on the listener.
+    alSourcei(_source, AL_SOURCE_RELATIVE, AL_TRUE);
+    alSource3f(_source, AL_POSITION, 0.0f, 0.0f, 0.0f);
+    alSourcef(_source, AL_GAIN, 1.0f);
+
+    _free_buffers.assign(_buffers, _buffers + MIXER_NUMBER_BUFFERS);
+    _mix_buffer.resize(MIXER_BUFFER_FRAMES * 2);
+    _output_buffer.resize(MIXER_BUFFER_FRAMES * 2);
+    _voices.reserve(64);
+
+    _initialized = true;
+    return true;
+}
+
+void AudioMixer::Shutdown()
+{
+    if(!_initialized)
+        return;
+
+    alSourceStop(_source);
+    alSourcei(_source, AL_BUFFER, 0);
+    alDeleteSources(1, &_source);
+    alDeleteBuffers(MIXER_NUMBER_BUFFERS, _buffers);
+    _source = 0;
+
+    _voices.clear();
+    _free_buffers.clear();
+    _number_voices = 0;
+    _initialized = false;
+}
+
+uint32_t AudioMixer::Play(const MixerSoundPtr &sound, float volume)
+{
+    uint32_t voice = _next_voice_id++;
+    // 0 means no voice.
+    if(_next_voice_id == 0)
+        _next_voice_id = 1;
+
+    _SendCommand(MIXER_PLAY, voice, volume, sound);
+    return voice;
+}
+
+void AudioMixer::Stop(uint32_t voice)
+{
+    _SendCommand(MIXER_STOP, voice);
+}
+
+void AudioMixer::Pause(uint32_t voice)
+{
+    _SendCommand(MIXER_PAUSE, voice);
+}
+
+void AudioMixer::Resume(uint32_t voice)
+{
+    _SendCommand(MIXER_RESUME, voice);
+}
+
+void AudioMixer::SetVolume(uint32_t voice, float volume)
+{
+    _SendCommand(MIXER_SET_VOLUME, voice, volume);
+}
+
+void AudioMixer::Seek(uint32_t voice, uint32_t frame)
+{
+    _SendCommand(MIXER_SEEK, voice, 0.0f, MixerSoundPtr(), frame);
+}
+
+void AudioMixer::_SendCommand(MIXER_COMMAND type, uint32_t voice, float volume, const MixerSoundPtr &sound,
+                              uint32_t frame)
+{
+    // Nothing consumes the commands anymore once shut down.
+    if(!_initialized)
+        return;
+
+    MixerCommand command;
+    command.type = type;
+    command.voice = voice;
+    command.sound = sound;
+    command.volume = volume;
+    command.frame = frame;
+
+    // Commands can't be dropped, so wait for the thread to make room if ever needed.
+    while(!_commands.Push(command))
+        std::this_thread::yield();
+}
+
+void AudioMixer::Update()
+{
+    if(!_initialized)
+        return;
+
+    MixerCommand command;
+    while(_commands.Pop(command))
+        _ProcessCommand(command);
+
+    // Report the ended voices. Retry on the next update when the queue is full.
+    for(uint32_t i = 0; i < _voices.size();) {
+        if(_voices[i].ended && _ended_voices.Push(_voices[i].id)) {
+            _voices[i] = _voices.back();
+            _voices.pop_back();
+        } else {
+            ++i;
+        }
+    }
+    _number_voices = static_cast<uint32_t>(_voices.size());
+
+    // Get back the buffers which finished playing.
+    ALint buffers_processed = 0;
+    alGetSourcei(_source, AL_BUFFERS_PROCESSED, &buffers_processed);
+    for(; buffers_processed > 0; --buffers_processed) {
+        ALuint buffer;
+        alSourceUnqueueBuffers(_source, 1, &buffer);
+        _free_buffers.push_back(buffer);
+    }
+
+    bool playing = false;
+    for(uint32_t i = 0; i < _voices.size(); ++i) {
+        if(!_voices[i].paused && !_voices[i].ended) {
+            playing = true;
+            break;
+        }
+    }
+
+    // Nothing is mixed while no voice is playing: the source then simply runs out of buffers.
+    if(!playing)
+        return;
+
+    while(!_free_buffers.empty()) {
+        _MixBuffer();
+        ALuint buffer = _free_buffers.back();
+        _free_buffers.pop_back();
+        alBufferData(buffer, AL_FORMAT_STEREO16, _output_buffer.data(),
+                     static_cast<ALsizei>(_output_buffer.size() * sizeof(int16_t)), MIXER_FREQUENCY);
+        alSourceQueueBuffers(_source, 1, &buffer);
+    }
+
+    ALint state;
+    alGetSourcei(_source, AL_SOURCE_STATE, &state);
+    if(state != AL_PLAYING)
+        alSourcePlay(_source);
+
+    ALenum error = alGetError();
+    if(error != AL_NO_ERROR)
+        IF_PRINT_WARNING(AUDIO_DEBUG) << "OpenAL error while updating the mixer: " << error << std::endl;
+}
+
+void AudioMixer::_ProcessCommand(const MixerCommand &command)
+{
+    if(command.type == MIXER_PLAY) {
+        if(command.sound == nullptr || command.sound->number_frames == 0) {
+            // Report it anyway so that the descriptor doesn't wait for it.
+            Voice voice;
+            voice.id = command.voice;
+            voice.position = 0.0;
+            voice.step = 1.0;
+            voice.volume = 0.0f;
+            voice.paused = false;
+            voice.ended = true;
+            _voices.push_back(voice);
+            return;
+        }
+
+        Voice voice;
+        voice.id = command.voice;
+        voice.sound = command.sound;
+        voice.position = 0.0;
+        voice.step = static_cast<double>(command.sound->samples_per_second) / MIXER_FREQUENCY;
+        voice.volume = command.volume;
+        voice.paused = false;
+        voice.ended = false;
+        _voices.push_back(voice);
+        return;
+    }
+
+    Voice *voice = _FindVoice(command.voice);
+    if(voice == nullptr)
+        return;
+
+    switch(command.type) {
+    case MIXER_STOP:
+        voice->ended = true;
+        break;
+    case MIXER_PAUSE:
+        voice->paused = true;
+        break;
+    case MIXER_RESUME:
+        voice->paused = false;
+        break;
+    case MIXER_SET_VOLUME:
+        voice->volume = command.volume;
+        break;
+    case MIXER_SEEK:
+        if(!voice->ended && voice->sound != nullptr && command.frame < voice->sound->number_frames)
+            voice->position = static_cast<double>(command.frame);
+        break;
+    default:
+        break;
+    }
+}
+
+void AudioMixer::_MixBuffer()
+{
+    float *mix = _mix_buffer.data();
+    const uint32_t number_samples = MIXER_BUFFER_FRAMES * 2;
+    std::fill(mix, mix + number_samples, 0.0f);
+
+    for(uint32_t i = 0; i < _voices.size(); ++i) {
+        Voice &voice = _voices[i];
+        if(voice.paused || voice.ended)
+            continue;
+
+        if(_MixVoice(voice, MIXER_BUFFER_FRAMES) < MIXER_BUFFER_FRAMES)
+            voice.ended = true;
+    }
+
+    // Clamp and convert to 16-bit samples.
+    int16_t *output = _output_buffer.data();
+    for(uint32_t i = 0; i < number_samples; ++i) {
+        float value = std::min(std::max(mix[i], -1.0f), 1.0f);
+        output[i] = static_cast<int16_t>(value * 32767.0f);
+    }
+}
+
+uint32_t AudioMixer::_MixVoice(Voice &voice, uint32_t number_frames)
+{
+    const MixerSound &sound = *voice.sound;
+    const float *samples = sound.samples.data();
+    const float volume = voice.volume;
+    float *mix = _mix_buffer.data();
+
+    // Without resampling, the frames are simply added.
+    if(sound.samples_per_second == MIXER_FREQUENCY) {
+        const uint32_t position = static_cast<uint32_t>(voice.position);
+        const uint32_t frames = std::min(number_frames, sound.number_frames - position);
+
+        if(sound.number_channels == 2) {
+            const float *source = samples + position * 2;
+            for(uint32_t i = 0; i < frames * 2; ++i)
+                mix[i] += source[i] * volume;
+        } else {
+            const float *source = samples + position;
+            for(uint32_t i = 0; i < frames; ++i) {
+                const float value = source[i] * volume;
+                mix[i * 2] += value;
+                mix[i * 2 + 1] += value;
+            }
+        }
+
+        voice.position += frames;
+        return frames;
+    }
+
+    // Otherwise, interpolate linearly between the two closest frames.
+    const double last_frame = static_cast<double>(sound.number_frames - 1);
+    uint32_t frames = 0;
+    double position = voice.position;
+    for(; frames < number_frames && position < last_frame; ++frames) {
+        const uint32_t index = static_cast<uint32_t>(position);
+        const float ratio = static_cast<float>(position - index);
+
+        if(sound.number_channels == 2) {
+            const float *source = samples + index * 2;
+            mix[frames * 2] += (source[0] + (source[2] - source[0]) * ratio) * volume;
+            mix[frames * 2 + 1] += (source[1] + (source[3] - source[1]) * ratio) * volume;
+        } else {
+            const float *source = samples + index;
+            const float value = (source[0] + (source[1] - source[0]) * ratio) * volume;
+            mix[frames * 2] += value;
+            mix[frames * 2 + 1] += value;
+        }
+        position += voice.step;
+    }
+
+    voice.position = position;
+    return frames;
+}
+
+AudioMixer::Voice *AudioMixer::_FindVoice(uint32_t id)
+{
+    for(uint32_t i = 0; i < _voices.size(); ++i) {
+        if(_voices[i].id == id)
+            return &_voices[i];
+    }
+    return nullptr;
+}
+
+} // namespace private_audio
+
+} // namespace vt_audio
@@ -0,0 +1,240 @@
+////////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2018 by Bertram (Valyria Tear)
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+////////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file   audio_mixer.h
+*** \author Yohann Ferreira, yohann ferreira orange fr
+*** \brief  Header file for the software mixer of short sounds
+***
+*** Short one-shot sounds are mixed together in software, and the result is
+*** streamed to a single OpenAL source. Many overlapping sounds then don't use
+*** as many sources, nor as many OpenAL calls.
+*** ***************************************************************************/
+
+#ifndef __AUDIO_MIXER_HEADER__
+#define __AUDIO_MIXER_HEADER__
+
+#include "audio_stream_thread.h"
+
+#include <memory>
+
+namespace vt_audio
+{
+
+namespace private_audio
+{
+
+class AudioInput;
+
+//! \brief The biggest decoded data size of a sound played through the mixer, in bytes
+const uint32_t MIXER_MAX_SOUND_SIZE = 512 * 1024;
+
+//! \brief The sample rate of the mixer output, in Hz. The output is stereo, 16 bits.
+const uint32_t MIXER_FREQUENCY = 44100;
+
+//! \brief The number of samples mixed at once in each buffer, for each channel
+const uint32_t MIXER_BUFFER_FRAMES = 512;
+
+//! \brief The number of buffers queued on the mixer source, setting its latency
+const uint32_t MIXER_NUMBER_BUFFERS = 3;
+
+//! \brief The decoded data of a sound, in the mixer format
+class MixerSound
+{
+public:
+    MixerSound() :
+        number_channels(0), samples_per_second(0), number_frames(0) {}
+
+    //! \brief The samples, from -1.0f to 1.0f, interleaved when in stereo
+    std::vector<float> samples;
+
+    //! \brief Either 1 or 2
+    uint32_t number_channels;
+
+    uint32_t samples_per_second;
+
+    //! \brief The number of samples, for each channel
+    uint32_t number_frames;
+
+    /** \brief Converts decoded data to the mixer format
+    *** \param input The input the data was decoded from
+    *** \param data The whole decoded data, of input->GetDataSize() bytes
+    *** \return The converted sound, or nullptr if its format isn't supported
+    **/
+    static std::shared_ptr<const MixerSound> Create(const AudioInput *input, const uint8_t *data);
+};
+
+typedef std::shared_ptr<const MixerSound> MixerSoundPtr;
+
+//! \brief The commands sent to the mixer
+enum MIXER_COMMAND {
+    MIXER_PLAY,
+    MIXER_STOP,
+    MIXER_PAUSE,
+    MIXER_RESUME,
+    MIXER_SET_VOLUME,
+    MIXER_SEEK
+};
+
+struct MixerCommand {
+    MIXER_COMMAND type;
+
+    //! \brief The id of the voice the command is about
+    uint32_t voice;
+
+    //! \brief The sound to play, for the play command.
+    MixerSoundPtr sound;
+
+    //! \brief The voice volume, for the play and volume commands.
+    float volume;
+
+    //! \brief The sound frame to continue from, for the seek command.
+    uint32_t frame;
+};
+
+/** ****************************************************************************
+*** \brief Mixes short sounds in software, and streams the result to an OpenAL source
+***
+*** Each sound played through the mixer is a voice, identified by an id. The main
+*** thread sends commands about the voices through a lock-free queue, while the
+*** streaming thread mixes them. The voices which ended are reported back through
+*** another queue.
+***
+*** The mixing loops are kept simple and branchless on purpose, so that the
+*** compiler can vectorize them.
+*** ***************************************************************************/
+class AudioMixer
+{
+public:
+    AudioMixer():
+        _initialized(false),
+        _source(0),
+        _next_voice_id(1),
+        _number_voices(0)
+    {}
+
+    ~AudioMixer() {
+        Shutdown();
+    }
+
+    //! \brief Creates the mixer source and buffers. Called on the main thread.
+    bool Initialize();
+
+    //! \brief Deletes the mixer source and buffers, once the streaming thread is stopped.
+    void Shutdown();
+
+    bool IsInitialized() const {
+        return _initialized;
+    }
+
+    /** \name Main thread functions
+    **/
+    //@{
+    /** \brief Starts playing a sound
+    *** \param sound The sound to play
+    *** \param volume The sound volume, from 0.0f to 1.0f
+    *** \return The id of the new voice
+    **/
+    uint32_t Play(const MixerSoundPtr &sound, float volume);
+
+    void Stop(uint32_t voice);
+
+    void Pause(uint32_t voice);
+
+    void Resume(uint32_t voice);
+
+    void SetVolume(uint32_t voice, float volume);
+
+    //! \brief Moves the playback of a voice to the given frame of its sound.
+    void Seek(uint32_t voice, uint32_t frame);
+
+    //! \brief Takes the id of a voice which ended, if any.
+    bool PopEndedVoice(uint32_t &voice) {
+        return _ended_voices.Pop(voice);
+    }
+
+    //! \brief Returns the number of voices being mixed.
+    uint32_t GetNumberVoices() const {
+        return _number_voices.load();
+    }
+    //@}
+
+    //! \brief Mixes the playing voices into the free buffers. Called on the streaming thread.
+    void Update();
+
+private:
+    //! \brief A sound being mixed. Only used by the streaming thread.
+    struct Voice {
+        uint32_t id;
+
+        MixerSoundPtr sound;
+
+        //! \brief The playback position in the sound, in frames
+        double position;
+
+        //! \brief The frames advanced in the sound for each output frame, when resampling
+        double step;
+
+        float volume;
+
+        bool paused;
+
+        //! \brief Whether the voice ended, and is waiting to be reported as such
+        bool ended;
+    };
+
+    bool _initialized;
+
+    ALuint _source;
+
+    ALuint _buffers[MIXER_NUMBER_BUFFERS];
+
+    //! \brief The buffers which aren't queued on the source. Only used by the streaming thread.
+    std::vector<ALuint> _free_buffers;
+
+    //! \brief The commands queue, from the main thread.
+    SPSCQueue<MixerCommand, 256> _commands;
+
+    //! \brief The ended voices queue, to the main thread.
+    SPSCQueue<uint32_t, 256> _ended_voices;
+
+    //! \brief The id given to the next voice. Only used by the main thread.
+    uint32_t _next_voice_id;
+
+    //! \brief The voices being mixed. Only used by the streaming thread.
+    std::vector<Voice> _voices;
+
+    std::atomic<uint32_t> _number_voices;
+
+    //! \brief The mixing buffers. Only used by the streaming thread.
+    //@{
+    std::vector<float> _mix_buffer;
+    std::vector<int16_t> _output_buffer;
+    //@}
+
+    void _SendCommand(MIXER_COMMAND type, uint32_t voice, float volume = 0.0f,
+                      const MixerSoundPtr &sound = MixerSoundPtr(), uint32_t frame = 0);
+
+    void _ProcessCommand(const MixerCommand &command);
+
+    //! \brief Mixes the next buffer of every playing voice into _output_buffer.
+    void _MixBuffer();
+
+    //! \brief Adds the next frames of a voice to the mixing buffer.
+    //! \return The number of frames actually mixed, less than requested when the sound ended.
+    uint32_t _MixVoice(Voice &voice, uint32_t number_frames);
+
+    Voice *_FindVoice(uint32_t id);
+};
+
+} // namespace private_audio
+
+} // namespace vt_audio
+
+#endif // __AUDIO_MIXER_HEADER__
@@ -0,0 +1,274 @@
+////////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2018 by Bertram (Valyria Tear)
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+////////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file   audio_pcm_cache.cpp
+*** \author Yohann Ferreira, yohann ferreira orange fr
+*** \brief  Implementation of the on-disk cache of decoded sounds
+*** ***************************************************************************/
+
+#include "audio_pcm_cache.h"
+
+#include "common/app_settings.h"
+
+#include "utils/utils_common.h"
+#include "utils/utils_files.h"
+#include "utils/utils_strings.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sys/stat.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace vt_audio
+{
+
+extern bool AUDIO_DEBUG;
+
+namespace private_audio
+{
+
+//! \brief Identifies the cache files, and their format version.
+const char PCM_CACHE_MAGIC[4] = { 'V', 'T', 'P', 'C' };
+const uint32_t PCM_CACHE_VERSION = 1;
+
+//! \brief Numbers the temporary files, as the main and preloader threads may save the same sound at once.
+static std::atomic<uint32_t> _pcm_cache_temp_count(0);
+
+//! \brief Gives the cache filename of a sound file, flattening its path.
+static std::string _GetPcmCacheFilename(const std::string &filename)
+{
+    std::string cache_name = filename;
+    for(uint32_t i = 0; i < cache_name.size(); ++i) {
+        if(cache_name[i] == '/' || cache_name[i] == '\\' || cache_name[i] == ':')
+            cache_name[i] = '_';
+    }
+    return vt_common::GetUserDataPath() + PCM_CACHE_FOLDER + cache_name + ".pcm";
+}
+
+//! \brief Gets the modification time and size of a file.
+static bool _GetFileStatus(const std::string &filename, int64_t &modification_time, uint64_t &size)
+{
+    struct stat file_status;
+    if(stat(filename.c_str(), &file_status) != 0)
+        return false;
+
+    modification_time = static_cast<int64_t>(file_status.st_mtime);
+    size = static_cast<uint64_t>(file_status.st_size);
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// PcmCacheFile class methods
+////////////////////////////////////////////////////////////////////////////////
+
+PcmCacheFile::PcmCacheFile(const std::string &source_filename, const std::string &cache_filename) :
+    AudioInput(),
+    _cache_filename(cache_filename),
+    _file_data(nullptr),
+    _file_size(0),
+    _audio_data(nullptr),
+    _data_position(0)
+{
+    _filename = source_filename;
+}
+
+PcmCacheFile::~PcmCacheFile()
+{
+    _Close();
+}
+
+bool PcmCacheFile::Initialize()
+{
+    _Close();
+
+#ifdef _WIN32
+    std::ifstream file(_cache_filename.c_str(), std::ios::binary);
+    if(!file.is_open())
+        return false;
+    file.seekg(0, std::ios::end);
+    _file_buffer.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0, std::ios::beg);
+    if(_file_buffer.empty() || !file.read(reinterpret_cast<char *>(&_file_buffer[0]), _file_buffer.size())) {
+        _file_buffer.clear();
+        return false;
+    }
+    _file_data = &_file_buffer[0];
+    _file_size = _file_buffer.size();
+#else
+    int file = open(_cache_filename.c_str(), O_RDONLY);
+    if(file < 0)
+        return false;
+
+    struct stat file_status;
+    if(fstat(file, &file_status) != 0 || file_status.st_size <= 0) {
+        close(file);
+        return false;
+    }
+
+    void *mapping = mmap(nullptr, static_cast<size_t>(file_status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+    // The mapping stays valid once the file is closed.
+    close(file);
+    if(mapping == MAP_FAILED)
+        return false;
+
+    _file_data = static_cast<const uint8_t *>(mapping);
+    _file_size = static_cast<size_t>(file_status.st_size);
+#endif
+
+    // Check the cache against the current source file.
+    PcmCacheHeader header;
+    int64_t source_modification_time = 0;
+    uint64_t source_size = 0;
+    if(_file_size < sizeof(header) || !_GetFileStatus(_filename, source_modification_time, source_size)) {
+        _Close();
+        return false;
+    }
+    memcpy(&header, _file_data, sizeof(header));
+
+    if(memcmp(header.magic, PCM_CACHE_MAGIC, sizeof(header.magic)) != 0
+            || header.version != PCM_CACHE_VERSION
+            || header.source_modification_time != source_modification_time
+            || header.source_size != source_size
+            || header.number_channels == 0 || header.bits_per_sample == 0 || header.bits_per_sample % 8 != 0
+            || static_cast<uint64_t>(header.total_number_samples) * header.number_channels * (header.bits_per_sample / 8)
+               != header.data_size
+            || _file_size - sizeof(header) < header.data_size) {
+        IF_PRINT_DEBUG(AUDIO_DEBUG) << "outdated decoded sound cache: " << _cache_filename << std::endl;
+        _Close();
+        return false;
+    }
+
+    _samples_per_second = header.samples_per_second;
+    _bits_per_sample = header.bits_per_sample;
+    _number_channels = header.number_channels;
+    _total_number_samples = header.total_number_samples;
+    _data_size = header.data_size;
+    _sample_size = _number_channels * _bits_per_sample / 8;
+    _play_time = _samples_per_second > 0 ? static_cast<float>(_total_number_samples) / _samples_per_second : 0.0f;
+
+    _audio_data = _file_data + sizeof(header);
+    _data_position = 0;
+    return true;
+}
+
+void PcmCacheFile::Seek(uint32_t sample_position)
+{
+    if(sample_position >= _total_number_samples) {
+        IF_PRINT_WARNING(AUDIO_DEBUG) << "failed because requested sample position exceeded the maximum: " << sample_position << std::endl;
+        return;
+    }
+
+    _data_position = sample_position;
+}
+
+uint32_t PcmCacheFile::Read(uint8_t *buffer, uint32_t size, bool &end)
+{
+    // Clamp the number of samples to read in case there are not enough because of end of stream
+    uint32_t read = (_total_number_samples - _data_position >= size) ? size : (_total_number_samples - _data_position);
+
+    memcpy(buffer, _audio_data + _data_position * _sample_size, read * _sample_size);
+    _data_position += read;
+    end = (_data_position == _total_number_samples);
+
+    return read;
+}
+
+void PcmCacheFile::_Close()
+{
+#ifdef _WIN32
+    _file_buffer.clear();
+#else
+    if(_file_data != nullptr)
+        munmap(const_cast<uint8_t *>(_file_data), _file_size);
+#endif
+    _file_data = nullptr;
+    _file_size = 0;
+    _audio_data = nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// PCM cache functions
+////////////////////////////////////////////////////////////////////////////////
+
+AudioInput *OpenPcmCacheFile(const std::string &filename)
+{
+    std::string cache_filename = _GetPcmCacheFilename(filename);
+    if(!vt_utils::DoesFileExist(cache_filename))
+        return nullptr;
+
+    PcmCacheFile *input = new PcmCacheFile(filename, cache_filename);
+    if(!input->Initialize()) {
+        delete input;
+        return nullptr;
+    }
+    return input;
+}
+
+void SavePcmCacheFile(const AudioInput *input, const uint8_t *data)
+{
+    const std::string &filename = input->GetFilename();
+
+    // Only the short Ogg sounds are worth caching.
+    if(input->GetDataSize() == 0 || input->GetDataSize() > PCM_CACHE_MAX_DATA_SIZE)
+        return;
+    if(filename.size() <= 3 || vt_utils::Upcase(filename.substr(filename.size() - 3, 3)) != "OGG")
+        return;
+
+    PcmCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    if(!_GetFileStatus(filename, header.source_modification_time, header.source_size))
+        return;
+    memcpy(header.magic, PCM_CACHE_MAGIC, sizeof(header.magic));
+    header.version = PCM_CACHE_VERSION;
+    header.samples_per_second = input->GetSamplesPerSecond();
+    header.bits_per_sample = input->GetBitsPerSample();
+    header.number_channels = input->GetNumberChannels();
+    header.total_number_samples = input->GetTotalNumberSamples();
+    header.data_size = input->GetDataSize();
+
+    const std::string cache_folder = vt_common::GetUserDataPath() + PCM_CACHE_FOLDER;
+    if(!vt_utils::DoesFileExist(cache_folder))
+        vt_utils::MakeDirectory(cache_folder);
+
+    // Write a temporary file first, so that an interrupted write never leaves a truncated cache file.
+    const std::string cache_filename = _GetPcmCacheFilename(filename);
+    const std::string temp_filename = cache_filename + "."
+                                      + vt_utils::NumberToString(_pcm_cache_temp_count++) + ".tmp";
+    {
+        std::ofstream file(temp_filename.c_str(), std::ios::binary | std::ios::trunc);
+        if(!file.is_open()) {
+            IF_PRINT_WARNING(AUDIO_DEBUG) << "couldn't write the decoded sound cache: " << temp_filename << std::endl;
+            return;
+        }
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char *>(data), header.data_size);
+        if(!file.good()) {
+            file.close();
+            std::remove(temp_filename.c_str());
+            return;
+        }
+    }
+
+    // Renaming over an existing file fails on Windows.
+    std::remove(cache_filename.c_str());
+    if(std::rename(temp_filename.c_str(), cache_filename.c_str()) != 0)
+        std::remove(temp_filename.c_str());
+}
+
+} // namespace private_audio
+
+} // namespace vt_audio
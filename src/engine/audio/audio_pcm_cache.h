@@ -0,0 +1,125 @@
+////////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2018 by Bertram (Valyria Tear)
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+////////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file   audio_pcm_cache.h
+*** \author Yohann Ferreira, yohann ferreira orange fr
+*** \brief  Header file for the on-disk cache of decoded sounds
+***
+*** Decoding short Ogg sounds is done once: their PCM data is then saved in the
+*** user data folder and memory-mapped the next times they are loaded.
+*** ***************************************************************************/
+
+#ifndef __AUDIO_PCM_CACHE_HEADER__
+#define __AUDIO_PCM_CACHE_HEADER__
+
+#include "audio_input.h"
+
+#include <vector>
+
+namespace vt_audio
+{
+
+namespace private_audio
+{
+
+//! \brief The user data sub-folder where the decoded sounds are cached.
+const std::string PCM_CACHE_FOLDER = "pcm_cache/";
+
+//! \brief The biggest decoded data size of a cached sound, in bytes: only short sounds are cached.
+const uint32_t PCM_CACHE_MAX_DATA_SIZE = 2 * 1024 * 1024;
+
+/** ****************************************************************************
+*** \brief The header of a cached decoded sound file, followed by the PCM data
+***
+*** The source file modification time and size are used to tell whether the
+*** cached data is still valid. The values are stored in the machine byte order,
+*** since the cache isn't meant to be shared.
+*** ***************************************************************************/
+struct PcmCacheHeader {
+    char magic[4];
+    uint32_t version;
+    int64_t source_modification_time;
+    uint64_t source_size;
+    uint32_t samples_per_second;
+    uint16_t bits_per_sample;
+    uint16_t number_channels;
+    uint32_t total_number_samples;
+    uint32_t data_size;
+};
+
+/** ****************************************************************************
+*** \brief Manages input from a cached decoded sound file
+***
+*** The cache file is memory-mapped when possible, so that loading the sound
+*** only copies its data once into the OpenAL buffer.
+***
+*** \note The filename given by this input is the one of the source file,
+*** so that the descriptors using it behave as if they had decoded the source.
+*** ***************************************************************************/
+class PcmCacheFile : public AudioInput
+{
+public:
+    PcmCacheFile(const std::string &source_filename, const std::string &cache_filename);
+
+    ~PcmCacheFile();
+
+    //! \brief Inherited functions from AudioInput class
+    //@{
+    //! \brief Maps the cache file, and checks it is valid against the source file.
+    bool Initialize();
+
+    void Seek(uint32_t sample_position);
+
+    uint32_t Read(uint8_t *data_buffer, uint32_t number_samples, bool &end);
+    //@}
+
+private:
+    //! \brief The name of the cache file
+    std::string _cache_filename;
+
+    //! \brief The cache file content, header included
+    const uint8_t *_file_data;
+
+    //! \brief The size of the cache file content, in bytes
+    size_t _file_size;
+
+#ifdef _WIN32
+    //! \brief The cache file content, read in memory since it isn't mapped on Windows
+    std::vector<uint8_t> _file_buffer;
+#endif
+
+    //! \brief The PCM data, just after the header
+    const uint8_t *_audio_data;
+
+    //! \brief Position in the data where the next read operation will be performed, in samples
+    uint32_t _data_position;
+
+    //! \brief Unmaps the cache file
+    void _Close();
+}; // class PcmCacheFile : public AudioInput
+
+/** \brief Opens the cached decoded data of a sound file, if valid
+*** \return The initialized input, or nullptr if the file isn't cached or its cache is outdated
+**/
+AudioInput *OpenPcmCacheFile(const std::string &filename);
+
+/** \brief Saves the decoded data of a short Ogg sound file in the cache
+*** \param input The input the data was decoded from
+*** \param data The whole decoded data, of input->GetDataSize() bytes
+***
+*** Other files, such as wav files which don't need decoding, aren't cached.
+**/
+void SavePcmCacheFile(const AudioInput *input, const uint8_t *data);
+
+} // namespace private_audio
+
+} // namespace vt_audio
+
+#endif // __AUDIO_PCM_CACHE_HEADER__
@@ -0,0 +1,204 @@
+////////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2018 by Bertram (Valyria Tear)
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+////////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file   audio_preloader.cpp
+*** \author Yohann Ferreira, yohann ferreira orange fr
+*** \brief  Implementation of the background audio preloader
+*** ***************************************************************************/
+
+#include "audio_preloader.h"
+
+#include "audio_input.h"
+#include "audio_pcm_cache.h"
+
+#include "utils/utils_common.h"
+
+namespace vt_audio
+{
+
+extern bool AUDIO_DEBUG;
+
+namespace private_audio
+{
+
+void AudioPreloader::Shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if(!_running)
+            return;
+        _running = false;
+    }
+    _condition.notify_all();
+    _thread.join();
+
+    for(uint32_t i = 0; i < _files.size(); ++i)
+        _Delete(_files[i]);
+    _files.clear();
+}
+
+void AudioPreloader::Preload(const std::vector<std::string> &filenames, bool decode, bool use_pcm_cache)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    for(uint32_t i = 0; i < filenames.size(); ++i) {
+        // Don't prepare a file twice
+        bool queued = false;
+        for(uint32_t j = 0; j < _files.size(); ++j) {
+            if(_files[j]->filename == filenames[i] && _files[j]->decode == decode) {
+                queued = true;
+                break;
+            }
+        }
+        if(queued)
+            continue;
+
+        PreloadedAudio *file = new PreloadedAudio();
+        file->filename = filenames[i];
+        file->decode = decode;
+        file->use_pcm_cache = decode && use_pcm_cache;
+        file->ready = false;
+        file->discarded = false;
+        file->input = nullptr;
+        _files.push_back(file);
+    }
+
+    if(!_running) {
+        _running = true;
+        _thread = std::thread(&AudioPreloader::_Run, this);
+    }
+    _condition.notify_all();
+}
+
+AudioInput *AudioPreloader::TakeInput(const std::string &filename, bool decode, std::vector<uint8_t> &data)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    PreloadedAudio *file = nullptr;
+    for(uint32_t i = 0; i < _files.size(); ++i) {
+        if(_files[i]->filename == filename && _files[i]->decode == decode) {
+            file = _files[i];
+            break;
+        }
+    }
+    if(file == nullptr)
+        return nullptr;
+
+    // The file is about to be prepared anyway, so waiting for it is faster than starting over.
+    while(!file->ready)
+        _condition.wait(lock);
+
+    for(std::vector<PreloadedAudio *>::iterator it = _files.begin(); it != _files.end(); ++it) {
+        if(*it == file) {
+            _files.erase(it);
+            break;
+        }
+    }
+
+    AudioInput *input = file->input;
+    data.swap(file->data);
+    file->input = nullptr;
+    _Delete(file);
+    return input;
+}
+
+void AudioPreloader::Clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    for(uint32_t i = 0; i < _files.size(); ++i) {
+        // The file being prepared is freed by the thread once done
+        if(_files[i] == _current)
+            _current->discarded = true;
+        else
+            _Delete(_files[i]);
+    }
+    _files.clear();
+}
+
+uint32_t AudioPreloader::GetNumberPreloaded()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _files.size();
+}
+
+void AudioPreloader::_Run()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while(_running) {
+        // Prepare the files in queuing order
+        PreloadedAudio *file = nullptr;
+        for(uint32_t i = 0; i < _files.size(); ++i) {
+            if(!_files[i]->ready) {
+                file = _files[i];
+                break;
+            }
+        }
+        if(file == nullptr) {
+            _condition.wait(lock);
+            continue;
+        }
+
+        _current = file;
+        lock.unlock();
+        _Prepare(file);
+        lock.lock();
+        _current = nullptr;
+
+        file->ready = true;
+        if(file->discarded)
+            _Delete(file);
+        _condition.notify_all();
+    }
+}
+
+void AudioPreloader::_Prepare(PreloadedAudio *file)
+{
+    // The cached data is mapped and ready to be read.
+    AudioInput *input = file->use_pcm_cache ? OpenPcmCacheFile(file->filename) : nullptr;
+    const bool cached = (input != nullptr);
+
+    if(input == nullptr)
+        input = CreateAudioInput(file->filename);
+    if(input == nullptr)
+        return;
+
+    if(!cached && !input->Initialize()) {
+        IF_PRINT_WARNING(AUDIO_DEBUG) << "failed to preload audio file: " << file->filename << std::endl;
+        delete input;
+        return;
+    }
+
+    if(file->decode) {
+        file->data.resize(input->GetDataSize());
+        bool all_data_read = false;
+        if(file->data.empty() || input->Read(&file->data[0], input->GetTotalNumberSamples(), all_data_read) != input->GetTotalNumberSamples()) {
+            IF_PRINT_WARNING(AUDIO_DEBUG) << "failed to decode preloaded audio file: " << file->filename << std::endl;
+            file->data.clear();
+            delete input;
+            return;
+        }
+
+        if(file->use_pcm_cache && !cached)
+            SavePcmCacheFile(input, &file->data[0]);
+    }
+
+    file->input = input;
+}
+
+void AudioPreloader::_Delete(PreloadedAudio *file)
+{
+    delete file->input;
+    delete file;
+}
+
+} // namespace private_audio
+
+} // namespace vt_audio
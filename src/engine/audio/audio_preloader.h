@@ -0,0 +1,137 @@
+////////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2018 by Bertram (Valyria Tear)
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+////////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file   audio_preloader.h
+*** \author Yohann Ferreira, yohann ferreira orange fr
+*** \brief  Header file for the background audio preloader
+***
+*** The preloader opens, and decodes when relevant, audio files on a background
+*** thread before they are actually loaded, e.g. during a map transition fade.
+*** ***************************************************************************/
+
+#ifndef __AUDIO_PRELOADER_HEADER__
+#define __AUDIO_PRELOADER_HEADER__
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace vt_audio
+{
+
+namespace private_audio
+{
+
+class AudioInput;
+
+/** ****************************************************************************
+*** \brief Prepares audio inputs on a background thread
+***
+*** Each preloaded file is opened and initialized by the preloader thread. Files
+*** meant to be loaded statically are fully decoded as well. The audio descriptors
+*** loading those files then take the prepared input over instead of doing the work.
+***
+*** \note The preloader thread doesn't use OpenAL: filling the buffers is still
+*** done by the descriptors, on the main thread.
+*** ***************************************************************************/
+class AudioPreloader
+{
+public:
+    AudioPreloader():
+        _running(false),
+        _current(nullptr)
+    {}
+
+    ~AudioPreloader() {
+        Shutdown();
+    }
+
+    //! \brief Stops the preloader thread and discards every prepared file.
+    void Shutdown();
+
+    /** \brief Queues files to prepare
+    *** \param filenames The files to prepare
+    *** \param decode Whether the files are meant to be loaded statically and should be decoded
+    *** \param use_pcm_cache Whether the decoded data is read from and saved to the on-disk cache
+    **/
+    void Preload(const std::vector<std::string> &filenames, bool decode, bool use_pcm_cache = false);
+
+    /** \brief Takes over the input prepared for a file, waiting for it when still in preparation
+    *** \param filename The audio file to get the input of
+    *** \param decode Whether the file is loaded statically, and the decoded data is wanted
+    *** \param data Receives the decoded data, when the file is loaded statically
+    *** \return The initialized input, or nullptr if the file wasn't preloaded or couldn't be prepared
+    **/
+    AudioInput *TakeInput(const std::string &filename, bool decode, std::vector<uint8_t> &data);
+
+    //! \brief Discards the prepared files which weren't taken.
+    void Clear();
+
+    //! \brief Returns the number of files waiting for preparation or to be taken.
+    uint32_t GetNumberPreloaded();
+
+private:
+    //! \brief A file being or having been prepared
+    struct PreloadedAudio {
+        std::string filename;
+
+        //! \brief Whether the file data should be decoded
+        bool decode;
+
+        //! \brief Whether the decoded data can come from, and go to, the on-disk cache
+        bool use_pcm_cache;
+
+        //! \brief Whether the preparation is done
+        bool ready;
+
+        //! \brief Whether the file was discarded while the thread was preparing it
+        bool discarded;
+
+        //! \brief The prepared input, or nullptr if the preparation failed
+        AudioInput *input;
+
+        //! \brief The decoded data, when requested
+        std::vector<uint8_t> data;
+    };
+
+    std::mutex _mutex;
+
+    //! \brief Signaled when a file is queued or prepared
+    std::condition_variable _condition;
+
+    std::thread _thread;
+
+    //! \brief Protected by the mutex
+    bool _running;
+
+    //! \brief The files to prepare and the ones prepared, in queuing order. Protected by the mutex.
+    std::vector<PreloadedAudio *> _files;
+
+    //! \brief The file the thread is preparing, if any. Protected by the mutex.
+    PreloadedAudio *_current;
+
+    //! \brief The preloader thread loop.
+    void _Run();
+
+    //! \brief Opens and possibly decodes a file. Called without holding the mutex.
+    static void _Prepare(PreloadedAudio *file);
+
+    //! \brief Frees a file which isn't referenced anymore.
+    static void _Delete(PreloadedAudio *file);
+};
+
+} // namespace private_audio
+
+} // namespace vt_audio
+
+#endif // __AUDIO_PRELOADER_HEADER__
@@ -0,0 +1,299 @@
+////////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2018 by Bertram (Valyria Tear)
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+////////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file   audio_stream_thread.cpp
+*** \author Yohann Ferreira, yohann ferreira orange fr
+*** \brief  Implementation of the audio streaming thread
+*** ***************************************************************************/
+
+#include "audio_stream_thread.h"
+
+#include "audio.h"
+#include "audio_mixer.h"
+
+#include "utils/utils_common.h"
+
+#include <chrono>
+
+namespace vt_audio
+{
+
+namespace private_audio
+{
+
+//! \brief The time the streaming thread sleeps between two updates, in milliseconds.
+//! The streaming buffers hold several hundreds of milliseconds, so this is plenty.
+const uint32_t STREAM_THREAD_UPDATE_INTERVAL = 5;
+
+void AudioStreamThread::Initialize()
+{
+    if(_running)
+        return;
+
+    _running = true;
+    _thread = std::thread(&AudioStreamThread::_Run, this);
+}
+
+void AudioStreamThread::Shutdown()
+{
+    if(!_running)
+        return;
+
+    _running = false;
+    _Wake();
+    _thread.join();
+
+    // The remaining streams are given back to their descriptors.
+    StreamCommand command;
+    while(_commands.Pop(command)) {
+        if(command.type == STREAM_DETACH || command.type == STREAM_ATTACH)
+            command.descriptor->_stream_attached = false;
+    }
+    for(uint32_t i = 0; i < _streams.size(); ++i) {
+        alSourceStop(_streams[i].source);
+        alSourcei(_streams[i].source, AL_BUFFER, 0);
+        _streams[i].descriptor->_stream_attached = false;
+    }
+    _streams.clear();
+}
+
+void AudioStreamThread::AttachStream(AudioDescriptor* descriptor)
+{
+    if(!_running) {
+        IF_PRINT_WARNING(AUDIO_DEBUG) << "the streaming thread isn't running" << std::endl;
+        return;
+    }
+
+    descriptor->_stream_attached = true;
+    SendCommand(STREAM_ATTACH, descriptor);
+}
+
+void AudioStreamThread::DetachStream(AudioDescriptor* descriptor)
+{
+    if(!descriptor->_stream_attached)
+        return;
+
+    if(!_running) {
+        descriptor->_stream_attached = false;
+        return;
+    }
+
+    SendCommand(STREAM_DETACH, descriptor);
+
+    // The stream data can't be freed before the thread is done with it,
+    // so have it process the command now rather than at its next update.
+    _Wake();
+    std::unique_lock<std::mutex> lock(_wake_mutex);
+    _detached_condition.wait(lock, [descriptor]() {
+        return !descriptor->_stream_attached.load(std::memory_order_acquire);
+    });
+}
+
+void AudioStreamThread::SendCommand(STREAM_COMMAND type, AudioDescriptor* descriptor,
+                                    uint32_t value, uint32_t sample)
+{
+    StreamCommand command;
+    command.type = type;
+    command.descriptor = descriptor;
+    command.value = value;
+    command.sample = sample;
+
+    // Commands can't be dropped, so wait for the thread to make room if ever needed.
+    while(!_commands.Push(command))
+        std::this_thread::yield();
+}
+
+void AudioStreamThread::_Run()
+{
+    StreamCommand command;
+    while(_running.load()) {
+        while(_commands.Pop(command))
+            _ProcessCommand(command);
+
+        for(uint32_t i = 0; i < _streams.size(); ++i) {
+            if(_streams[i].playing)
+                _UpdateStream(_streams[i]);
+        }
+
+        if(_mixer != nullptr)
+            _mixer->Update();
+
+        std::unique_lock<std::mutex> lock(_wake_mutex);
+        _wake_condition.wait_for(lock, std::chrono::milliseconds(STREAM_THREAD_UPDATE_INTERVAL),
+                                 [this]() { return _wake_requested; });
+        _wake_requested = false;
+    }
+}
+
+void AudioStreamThread::_Wake()
+{
+    std::lock_guard<std::mutex> lock(_wake_mutex);
+    _wake_requested = true;
+    _wake_condition.notify_one();
+}
+
+void AudioStreamThread::_ProcessCommand(const StreamCommand& command)
+{
+    AudioDescriptor* descriptor = command.descriptor;
+
+    if(command.type == STREAM_ATTACH) {
+        if(_FindStream(descriptor) != nullptr)
+            return;
+
+        StreamSlot slot;
+        slot.descriptor = descriptor;
+        slot.source = descriptor->_source->source;
+        slot.play_id = 0;
+        slot.playing = false;
+        _streams.push_back(slot);
+        _PrepareStream(_streams.back());
+        return;
+    }
+
+    StreamSlot* slot = _FindStream(descriptor);
+    if(slot == nullptr) {
+        IF_PRINT_WARNING(AUDIO_DEBUG) << "command received for a stream which isn't attached" << std::endl;
+        return;
+    }
+
+    switch(command.type) {
+    case STREAM_DETACH:
+        alSourceStop(slot->source);
+        alSourcei(slot->source, AL_BUFFER, 0);
+        _streams.erase(_streams.begin() + (slot - &_streams[0]));
+        // Tells the main thread it can free the stream.
+        {
+            std::lock_guard<std::mutex> lock(_wake_mutex);
+            descriptor->_stream_attached.store(false, std::memory_order_release);
+        }
+        _detached_condition.notify_all();
+        break;
+    case STREAM_PLAY:
+        slot->play_id = command.value;
+        // Restart from the last seeked position when the stream already ended.
+        if(descriptor->_stream->GetEndOfStream()) {
+            descriptor->_stream->Seek(command.sample);
+            _PrepareStream(*slot);
+        }
+        alSourcePlay(slot->source);
+        slot->playing = true;
+        break;
+    case STREAM_STOP:
+        alSourceStop(slot->source);
+        slot->playing = false;
+        break;
+    case STREAM_PAUSE:
+        alSourcePause(slot->source);
+        slot->playing = false;
+        break;
+    case STREAM_SEEK:
+        descriptor->_stream->Seek(command.sample);
+        _PrepareStream(*slot);
+        break;
+    case STREAM_SET_LOOPING:
+        descriptor->_stream->SetLooping(command.value != 0);
+        break;
+    case STREAM_SET_LOOP_START:
+        descriptor->_stream->SetLoopStart(command.value);
+        break;
+    case STREAM_SET_LOOP_END:
+        descriptor->_stream->SetLoopEnd(command.value);
+        break;
+    default:
+        break;
+    }
+
+    ALenum error = alGetError();
+    if(error != AL_NO_ERROR)
+        IF_PRINT_WARNING(AUDIO_DEBUG) << "OpenAL error while processing a stream command: " << error << std::endl;
+}
+
+void AudioStreamThread::_UpdateStream(StreamSlot& slot)
+{
+    AudioDescriptor* descriptor = slot.descriptor;
+    AudioInput* input = descriptor->_input;
+
+    // Refill every buffer which finished playing.
+    ALint buffers_processed = 0;
+    alGetSourcei(slot.source, AL_BUFFERS_PROCESSED, &buffers_processed);
+    for(; buffers_processed > 0; --buffers_processed) {
+        ALuint buffer_finished;
+        alSourceUnqueueBuffers(slot.source, 1, &buffer_finished);
+
+        uint32_t size = descriptor->_stream->FillBuffer(descriptor->_data, descriptor->_stream_buffer_size);
+        if(size > 0) {  // Make sure that there is data available to fill
+            alBufferData(buffer_finished, descriptor->_format, descriptor->_data,
+                         size * input->GetSampleSize(), input->GetSamplesPerSecond());
+            alSourceQueueBuffers(slot.source, 1, &buffer_finished);
+        }
+    }
+    descriptor->_stream_position = descriptor->_stream->GetCurrentSamplePosition();
+
+    // The stream ended once every remaining buffer has been played.
+    ALint queued = 0;
+    alGetSourcei(slot.source, AL_BUFFERS_QUEUED, &queued);
+    if(queued == 0) {
+        slot.playing = false;
+        descriptor->_stream_ended_id = slot.play_id;
+        return;
+    }
+
+    // If the source ran out of buffers before they could be refilled, restart it.
+    ALint state;
+    alGetSourcei(slot.source, AL_SOURCE_STATE, &state);
+    if(state != AL_PLAYING) {
+        alSourcePlay(slot.source);
+        ++_number_underruns;
+    }
+
+    ALenum error = alGetError();
+    if(error != AL_NO_ERROR)
+        IF_PRINT_WARNING(AUDIO_DEBUG) << "OpenAL error while updating a stream: " << error << std::endl;
+}
+
+void AudioStreamThread::_PrepareStream(StreamSlot& slot)
+{
+    AudioDescriptor* descriptor = slot.descriptor;
+    AudioInput* input = descriptor->_input;
+
+    ALint state;
+    alGetSourcei(slot.source, AL_SOURCE_STATE, &state);
+
+    // Stop the audio if it is playing and detach the buffers from the source
+    alSourceStop(slot.source);
+    alSourcei(slot.source, AL_BUFFER, 0);
+
+    // Fill each buffer with audio data
+    for(uint32_t i = 0; i < NUMBER_STREAMING_BUFFERS; ++i) {
+        uint32_t read = descriptor->_stream->FillBuffer(descriptor->_data, descriptor->_stream_buffer_size);
+        if(read > 0) {
+            descriptor->_buffer[i].FillBuffer(descriptor->_data, descriptor->_format,
+                                              read * input->GetSampleSize(), input->GetSamplesPerSecond());
+            alSourceQueueBuffers(slot.source, 1, &descriptor->_buffer[i].buffer);
+        }
+    }
+    descriptor->_stream_position = descriptor->_stream->GetCurrentSamplePosition();
+
+    if(state == AL_PLAYING)
+        alSourcePlay(slot.source);
+}
+
+AudioStreamThread::StreamSlot* AudioStreamThread::_FindStream(AudioDescriptor* descriptor)
+{
+    for(uint32_t i = 0; i < _streams.size(); ++i) {
+        if(_streams[i].descriptor == descriptor)
+            return &_streams[i];
+    }
+    return nullptr;
+}
+
+} // namespace private_audio
+
+} // namespace vt_audio
@@ -0,0 +1,232 @@
+////////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2018 by Bertram (Valyria Tear)
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+////////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file   audio_stream_thread.h
+*** \author Yohann Ferreira, yohann ferreira orange fr
+*** \brief  Header file for the audio streaming thread
+***
+*** The streaming thread decodes the streamed audio and keeps the OpenAL buffer
+*** queues of their sources filled, independently of the main loop frame rate.
+*** ***************************************************************************/
+
+#ifndef __AUDIO_STREAM_THREAD_HEADER__
+#define __AUDIO_STREAM_THREAD_HEADER__
+
+// OpenAL includes
+#ifdef __APPLE__
+#include <OpenAL/al.h>
+#else
+#include "al.h"
+#endif
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vt_audio
+{
+
+class AudioDescriptor;
+
+namespace private_audio
+{
+
+class AudioMixer;
+
+/** ****************************************************************************
+*** \brief A lock-free single producer, single consumer ring buffer queue
+***
+*** One thread may push items while another one pops them, without any lock.
+*** The queue can hold up to CAPACITY - 1 items.
+*** ***************************************************************************/
+template <typename T, uint32_t CAPACITY>
+class SPSCQueue
+{
+public:
+    SPSCQueue():
+        _head(0),
+        _tail(0)
+    {}
+
+    //! \brief Adds an item to the queue. Only called by the producer thread.
+    //! \return false if the queue was full.
+    bool Push(const T& item) {
+        uint32_t tail = _tail.load(std::memory_order_relaxed);
+        uint32_t next = (tail + 1) % CAPACITY;
+        if(next == _head.load(std::memory_order_acquire))
+            return false;
+
+        _items[tail] = item;
+        _tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    //! \brief Takes the oldest item from the queue. Only called by the consumer thread.
+    //! \return false if the queue was empty.
+    bool Pop(T& item) {
+        uint32_t head = _head.load(std::memory_order_relaxed);
+        if(head == _tail.load(std::memory_order_acquire))
+            return false;
+
+        item = _items[head];
+        _head.store((head + 1) % CAPACITY, std::memory_order_release);
+        return true;
+    }
+
+private:
+    T _items[CAPACITY];
+
+    //! \brief The index of the next item to pop, written by the consumer.
+    std::atomic<uint32_t> _head;
+
+    //! \brief The index of the next item to push, written by the producer.
+    std::atomic<uint32_t> _tail;
+};
+
+//! \brief The commands sent to the streaming thread
+enum STREAM_COMMAND {
+    STREAM_ATTACH,
+    STREAM_DETACH,
+    STREAM_PLAY,
+    STREAM_STOP,
+    STREAM_PAUSE,
+    STREAM_SEEK,
+    STREAM_SET_LOOPING,
+    STREAM_SET_LOOP_START,
+    STREAM_SET_LOOP_END
+};
+
+struct StreamCommand {
+    STREAM_COMMAND type;
+
+    AudioDescriptor* descriptor;
+
+    //! \brief The command parameter: the play id, the looping flag or a loop point.
+    uint32_t value;
+
+    //! \brief The sample position to seek to, when relevant.
+    uint32_t sample;
+};
+
+/** ****************************************************************************
+*** \brief Owns the decoding and buffer queuing of every streamed audio descriptor
+***
+*** Once a streamed audio descriptor acquires a source, it is attached to the
+*** streaming thread which takes ownership of its stream, input data and buffers
+*** until it is detached. The main thread then only sends commands through
+*** a lock-free queue, so that a long frame can't starve the buffer queues.
+***
+*** \note Only the main thread may call the public functions of this class.
+*** ***************************************************************************/
+class AudioStreamThread
+{
+public:
+    AudioStreamThread():
+        _running(false),
+        _wake_requested(false),
+        _number_underruns(0),
+        _mixer(nullptr)
+    {}
+
+    ~AudioStreamThread() {
+        Shutdown();
+    }
+
+    //! \brief Starts the streaming thread.
+    void Initialize();
+
+    //! \brief Sets the software mixer updated by the thread. Must be called before Initialize().
+    void SetMixer(AudioMixer* mixer) {
+        _mixer = mixer;
+    }
+
+    //! \brief Stops the streaming thread. The streams left attached are released.
+    void Shutdown();
+
+    //! \brief Hands the stream of the descriptor to the thread. The descriptor must own a source.
+    void AttachStream(AudioDescriptor* descriptor);
+
+    //! \brief Takes back the stream of the descriptor, waiting for the thread to release it.
+    void DetachStream(AudioDescriptor* descriptor);
+
+    //! \brief Sends a command about an attached stream to the thread.
+    void SendCommand(STREAM_COMMAND type, AudioDescriptor* descriptor,
+                     uint32_t value = 0, uint32_t sample = 0);
+
+    //! \brief Returns the number of times a stream source ran out of buffers and had to be restarted.
+    uint32_t GetNumberUnderruns() const {
+        return _number_underruns.load();
+    }
+
+private:
+    //! \brief The data kept by the thread about an attached stream.
+    struct StreamSlot {
+        AudioDescriptor* descriptor;
+
+        ALuint source;
+
+        //! \brief The id of the latest play command, reported when the stream ends.
+        uint32_t play_id;
+
+        //! \brief Whether the stream buffers should be refilled.
+        bool playing;
+    };
+
+    //! \brief The thread commands queue.
+    SPSCQueue<StreamCommand, 256> _commands;
+
+    std::thread _thread;
+
+    std::atomic<bool> _running;
+
+    /** \brief Wakes the thread up before the end of its update interval, and tells the
+    *** main thread a stream was detached. The commands themselves don't take it.
+    **/
+    //@{
+    std::mutex _wake_mutex;
+    std::condition_variable _wake_condition;
+    std::condition_variable _detached_condition;
+    bool _wake_requested;
+    //@}
+
+    //! \brief Incremented by the streaming thread, read by the main thread.
+    std::atomic<uint32_t> _number_underruns;
+
+    //! \brief The attached streams. Only accessed by the streaming thread.
+    std::vector<StreamSlot> _streams;
+
+    //! \brief The software mixer, if any, which buffers are filled along with the streams.
+    AudioMixer* _mixer;
+
+    //! \brief The streaming thread loop.
+    void _Run();
+
+    //! \brief Has the thread process the pending commands without waiting for its next update.
+    void _Wake();
+
+    void _ProcessCommand(const StreamCommand& command);
+
+    //! \brief Refills the processed buffers of a playing stream and restarts it after an underrun.
+    void _UpdateStream(StreamSlot& slot);
+
+    //! \brief Unqueues every buffer of the stream source and fills them again from the stream position.
+    void _PrepareStream(StreamSlot& slot);
+
+    StreamSlot* _FindStream(AudioDescriptor* descriptor);
+};
+
+} // namespace private_audio
+
+} // namespace vt_audio
+
+#endif // __AUDIO_STREAM_THREAD_HEADER__
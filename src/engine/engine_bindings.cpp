@@ -99,6 +99,17 @@ void BindEngineCode()
             .def("CreateText", (vt_video::TextImage*(ScriptSupervisor:: *)(const std::string&, const vt_video::TextStyle&))&ScriptSupervisor::CreateText)
             .def("CreateText", (vt_video::TextImage*(ScriptSupervisor:: *)(const vt_utils::ustring&, const vt_video::TextStyle&))&ScriptSupervisor::CreateText)
             .def("SetDrawFlag", &ScriptSupervisor::SetDrawFlag)
+            .def("AddRetainedDraw", &ScriptSupervisor::AddRetainedDraw)
+            .def("ClearRetainedDraws", &ScriptSupervisor::ClearRetainedDraws)
+            .def("NotifyEvent", &ScriptSupervisor::NotifyEvent)
+
+            // Namespace constants
+            .enum_("constants") [
+                // Retained draw layers
+                luabind::value("SCRIPT_DRAW_BACKGROUND", SCRIPT_DRAW_BACKGROUND),
+                luabind::value("SCRIPT_DRAW_FOREGROUND", SCRIPT_DRAW_FOREGROUND),
+                luabind::value("SCRIPT_DRAW_POST_EFFECTS", SCRIPT_DRAW_POST_EFFECTS)
+            ]
         ];
 
         luabind::module(vt_script::ScriptManager->GetGlobalState(), "vt_mode_manager")
@@ -20,6 +20,7 @@
 #include "engine/video/video.h"
 #include "script/script_read.h"
 #include "engine/mode_manager.h"
+#include "engine/script_profiler.h"
 #include "engine/system.h"
 
 #include "modes/mode_help_window.h"
@@ -337,6 +338,18 @@ void InputEngine::_KeyEventHandler(SDL_KeyboardEvent &key_event)
                 // Display and cycle through the texture sheets
                 TextureManager->DEBUG_NextTexSheet();
                 return;
+            } else if(key_event.keysym.sym == SDLK_p) {
+                // Toggle the scripts profiling, and save its results once done
+                if(ScriptProfilerManager->IsEnabled()) {
+                    ScriptProfilerManager->SetEnabled(false);
+                    std::string path = GetUserDataPath() + SCRIPT_PROFILE_FILENAME;
+                    if(ScriptProfilerManager->SaveCSV(path))
+                        std::cout << "Scripts profile saved in: " << path << std::endl;
+                } else {
+                    ScriptProfilerManager->Reset();
+                    ScriptProfilerManager->SetEnabled(true);
+                }
+                return;
             }
 #endif
 
@@ -18,6 +18,7 @@
 #include "mode_manager.h"
 
 #include "system.h"
+#include "script_gc.h"
 
 #include "engine/video/video.h"
 #include "engine/audio/audio.h"
@@ -300,6 +301,9 @@ void ModeEngine::Update()
             _push_stack.pop_back();
         }
 
+        // Collect the scripts garbage of the previous modes while the screen is faded out.
+        vt_script::ScriptGCManager->FullCollect();
+
         // Make sure there is a game mode on the stack,
         // otherwise we'll get a segmentation fault.
         if(_game_stack.empty()) {
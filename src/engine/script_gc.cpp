@@ -0,0 +1,103 @@
+////////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2018 by Bertram (Valyria Tear)
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+////////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file   script_gc.cpp
+*** \author Yohann Ferreira, yohann ferreira orange fr
+*** \brief  Implementation of the frame-budgeted Lua garbage collection
+*** ***************************************************************************/
+
+#include "engine/script_gc.h"
+
+#include "script/script.h"
+
+#include "utils/utils_common.h"
+
+#include <algorithm>
+
+namespace vt_script
+{
+
+ScriptGarbageCollector *ScriptGCManager = nullptr;
+
+ScriptGarbageCollector::ScriptGarbageCollector() :
+    _lua_state(nullptr),
+    _frame_time(0.0f),
+    _number_cycles(0),
+    _collecting(false),
+    _cycle_end_heap_size(0)
+{}
+
+bool ScriptGarbageCollector::SingletonInitialize()
+{
+    if(ScriptManager == nullptr || ScriptManager->GetGlobalState() == nullptr) {
+        PRINT_ERROR << "The script engine must be initialized first" << std::endl;
+        return false;
+    }
+    _lua_state = ScriptManager->GetGlobalState();
+
+    // The automatic collection is kept as a safety net, behind the frame steps.
+    lua_gc(_lua_state, LUA_GCSETPAUSE, SCRIPT_GC_PAUSE);
+    lua_gc(_lua_state, LUA_GCSETSTEPMUL, SCRIPT_GC_STEP_MULTIPLIER);
+    _cycle_end_heap_size = GetHeapSize();
+    return true;
+}
+
+void ScriptGarbageCollector::Step(uint32_t deadline)
+{
+    _frame_time = 0.0f;
+    if(_lua_state == nullptr)
+        return;
+
+    if(!_collecting) {
+        if(GetHeapSize() < _cycle_end_heap_size + SCRIPT_GC_HEAP_GROWTH)
+            return;
+        _collecting = true;
+    }
+
+    const uint64_t frequency = SDL_GetPerformanceFrequency();
+    const uint64_t start = SDL_GetPerformanceCounter();
+    const uint32_t now = SDL_GetTicks();
+    const uint32_t idle_time = deadline > now + SCRIPT_GC_IDLE_MARGIN ? deadline - now - SCRIPT_GC_IDLE_MARGIN : 0;
+    const uint64_t budget = std::min(idle_time, SCRIPT_GC_MAX_FRAME_TIME) * frequency / 1000;
+
+    // At least one step is done, even without idle time.
+    do {
+        if(lua_gc(_lua_state, LUA_GCSTEP, SCRIPT_GC_STEP_SIZE) != 0) {
+            ++_number_cycles;
+            _collecting = false;
+            _cycle_end_heap_size = GetHeapSize();
+            break;
+        }
+    } while(SDL_GetPerformanceCounter() - start < budget);
+
+    _frame_time = static_cast<float>(SDL_GetPerformanceCounter() - start) * 1000.0f / frequency;
+}
+
+void ScriptGarbageCollector::FullCollect()
+{
+    if(_lua_state == nullptr)
+        return;
+
+    lua_gc(_lua_state, LUA_GCCOLLECT, 0);
+    ++_number_cycles;
+    _collecting = false;
+    _cycle_end_heap_size = GetHeapSize();
+}
+
+uint32_t ScriptGarbageCollector::GetHeapSize() const
+{
+    if(_lua_state == nullptr)
+        return 0;
+
+    return static_cast<uint32_t>(lua_gc(_lua_state, LUA_GCCOUNT, 0)) * 1024
+           + static_cast<uint32_t>(lua_gc(_lua_state, LUA_GCCOUNTB, 0));
+}
+
+} // namespace vt_script
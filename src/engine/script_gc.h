@@ -0,0 +1,114 @@
+////////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2018 by Bertram (Valyria Tear)
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+////////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file   script_gc.h
+*** \author Yohann Ferreira, yohann ferreira orange fr
+*** \brief  Header file for the frame-budgeted Lua garbage collection
+***
+*** The Lua collector is driven by the main loop, in the time left before the
+*** next frame, instead of kicking in whenever the scripts allocate.
+*** ***************************************************************************/
+
+#ifndef __SCRIPT_GC_HEADER__
+#define __SCRIPT_GC_HEADER__
+
+#include "utils/singleton.h"
+
+#include <cstdint>
+
+struct lua_State;
+
+namespace vt_script
+{
+
+class ScriptGarbageCollector;
+
+//! \brief The singleton pointer of the Lua garbage collection control.
+extern ScriptGarbageCollector *ScriptGCManager;
+
+//! \brief The amount of work done by each collection step, as given to lua_gc(LUA_GCSTEP)
+const int32_t SCRIPT_GC_STEP_SIZE = 8;
+
+//! \brief The idle time kept free before the next frame, in milliseconds
+const uint32_t SCRIPT_GC_IDLE_MARGIN = 1;
+
+//! \brief The most time spent collecting in a frame, in milliseconds
+const uint32_t SCRIPT_GC_MAX_FRAME_TIME = 2;
+
+//! \brief The heap growth since the end of the last cycle which starts a new one, in bytes
+const uint32_t SCRIPT_GC_HEAP_GROWTH = 512 * 1024;
+
+/** \brief The automatic collection settings, as given to lua_gc(LUA_GCSETPAUSE) and lua_gc(LUA_GCSETSTEPMUL)
+*** The automatic collection only waits longer than the frame steps do, so that it
+*** only kicks in when the scripts allocate faster than the idle time can collect.
+**/
+//@{
+const int32_t SCRIPT_GC_PAUSE = 400;
+const int32_t SCRIPT_GC_STEP_MULTIPLIER = 200;
+//@}
+
+/** ****************************************************************************
+*** \brief Runs the Lua garbage collection in the idle time of each frame
+***
+*** A collection cycle is started once the heap has grown by SCRIPT_GC_HEAP_GROWTH
+*** since the last one ended, and then done in small incremental steps between
+*** two frames, for at most SCRIPT_GC_MAX_FRAME_TIME per frame. At least one step
+*** is done every frame during a cycle, so that it ends on slow machines too.
+*** A full collection is only done when changing game modes, behind the fade.
+*** ***************************************************************************/
+class ScriptGarbageCollector : public vt_utils::Singleton<ScriptGarbageCollector>
+{
+    friend class vt_utils::Singleton<ScriptGarbageCollector>;
+
+public:
+    //! \brief Takes control of the collector of the global Lua state. The script engine must be initialized.
+    bool SingletonInitialize();
+
+    /** \brief Runs collection steps until the deadline, when a cycle is due
+    *** \param deadline The tick at which the next frame starts, in milliseconds
+    **/
+    void Step(uint32_t deadline);
+
+    //! \brief Runs a full collection cycle.
+    void FullCollect();
+
+    //! \brief Returns the memory used by Lua, in bytes.
+    uint32_t GetHeapSize() const;
+
+    //! \brief Returns the time spent collecting during the last frame, in milliseconds.
+    float GetFrameTime() const {
+        return _frame_time;
+    }
+
+    //! \brief Returns the number of collection cycles completed.
+    uint32_t GetNumberCycles() const {
+        return _number_cycles;
+    }
+
+private:
+    ScriptGarbageCollector();
+
+    //! \brief The global Lua state, once controlled
+    lua_State *_lua_state;
+
+    float _frame_time;
+
+    uint32_t _number_cycles;
+
+    //! \brief Whether a collection cycle was started and isn't over yet
+    bool _collecting;
+
+    //! \brief The heap size when the last cycle ended, in bytes
+    uint32_t _cycle_end_heap_size;
+};
+
+} // namespace vt_script
+
+#endif // __SCRIPT_GC_HEADER__
@@ -0,0 +1,300 @@
+////////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2018 by Bertram (Valyria Tear)
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+////////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file   script_profiler.cpp
+*** \author Yohann Ferreira, yohann ferreira orange fr
+*** \brief  Implementation of the Lua scripts profiler
+*** ***************************************************************************/
+
+#include "engine/script_profiler.h"
+
+#include "engine/script_gc.h"
+#include "engine/video/video.h"
+
+#include "utils/utils_strings.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+using namespace vt_video;
+using namespace vt_utils;
+
+namespace vt_script
+{
+
+ScriptProfiler *ScriptProfilerManager = nullptr;
+bool SCRIPT_PROFILE = false;
+
+using namespace private_script;
+
+//! \brief The number of functions shown in the overlay
+const uint32_t PROFILER_OVERLAY_ENTRIES = 12;
+
+//! \brief The time between two refreshes of the overlay, in milliseconds
+const uint32_t PROFILER_OVERLAY_UPDATE_TIME = 500;
+
+//! \brief Converts nanoseconds to milliseconds.
+static double _ToMilliseconds(uint64_t nanoseconds)
+{
+    return static_cast<double>(nanoseconds) / 1000000.0;
+}
+
+ScriptProfiler::ScriptProfiler() :
+    _enabled(false),
+    _number_frames(0),
+    _overlay_update_time(0),
+    _overlay_text(nullptr)
+{}
+
+ScriptProfiler::~ScriptProfiler()
+{
+    // The Lua threads unset the hook themselves, on their next call.
+    _enabled = false;
+    delete _overlay_text;
+}
+
+void ScriptProfiler::SetEnabled(bool enabled)
+{
+    if(_enabled == enabled)
+        return;
+
+    _enabled = enabled;
+    // The calls running when the profiling starts or stops aren't measured.
+    for(uint32_t i = 0; i < _stack.size(); ++i)
+        --_entries[_stack[i].entry].depth;
+    _stack.clear();
+}
+
+void ScriptProfiler::Reset()
+{
+    _entries.clear();
+    _call_entries.clear();
+    _function_entries.clear();
+    _stack.clear();
+    _number_frames = 0;
+    _overlay_update_time = 0;
+}
+
+void ScriptProfiler::Update()
+{
+    if(!_enabled)
+        return;
+
+    ++_number_frames;
+
+    uint32_t time = SDL_GetTicks();
+    if(time - _overlay_update_time >= PROFILER_OVERLAY_UPDATE_TIME) {
+        _overlay_update_time = time;
+        _UpdateOverlayText();
+    }
+}
+
+void ScriptProfiler::DrawOverlay()
+{
+    if(!_enabled || _overlay_text == nullptr)
+        return;
+
+    VideoManager->PushState();
+    VideoManager->SetStandardCoordSys();
+    VideoManager->SetDrawFlags(VIDEO_X_LEFT, VIDEO_Y_TOP, VIDEO_X_NOFLIP, VIDEO_Y_NOFLIP, VIDEO_BLEND, 0);
+    VideoManager->Move(10.0f, 10.0f);
+    _overlay_text->Draw();
+    VideoManager->PopState();
+}
+
+bool ScriptProfiler::SaveCSV(const std::string &filename) const
+{
+    std::ofstream file(filename.c_str(), std::ios::trunc);
+    if(!file.is_open()) {
+        PRINT_WARNING << "Couldn't write the script profile: " << filename << std::endl;
+        return false;
+    }
+
+    const double frames = _number_frames > 0 ? static_cast<double>(_number_frames) : 1.0;
+
+    file << "function,calls,inclusive_ms,exclusive_ms,calls_per_frame,inclusive_ms_per_frame,exclusive_ms_per_frame" << std::endl;
+    file << std::fixed << std::setprecision(4);
+    for(uint32_t i = 0; i < _entries.size(); ++i) {
+        const ScriptProfileEntry &entry = _entries[i];
+
+        // The quotes of the name are doubled, as CSV requires.
+        std::string name = entry.name;
+        for(size_t position = name.find('"'); position != std::string::npos; position = name.find('"', position + 2))
+            name.insert(position, 1, '"');
+
+        file << '"' << name << "\"," << entry.calls << ','
+             << _ToMilliseconds(entry.inclusive_time) << ',' << _ToMilliseconds(entry.exclusive_time) << ','
+             << entry.calls / frames << ',' << _ToMilliseconds(entry.inclusive_time) / frames << ','
+             << _ToMilliseconds(entry.exclusive_time) / frames << std::endl;
+    }
+
+    return file.good();
+}
+
+void ScriptProfiler::_BeginCall(lua_State *thread, const std::string &name)
+{
+    if(thread != nullptr && lua_gethook(thread) != _LuaHook)
+        lua_sethook(thread, _LuaHook, LUA_MASKCALL | LUA_MASKRET, 0);
+
+    _PushFrame(_GetCallEntry(name), nullptr);
+}
+
+void ScriptProfiler::_EndCall()
+{
+    // Pop the Lua functions which didn't return, such as the yielded ones.
+    while(!_stack.empty() && _stack.back().thread != nullptr)
+        _PopFrame();
+
+    if(!_stack.empty())
+        _PopFrame();
+}
+
+void ScriptProfiler::_PushFrame(uint32_t entry, lua_State *thread)
+{
+    ProfileFrame frame;
+    frame.entry = entry;
+    frame.thread = thread;
+    frame.children_time = 0;
+
+    ++_entries[entry].calls;
+    ++_entries[entry].depth;
+
+    frame.start_time = ProfileClock::now();
+    _stack.push_back(frame);
+}
+
+void ScriptProfiler::_PopFrame()
+{
+    const ProfileFrame &frame = _stack.back();
+    uint64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(ProfileClock::now() - frame.start_time).count();
+
+    ScriptProfileEntry &entry = _entries[frame.entry];
+    entry.exclusive_time += elapsed > frame.children_time ? elapsed - frame.children_time : 0;
+    // Only the outermost call of a recursive function counts in its inclusive time.
+    if(--entry.depth == 0)
+        entry.inclusive_time += elapsed;
+
+    _stack.pop_back();
+    if(!_stack.empty())
+        _stack.back().children_time += elapsed;
+}
+
+uint32_t ScriptProfiler::_GetCallEntry(const std::string &name)
+{
+    std::unordered_map<std::string, uint32_t>::const_iterator it = _call_entries.find(name);
+    if(it != _call_entries.end())
+        return it->second;
+
+    uint32_t entry = static_cast<uint32_t>(_entries.size());
+    _entries.push_back(ScriptProfileEntry(name));
+    _call_entries[name] = entry;
+    return entry;
+}
+
+void ScriptProfiler::_UpdateOverlayText()
+{
+    if(_overlay_text == nullptr)
+        _overlay_text = new TextImage(std::string(), TextStyle("text14", Color::white));
+
+    std::vector<const ScriptProfileEntry *> entries;
+    for(uint32_t i = 0; i < _entries.size(); ++i)
+        entries.push_back(&_entries[i]);
+    std::sort(entries.begin(), entries.end(), [](const ScriptProfileEntry *a, const ScriptProfileEntry *b) {
+        return a->exclusive_time > b->exclusive_time;
+    });
+    if(entries.size() > PROFILER_OVERLAY_ENTRIES)
+        entries.resize(PROFILER_OVERLAY_ENTRIES);
+
+    const double frames = _number_frames > 0 ? static_cast<double>(_number_frames) : 1.0;
+    std::ostringstream text;
+    text << std::fixed << std::setprecision(3);
+    text << "Lua heap: " << (ScriptGCManager != nullptr ? ScriptGCManager->GetHeapSize() / 1024 : 0)
+         << " KiB, garbage collection: " << (ScriptGCManager != nullptr ? ScriptGCManager->GetFrameTime() : 0.0f)
+         << " ms per frame" << std::endl;
+    text << "Scripts profile (ms per frame, exclusive / inclusive, calls)";
+    for(uint32_t i = 0; i < entries.size(); ++i) {
+        text << std::endl << _ToMilliseconds(entries[i]->exclusive_time) / frames << " / "
+             << _ToMilliseconds(entries[i]->inclusive_time) / frames << " / "
+             << std::setprecision(1) << entries[i]->calls / frames << std::setprecision(3)
+             << "  " << entries[i]->name;
+    }
+
+    _overlay_text->SetText(text.str());
+}
+
+void ScriptProfiler::_LuaHook(lua_State *thread, lua_Debug *debug)
+{
+    ScriptProfiler *profiler = ScriptProfilerManager;
+    if(profiler == nullptr || !profiler->_enabled) {
+        lua_sethook(thread, nullptr, 0, 0);
+        return;
+    }
+
+    // Only the Lua functions called from a measured engine call are measured.
+    std::vector<ProfileFrame> &stack = profiler->_stack;
+    if(stack.empty())
+        return;
+
+    bool call = (debug->event == LUA_HOOKCALL);
+#ifdef LUA_HOOKTAILCALL
+    // The tail called function replaces the calling one, and only returns once.
+    if(debug->event == LUA_HOOKTAILCALL) {
+        if(stack.back().thread == thread)
+            profiler->_PopFrame();
+        call = true;
+    }
+#endif
+
+    if(call) {
+        lua_getinfo(thread, "f", debug);
+        const void *function = lua_topointer(thread, -1);
+        lua_pop(thread, 1);
+
+        uint32_t entry = 0;
+        std::unordered_map<const void *, uint32_t>::const_iterator it = profiler->_function_entries.find(function);
+        if(it != profiler->_function_entries.end()) {
+            entry = it->second;
+        } else {
+            lua_getinfo(thread, "Sn", debug);
+            std::string name = debug->name != nullptr ? debug->name : "?";
+            if(strcmp(debug->what, "C") == 0)
+                name += " [C]";
+            else
+                name += std::string(" (") + debug->short_src + ":" + NumberToString(debug->linedefined) + ")";
+
+            entry = static_cast<uint32_t>(profiler->_entries.size());
+            profiler->_entries.push_back(ScriptProfileEntry(name));
+            profiler->_function_entries[function] = entry;
+        }
+
+        profiler->_PushFrame(entry, thread);
+        return;
+    }
+
+    // A return (or, in Lua 5.1, the end of a tail call): pop the innermost function of this thread.
+    // The functions of other threads above it were left by a coroutine yield.
+    for(uint32_t i = static_cast<uint32_t>(stack.size()); i > 0; --i) {
+        const ProfileFrame &frame = stack[i - 1];
+        // Don't go past the engine call.
+        if(frame.thread == nullptr)
+            return;
+        if(frame.thread != thread)
+            continue;
+
+        while(stack.size() >= i)
+            profiler->_PopFrame();
+        return;
+    }
+}
+
+} // namespace vt_script
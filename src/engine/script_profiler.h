@@ -0,0 +1,233 @@
+////////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2018 by Bertram (Valyria Tear)
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+////////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file   script_profiler.h
+*** \author Yohann Ferreira, yohann ferreira orange fr
+*** \brief  Header file for the Lua scripts profiler
+***
+*** The profiler measures the time spent in the script functions called by the
+*** engine every frame, such as the map and scene scripts update and draw
+*** functions, and in the Lua functions they call in turn.
+*** ***************************************************************************/
+
+#ifndef __SCRIPT_PROFILER_HEADER__
+#define __SCRIPT_PROFILER_HEADER__
+
+#include "script/script_read.h"
+#include "utils/singleton.h"
+
+#include <chrono>
+#include <unordered_map>
+
+struct lua_Debug;
+
+namespace vt_video
+{
+class TextImage;
+}
+
+namespace vt_script
+{
+
+class ScriptProfiler;
+
+//! \brief The singleton pointer of the script profiler.
+extern ScriptProfiler *ScriptProfilerManager;
+
+//! \brief Whether the scripts are profiled from the game start, with the results saved on exit
+extern bool SCRIPT_PROFILE;
+
+//! \brief The file the profiling results are saved to, in the user data folder
+const std::string SCRIPT_PROFILE_FILENAME = "script_profile.csv";
+
+namespace private_script
+{
+
+//! \brief The profiling data of a script function, or of an engine call to a script
+class ScriptProfileEntry
+{
+public:
+    explicit ScriptProfileEntry(const std::string &entry_name) :
+        name(entry_name), calls(0), inclusive_time(0), exclusive_time(0), depth(0) {}
+
+    //! \brief The function name, with its script file and line when known
+    std::string name;
+
+    uint32_t calls;
+
+    //! \brief The time spent in the function, including the functions it called, in nanoseconds
+    uint64_t inclusive_time;
+
+    //! \brief The time spent in the function itself, in nanoseconds
+    uint64_t exclusive_time;
+
+    //! \brief The number of calls of the function currently running, so that recursion isn't counted twice
+    uint32_t depth;
+};
+
+} // namespace private_script
+
+/** ****************************************************************************
+*** \brief Aggregates the time spent in the script functions
+***
+*** The engine calls to the scripts are measured through ScriptProfileScope objects.
+*** While profiling, a Lua hook is also set on the Lua threads called into, so that
+*** every Lua function they run gets measured as well.
+***
+*** The results are shown in the debug overlay and can be saved as CSV.
+***
+*** \note The profiler has a noticeable cost, and is disabled by default.
+*** ***************************************************************************/
+class ScriptProfiler : public vt_utils::Singleton<ScriptProfiler>
+{
+    friend class vt_utils::Singleton<ScriptProfiler>;
+    friend class ScriptProfileScope;
+
+public:
+    ~ScriptProfiler();
+
+    bool SingletonInitialize() {
+        return true;
+    }
+
+    //! \brief Starts or stops profiling. The results are kept until Reset() is called.
+    void SetEnabled(bool enabled);
+
+    bool IsEnabled() const {
+        return _enabled;
+    }
+
+    //! \brief Forgets the profiling results.
+    void Reset();
+
+    //! \brief Counts the frames, and refreshes the overlay text from time to time.
+    void Update();
+
+    //! \brief Draws the most expensive functions, while profiling.
+    void DrawOverlay();
+
+    /** \brief Saves the profiling results, one function per line
+    *** \param filename The CSV file to write
+    *** \return false if the file couldn't be written
+    **/
+    bool SaveCSV(const std::string &filename) const;
+
+private:
+    ScriptProfiler();
+
+    typedef std::chrono::steady_clock ProfileClock;
+
+    //! \brief A function currently running.
+    struct ProfileFrame {
+        //! \brief The index of the function entry
+        uint32_t entry;
+
+        //! \brief The Lua thread running a Lua function, or nullptr for an engine call
+        lua_State *thread;
+
+        ProfileClock::time_point start_time;
+
+        //! \brief The inclusive time of the functions it called, in nanoseconds
+        uint64_t children_time;
+    };
+
+    bool _enabled;
+
+    //! \brief The profiling results.
+    std::vector<private_script::ScriptProfileEntry> _entries;
+
+    //! \brief The entries of the engine calls, indexed by name.
+    std::unordered_map<std::string, uint32_t> _call_entries;
+
+    //! \brief The entries of the Lua functions, indexed by function.
+    std::unordered_map<const void *, uint32_t> _function_entries;
+
+    //! \brief The functions currently running, the innermost last.
+    std::vector<ProfileFrame> _stack;
+
+    //! \brief The number of frames profiled.
+    uint32_t _number_frames;
+
+    //! \brief The time the overlay text was last refreshed, in milliseconds.
+    uint32_t _overlay_update_time;
+
+    vt_video::TextImage *_overlay_text;
+
+    /** \brief Starts measuring an engine call to a script function
+    *** \param thread The Lua thread the function runs in, which gets hooked
+    *** \param name The name of the call
+    **/
+    void _BeginCall(lua_State *thread, const std::string &name);
+
+    //! \brief Stops measuring the latest engine call, and the Lua functions left running in it.
+    void _EndCall();
+
+    void _PushFrame(uint32_t entry, lua_State *thread);
+
+    void _PopFrame();
+
+    //! \brief Returns the index of the entry of an engine call, created if needed.
+    uint32_t _GetCallEntry(const std::string &name);
+
+    //! \brief Updates the overlay text with the most expensive functions.
+    void _UpdateOverlayText();
+
+    //! \brief The Lua hook measuring the Lua function calls.
+    static void _LuaHook(lua_State *thread, lua_Debug *debug);
+};
+
+/** ****************************************************************************
+*** \brief Measures an engine call to a script function, for as long as it exists
+***
+*** It does nothing when the profiler is disabled.
+*** ***************************************************************************/
+class ScriptProfileScope
+{
+public:
+    /** \param function The called script function
+    *** \param name The name of the call, such as the calling function
+    *** \param script The script file the function comes from, if any
+    **/
+    ScriptProfileScope(const luabind::object &function, const char *name,
+                       const std::string &script = std::string()) :
+        _active(ScriptProfilerManager != nullptr && ScriptProfilerManager->IsEnabled())
+    {
+        if(_active)
+            ScriptProfilerManager->_BeginCall(function.interpreter(), script.empty() ? std::string(name) : script + ": " + name);
+    }
+
+    /** \param thread The Lua thread resumed, such as a coroutine created before the profiling started
+    *** \param name The name of the call, such as the calling function
+    *** \param script The script file the thread comes from, if any
+    **/
+    ScriptProfileScope(lua_State *thread, const char *name,
+                       const std::string &script = std::string()) :
+        _active(ScriptProfilerManager != nullptr && ScriptProfilerManager->IsEnabled())
+    {
+        if(_active)
+            ScriptProfilerManager->_BeginCall(thread, script.empty() ? std::string(name) : script + ": " + name);
+    }
+
+    ~ScriptProfileScope() {
+        if(_active)
+            ScriptProfilerManager->_EndCall();
+    }
+
+private:
+    //! \brief Whether the call is measured
+    bool _active;
+
+    ScriptProfileScope(const ScriptProfileScope &);
+    ScriptProfileScope &operator=(const ScriptProfileScope &);
+};
+
+} // namespace vt_script
+
+#endif // __SCRIPT_PROFILER_HEADER__
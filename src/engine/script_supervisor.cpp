@@ -16,6 +16,10 @@
 #include "engine/script_supervisor.h"
 
 #include "engine/mode_manager.h"
+#include "engine/script_profiler.h"
+#include "engine/system.h"
+
+#include <algorithm>
 
 using namespace vt_video;
 using namespace vt_script;
@@ -70,18 +74,20 @@ void ScriptSupervisor::Initialize(vt_mode_manager::GameMode *gm)
 
         _reset_functions.push_back(scene_script->ReadFunctionPointer("Reset"));
         _restart_functions.push_back(scene_script->ReadFunctionPointer("Restart"));
-        _update_functions.push_back(scene_script->ReadFunctionPointer("Update"));
-        _draw_background_functions.push_back(scene_script->ReadFunctionPointer("DrawBackground"));
-        _draw_foreground_functions.push_back(scene_script->ReadFunctionPointer("DrawForeground"));
-        _draw_post_effects_functions.push_back(scene_script->ReadFunctionPointer("DrawPostEffects"));
+        _update_functions.push_back(_ReadUpdateCallback(scene_script));
+        _draw_background_functions.push_back(_ReadDrawFunction(scene_script, "DrawBackground"));
+        _draw_foreground_functions.push_back(_ReadDrawFunction(scene_script, "DrawForeground"));
+        _draw_post_effects_functions.push_back(_ReadDrawFunction(scene_script, "DrawPostEffects"));
 
         // Add the script to the list now it is valid.
         _scene_scripts.push_back(scene_script);
 
         // Trigger the Initialize functions in the loading order.
         luabind::object init_function = scene_script->ReadFunctionPointer("Initialize");
-        if(init_function.is_valid() && gm)
+        if(init_function.is_valid() && gm) {
+            ScriptProfileScope profile(init_function, "Initialize", scene_script->GetFilename());
             luabind::call_function<void>(init_function, gm);
+        }
         else
             PRINT_ERROR << "Couldn't initialize the scene component" << std::endl; // Should never happen
     }
@@ -95,41 +101,191 @@ void ScriptSupervisor::SetDrawFlag(vt_video::VIDEO_DRAW_FLAGS draw_flag)
 void ScriptSupervisor::Reset()
 {
     // Updates custom scripts
-    for(uint32_t i = 0; i < _reset_functions.size(); ++i)
+    for(uint32_t i = 0; i < _reset_functions.size(); ++i) {
+        ScriptProfileScope profile(_reset_functions[i], "Reset", _scene_scripts[i]->GetFilename());
         ReadScriptDescriptor::RunScriptObject(_reset_functions[i]);
+    }
+    NotifyEvent("Reset");
 }
 
 void ScriptSupervisor::Restart()
 {
     // Updates custom scripts
-    for(uint32_t i = 0; i < _restart_functions.size(); ++i)
+    for(uint32_t i = 0; i < _restart_functions.size(); ++i) {
+        ScriptProfileScope profile(_restart_functions[i], "Restart", _scene_scripts[i]->GetFilename());
         ReadScriptDescriptor::RunScriptObject(_restart_functions[i]);
+    }
+    NotifyEvent("Restart");
 }
 
 void ScriptSupervisor::Update()
 {
+    const uint32_t update_time = vt_system::SystemManager->GetUpdateTime();
+
+    for(uint32_t i = 0; i < _retained_animations.size(); ++i)
+        _retained_animations[i]->Update();
+
     // Updates custom scripts
-    for(uint32_t i = 0; i < _update_functions.size(); ++i)
-        ReadScriptDescriptor::RunScriptObject(_update_functions[i]);
+    for(uint32_t i = 0; i < _update_functions.size(); ++i) {
+        ScriptCallback& callback = _update_functions[i];
+        if(!callback.function.is_valid())
+            continue;
+
+        if(callback.IsEveryFrame()) {
+            ScriptProfileScope profile(callback.function, "Update", _scene_scripts[i]->GetFilename());
+            ReadScriptDescriptor::RunScriptObject(callback.function);
+            continue;
+        }
+
+        callback.elapsed += update_time;
+        if(callback.events.empty() && callback.elapsed >= callback.interval)
+            callback.due = true;
+        if(!callback.due)
+            continue;
+
+        // The function gets the time elapsed since its last call.
+        const uint32_t elapsed = callback.elapsed;
+        callback.due = false;
+        callback.elapsed = 0;
+
+        try {
+            ScriptProfileScope profile(callback.function, "Update", _scene_scripts[i]->GetFilename());
+            luabind::call_function<void>(callback.function, elapsed);
+        } catch(const luabind::error &e) {
+            PRINT_ERROR << "Error while running the Update function of: "
+                        << _scene_scripts[i]->GetFilename() << std::endl;
+            ScriptManager->HandleLuaError(e);
+        } catch(const luabind::cast_failed &e) {
+            PRINT_ERROR << "Error while running the Update function of: "
+                        << _scene_scripts[i]->GetFilename() << std::endl;
+            ScriptManager->HandleCastError(e);
+        }
+    }
 }
 
 void ScriptSupervisor::DrawBackground()
 {
     // Handles custom scripted draw before sprites
-    for(uint32_t i = 0; i < _draw_background_functions.size(); ++i)
-        ReadScriptDescriptor::RunScriptObject(_draw_background_functions[i]);
+    _Draw(_draw_background_functions, SCRIPT_DRAW_BACKGROUND, "DrawBackground");
 }
 
 void ScriptSupervisor::DrawForeground()
 {
-    for(uint32_t i = 0; i < _draw_foreground_functions.size(); ++i)
-        ReadScriptDescriptor::RunScriptObject(_draw_foreground_functions[i]);
+    _Draw(_draw_foreground_functions, SCRIPT_DRAW_FOREGROUND, "DrawForeground");
 }
 
 void ScriptSupervisor::DrawPostEffects()
 {
-    for(uint32_t i = 0; i < _draw_post_effects_functions.size(); ++i)
-        ReadScriptDescriptor::RunScriptObject(_draw_post_effects_functions[i]);
+    _Draw(_draw_post_effects_functions, SCRIPT_DRAW_POST_EFFECTS, "DrawPostEffects");
+}
+
+void ScriptSupervisor::AddRetainedDraw(SCRIPT_DRAW_LAYER layer, ImageDescriptor* image,
+                                       float x, float y, const Color& color)
+{
+    if(layer >= SCRIPT_DRAW_LAYER_TOTAL || image == nullptr) {
+        PRINT_WARNING << "Invalid retained draw layer or image" << std::endl;
+        return;
+    }
+
+    RetainedDraw draw;
+    draw.image = image;
+    draw.x = x;
+    draw.y = y;
+    draw.color = color;
+    _retained_draws[layer].push_back(draw);
+
+    // The retained animations can't be updated by the scripts anymore.
+    std::vector<AnimatedImage*>::const_iterator it = std::find(_animated_images.begin(), _animated_images.end(), image);
+    if(it != _animated_images.end()
+            && std::find(_retained_animations.begin(), _retained_animations.end(), *it) == _retained_animations.end())
+        _retained_animations.push_back(*it);
+}
+
+void ScriptSupervisor::ClearRetainedDraws(SCRIPT_DRAW_LAYER layer)
+{
+    if(layer >= SCRIPT_DRAW_LAYER_TOTAL)
+        return;
+
+    _retained_draws[layer].clear();
+
+    // Only keep updating the animations still drawn.
+    _retained_animations.clear();
+    for(uint32_t i = 0; i < SCRIPT_DRAW_LAYER_TOTAL; ++i) {
+        for(uint32_t j = 0; j < _retained_draws[i].size(); ++j) {
+            std::vector<AnimatedImage*>::const_iterator it = std::find(_animated_images.begin(), _animated_images.end(),
+                                                                       _retained_draws[i][j].image);
+            if(it != _animated_images.end()
+                    && std::find(_retained_animations.begin(), _retained_animations.end(), *it) == _retained_animations.end())
+                _retained_animations.push_back(*it);
+        }
+    }
+}
+
+void ScriptSupervisor::NotifyEvent(const std::string& event_name)
+{
+    for(uint32_t i = 0; i < _update_functions.size(); ++i) {
+        ScriptCallback& callback = _update_functions[i];
+        if(std::find(callback.events.begin(), callback.events.end(), event_name) != callback.events.end())
+            callback.due = true;
+    }
+}
+
+ScriptSupervisor::ScriptCallback ScriptSupervisor::_ReadUpdateCallback(ReadScriptDescriptor* scene_script)
+{
+    ScriptCallback callback;
+    callback.function = scene_script->ReadFunctionPointer("Update");
+    if(!callback.function.is_valid() || !scene_script->DoesTableExist("callbacks"))
+        return callback;
+
+    scene_script->OpenTable("callbacks");
+    if(scene_script->DoesTableExist("Update")) {
+        scene_script->OpenTable("Update");
+        if(scene_script->DoesUIntExist("interval"))
+            callback.interval = scene_script->ReadUInt("interval");
+        if(scene_script->DoesTableExist("events"))
+            scene_script->ReadStringVector("events", callback.events);
+        scene_script->CloseTable(); // Update
+    }
+    scene_script->CloseTable(); // callbacks
+
+    return callback;
+}
+
+luabind::object ScriptSupervisor::_ReadDrawFunction(ReadScriptDescriptor* scene_script, const std::string& function_name)
+{
+    if(scene_script->DoesTableExist("callbacks")) {
+        scene_script->OpenTable("callbacks");
+        if(scene_script->DoesTableExist(function_name)) {
+            PRINT_WARNING << "The " << function_name << " function of " << scene_script->GetFilename()
+                          << " can't be scheduled and is called every frame. Use retained draws instead." << std::endl;
+        }
+        scene_script->CloseTable(); // callbacks
+    }
+
+    return scene_script->ReadFunctionPointer(function_name);
+}
+
+void ScriptSupervisor::_Draw(std::vector<luabind::object>& functions, SCRIPT_DRAW_LAYER layer, const char* name)
+{
+    for(uint32_t i = 0; i < functions.size(); ++i) {
+        if(!functions[i].is_valid())
+            continue;
+
+        ScriptProfileScope profile(functions[i], name, _scene_scripts[i]->GetFilename());
+        ReadScriptDescriptor::RunScriptObject(functions[i]);
+    }
+
+    const std::vector<RetainedDraw>& draws = _retained_draws[layer];
+    if(draws.empty())
+        return;
+
+    VideoManager->PushState();
+    VideoManager->SetDrawFlags(VIDEO_X_LEFT, VIDEO_Y_TOP, VIDEO_BLEND, 0);
+    for(uint32_t i = 0; i < draws.size(); ++i) {
+        VideoManager->Move(draws[i].x, draws[i].y);
+        draws[i].image->Draw(draws[i].color);
+    }
+    VideoManager->PopState();
 }
 
 // Images loading
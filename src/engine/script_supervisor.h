@@ -27,6 +27,33 @@ namespace vt_mode_manager {
 class GameMode;
 }
 
+//! \brief The layers the retained draws of the scene scripts are drawn in.
+enum SCRIPT_DRAW_LAYER {
+    SCRIPT_DRAW_BACKGROUND = 0,
+    SCRIPT_DRAW_FOREGROUND = 1,
+    SCRIPT_DRAW_POST_EFFECTS = 2,
+    SCRIPT_DRAW_LAYER_TOTAL = 3
+};
+
+/** ***************************************************************************
+*** \brief Runs the scene scripts of a game mode.
+***
+*** By default, the Update function of each script is called every frame.
+*** A script can declare in a 'callbacks' table of its tablespace when it should be
+*** called instead:
+*** - callbacks.Update = { interval = 500 } calls it at most every 500 ms, with the
+*** time elapsed since its last call as argument.
+*** - callbacks.Update = { events = { "Reset" } } only calls it when one of the events
+*** is notified. The game modes notify:
+***   - "Reset", when the mode becomes active, and "Restart", when a battle is restarted,
+***   - "MapStateChange", when the map state changes (dialogue, scene, treasure...),
+***   - "Victory" and "Defeat", when a battle ends.
+*** The scripts can also notify their own events through NotifyEvent().
+***
+*** The Draw functions are always called every frame, as anything they draw only
+*** lasts one frame. Static overlays should rather be added as retained draws,
+*** which the supervisor draws every frame without calling the script.
+*** **************************************************************************/
 class ScriptSupervisor
 {
 public:
@@ -107,7 +134,67 @@ public:
     //! \brief Used to permit changing a draw flag at boot time. Use with caution.
     void SetDrawFlag(vt_video::VIDEO_DRAW_FLAGS draw_flag);
 
+    /** \brief Adds an image drawn every frame by the supervisor, without calling the script.
+    *** \param layer The layer to draw the image in
+    *** \param image The image, created through the supervisor.
+    *** Retained animations are also updated by the supervisor.
+    *** \param x The left position of the image, in the standard coordinate system
+    *** \param y The top position of the image, in the standard coordinate system
+    *** \param color The color to draw the image with
+    **/
+    void AddRetainedDraw(SCRIPT_DRAW_LAYER layer, vt_video::ImageDescriptor* image,
+                         float x, float y, const vt_video::Color& color);
+
+    //! \brief Removes every retained draw of the given layer.
+    void ClearRetainedDraws(SCRIPT_DRAW_LAYER layer);
+
+    //! \brief Calls the Update functions waiting for the given event, on the next update.
+    void NotifyEvent(const std::string& event_name);
+
 private:
+    //! \brief A script function, and when it should be called.
+    struct ScriptCallback {
+        ScriptCallback():
+            interval(0),
+            elapsed(0),
+            due(false)
+        {}
+
+        luabind::object function;
+
+        //! \brief The minimum time between two calls, in milliseconds. 0 means every frame.
+        uint32_t interval;
+
+        //! \brief The time elapsed since the last call, in milliseconds.
+        uint32_t elapsed;
+
+        //! \brief The events the function is called on. When empty, it is called on time.
+        std::vector<std::string> events;
+
+        //! \brief Whether the function is to be called.
+        bool due;
+
+        //! \brief Whether the function is called every frame, as by default.
+        bool IsEveryFrame() const {
+            return interval == 0 && events.empty();
+        }
+    };
+
+    //! \brief An image drawn by the supervisor itself.
+    struct RetainedDraw {
+        vt_video::ImageDescriptor* image;
+        float x;
+        float y;
+        vt_video::Color color;
+    };
+
+    //! \brief The images drawn every frame in each layer, without calling the scripts.
+    std::vector<RetainedDraw> _retained_draws[SCRIPT_DRAW_LAYER_TOTAL];
+
+    //! \brief The created animations among the retained draws, updated by the supervisor.
+    std::vector<vt_video::AnimatedImage*> _retained_animations;
+
+
     //! \brief Contains a collection of custom created images
     std::vector<vt_video::TextImage*> _text_images;
 
@@ -138,7 +225,7 @@ private:
     *** one common operation is to detect certain conditions and respond appropriately, such as
     *** triggering a dialogue.
     **/
-    std::vector<luabind::object> _update_functions;
+    std::vector<ScriptCallback> _update_functions;
 
     /** \brief Script functions which assists with the #DrawBackground method
     *** Those functions execute any code that needs to be performed on a draw call.
@@ -161,6 +248,21 @@ private:
     /** \brief Scripts objects keeping the corresponding lua coroutines alive.
     **/
     std::vector<vt_script::ReadScriptDescriptor*> _scene_scripts;
+    //@}
+
+    /** \brief Reads the Update function, and when it should be called from the script callbacks table.
+    *** \param scene_script The script, with its tablespace open
+    **/
+    ScriptCallback _ReadUpdateCallback(vt_script::ReadScriptDescriptor* scene_script);
+
+    /** \brief Reads a Draw function, which is called every frame.
+    *** \param scene_script The script, with its tablespace open
+    *** \param function_name The name of the function
+    **/
+    luabind::object _ReadDrawFunction(vt_script::ReadScriptDescriptor* scene_script, const std::string& function_name);
+
+    //! \brief Calls the script draw functions, and draws the retained images of the layer.
+    void _Draw(std::vector<luabind::object>& functions, SCRIPT_DRAW_LAYER layer, const char* name);
 };
 
 #endif
@@ -363,6 +363,7 @@ void SystemTimer::_UpdateTimer(uint32_t time)
 SystemEngine::SystemEngine():
     _last_update(0),
     _update_time(1), // Set to 1 to avoid hanging the system.
+    _fixed_update_time(0),
     _hours_played(0),
     _minutes_played(0),
     _seconds_played(0),
@@ -615,7 +616,7 @@ void SystemEngine::UpdateTimers(uint32_t update_tick)
     // Update the update game timer
     uint32_t tmp = _last_update;
     _last_update = update_tick;
-    _update_time = _last_update - tmp;
+    _update_time = (_fixed_update_time > 0) ? _fixed_update_time : _last_update - tmp;
 
     // Update the game play timer
     _milliseconds_played += _update_time;
@@ -465,6 +465,14 @@ public:
     **/
     void UpdateTimers(uint32_t update_tick);
 
+    /** \brief Makes every timer update last the given time, whatever the update ticks given.
+    *** \param update_time The time of each update in milliseconds, or 0 to use the actual time again.
+    *** Used to play the game deterministically, and faster than real-time, as the battle simulator does.
+    **/
+    void SetFixedUpdateTime(uint32_t update_time) {
+        _fixed_update_time = update_time;
+    }
+
     /** \brief Checks all system timers for whether they should be paused or resumed
     *** This function is typically called whenever the ModeEngine class has changed the active game mode.
     *** When this is done, all system timers that are owned by the active game mode are resumed, all timers with
@@ -616,6 +624,9 @@ private:
     //! \brief The number of milliseconds that have transpired on the last timer update.
     uint32_t _update_time;
 
+    //! \brief The time of each timer update when not 0, instead of the time elapsed.
+    uint32_t _fixed_update_time;
+
     /** \name Play time members
     *** \brief Timers that retain the total amount of time that the user has been playing
     *** When the player starts a new game or loads an existing game, these timers are reset.
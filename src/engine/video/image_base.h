@@ -91,6 +91,15 @@ public:
         return _rgb_format ? 3 : 4;
     }
 
+    //! \brief Gives direct access to the pixel buffer, stored row after row.
+    uint8_t* GetPixels() {
+        return _pixels.data();
+    }
+
+    const uint8_t* GetPixels() const {
+        return _pixels.data();
+    }
+
     /** \brief Loads raw image data from a file and stores the data in the class members
     *** \param filename The name of the image file to load.
     *** \return True if the image was loaded successfully, false if it was not
@@ -30,6 +30,8 @@
 #include "engine/audio/audio.h"
 #include "engine/input.h"
 #include "engine/mode_manager.h"
+#include "engine/script_gc.h"
+#include "engine/script_profiler.h"
 #include "engine/video/video.h"
 #include "engine/system.h"
 
@@ -178,6 +180,10 @@ static bool LoadSettings()
 
         AudioManager->SetMusicVolume(static_cast<float>(settings.ReadFloat("music_vol")));
         AudioManager->SetSoundVolume(static_cast<float>(settings.ReadFloat("sound_vol")));
+        if (settings.DoesBoolExist("pcm_cache"))
+            AudioManager->SetPcmCacheEnabled(settings.ReadBool("pcm_cache"));
+        if (settings.DoesBoolExist("sound_mixer"))
+            AudioManager->SetSoundMixerEnabled(settings.ReadBool("sound_mixer"));
 
         settings.CloseTable(); // audio_settings
     }
@@ -330,6 +336,8 @@ static void InitializeEngine()
     AudioManager = AudioEngine::SingletonCreate();
     InputManager = InputEngine::SingletonCreate();
     ScriptManager = ScriptEngine::SingletonCreate();
+    ScriptProfilerManager = ScriptProfiler::SingletonCreate();
+    ScriptGCManager = ScriptGarbageCollector::SingletonCreate();
     VideoManager = VideoEngine::SingletonCreate();
     SystemManager = SystemEngine::SingletonCreate();
     ModeManager = ModeEngine::SingletonCreate();
@@ -350,6 +358,12 @@ static void InitializeEngine()
         throw Exception("ERROR: unable to initialize ScriptManager",
                         __FILE__, __LINE__, __FUNCTION__);
     }
+    ScriptProfilerManager->SetEnabled(SCRIPT_PROFILE);
+
+    if(!ScriptGCManager->SingletonInitialize()) {
+        throw Exception("ERROR: unable to initialize ScriptGCManager",
+                        __FILE__, __LINE__, __FUNCTION__);
+    }
 
     vt_defs::BindEngineCode();
     vt_defs::BindCommonCode();
@@ -423,6 +437,10 @@ void DeinitializeEngine()
     // NOTE: Even if the singleton objects do not exist when this function is called, invoking the
     // static Destroy() singleton function will do no harm (it checks that the object exists before deleting it).
 
+    // Save the scripts profile requested from the command line.
+    if(ScriptProfilerManager && ScriptProfilerManager->IsEnabled() && SCRIPT_PROFILE)
+        ScriptProfilerManager->SaveCSV(GetUserDataPath() + SCRIPT_PROFILE_FILENAME);
+
     // Delete the mode manager first so that all game modes free their resources
     ModeEngine::SingletonDestroy();
 
@@ -436,6 +454,8 @@ void DeinitializeEngine()
     InputEngine::SingletonDestroy();
     SystemEngine::SingletonDestroy();
     VideoEngine::SingletonDestroy();
+    ScriptProfiler::SingletonDestroy();
+    ScriptGarbageCollector::SingletonDestroy();
     // Do it last since all luabind objects must be freed
     // before closing the lua state.
     ScriptEngine::SingletonDestroy();
@@ -453,6 +473,7 @@ void RenderFrame()
     ModeManager->DrawPostEffects();
     VideoManager->DrawFadeEffect();
     VideoManager->DrawDebugInfo();
+    ScriptProfilerManager->DrawOverlay();
 }
 
 //! \brief Update the engine logic with the provided new absolute tick time.
@@ -480,6 +501,8 @@ void UpdateEngine(uint32_t update_tick)
 
     // Update any streaming audio sources
     AudioManager->Update();
+    // Without an audio device, the audio only plays as it gets rendered
+    AudioManager->UpdateHeadless(SystemManager->GetUpdateTime());
 
     //std::cout << "Update audio delay: " << SDL_GetTicks() - update_tick << "ms" << std::endl;
     //update_tick = SDL_GetTicks();
@@ -487,6 +510,9 @@ void UpdateEngine(uint32_t update_tick)
     // Update the game status
     ModeManager->Update();
 
+    // Count the frame in the scripts profile, if any
+    ScriptProfilerManager->Update();
+
     //std::cout << "Update events delay: " << SDL_GetTicks() - update_tick << "ms" << std::endl;
     //std::cout << "Update total delay: " << SDL_GetTicks() - update_begin_tick << "ms" << std::endl;
 }
@@ -517,7 +543,7 @@ int main(int argc, char* argv[])
                          SDL_WINDOWPOS_CENTERED,
                          vt_video::VIDEO_VIEWPORT_WIDTH,
                          vt_video::VIDEO_VIEWPORT_HEIGHT,
-                         SDL_WINDOW_OPENGL);
+                         SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
     if (!sdl_window) {
         PRINT_ERROR << "SDL window creation failed: "
                     << SDL_GetError() << std::endl;
@@ -594,6 +620,22 @@ int main(int argc, char* argv[])
 
     // Set the window handle, apply actual screen resolution
     VideoManager->SetWindowHandle(sdl_window);
+
+    // The battles are simulated with the window kept hidden, and nothing drawn.
+    if(vt_main::IsBattleSimulationRequested()) {
+        int return_code = EXIT_FAILURE;
+        try {
+            return_code = vt_main::RunBattleSimulation() ? EXIT_SUCCESS : EXIT_FAILURE;
+        } catch(const Exception& e) {
+            PRINT_ERROR << e.ToString() << std::endl;
+        }
+
+        DeinitializeEngine();
+        SDL_GL_DeleteContext(glcontext);
+        SDL_DestroyWindow(sdl_window);
+        return return_code;
+    }
+
     VideoManager->ApplySettings();
 
     // Now the settings are loaded, let's set the windows translated title.
@@ -635,6 +677,9 @@ int main(int argc, char* argv[])
 
             next_render_tick = SDL_GetTicks() + SKIP_RENDER_TICKS;
 
+            // Collect the scripts garbage in the time left before the next frame.
+            ScriptGCManager->Step(next_render_tick);
+
         } // while (SystemManager->NotDone())
     } catch(const Exception& e) {
 #ifdef WIN32
@@ -18,11 +18,13 @@
 #include "main_options.h"
 
 #include "engine/audio/audio.h"
+#include "engine/audio/audio_benchmark.h"
 #include "engine/video/video.h"
 #include "script/script_write.h"
 #include "engine/input.h"
 #include "engine/system.h"
 #include "engine/mode_manager.h"
+#include "engine/script_profiler.h"
 
 #include "utils/utils_files.h"
 
@@ -30,8 +32,21 @@
 #include "common/app_settings.h"
 #include "common/global/global.h"
 
+#include "modes/map/map_mode.h"
+#include "modes/battle/battle_simulator.h"
+
 #include <SDL2/SDL_ttf.h>
 
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
+#include <sstream>
+#include <thread>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
 namespace vt_battle {
 extern bool BATTLE_DEBUG;
 }
@@ -57,11 +72,44 @@ using namespace vt_common;
 namespace vt_main
 {
 
+//! \brief The battle simulation requested on the command line, if any
+struct BattleSimulationOptions {
+    BattleSimulationOptions() :
+        requested(false),
+        worker(false),
+        first(0),
+        number(1000),
+        seed(0)
+    {}
+
+    bool requested;
+
+    //! \brief Whether this process simulates a share of the battles for another one
+    bool worker;
+
+    //! \brief The save game file or slot, and the comma separated enemy ids, as given
+    std::string save_game;
+    std::string enemies;
+
+    std::vector<uint32_t> enemy_ids;
+
+    uint32_t first;
+    uint32_t number;
+    uint32_t seed;
+
+    //! \brief The program used to start the worker processes
+    std::string executable;
+};
+
+static BattleSimulationOptions battle_simulation;
+
 bool ParseProgramOptions(int32_t &return_code, int32_t argc, char* argv[])
 {
     // Convert the argument list to a vector of strings for convenience
     std::vector<std::string> options(argv, argv + argc);
     return_code = 0;
+    if(!options.empty())
+        battle_simulation.executable = options[0];
 
     for(uint32_t i = 1; i < options.size(); i++) {
         if(options[i] == "-d" || options[i] == "--debug") {
@@ -78,6 +126,34 @@ bool ParseProgramOptions(int32_t &return_code, int32_t argc, char* argv[])
             i++;
         } else if(options[i] == "--disable-audio") {
             vt_audio::AUDIO_ENABLE = false;
+        } else if(options[i] == "--headless-audio") {
+            vt_audio::AUDIO_HEADLESS = true;
+        } else if(options[i] == "--profile-scripts") {
+            vt_script::SCRIPT_PROFILE = true;
+        } else if(options[i] == "--audio-benchmark") {
+            if((i + 1) >= options.size()) {
+                std::cerr << "Option " << options[i] << " requires an argument." << std::endl;
+                PrintUsage();
+                return_code = 1;
+                return false;
+            }
+            return_code = RunAudioBenchmark(options[i + 1]) ? 0 : 1;
+            return false;
+        } else if(options[i] == "--simulate-battle" || options[i] == "--simulate-battle-worker") {
+            if((i + 1) >= options.size()) {
+                std::cerr << "Option " << options[i] << " requires an argument." << std::endl;
+                PrintUsage();
+                return_code = 1;
+                return false;
+            }
+            if(!ParseBattleSimulation(options[i + 1], options[i] == "--simulate-battle-worker")) {
+                PrintUsage();
+                return_code = 1;
+                return false;
+            }
+            // The battles are simulated once the engine is initialized.
+            vt_audio::AUDIO_ENABLE = false;
+            i++;
         } else if(options[i] == "-h" || options[i] == "--help") {
             PrintUsage();
             return_code = 0;
@@ -151,6 +227,16 @@ void PrintUsage()
             << "                       map, mode_manager, pause, quit, scene, system" << std::endl
             << "                       utils, video" << std::endl
             << "  --disable-audio   :: disables loading and playing audio" << std::endl
+            << "  --headless-audio  :: plays audio without any audio device" << std::endl
+            << "  --audio-benchmark <files> :: measures the audio engine performance without" << std::endl
+            << "                       any audio device, using the given map scripts audio" << std::endl
+            << "                       and the given music and sound files" << std::endl
+            << "  --simulate-battle \"<save> <enemies> [number] [seed]\" :: plays the party of" << std::endl
+            << "                       the given save game file or slot against the given" << std::endl
+            << "                       comma separated enemy ids, 1000 times by default," << std::endl
+            << "                       and prints the win rates, turns and damage dealt" << std::endl
+            << "  --profile-scripts :: measures the time spent in each script function, and" << std::endl
+            << "                       saves it in script_profile.csv in the user data folder" << std::endl
             << "  --help/-h         :: prints this help menu" << std::endl
             << "  --info/-i         :: prints information about the user's system" << std::endl
             << "  --reset/-r        :: resets game configuration to use default settings" << std::endl;
@@ -288,6 +374,202 @@ bool PrintSystemInformation()
     return true;
 } // bool PrintSystemInformation()
 
+bool RunAudioBenchmark(const std::string &vars)
+{
+    std::vector<std::string> files;
+    if(!ParseSecondaryOptions(vars, files))
+        return false;
+
+    // Map scripts give the audio they use, the other files are taken as is.
+    std::vector<std::string> music_filenames;
+    std::vector<std::string> sound_filenames;
+    for(uint32_t i = 0; i < files.size(); ++i) {
+        if(files[i].empty())
+            continue;
+        if(files[i].size() > 4 && files[i].compare(files[i].size() - 4, 4, ".lua") == 0)
+            vt_map::MapMode::GetMapAudioFiles(files[i], music_filenames, sound_filenames);
+        else if(files[i].find("music/") != std::string::npos)
+            music_filenames.push_back(files[i]);
+        else
+            sound_filenames.push_back(files[i]);
+    }
+
+    // Each file is benchmarked once.
+    std::sort(music_filenames.begin(), music_filenames.end());
+    music_filenames.erase(std::unique(music_filenames.begin(), music_filenames.end()), music_filenames.end());
+    std::sort(sound_filenames.begin(), sound_filenames.end());
+    sound_filenames.erase(std::unique(sound_filenames.begin(), sound_filenames.end()), sound_filenames.end());
+
+    if(music_filenames.empty() && sound_filenames.empty()) {
+        std::cerr << "ERROR: no audio files to benchmark" << std::endl;
+        return false;
+    }
+
+    printf("\n===== Audio Benchmark\n");
+
+    vt_audio::AUDIO_ENABLE = true;
+    vt_audio::AUDIO_HEADLESS = true;
+    vt_audio::AudioManager = vt_audio::AudioEngine::SingletonCreate();
+    if(vt_audio::AudioManager->SingletonInitialize() == false) {
+        std::cerr << "ERROR: unable to initialize the AudioManager" << std::endl;
+        vt_audio::AudioEngine::SingletonDestroy();
+        return false;
+    }
+
+    bool success = vt_audio::RunAudioBenchmark(music_filenames, sound_filenames);
+    vt_audio::AudioEngine::SingletonDestroy();
+
+    return success;
+} // bool RunAudioBenchmark(const std::string &vars)
+
+//! \brief Reads an unsigned number, returning false if the text isn't one.
+static bool _ParseNumber(const std::string &text, uint32_t &number)
+{
+    if(text.empty() || text.find_first_not_of("0123456789") != std::string::npos)
+        return false;
+    number = static_cast<uint32_t>(strtoul(text.c_str(), nullptr, 10));
+    return true;
+}
+
+//! \brief Returns the file a worker process writes its battle results to.
+static std::string _GetBattleSimulationFilename(uint32_t seed, uint32_t first)
+{
+    std::ostringstream filename;
+    filename << GetUserDataPath() << "battle_simulation_" << seed << "_" << first << ".txt";
+    return filename.str();
+}
+
+bool ParseBattleSimulation(const std::string &vars, bool worker)
+{
+    std::vector<std::string> args;
+    if(!ParseSecondaryOptions(vars, args))
+        return false;
+
+    battle_simulation.requested = true;
+    battle_simulation.worker = worker;
+    battle_simulation.seed = static_cast<uint32_t>(time(nullptr));
+
+    bool valid = (args.size() >= 2);
+    if(worker) {
+        // <save> <enemies> <first> <number> <seed>
+        valid = valid && args.size() == 5
+                && _ParseNumber(args[2], battle_simulation.first)
+                && _ParseNumber(args[3], battle_simulation.number)
+                && _ParseNumber(args[4], battle_simulation.seed);
+    } else {
+        valid = valid && args.size() <= 4
+                && (args.size() < 3 || _ParseNumber(args[2], battle_simulation.number))
+                && (args.size() < 4 || _ParseNumber(args[3], battle_simulation.seed));
+    }
+    if(!valid) {
+        std::cerr << "ERROR: invalid battle simulation arguments: " << vars << std::endl;
+        return false;
+    }
+
+    battle_simulation.save_game = args[0];
+    battle_simulation.enemies = args[1];
+    std::istringstream enemies(args[1]);
+    std::string enemy;
+    while(std::getline(enemies, enemy, ',')) {
+        uint32_t enemy_id = 0;
+        if(!_ParseNumber(enemy, enemy_id)) {
+            std::cerr << "ERROR: invalid enemy id: " << enemy << std::endl;
+            return false;
+        }
+        battle_simulation.enemy_ids.push_back(enemy_id);
+    }
+
+    if(battle_simulation.enemy_ids.empty() || battle_simulation.number == 0) {
+        std::cerr << "ERROR: the battle simulation needs enemies and at least one battle" << std::endl;
+        return false;
+    }
+    return true;
+} // bool ParseBattleSimulation(const std::string &vars, bool worker)
+
+bool IsBattleSimulationRequested()
+{
+    return battle_simulation.requested;
+}
+
+bool RunBattleSimulation()
+{
+    using namespace vt_battle;
+
+    // A save slot is given from 1, as shown in game.
+    std::string save_filename = battle_simulation.save_game;
+    uint32_t slot = 0;
+    if(_ParseNumber(save_filename, slot) && slot > 0)
+        save_filename = vt_global::FindSaveGameFilename(slot - 1);
+
+    BattleSimulator simulator(save_filename, battle_simulation.enemy_ids);
+    const uint32_t seed = battle_simulation.seed;
+
+    if(battle_simulation.worker) {
+        std::vector<BattleSimulationResult> results;
+        return simulator.Run(battle_simulation.first, battle_simulation.number, seed, results)
+               && BattleSimulator::SaveResults(_GetBattleSimulationFilename(seed, battle_simulation.first), results);
+    }
+
+    // The engine and the scripts aren't thread-safe, so the battles are shared
+    // with other processes of the game, each simulating a range of battles.
+    const uint32_t number = battle_simulation.number;
+    uint32_t jobs = std::max(1u, std::thread::hardware_concurrency());
+    jobs = std::min(jobs, number);
+
+    std::vector<uint32_t> firsts(jobs, 0);
+    std::vector<uint32_t> counts(jobs, 0);
+    for(uint32_t i = 0; i < jobs; ++i) {
+        counts[i] = number / jobs + (i < number % jobs ? 1 : 0);
+        firsts[i] = (i == 0) ? 0 : firsts[i - 1] + counts[i - 1];
+    }
+
+    std::string executable = battle_simulation.executable;
+#ifdef __linux__
+    // The program may have changed its working directory since it was started.
+    char path[4096];
+    ssize_t length = readlink("/proc/self/exe", path, sizeof(path) - 1);
+    if(length > 0)
+        executable.assign(path, length);
+#endif
+
+    std::cout << std::endl << "===== Battle simulation of " << number << " battles, seed "
+              << seed << ", " << jobs << " job(s)" << std::endl;
+
+    std::vector<int> worker_codes(jobs, 0);
+    std::vector<std::thread> workers;
+    for(uint32_t i = 1; i < jobs; ++i) {
+        std::ostringstream command;
+        command << "\"" << executable << "\" --simulate-battle-worker \""
+                << battle_simulation.save_game << " " << battle_simulation.enemies << " "
+                << firsts[i] << " " << counts[i] << " " << seed << "\"";
+        const std::string command_line = command.str();
+        workers.push_back(std::thread([command_line, i, &worker_codes]() {
+            worker_codes[i] = std::system(command_line.c_str());
+        }));
+    }
+
+    std::vector<BattleSimulationResult> results;
+    bool success = simulator.Run(firsts[0], counts[0], seed, results);
+
+    for(uint32_t i = 0; i < workers.size(); ++i)
+        workers[i].join();
+
+    for(uint32_t i = 1; i < jobs; ++i) {
+        const std::string filename = _GetBattleSimulationFilename(seed, firsts[i]);
+        if(worker_codes[i] != 0 || !BattleSimulator::LoadResults(filename, results)) {
+            std::cerr << "ERROR: the battles " << firsts[i] << " to " << firsts[i] + counts[i] - 1
+                      << " couldn't be simulated" << std::endl;
+            success = false;
+        }
+        if(DoesFileExist(filename))
+            DeleteAFile(filename);
+    }
+
+    if(!results.empty())
+        BattleSimulator::PrintReport(results, simulator.GetActorNames());
+    return success;
+} // bool RunBattleSimulation()
+
 bool ResetSettings()
 {
     std::string file = GetUserConfigPath() + "settings.lua";
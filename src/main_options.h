@@ -51,6 +51,30 @@ void PrintUsage();
 **/
 bool PrintSystemInformation();
 
+/** \brief Runs the headless audio engine benchmark
+*** \param vars The map script files whose audio is used, and additional music and sound files.
+*** \return False if the audio engine couldn't be benchmarked.
+**/
+bool RunAudioBenchmark(const std::string& vars);
+
+/** \brief Reads the battle simulation to run once the engine is initialized
+*** \param vars The save game file or slot, the comma separated enemy ids,
+*** and optionally the number of battles and the random seed.
+*** \param worker Whether the arguments are given by another process of the game,
+*** as the save game, the enemy ids, the first battle, the number of battles and the seed.
+*** \return False if the arguments are invalid.
+**/
+bool ParseBattleSimulation(const std::string& vars, bool worker);
+
+//! \brief Tells whether a battle simulation was given on the command line.
+bool IsBattleSimulationRequested();
+
+/** \brief Runs the battle simulation given on the command line, and prints its report
+*** \note The game engine must be initialized.
+*** \return False if a battle couldn't be simulated.
+**/
+bool RunBattleSimulation();
+
 /** \brief Resets the game settings (audio volume, key mappings, etc.) to their default values.
 *** \return False if the settings could not be restored, or if another problem occured.
 **/
@@ -631,6 +631,7 @@ void BattleMode::ChangeState(BATTLE_STATE new_state)
         }
         _battle_finish = new BattleVictory();
         _battle_finish->Initialize();
+        GetScriptSupervisor().NotifyEvent("Victory");
         break;
     }
     case BATTLE_STATE_DEFEAT: {
@@ -643,6 +644,7 @@ void BattleMode::ChangeState(BATTLE_STATE new_state)
         }
         _battle_finish = new BattleDefeat();
         _battle_finish->Initialize();
+        GetScriptSupervisor().NotifyEvent("Defeat");
         break;
     }
     default:
@@ -751,6 +753,13 @@ void BattleMode::NotifyActorDeath(BattleActor *actor)
         IF_PRINT_WARNING(BATTLE_DEBUG) << "actor death occurred after battle was finished" << std::endl;
 }
 
+BattleActor* BattleMode::GetActingActor() const
+{
+    if(_ready_queue.empty() || _ready_queue.front()->GetState() != ACTOR_STATE_ACTING)
+        return nullptr;
+    return _ready_queue.front();
+}
+
 bool BattleMode::isOneCharacterDead() const
 {
     for(std::deque<private_battle::BattleCharacter *>::const_iterator it = _character_actors.begin();
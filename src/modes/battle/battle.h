@@ -181,6 +181,15 @@ public:
         return ((_state == private_battle::BATTLE_STATE_VICTORY) || (_state == private_battle::BATTLE_STATE_DEFEAT));
     }
 
+    //! \brief Returns the actor currently executing its action, or nullptr if none is.
+    private_battle::BattleActor* GetActingActor() const;
+
+    //! \brief Sets whether the characters actions are chosen automatically,
+    //! as with the auto-battle option of the battle menu.
+    void SetAutoBattleActive(bool active) {
+        _battle_menu.SetAutoBattleActive(active);
+    }
+
     //! \brief Returns the number of character actors in the battle, both living and dead
     uint32_t GetNumberOfCharacters() const {
         return _character_actors.size();
@@ -0,0 +1,308 @@
+////////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2018 by Bertram (Valyria Tear)
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+////////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file   battle_simulator.cpp
+*** \author Yohann Ferreira, yohann ferreira orange fr
+*** \brief  Source file for the headless battle simulator
+*** ***************************************************************************/
+
+#include "modes/battle/battle_simulator.h"
+
+#include "modes/battle/battle.h"
+#include "modes/battle/objects/battle_character.h"
+#include "modes/battle/objects/battle_enemy.h"
+
+#include "common/global/global.h"
+#include "engine/mode_manager.h"
+#include "engine/system.h"
+#include "script/script.h"
+
+#include "utils/ustring.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+using namespace vt_utils;
+using namespace vt_mode_manager;
+using namespace vt_system;
+using namespace vt_global;
+using namespace vt_script;
+
+namespace vt_battle
+{
+
+namespace private_battle
+{
+
+/** ****************************************************************************
+*** \brief An empty game mode kept under the simulated battles
+***
+*** The game stack must never be emptied, and popping a battle makes the mode
+*** under it active again.
+*** ***************************************************************************/
+class BattleSimulationMode : public GameMode
+{
+public:
+    void Reset()
+    {}
+
+    void Draw()
+    {}
+};
+
+//! \brief Returns the value under which the given ratio of the sorted values are.
+static uint32_t _GetPercentile(const std::vector<uint32_t>& sorted_values, float ratio)
+{
+    if(sorted_values.empty())
+        return 0;
+
+    size_t index = static_cast<size_t>(ratio * (sorted_values.size() - 1) + 0.5f);
+    return sorted_values[std::min(index, sorted_values.size() - 1)];
+}
+
+//! \brief Returns the given count as a percentage of the total.
+static float _GetPercentage(uint32_t count, uint32_t total)
+{
+    return (total == 0) ? 0.0f : 100.0f * count / total;
+}
+
+//! \brief Prints the 10%, 50%, 90% percentiles and maximum of the given values.
+static void _PrintDistribution(const std::string& label, std::vector<uint32_t>& values)
+{
+    std::sort(values.begin(), values.end());
+    std::cout << label << _GetPercentile(values, 0.1f) << " / "
+              << _GetPercentile(values, 0.5f) << " / "
+              << _GetPercentile(values, 0.9f) << " / "
+              << (values.empty() ? 0 : values.back())
+              << " (10% / 50% / 90% / max)" << std::endl;
+}
+
+} // namespace private_battle
+
+using namespace private_battle;
+
+uint32_t BattleSimulationResult::GetNumberTurns() const
+{
+    uint32_t turns = 0;
+    for(uint32_t i = 0; i < actors.size(); ++i)
+        turns += actors[i].actions;
+    return turns;
+}
+
+BattleSimulator::BattleSimulator(const std::string& save_filename, const std::vector<uint32_t>& enemy_ids) :
+    _save_filename(save_filename),
+    _enemy_ids(enemy_ids)
+{
+    ModeManager->Push(new BattleSimulationMode(), false, false);
+    ModeManager->Update();
+}
+
+bool BattleSimulator::Run(uint32_t first, uint32_t number, uint32_t seed, std::vector<BattleSimulationResult>& results)
+{
+    // The battles are played by steps of a fixed game time, as fast as possible.
+    SystemManager->SetFixedUpdateTime(BATTLE_SIMULATION_UPDATE_TIME);
+
+    bool success = true;
+    for(uint32_t i = first; i < first + number; ++i) {
+        BattleSimulationResult result;
+        if(!_Simulate(seed + i, result)) {
+            success = false;
+            break;
+        }
+        results.push_back(result);
+    }
+
+    SystemManager->SetFixedUpdateTime(0);
+    return success;
+}
+
+bool BattleSimulator::_Simulate(uint32_t seed, BattleSimulationResult& result)
+{
+    // The victories change the party state, so each battle starts from the save game.
+    if(!GlobalManager->LoadGame(_save_filename, 0)) {
+        PRINT_ERROR << "Couldn't load the save game: " << _save_filename << std::endl;
+        return false;
+    }
+
+    // Both the engine and the scripts random numbers must be seeded for the battle to be replayable.
+    srand(seed);
+    luabind::object math_table = luabind::globals(ScriptManager->GetGlobalState())["math"];
+    luabind::call_function<void>(math_table["randomseed"], seed);
+
+    BattleMode* battle = new BattleMode();
+    for(uint32_t i = 0; i < _enemy_ids.size(); ++i)
+        battle->AddEnemy(_enemy_ids[i]);
+    battle->SetAutoBattleActive(true);
+
+    // The battle characters are only created once the battle is made active.
+    ModeManager->Push(battle, false, false);
+    uint32_t battle_time = 0;
+    SystemManager->UpdateTimers(battle_time);
+    ModeManager->Update();
+
+    if(battle->GetCharacterActors().empty() || battle->GetEnemyActors().empty()) {
+        PRINT_ERROR << "The battle needs both characters and enemies" << std::endl;
+        ModeManager->Pop(false, false);
+        ModeManager->Update();
+        return false;
+    }
+
+    while(!battle->IsBattleFinished() && battle_time < BATTLE_SIMULATION_MAX_TIME) {
+        battle_time += BATTLE_SIMULATION_UPDATE_TIME;
+        SystemManager->UpdateTimers(battle_time);
+        ModeManager->Update();
+    }
+
+    result.battle_time = battle_time;
+    if(!battle->IsBattleFinished())
+        result.outcome = BATTLE_SIMULATION_TIMEOUT;
+    else if(battle->GetState() == BATTLE_STATE_DEFEAT)
+        result.outcome = BATTLE_SIMULATION_DEFEAT;
+    else
+        result.outcome = BATTLE_SIMULATION_VICTORY;
+
+    std::deque<BattleCharacter *>& characters = battle->GetCharacterActors();
+    std::deque<BattleEnemy *>& enemies = battle->GetEnemyActors();
+    bool name_actors = _actor_names.empty();
+    for(uint32_t i = 0; i < characters.size(); ++i) {
+        result.actors.push_back(characters[i]->GetStatistics());
+        if(name_actors)
+            _actor_names.push_back(MakeStandardString(characters[i]->GetName()));
+    }
+    for(uint32_t i = 0; i < enemies.size(); ++i) {
+        result.actors.push_back(enemies[i]->GetStatistics());
+        if(name_actors)
+            _actor_names.push_back(MakeStandardString(enemies[i]->GetName()));
+    }
+
+    ModeManager->Pop(false, false);
+    ModeManager->Update();
+    return true;
+}
+
+bool BattleSimulator::SaveResults(const std::string& filename, const std::vector<BattleSimulationResult>& results)
+{
+    std::ofstream file(filename.c_str());
+    if(!file) {
+        PRINT_ERROR << "Couldn't write the battle results file: " << filename << std::endl;
+        return false;
+    }
+
+    for(uint32_t i = 0; i < results.size(); ++i) {
+        const BattleSimulationResult& result = results[i];
+        file << "battle " << result.outcome << " " << result.battle_time << " " << result.actors.size() << std::endl;
+        for(uint32_t j = 0; j < result.actors.size(); ++j) {
+            const BattleActorStatistics& actor = result.actors[j];
+            file << actor.actions << " " << actor.misses << " " << actor.deaths << " "
+                 << actor.damage_taken << " " << actor.hits.size();
+            for(uint32_t k = 0; k < actor.hits.size(); ++k)
+                file << " " << actor.hits[k];
+            file << std::endl;
+        }
+    }
+    return file.good();
+}
+
+bool BattleSimulator::LoadResults(const std::string& filename, std::vector<BattleSimulationResult>& results)
+{
+    std::ifstream file(filename.c_str());
+    if(!file) {
+        PRINT_ERROR << "Couldn't read the battle results file: " << filename << std::endl;
+        return false;
+    }
+
+    std::string tag;
+    while(file >> tag) {
+        uint32_t outcome = 0;
+        uint32_t number_actors = 0;
+        BattleSimulationResult result;
+        if(tag != "battle" || !(file >> outcome >> result.battle_time >> number_actors)
+                || outcome > BATTLE_SIMULATION_TIMEOUT) {
+            PRINT_ERROR << "Invalid battle results file: " << filename << std::endl;
+            return false;
+        }
+        result.outcome = static_cast<BATTLE_SIMULATION_OUTCOME>(outcome);
+
+        result.actors.resize(number_actors);
+        for(uint32_t i = 0; i < number_actors; ++i) {
+            BattleActorStatistics& actor = result.actors[i];
+            uint32_t number_hits = 0;
+            file >> actor.actions >> actor.misses >> actor.deaths >> actor.damage_taken >> number_hits;
+            actor.hits.resize(number_hits);
+            for(uint32_t j = 0; j < number_hits; ++j)
+                file >> actor.hits[j];
+        }
+
+        if(!file) {
+            PRINT_ERROR << "Invalid battle results file: " << filename << std::endl;
+            return false;
+        }
+        results.push_back(result);
+    }
+    return true;
+}
+
+void BattleSimulator::PrintReport(const std::vector<BattleSimulationResult>& results,
+                                  const std::vector<std::string>& actor_names)
+{
+    uint32_t outcomes[3] = { 0, 0, 0 };
+    std::vector<uint32_t> turns;
+    std::vector<uint32_t> battle_times;
+    for(uint32_t i = 0; i < results.size(); ++i) {
+        ++outcomes[results[i].outcome];
+        turns.push_back(results[i].GetNumberTurns());
+        battle_times.push_back(results[i].battle_time / 1000);
+    }
+
+    const uint32_t number = static_cast<uint32_t>(results.size());
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << std::endl << "===== Battle outcomes" << std::endl;
+    std::cout << "Simulated battles:           " << number << std::endl;
+    std::cout << "Victories:                   " << _GetPercentage(outcomes[BATTLE_SIMULATION_VICTORY], number) << " %" << std::endl;
+    std::cout << "Defeats:                     " << _GetPercentage(outcomes[BATTLE_SIMULATION_DEFEAT], number) << " %" << std::endl;
+    std::cout << "Timeouts:                    " << _GetPercentage(outcomes[BATTLE_SIMULATION_TIMEOUT], number) << " %" << std::endl;
+    _PrintDistribution("Turns:                       ", turns);
+    _PrintDistribution("Battle time (s):             ", battle_times);
+
+    for(uint32_t i = 0; i < actor_names.size(); ++i) {
+        uint32_t actions = 0;
+        uint32_t misses = 0;
+        uint32_t deaths = 0;
+        std::vector<uint32_t> hits;
+        std::vector<uint32_t> damage_per_battle;
+        for(uint32_t j = 0; j < results.size(); ++j) {
+            if(i >= results[j].actors.size())
+                continue;
+            const BattleActorStatistics& actor = results[j].actors[i];
+            actions += actor.actions;
+            misses += actor.misses;
+            deaths += (actor.deaths > 0) ? 1 : 0;
+            hits.insert(hits.end(), actor.hits.begin(), actor.hits.end());
+
+            uint32_t damage = 0;
+            for(uint32_t k = 0; k < actor.hits.size(); ++k)
+                damage += actor.hits[k];
+            damage_per_battle.push_back(damage);
+        }
+
+        std::cout << std::endl << "===== " << actor_names[i] << std::endl;
+        std::cout << "Actions per battle:          " << (number == 0 ? 0.0f : static_cast<float>(actions) / number) << std::endl;
+        std::cout << "Missed actions:              " << _GetPercentage(misses, misses + static_cast<uint32_t>(hits.size())) << " %" << std::endl;
+        _PrintDistribution("Damage per hit:              ", hits);
+        _PrintDistribution("Damage per battle:           ", damage_per_battle);
+        std::cout << "Battles with a death:        " << _GetPercentage(deaths, number) << " %" << std::endl;
+    }
+    std::cout << std::endl;
+}
+
+} // namespace vt_battle
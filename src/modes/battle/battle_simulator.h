@@ -0,0 +1,118 @@
+////////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2018 by Bertram (Valyria Tear)
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+////////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file   battle_simulator.h
+*** \author Yohann Ferreira, yohann ferreira orange fr
+*** \brief  Header file for the headless battle simulator
+***
+*** The simulator plays a save game party against an enemy group many times,
+*** to evaluate an encounter balance without playing it. Each battle is an
+*** actual BattleMode run on the game stack: the actors, skill and item
+*** actions, status effects, damage formulas and enemy AI scripts are the
+*** game ones. The characters fight in auto-battle, and nothing is drawn
+*** nor played.
+***
+*** The game timers are updated by a fixed time, and the C and Lua random
+*** numbers are seeded for each battle, so that a battle always gives the
+*** same outcome for a given seed.
+*** ***************************************************************************/
+
+#ifndef __BATTLE_SIMULATOR_HEADER__
+#define __BATTLE_SIMULATOR_HEADER__
+
+#include "modes/battle/objects/battle_actor.h"
+
+#include <string>
+#include <vector>
+
+namespace vt_battle
+{
+
+//! \brief The game time each simulation update lasts, in milliseconds
+const uint32_t BATTLE_SIMULATION_UPDATE_TIME = 16;
+
+//! \brief The battle time after which a simulated battle is given up, in milliseconds
+const uint32_t BATTLE_SIMULATION_MAX_TIME = 30 * 60 * 1000;
+
+//! \brief The possible outcomes of a simulated battle
+enum BATTLE_SIMULATION_OUTCOME {
+    BATTLE_SIMULATION_VICTORY = 0,
+    BATTLE_SIMULATION_DEFEAT  = 1,
+    BATTLE_SIMULATION_TIMEOUT = 2
+};
+
+//! \brief The result of a simulated battle
+struct BattleSimulationResult {
+    BattleSimulationResult() :
+        outcome(BATTLE_SIMULATION_TIMEOUT),
+        battle_time(0)
+    {}
+
+    BATTLE_SIMULATION_OUTCOME outcome;
+
+    //! \brief The battle time until the victory or defeat, in milliseconds
+    uint32_t battle_time;
+
+    //! \brief The characters statistics, then the enemies ones
+    std::vector<private_battle::BattleActorStatistics> actors;
+
+    //! \brief Returns the number of actions executed by every actor.
+    uint32_t GetNumberTurns() const;
+};
+
+/** ****************************************************************************
+*** \brief Runs headless battles between a save game party and an enemy group
+***
+*** The game engine must be initialized, and the game stack left to the
+*** simulator while it runs.
+*** ***************************************************************************/
+class BattleSimulator
+{
+public:
+    //! \note An empty game mode is pushed on the game stack, to stay under the battles.
+    BattleSimulator(const std::string& save_filename, const std::vector<uint32_t>& enemy_ids);
+
+    /** \brief Simulates a range of battles
+    *** \param first The number of the first battle, the seed of each battle being seed + its number
+    *** \param results Filled with the result of each battle
+    *** \return false if a battle couldn't be set up
+    **/
+    bool Run(uint32_t first, uint32_t number, uint32_t seed, std::vector<BattleSimulationResult>& results);
+
+    //! \brief Returns the name of each actor, in the battle results order,
+    //! once a battle was simulated.
+    const std::vector<std::string>& GetActorNames() const {
+        return _actor_names;
+    }
+
+    //! \brief Writes battle results to a file, read back with LoadResults().
+    static bool SaveResults(const std::string& filename, const std::vector<BattleSimulationResult>& results);
+
+    //! \brief Appends the battle results of a file written by SaveResults().
+    static bool LoadResults(const std::string& filename, std::vector<BattleSimulationResult>& results);
+
+    //! \brief Prints the win rates, turn counts and damage distributions of a set of battles.
+    static void PrintReport(const std::vector<BattleSimulationResult>& results,
+                            const std::vector<std::string>& actor_names);
+
+private:
+    std::string _save_filename;
+
+    std::vector<uint32_t> _enemy_ids;
+
+    std::vector<std::string> _actor_names;
+
+    //! \brief Plays one battle until its victory or defeat.
+    bool _Simulate(uint32_t seed, BattleSimulationResult& result);
+};
+
+} // namespace vt_battle
+
+#endif // __BATTLE_SIMULATOR_HEADER__
@@ -81,9 +81,9 @@ void ItemCommand::ResetItemList()
 {
     _battle_items.clear();
 
-    auto inv_items = GlobalManager->GetInventoryHandler().GetInventoryItems();
+    InventoryView<GlobalItem> inv_items = GlobalManager->GetInventoryHandler().GetInventoryItems();
     for (uint32_t i = 0; i < inv_items.size(); ++i) {
-        std::shared_ptr<GlobalItem> global_item = inv_items.at(i);
+        const GlobalItem* global_item = static_cast<const GlobalItem*>(inv_items.GetObject(i).get());
 
         // Only add non key and valid items as items available at battle start.
         if (global_item->GetCount() == 0)
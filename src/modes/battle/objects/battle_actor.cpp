@@ -57,7 +57,8 @@ BattleActor::BattleActor(GlobalActor *actor) :
     _sprite_alpha(1.0f),
     _animation_timer(0),
     _stamina_location(0.0f, 0.0f),
-    _effects_supervisor(new BattleStatusEffectsSupervisor(this))
+    _effects_supervisor(new BattleStatusEffectsSupervisor(this)),
+    _updating_status_effects(false)
 {
     if(actor == nullptr) {
         IF_PRINT_WARNING(BATTLE_DEBUG) << "constructor received nullptr argument" << std::endl;
@@ -134,6 +135,8 @@ void BattleActor::ResetActor()
         _action = nullptr;
     }
 
+    _statistics = BattleActorStatistics();
+
     // Invalidate the actor state to force the reinit of the idle or dead state
     _state = ACTOR_STATE_INVALID;
 
@@ -209,7 +212,11 @@ void BattleActor::ChangeState(ACTOR_STATE new_state)
         _state_timer.Run();
         break;
     }
+    case ACTOR_STATE_ACTING:
+        ++_statistics.actions;
+        break;
     case ACTOR_STATE_DYING:
+        ++_statistics.deaths;
         ChangeSpriteAnimation("dying");
         // Note that the state timer is initialized in Battle Character
         // or In BattleEnemy
@@ -254,10 +261,16 @@ void BattleActor::RegisterDamage(uint32_t amount, BattleTarget *target)
         return;
     }
 
+    // Count the actual hit points lost
+    BattleMode* BM = BattleMode::CurrentInstance();
+    const uint32_t hit_points = GetHitPoints();
     SubtractHitPoints(amount);
+    _statistics.damage_taken += hit_points - GetHitPoints();
+    BattleActor* attacker = _updating_status_effects ? nullptr : BM->GetActingActor();
+    if(attacker)
+        attacker->_statistics.hits.push_back(amount);
 
     // Set the indicator parameters
-    BattleMode* BM = BattleMode::CurrentInstance();
     vt_mode_manager::IndicatorSupervisor& indicator = BM->GetIndicatorSupervisor();
     indicator.AddDamageIndicator(GetXLocation(), GetYLocation(), amount, _GetDamageTextStyle(amount, false));
 
@@ -461,6 +474,10 @@ void BattleActor::RegisterMiss(bool was_attacked)
     vt_mode_manager::IndicatorSupervisor& indicator = BM->GetIndicatorSupervisor();
     indicator.AddMissIndicator(GetXLocation(), y_pos);
 
+    BattleActor* attacker = was_attacked ? BM->GetActingActor() : nullptr;
+    if(attacker)
+        ++attacker->_statistics.misses;
+
     if(was_attacked && IsAlive())
         ChangeSpriteAnimation("dodge");
 }
@@ -524,8 +541,11 @@ void BattleActor::_UpdateState()
         break;
     }
 
-    if (IsAlive())
+    if (IsAlive()) {
+        _updating_status_effects = true;
         _effects_supervisor->Update();
+        _updating_status_effects = false;
+    }
 
     // Don't update the state_timer if the character is hurt.
     if (_hurt_timer.IsRunning())
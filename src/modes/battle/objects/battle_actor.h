@@ -45,6 +45,31 @@ enum ACTOR_STATE {
     ACTOR_STATE_TOTAL         =  12
 };
 
+//! \brief What an actor did during a battle, reported by the battle simulator
+struct BattleActorStatistics {
+    BattleActorStatistics() :
+        actions(0),
+        misses(0),
+        deaths(0),
+        damage_taken(0)
+    {}
+
+    //! \brief The number of actions the actor executed
+    uint32_t actions;
+
+    //! \brief The number of attacks of the actor which missed their target
+    uint32_t misses;
+
+    //! \brief The number of times the actor fell
+    uint32_t deaths;
+
+    //! \brief The hit points lost, status effects included
+    uint32_t damage_taken;
+
+    //! \brief The damage of each hit dealt by the actor actions
+    std::vector<uint32_t> hits;
+};
+
 /** \brief An abstract class for representing an actor in the battle
 ***
 *** An "actor" is a term used to represent both characters and enemies in battle.
@@ -357,6 +382,10 @@ public:
     void SetIdleStateTime(uint32_t time) {
         _idle_state_time = time;
     }
+
+    const BattleActorStatistics& GetStatistics() const {
+        return _statistics;
+    }
     //@}
 
 protected:
@@ -396,6 +425,13 @@ protected:
     //! \brief An assistant class to the actor that manages all the actor's status and elemental effects
     BattleStatusEffectsSupervisor* _effects_supervisor;
 
+    //! \brief Tells whether the status effects are being updated,
+    //! so that the damage they deal isn't credited to the acting actor.
+    bool _updating_status_effects;
+
+    //! \brief What the actor did since the battle start
+    BattleActorStatistics _statistics;
+
     //! \brief Script object used when playing the death sequence.
     //! A default sequence is played one of those is invalid.
     vt_script::ReadScriptDescriptor _death_script;
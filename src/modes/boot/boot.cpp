@@ -18,6 +18,7 @@
 #include "modes/boot/boot.h"
 
 #include "common/global/global.h"
+#include "common/global/global_save.h"
 #include "common/app_name.h"
 
 #include "engine/input.h"
@@ -378,13 +379,12 @@ void BootMode::DrawPostEffects()
 // ****************************************************************************
 uint32_t BootMode::_GetNbSavesAvailable()
 {
+    GlobalManager->WaitForSaveGames();
+
     uint32_t savesAvailable = 0;
-    std::string data_path = GetUserDataPath();
     uint32_t max_slot_id = SystemManager->GetGameSaveSlots();
     for(uint32_t id = 0; id < max_slot_id; ++id) {
-        std::ostringstream f;
-        f << data_path + "saved_game_" << id << ".lua";
-        const std::string& filename = f.str();
+        const std::string filename = FindSaveGameFilename(id);
 
         if(DoesFileExist(filename)) {
             ++savesAvailable;
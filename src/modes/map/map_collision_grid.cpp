@@ -0,0 +1,120 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2018 by Bertram (Valyria Tear)
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See https://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file    map_collision_grid.cpp
+*** \author  Yohann Ferreira, yohann ferreira orange fr
+*** \brief   Source file for the bit-packed map collision grid.
+*** ***************************************************************************/
+
+#include "modes/map/map_collision_grid.h"
+
+namespace vt_map
+{
+
+namespace private_map
+{
+
+void CollisionBitGrid::Resize(uint32_t width, uint32_t height)
+{
+    _width = width;
+    _height = height;
+    _words_per_row = (width + 63) / 64;
+    _cells.assign(_words_per_row * _height, 0);
+}
+
+void CollisionBitGrid::Clear()
+{
+    _cells.assign(_cells.size(), 0);
+}
+
+void CollisionBitGrid::SetCell(uint32_t x, uint32_t y, bool blocked)
+{
+    uint64_t& word = _cells[y * _words_per_row + (x >> 6)];
+    const uint64_t bit = static_cast<uint64_t>(1) << (x & 63);
+    if (blocked)
+        word |= bit;
+    else
+        word &= ~bit;
+}
+
+void CollisionBitGrid::BlockArea(uint32_t left, uint32_t top, uint32_t right, uint32_t bottom)
+{
+    const uint32_t first_word = left >> 6;
+    const uint32_t last_word = right >> 6;
+
+    for (uint32_t y = top; y <= bottom; ++y) {
+        uint64_t* row = &_cells[y * _words_per_row];
+        for (uint32_t w = first_word; w <= last_word; ++w) {
+            row[w] |= _GetWordMask(w == first_word ? (left & 63) : 0,
+                                   w == last_word ? (right & 63) : 63);
+        }
+    }
+}
+
+bool CollisionBitGrid::IsAreaBlocked(uint32_t left, uint32_t top, uint32_t right, uint32_t bottom) const
+{
+    const uint32_t first_word = left >> 6;
+    const uint32_t last_word = right >> 6;
+
+    // Most queries are done for sprite-sized areas and fit within a single word.
+    if (first_word == last_word) {
+        const uint64_t mask = _GetWordMask(left & 63, right & 63);
+        for (uint32_t y = top; y <= bottom; ++y) {
+            if (_cells[y * _words_per_row + first_word] & mask)
+                return true;
+        }
+        return false;
+    }
+
+    for (uint32_t y = top; y <= bottom; ++y) {
+        const uint64_t* row = &_cells[y * _words_per_row];
+        for (uint32_t w = first_word; w <= last_word; ++w) {
+            if (row[w] & _GetWordMask(w == first_word ? (left & 63) : 0,
+                                      w == last_word ? (right & 63) : 63))
+                return true;
+        }
+    }
+    return false;
+}
+
+bool CollisionBitGrid::GetChangedArea(const CollisionBitGrid& other, uint32_t& left, uint32_t& top,
+                                      uint32_t& right, uint32_t& bottom) const
+{
+    bool changed = false;
+    uint32_t first_word = _words_per_row;
+    uint32_t last_word = 0;
+
+    for (uint32_t y = 0; y < _height; ++y) {
+        const uint64_t* row = &_cells[y * _words_per_row];
+        const uint64_t* other_row = &other._cells[y * _words_per_row];
+        for (uint32_t w = 0; w < _words_per_row; ++w) {
+            if (row[w] == other_row[w])
+                continue;
+
+            if (!changed)
+                top = y;
+            changed = true;
+            bottom = y;
+            first_word = w < first_word ? w : first_word;
+            last_word = w > last_word ? w : last_word;
+        }
+    }
+
+    if (!changed)
+        return false;
+
+    left = first_word * 64;
+    right = last_word * 64 + 63 < _width ? last_word * 64 + 63 : _width - 1;
+    return true;
+}
+
+} // namespace private_map
+
+} // namespace vt_map
@@ -0,0 +1,118 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2018 by Bertram (Valyria Tear)
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See https://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file    map_collision_grid.h
+*** \author  Yohann Ferreira, yohann ferreira orange fr
+*** \brief   Header file for the bit-packed map collision grid.
+*** ***************************************************************************/
+
+#ifndef __MAP_COLLISION_GRID_HEADER__
+#define __MAP_COLLISION_GRID_HEADER__
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace vt_map
+{
+
+namespace private_map
+{
+
+/** ****************************************************************************
+*** \brief A bit-packed grid telling which collision grid elements are blocked.
+***
+*** Each row of the grid is stored as a series of 64-bit words, one bit per
+*** grid element. This permits to answer whether any element of a rectangular
+*** area is blocked with a few word operations per row, instead of testing
+*** every element one by one.
+***
+*** \note Coordinates are given in collision grid elements and the area bounds
+*** are inclusive. The caller is responsible for giving valid coordinates.
+*** ***************************************************************************/
+class CollisionBitGrid
+{
+public:
+    CollisionBitGrid() :
+        _width(0),
+        _height(0),
+        _words_per_row(0)
+    {}
+
+    //! \brief Resizes the grid to the given dimensions and unblocks every element.
+    void Resize(uint32_t width, uint32_t height);
+
+    //! \brief Unblocks every element of the grid, keeping its dimensions.
+    void Clear();
+
+    //! \brief Exchanges the content of two grids.
+    void Swap(CollisionBitGrid& other) {
+        std::swap(_width, other._width);
+        std::swap(_height, other._height);
+        std::swap(_words_per_row, other._words_per_row);
+        _cells.swap(other._cells);
+    }
+
+    uint32_t GetWidth() const {
+        return _width;
+    }
+
+    uint32_t GetHeight() const {
+        return _height;
+    }
+
+    //! \brief Tells whether the given grid element is blocked.
+    bool IsCellBlocked(uint32_t x, uint32_t y) const {
+        return (_cells[y * _words_per_row + (x >> 6)] >> (x & 63)) & 1;
+    }
+
+    //! \brief Blocks or unblocks the given grid element.
+    void SetCell(uint32_t x, uint32_t y, bool blocked);
+
+    //! \brief Blocks every element of the given area.
+    void BlockArea(uint32_t left, uint32_t top, uint32_t right, uint32_t bottom);
+
+    //! \brief Tells whether at least one element of the given area is blocked.
+    bool IsAreaBlocked(uint32_t left, uint32_t top, uint32_t right, uint32_t bottom) const;
+
+    /** \brief Gives the bounds of the elements which differ from another grid of the same dimensions.
+    *** The horizontal bounds are rounded to whole words.
+    *** \return False if both grids are the same.
+    **/
+    bool GetChangedArea(const CollisionBitGrid& other, uint32_t& left, uint32_t& top,
+                        uint32_t& right, uint32_t& bottom) const;
+
+    //! \brief Gives direct access to the packed row words of the given row.
+    const uint64_t* GetRow(uint32_t y) const {
+        return &_cells[y * _words_per_row];
+    }
+
+private:
+    //! \brief The grid dimensions, in collision grid elements.
+    uint32_t _width;
+    uint32_t _height;
+
+    //! \brief The number of 64-bit words used to store one grid row.
+    uint32_t _words_per_row;
+
+    //! \brief The grid bits, stored row after row: _cells[y * _words_per_row + x / 64]
+    std::vector<uint64_t> _cells;
+
+    //! \brief Returns the mask of the bits between the first and last bit index of a word (inclusive).
+    static uint64_t _GetWordMask(uint32_t first_bit, uint32_t last_bit) {
+        return (~static_cast<uint64_t>(0) << first_bit) & (~static_cast<uint64_t>(0) >> (63 - last_bit));
+    }
+};
+
+} // namespace private_map
+
+} // namespace vt_map
+
+#endif // __MAP_COLLISION_GRID_HEADER__
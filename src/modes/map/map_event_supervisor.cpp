@@ -15,23 +15,95 @@
 
 #include "engine/system.h"
 
+#include <algorithm>
+
 namespace vt_map
 {
 
 namespace private_map
 {
 
+void DelayedEventWheel::Add(MapEvent* event, uint32_t delay)
+{
+    // An event is launched at the earliest on the next advance.
+    _Insert(Entry(_current_time + std::max<uint32_t>(delay, 1), event));
+    ++_size;
+}
+
+void DelayedEventWheel::Advance(uint32_t elapsed, std::vector<MapEvent*>& expired)
+{
+    const uint64_t target_time = _current_time + elapsed;
+    while(_current_time < target_time) {
+        // Nothing to launch, so the time can be skipped at once.
+        if(_size == 0) {
+            _current_time = target_time;
+            return;
+        }
+
+        ++_current_time;
+
+        // When a first level turn is complete, bring the next second level slot down.
+        if((_current_time & (LEVEL0_SLOTS - 1)) == 0) {
+            uint32_t level1_index = (_current_time >> LEVEL0_BITS) & (LEVEL1_SLOTS - 1);
+            if(level1_index == 0)
+                _Cascade(_overflow);
+            _Cascade(_level1[level1_index]);
+        }
+
+        std::vector<Entry>& slot = _level0[_current_time & (LEVEL0_SLOTS - 1)];
+        for(const Entry& entry : slot)
+            expired.push_back(entry.event);
+        _size -= slot.size();
+        slot.clear();
+    }
+}
+
+void DelayedEventWheel::Clear()
+{
+    for(uint32_t i = 0; i < LEVEL0_SLOTS; ++i)
+        _level0[i].clear();
+    for(uint32_t i = 0; i < LEVEL1_SLOTS; ++i)
+        _level1[i].clear();
+    _overflow.clear();
+    _size = 0;
+}
+
+void DelayedEventWheel::_Insert(const Entry& entry)
+{
+    if((entry.expire_time >> LEVEL0_BITS) == (_current_time >> LEVEL0_BITS))
+        _level0[entry.expire_time & (LEVEL0_SLOTS - 1)].push_back(entry);
+    else if((entry.expire_time >> (LEVEL0_BITS + LEVEL1_BITS)) == (_current_time >> (LEVEL0_BITS + LEVEL1_BITS)))
+        _level1[(entry.expire_time >> LEVEL0_BITS) & (LEVEL1_SLOTS - 1)].push_back(entry);
+    else
+        _overflow.push_back(entry);
+}
+
+void DelayedEventWheel::_Cascade(std::vector<Entry>& slot)
+{
+    if(slot.empty())
+        return;
+
+    std::vector<Entry> entries;
+    entries.swap(slot);
+    for(const Entry& entry : entries)
+        _Insert(entry);
+}
+
 EventSupervisor::~EventSupervisor()
 {
     _active_events.clear();
     _paused_events.clear();
-    _active_delayed_events.clear();
+    _active_delayed_events.Clear();
     _paused_delayed_events.clear();
+    _waiting_coroutines.Clear();
+    _event_waiters.clear();
+    _awake_coroutines.clear();
 
-    for(std::map<std::string, MapEvent *>::iterator it = _all_events.begin(); it != _all_events.end(); ++it) {
-        delete it->second;
+    for(uint32_t i = 0; i < _events.size(); ++i) {
+        delete _events[i];
     }
-    _all_events.clear();
+    _events.clear();
+    _event_handles.clear();
 }
 
 void EventSupervisor::StartEvent(const std::string &event_id)
@@ -60,7 +132,7 @@ void EventSupervisor::StartEvent(const std::string &event_id, uint32_t launch_ti
     if(launch_time == 0)
         StartEvent(event);
     else
-        _active_delayed_events.push_back(std::make_pair(static_cast<int32_t>(launch_time), event));
+        _active_delayed_events.Add(event, launch_time);
 }
 
 void EventSupervisor::StartEvent(MapEvent *event, uint32_t launch_time)
@@ -74,7 +146,7 @@ void EventSupervisor::StartEvent(MapEvent *event, uint32_t launch_time)
     if(launch_time == 0)
         StartEvent(event);
     else
-        _active_delayed_events.push_back(std::make_pair(static_cast<int32_t>(launch_time), event));
+        _active_delayed_events.Add(event, launch_time);
 }
 
 void EventSupervisor::StartEvent(MapEvent *event)
@@ -93,22 +165,33 @@ void EventSupervisor::StartEvent(MapEvent *event)
         return;
     }
 
-    for(std::vector<MapEvent *>::iterator it = _active_events.begin(); it != _active_events.end(); ++it) {
-        if((*it) == event) {
-            IF_PRINT_WARNING(MAP_DEBUG) << "The event: '" << event->GetEventID()
-                          << "' is already active and can be active only once at a time. "
-                          << "The StartEvent() call will be ignored."
-                          << std::endl << " You should fix the map script: "
-                          << MapMode::CurrentInstance()->GetMapScriptFilename() << std::endl;
-            return;
-        }
+    if(event->_active) {
+        IF_PRINT_WARNING(MAP_DEBUG) << "The event: '" << event->GetEventID()
+                      << "' is already active and can be active only once at a time. "
+                      << "The StartEvent() call will be ignored."
+                      << std::endl << " You should fix the map script: "
+                      << MapMode::CurrentInstance()->GetMapScriptFilename() << std::endl;
+        return;
     }
 
-    _active_events.push_back(event);
+    _AddActiveEvent(event);
     event->_Start();
     _ExamineEventLinks(event, true);
 }
 
+void EventSupervisor::ResolveEventLinks()
+{
+    for(MapEvent* event : _events) {
+        for(EventLink& link : event->_event_links) {
+            if(link.child_event == nullptr && _ResolveEventLink(link) == nullptr) {
+                IF_PRINT_WARNING(MAP_DEBUG) << "No event with this ID existed: '"
+                                            << link.child_event_id << "' linked from event ID: '"
+                                            << event->GetEventID() << "'" << std::endl;
+            }
+        }
+    }
+}
+
 void EventSupervisor::PauseEvent(const std::string &event_id)
 {
     // Never ever do that when updating events.
@@ -120,26 +203,20 @@ void EventSupervisor::PauseEvent(const std::string &event_id)
         return;
     }
 
-    // Search for active ones
-    for(std::vector<MapEvent *>::iterator it = _active_events.begin(); it != _active_events.end();) {
-        if((*it)->_event_id == event_id) {
-            _paused_events.push_back(*it);
-            it = _active_events.erase(it);
-        } else {
-            ++it;
-        }
+    MapEvent* event = GetEvent(event_id);
+    if(event == nullptr)
+        return;
+
+    // Search for the active one
+    if(event->_active) {
+        std::vector<MapEvent *>::iterator it = std::find(_active_events.begin(), _active_events.end(), event);
+        _paused_events.push_back(event);
+        _RemoveActiveEvent(it);
     }
 
     // and for the delayed ones
-    for(std::vector<std::pair<int32_t, MapEvent *> >::iterator it = _active_delayed_events.begin();
-            it != _active_delayed_events.end();) {
-        if((*it).second->_event_id == event_id) {
-            _paused_delayed_events.push_back(*it);
-            it = _active_delayed_events.erase(it);
-        } else {
-            ++it;
-        }
-    }
+    _active_delayed_events.Extract([event](MapEvent* delayed_event) { return delayed_event == event; },
+                                   _paused_delayed_events);
 }
 
 void EventSupervisor::PauseAllEvents(VirtualSprite *sprite)
@@ -162,23 +239,17 @@ void EventSupervisor::PauseAllEvents(VirtualSprite *sprite)
         SpriteEvent *event = dynamic_cast<SpriteEvent *>(*it);
         if(event && event->GetSprite() == sprite) {
             _paused_events.push_back(*it);
-            it = _active_events.erase(it);
+            it = _RemoveActiveEvent(it);
         } else {
             ++it;
         }
     }
 
     // Looking at incoming ones.
-    for(std::vector<std::pair<int32_t, MapEvent *> >::iterator it = _active_delayed_events.begin();
-            it != _active_delayed_events.end();) {
-        SpriteEvent *event = dynamic_cast<SpriteEvent *>((*it).second);
-        if(event && event->GetSprite() == sprite) {
-            _paused_delayed_events.push_back(*it);
-            it = _active_delayed_events.erase(it);
-        } else {
-            ++it;
-        }
-    }
+    _active_delayed_events.Extract([sprite](MapEvent* delayed_event) {
+                                       SpriteEvent *event = dynamic_cast<SpriteEvent *>(delayed_event);
+                                       return event && event->GetSprite() == sprite;
+                                   }, _paused_delayed_events);
 }
 
 void EventSupervisor::ResumeEvent(const std::string &event_id)
@@ -192,10 +263,14 @@ void EventSupervisor::ResumeEvent(const std::string &event_id)
         return;
     }
 
+    MapEvent* event = GetEvent(event_id);
+    if(event == nullptr)
+        return;
+
     for(std::vector<MapEvent *>::iterator it = _paused_events.begin();
             it != _paused_events.end();) {
-        if((*it)->_event_id == event_id) {
-            _active_events.push_back(*it);
+        if(*it == event) {
+            _AddActiveEvent(*it);
             it = _paused_events.erase(it);
         } else {
             ++it;
@@ -205,8 +280,8 @@ void EventSupervisor::ResumeEvent(const std::string &event_id)
     // and the delayed ones
     for(std::vector<std::pair<int32_t, MapEvent *> >::iterator it = _paused_delayed_events.begin();
             it != _paused_delayed_events.end();) {
-        if((*it).second->_event_id == event_id) {
-            _active_delayed_events.push_back(*it);
+        if((*it).second == event) {
+            _active_delayed_events.Add(it->second, it->first);
             it = _paused_delayed_events.erase(it);
         } else {
             ++it;
@@ -233,7 +308,7 @@ void EventSupervisor::ResumeAllEvents(VirtualSprite *sprite)
     for(std::vector<MapEvent *>::iterator it = _paused_events.begin(); it != _paused_events.end();) {
         SpriteEvent *event = dynamic_cast<SpriteEvent *>(*it);
         if(event && event->GetSprite() == sprite) {
-            _active_events.push_back(*it);
+            _AddActiveEvent(*it);
             it = _paused_events.erase(it);
         } else {
             ++it;
@@ -245,7 +320,7 @@ void EventSupervisor::ResumeAllEvents(VirtualSprite *sprite)
             it != _paused_delayed_events.end();) {
         SpriteEvent *event = dynamic_cast<SpriteEvent *>((*it).second);
         if(event && event->GetSprite() == sprite) {
-            _active_delayed_events.push_back(*it);
+            _active_delayed_events.Add(it->second, it->first);
             it = _paused_delayed_events.erase(it);
         } else {
             ++it;
@@ -255,8 +330,6 @@ void EventSupervisor::ResumeAllEvents(VirtualSprite *sprite)
 
 void EventSupervisor::EndEvent(const std::string &event_id, bool trigger_event_links)
 {
-    // Examine all potential active (now or later) events
-
     // Never ever do that when updating events.
     if(_is_updating) {
         PRINT_WARNING << "Tried to terminate the event: '" << event_id
@@ -266,91 +339,86 @@ void EventSupervisor::EndEvent(const std::string &event_id, bool trigger_event_l
         return;
     }
 
-    // Starting by active ones.
-    for(std::vector<MapEvent *>::iterator it = _active_events.begin(); it != _active_events.end();) {
-        if((*it)->_event_id == event_id) {
-            SpriteEvent *sprite_event = dynamic_cast<SpriteEvent *>(*it);
-            // Terminated sprite events need to release their owned sprite.
-            if(sprite_event)
-                sprite_event->Terminate();
-
-            MapEvent *terminated_event = *it;
-            it = _active_events.erase(it);
-            // We examine the event links only after the event has been removed from the active list
-            if(trigger_event_links)
-                _ExamineEventLinks(terminated_event, false);
-        } else {
-            ++it;
-        }
+    // Nothing to terminate when there is no such event.
+    MapEvent* event = GetEvent(event_id);
+    if(event != nullptr)
+        EndEvent(event, trigger_event_links);
+}
+
+void EventSupervisor::EndEvent(MapEvent *event, bool trigger_event_links)
+{
+    if(!event) {
+        PRINT_ERROR << "Couldn't terminate nullptr event" << std::endl;
+        return;
     }
 
-    // Looking at incoming ones.
-    for(std::vector<std::pair<int32_t, MapEvent *> >::iterator it = _active_delayed_events.begin();
-            it != _active_delayed_events.end();) {
-        if((*it).second->_event_id == event_id) {
-            MapEvent *terminated_event = (*it).second;
-            it = _active_delayed_events.erase(it);
+    // Never ever do that when updating events.
+    if(_is_updating) {
+        PRINT_WARNING << "Tried to terminate the event: '" << event->GetEventID()
+                      << "' within an update function. The EndEvent() call will be ignored."
+                      << std::endl << " You should fix the map script: "
+                      << MapMode::CurrentInstance()->GetMapScriptFilename() << std::endl;
+        return;
+    }
 
-            // We examine the event links only after the event has been removed from the active list
-            if(trigger_event_links)
-                _ExamineEventLinks(terminated_event, false);
-        } else {
-            ++it;
-        }
+    // Ended coroutine events don't wait for anything anymore.
+    if(event->GetEventType() == COROUTINE_EVENT)
+        _StopCoroutine(static_cast<CoroutineEvent *>(event));
+
+    // Examine all potential active (now or later) events
+    // Starting by the active one.
+    if(event->_active) {
+        SpriteEvent *sprite_event = dynamic_cast<SpriteEvent *>(event);
+        // Terminated sprite events need to release their owned sprite.
+        if(sprite_event)
+            sprite_event->Terminate();
+
+        _RemoveActiveEvent(std::find(_active_events.begin(), _active_events.end(), event));
+        _WakeEventWaiters(event);
+        // We examine the event links only after the event has been removed from the active list
+        if(trigger_event_links)
+            _ExamineEventLinks(event, false);
+    }
+
+    // Looking at incoming ones.
+    std::vector<std::pair<int32_t, MapEvent *> > terminated_events;
+    _active_delayed_events.Extract([event](MapEvent* delayed_event) { return delayed_event == event; },
+                                   terminated_events);
+    // We examine the event links only after the event has been removed from the active list
+    if(trigger_event_links) {
+        for(uint32_t i = 0; i < terminated_events.size(); ++i)
+            _ExamineEventLinks(event, false);
     }
 
     // And paused ones
-    for(std::vector<MapEvent *>::iterator it = _paused_events.begin(); it != _paused_events.end();) {
-        if((*it)->_event_id == event_id) {
-            SpriteEvent *sprite_event = dynamic_cast<SpriteEvent *>(*it);
-            // Paused sprite events need to release their owned sprite as they have been previously started.
-            if(sprite_event)
-                sprite_event->Terminate();
+    std::vector<MapEvent *>::iterator paused_it = std::find(_paused_events.begin(), _paused_events.end(), event);
+    if(paused_it != _paused_events.end()) {
+        SpriteEvent *sprite_event = dynamic_cast<SpriteEvent *>(event);
+        // Paused sprite events need to release their owned sprite as they have been previously started.
+        if(sprite_event)
+            sprite_event->Terminate();
 
-            MapEvent *terminated_event = *it;
-            it = _paused_events.erase(it);
-            // We examine the event links only after the event has been removed from the list
-            if(trigger_event_links)
-                _ExamineEventLinks(terminated_event, false);
-        } else {
-            ++it;
-        }
+        _paused_events.erase(paused_it);
+        _WakeEventWaiters(event);
+        // We examine the event links only after the event has been removed from the list
+        if(trigger_event_links)
+            _ExamineEventLinks(event, false);
     }
 
     for(std::vector<std::pair<int32_t, MapEvent *> >::iterator it = _paused_delayed_events.begin();
             it != _paused_delayed_events.end();) {
-        if((*it).second->_event_id == event_id) {
-            MapEvent *terminated_event = (*it).second;
+        if((*it).second == event) {
             it = _paused_delayed_events.erase(it);
 
             // We examine the event links only after the event has been removed from the list
             if(trigger_event_links)
-                _ExamineEventLinks(terminated_event, false);
+                _ExamineEventLinks(event, false);
         } else {
             ++it;
         }
     }
 }
 
-void EventSupervisor::EndEvent(MapEvent *event, bool trigger_event_links)
-{
-    if(!event) {
-        PRINT_ERROR << "Couldn't terminate nullptr event" << std::endl;
-        return;
-    }
-
-    // Never ever do that when updating events.
-    if(_is_updating) {
-        PRINT_WARNING << "Tried to terminate the event: '" << event->GetEventID()
-                      << "' within an update function. The EndEvent() call will be ignored."
-                      << std::endl << " You should fix the map script: "
-                      << MapMode::CurrentInstance()->GetMapScriptFilename() << std::endl;
-        return;
-    }
-
-    EndEvent(event->GetEventID(), trigger_event_links);
-}
-
 void EventSupervisor::EndAllEvents(VirtualSprite *sprite)
 {
     if(!sprite)
@@ -372,22 +440,20 @@ void EventSupervisor::EndAllEvents(VirtualSprite *sprite)
         if(event && event->GetSprite() == sprite) {
             // Active events need to release their owned sprite upon termination.
             event->Terminate();
+            _WakeEventWaiters(event);
 
-            it = _active_events.erase(it);
+            it = _RemoveActiveEvent(it);
         } else {
             ++it;
         }
     }
 
     // Looking at incoming ones.
-    for(std::vector<std::pair<int32_t, MapEvent *> >::iterator it = _active_delayed_events.begin();
-            it != _active_delayed_events.end();) {
-        SpriteEvent *event = dynamic_cast<SpriteEvent *>((*it).second);
-        if(event && event->GetSprite() == sprite)
-            it = _active_delayed_events.erase(it);
-        else
-            ++it;
-    }
+    std::vector<std::pair<int32_t, MapEvent *> > terminated_events;
+    _active_delayed_events.Extract([sprite](MapEvent* delayed_event) {
+                                       SpriteEvent *event = dynamic_cast<SpriteEvent *>(delayed_event);
+                                       return event && event->GetSprite() == sprite;
+                                   }, terminated_events);
 
     // And paused ones
     for(std::vector<MapEvent *>::iterator it = _paused_events.begin(); it != _paused_events.end();) {
@@ -395,6 +461,7 @@ void EventSupervisor::EndAllEvents(VirtualSprite *sprite)
         if(event && event->GetSprite() == sprite) {
             // Paused events have been started, so they might need to release their owned sprite.
             event->Terminate();
+            _WakeEventWaiters(event);
 
             it = _paused_events.erase(it);
         } else {
@@ -417,27 +484,21 @@ void EventSupervisor::Update()
     // Store the events that became active in the delayed event loop.
     std::vector<MapEvent *> events_to_start;
 
-    // Update all launch event timers and start all events whose timers have finished
-    for(std::vector<std::pair<int32_t, MapEvent *> >::iterator it = _active_delayed_events.begin();
-            it != _active_delayed_events.end();) {
-        it->first -= vt_system::SystemManager->GetUpdateTime();
-
-        if(it->first <= 0) {  // Timer has expired
-            MapEvent *start_event = it->second;
-            it = _active_delayed_events.erase(it);
-
-            // We add the event ready to start i a vector, waiting for the loop to end
-            // before starting it.
-            events_to_start.push_back(start_event);
-        } else {
-            ++it;
-        }
-    }
+    // Advance the launch timers and get the events whose timers have finished
+    _active_delayed_events.Advance(vt_system::SystemManager->GetUpdateTime(), events_to_start);
 
     // Starts the events that became active.
     for(std::vector<MapEvent *>::iterator it = events_to_start.begin(); it != events_to_start.end(); ++it)
         StartEvent(*it);
 
+    // Wake the coroutine events whose wait time has elapsed.
+    if(!_waiting_coroutines.IsEmpty()) {
+        std::vector<MapEvent *> expired_waits;
+        _waiting_coroutines.Advance(vt_system::SystemManager->GetUpdateTime(), expired_waits);
+        for(uint32_t i = 0; i < expired_waits.size(); ++i)
+            _WakeCoroutine(static_cast<CoroutineEvent *>(expired_waits[i]));
+    }
+
     // Store the events that ended within the update loop.
     std::vector<MapEvent *> finished_events;
 
@@ -451,7 +512,7 @@ void EventSupervisor::Update()
             finished_events.push_back(*it);
 
             // Remove the finished event from the active queue.
-            it = _active_events.erase(it);
+            it = _RemoveActiveEvent(it);
         } else {
             ++it;
         }
@@ -462,28 +523,37 @@ void EventSupervisor::Update()
     // We examine the event links only after the events has been removed from the active list
     // and the active list has finished parsing, to avoid a crash when adding a new event within the update loop.
     for(std::vector<MapEvent *>::iterator it = finished_events.begin(); it != finished_events.end(); ++it) {
+        _WakeEventWaiters(*it);
         _ExamineEventLinks(*it, false);
     }
+
+    // The coroutines are resumed out of the update loop, so that they can start and end events.
+    _ResumeAwakeCoroutines();
 }
 
 bool EventSupervisor::IsEventActive(const std::string &event_id) const
 {
-    for(std::vector<MapEvent *>::const_iterator it = _active_events.begin(); it != _active_events.end(); ++it) {
-        if((*it)->_event_id == event_id) {
-            return true;
-        }
-    }
-    return false;
+    return IsEventActive(GetEventHandle(event_id));
+}
+
+uint32_t EventSupervisor::GetEventHandle(const std::string &event_id) const
+{
+    std::unordered_map<std::string, uint32_t>::const_iterator it = _event_handles.find(event_id);
+
+    if(it == _event_handles.end())
+        return INVALID_EVENT_HANDLE;
+    else
+        return it->second;
 }
 
 MapEvent *EventSupervisor::GetEvent(const std::string &event_id) const
 {
-    std::map<std::string, MapEvent *>::const_iterator it = _all_events.find(event_id);
+    uint32_t event_handle = GetEventHandle(event_id);
 
-    if(it == _all_events.end())
+    if(event_handle == INVALID_EVENT_HANDLE)
         return nullptr;
     else
-        return it->second;
+        return _events[event_handle];
 }
 
 bool EventSupervisor::_RegisterEvent(MapEvent* new_event)
@@ -501,37 +571,117 @@ bool EventSupervisor::_RegisterEvent(MapEvent* new_event)
         return false;
     }
 
-    _all_events.insert(std::make_pair(new_event->_event_id, new_event));
+    // Intern the event ID as the event index.
+    new_event->_event_handle = _events.size();
+    _events.push_back(new_event);
+    _event_handles.insert(std::make_pair(new_event->_event_id, new_event->_event_handle));
+    return true;
+}
+
+bool EventSupervisor::_WaitEventEnd(CoroutineEvent* coroutine, MapEvent* event)
+{
+    // The coroutine event would wait for itself forever.
+    if(event == coroutine)
+        return false;
+
+    if(!event->_active && std::find(_paused_events.begin(), _paused_events.end(), event) == _paused_events.end())
+        return false;
+
+    _event_waiters[event].push_back(coroutine);
     return true;
 }
 
+void EventSupervisor::_WakeEventWaiters(MapEvent* event)
+{
+    if(_event_waiters.empty())
+        return;
+
+    std::unordered_map<MapEvent*, std::vector<CoroutineEvent*> >::iterator it = _event_waiters.find(event);
+    if(it == _event_waiters.end())
+        return;
+
+    _awake_coroutines.insert(_awake_coroutines.end(), it->second.begin(), it->second.end());
+    _event_waiters.erase(it);
+}
+
+void EventSupervisor::_ResumeAwakeCoroutines()
+{
+    if(_awake_coroutines.empty())
+        return;
+
+    // The resumed coroutines may wake others, which are then resumed on the next update.
+    std::vector<CoroutineEvent*> coroutines;
+    coroutines.swap(_awake_coroutines);
+    for(uint32_t i = 0; i < coroutines.size(); ++i) {
+        CoroutineEvent* coroutine = coroutines[i];
+        // Ended by a previously resumed coroutine.
+        if(coroutine->_thread == nullptr)
+            continue;
+
+        // Paused coroutine events are resumed once they are active again.
+        if(!coroutine->_active) {
+            _awake_coroutines.push_back(coroutine);
+            continue;
+        }
+
+        coroutine->_Resume();
+    }
+}
+
+void EventSupervisor::_StopCoroutine(CoroutineEvent* coroutine)
+{
+    std::vector<std::pair<int32_t, MapEvent*> > removed_waits;
+    _waiting_coroutines.Extract([coroutine](MapEvent* waiting_event) { return waiting_event == coroutine; },
+                                removed_waits);
+
+    for(std::unordered_map<MapEvent*, std::vector<CoroutineEvent*> >::iterator it = _event_waiters.begin();
+            it != _event_waiters.end();) {
+        std::vector<CoroutineEvent*>& waiters = it->second;
+        waiters.erase(std::remove(waiters.begin(), waiters.end(), coroutine), waiters.end());
+        if(waiters.empty())
+            it = _event_waiters.erase(it);
+        else
+            ++it;
+    }
+
+    _awake_coroutines.erase(std::remove(_awake_coroutines.begin(), _awake_coroutines.end(), coroutine),
+                            _awake_coroutines.end());
+
+    coroutine->_ReleaseThread();
+}
+
+MapEvent* EventSupervisor::_ResolveEventLink(EventLink& link)
+{
+    link.child_event = GetEvent(link.child_event_id);
+    return link.child_event;
+}
+
 void EventSupervisor::_ExamineEventLinks(MapEvent *parent_event, bool event_start)
 {
     for(uint32_t i = 0; i < parent_event->_event_links.size(); ++i) {
         EventLink &link = parent_event->_event_links[i];
 
         // Case 1: Start/finish launch member is not equal to the start/finish status of the parent event, so ignore this link
-        if(link.launch_at_start != event_start) {
+        if(link.launch_at_start != event_start)
+            continue;
+
+        // Links added after the map loading are resolved on first use.
+        MapEvent *child = link.child_event != nullptr ? link.child_event : _ResolveEventLink(link);
+        if(child == nullptr) {
+            PRINT_WARNING << "Couldn't launch child event, no event with this ID existed: '"
+                          << link.child_event_id << "' from parent event ID: '"
+                          << parent_event->GetEventID()
+                          << "' in map script: "
+                          << MapMode::CurrentInstance()->GetMapScriptFilename() << std::endl;
             continue;
         }
+
         // Case 2: The child event is to be launched immediately
-        else if(link.launch_timer == 0) {
-            StartEvent(link.child_event_id);
-        }
+        if(link.launch_timer == 0)
+            StartEvent(child);
         // Case 3: The child event has a timer associated with it and needs to be placed in the event launch container
-        else {
-            MapEvent *child = GetEvent(link.child_event_id);
-            if(child == nullptr) {
-                PRINT_WARNING << "Couldn't launch child event, no event with this ID existed: '"
-                              << link.child_event_id << "' from parent event ID: '"
-                              << parent_event->GetEventID()
-                              << "' in map script: "
-                              << MapMode::CurrentInstance()->GetMapScriptFilename() << std::endl;
-                continue;
-            } else {
-                _active_delayed_events.push_back(std::make_pair(static_cast<int32_t>(link.launch_timer), child));
-            }
-        }
+        else
+            _active_delayed_events.Add(child, link.launch_timer);
     }
 }
 
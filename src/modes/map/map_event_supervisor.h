@@ -13,12 +13,119 @@
 
 #include "modes/map/map_events.h"
 
+#include <unordered_map>
+
 namespace vt_map
 {
 
 namespace private_map
 {
 
+/** ****************************************************************************
+*** \brief A hierarchical timer wheel holding the events waiting to be launched.
+***
+*** The wheel counts time in milliseconds. The first level holds the events expiring
+*** within the current 256 ms window, one slot per millisecond. The second level holds
+*** the events expiring within the current 16384 ms window, one slot per 256 ms, and
+*** they are cascaded down to the first level when their window is reached. Events
+*** further in time are kept in an overflow list, cascaded every 16384 ms.
+***
+*** This permits to add and launch delayed events without touching every other
+*** waiting event at each update.
+*** ***************************************************************************/
+class DelayedEventWheel
+{
+public:
+    DelayedEventWheel():
+        _current_time(0),
+        _size(0)
+    {}
+
+    //! \brief Adds an event to launch after the given delay, in milliseconds.
+    void Add(MapEvent* event, uint32_t delay);
+
+    /** \brief Advances the wheel time.
+    *** \param elapsed The time elapsed since the last call, in milliseconds.
+    *** \param expired Filled with the events whose delay expired, sorted by expiration time.
+    **/
+    void Advance(uint32_t elapsed, std::vector<MapEvent*>& expired);
+
+    /** \brief Removes the events matching the given predicate from the wheel.
+    *** \param predicate A functor taking a MapEvent pointer and returning true if the event should be removed.
+    *** \param removed Filled with the removed events and their remaining delay.
+    **/
+    template <typename Predicate>
+    void Extract(Predicate predicate, std::vector<std::pair<int32_t, MapEvent*> >& removed) {
+        if(_size == 0)
+            return;
+        for(uint32_t i = 0; i < LEVEL0_SLOTS; ++i)
+            _ExtractFromSlot(_level0[i], predicate, removed);
+        for(uint32_t i = 0; i < LEVEL1_SLOTS; ++i)
+            _ExtractFromSlot(_level1[i], predicate, removed);
+        _ExtractFromSlot(_overflow, predicate, removed);
+    }
+
+    //! \brief Removes every event from the wheel.
+    void Clear();
+
+    bool IsEmpty() const {
+        return _size == 0;
+    }
+
+private:
+    struct Entry {
+        Entry(uint64_t time, MapEvent* map_event):
+            expire_time(time),
+            event(map_event)
+        {}
+
+        //! \brief The wheel time at which the event is launched.
+        uint64_t expire_time;
+
+        MapEvent* event;
+    };
+
+    static const uint32_t LEVEL0_BITS = 8;
+    static const uint32_t LEVEL1_BITS = 6;
+    static const uint32_t LEVEL0_SLOTS = 1 << LEVEL0_BITS;
+    static const uint32_t LEVEL1_SLOTS = 1 << LEVEL1_BITS;
+
+    //! \brief The wheel time, in milliseconds.
+    uint64_t _current_time;
+
+    //! \brief The number of events in the wheel.
+    uint32_t _size;
+
+    //! \brief The first level slots, one per millisecond.
+    std::vector<Entry> _level0[LEVEL0_SLOTS];
+
+    //! \brief The second level slots, one per first level turn.
+    std::vector<Entry> _level1[LEVEL1_SLOTS];
+
+    //! \brief The events expiring after the second level turn.
+    std::vector<Entry> _overflow;
+
+    //! \brief Places an entry in the slot corresponding to its expiration time.
+    void _Insert(const Entry& entry);
+
+    //! \brief Re-inserts the entries of a slot, which moves them down a level.
+    void _Cascade(std::vector<Entry>& slot);
+
+    template <typename Predicate>
+    void _ExtractFromSlot(std::vector<Entry>& slot, Predicate predicate,
+                          std::vector<std::pair<int32_t, MapEvent*> >& removed) {
+        for(std::vector<Entry>::iterator it = slot.begin(); it != slot.end();) {
+            if(predicate(it->event)) {
+                removed.push_back(std::make_pair(static_cast<int32_t>(it->expire_time - _current_time), it->event));
+                it = slot.erase(it);
+                --_size;
+            } else {
+                ++it;
+            }
+        }
+    }
+};
+
 /** ****************************************************************************
 *** \brief Manages, processes, and launches map events
 ***
@@ -33,15 +140,15 @@ namespace private_map
 *** Immediately after starting the first event, the supervisor will examine its event
 *** links to determine which, if any, children events begin relative to the start of
 *** the base event. If they are to start a certain time after the start of the parent
-*** event, they are placed in a container and their countdown timers are initialized.
-*** These timers will count down on every update call to the event manager and after
-*** the timers expire, these events will be launched. When an active event ends, again
+*** event, they are placed in a timer wheel which is advanced on every update call
+*** to the event manager, and after their delay expires, these events will be launched. When an active event ends, again
 *** its event links are examined to determine if any children events exist that start
 *** relative to the end of the parent event.
 *** ***************************************************************************/
 class EventSupervisor
 {
     friend class MapEvent;
+    friend class CoroutineEvent;
 public:
     EventSupervisor():
         _is_updating(false)
@@ -69,6 +176,12 @@ public:
     void StartEvent(MapEvent* event);
     void StartEvent(MapEvent* event, uint32_t launch_time);
 
+    /** \brief Resolves the child events of every registered event links.
+    *** Called once the map script has been loaded, so that starting or ending events
+    *** don't need to look up their children IDs. Links added later are resolved on first use.
+    **/
+    void ResolveEventLinks();
+
     /** \brief Pauses the active events by preventing them from updating
     *** \param event_id The ID of the active event(s) to pause
     *** If the event corresponding to the ID is not active, a warning will be issued and no change
@@ -119,6 +232,21 @@ public:
     **/
     bool IsEventActive(const std::string& event_id) const;
 
+    /** \brief Determines if a chosen event is active
+    *** \param event_handle The handle of the event to check, as returned by GetEventHandle()
+    *** \return True if the event is active, false if it is not or the handle is invalid
+    *** \note Bound as IsEventActiveHandle() in Lua, as luabind can't tell the overloads apart.
+    **/
+    bool IsEventActive(uint32_t event_handle) const {
+        return event_handle < _events.size() && _events[event_handle]->_active;
+    }
+
+    /** \brief Returns the integer handle of an event, permitting faster repeated queries.
+    *** \param event_id The ID of the event
+    *** \return The event handle, or INVALID_EVENT_HANDLE if no event was found
+    **/
+    uint32_t GetEventHandle(const std::string& event_id) const;
+
     //! \brief Returns true if any events are active
     bool HasActiveEvent() const {
         return !_active_events.empty();
@@ -126,7 +254,7 @@ public:
 
     //! \brief Returns true if any events are being prepared to be launched after their timers expire
     bool HasActiveDelayedEvent() const {
-        return !_active_delayed_events.empty();
+        return !_active_delayed_events.IsEmpty();
     }
 
     /** \brief Returns a pointer to a specified event stored by this class
@@ -138,9 +266,15 @@ public:
     bool DoesEventExist(const std::string& event_id) const
     { return !(GetEvent(event_id) == nullptr); }
 
+    //! \brief The value returned by GetEventHandle() when no event was found.
+    static const uint32_t INVALID_EVENT_HANDLE = 0xFFFFFFFF;
+
 private:
-    //! \brief A container for all map events, where the event's ID serves as the key to the std::map
-    std::map<std::string, MapEvent*> _all_events;
+    //! \brief The handles of all map events, where the event's ID serves as the key.
+    std::unordered_map<std::string, uint32_t> _event_handles;
+
+    //! \brief All map events, indexed by their handle.
+    std::vector<MapEvent*> _events;
 
     //! \brief A list of all events which have started but are not yet finished
     std::vector<MapEvent*> _active_events;
@@ -148,10 +282,8 @@ private:
     //! \brief A list of all events which have been paused
     std::vector<MapEvent*> _paused_events;
 
-    /** \brief A list of all events that are waiting on their launch timers to expire before being started
-    *** The interger part of this std::pair is the countdown timer for this event to be launched
-    **/
-    std::vector<std::pair<int32_t, MapEvent*> > _active_delayed_events;
+    //! \brief All events that are waiting on their launch timers to expire before being started
+    DelayedEventWheel _active_delayed_events;
 
     /** \brief A list of all events that are waiting on their launch timers to expire before being started
     *** The interger part of this std::pair is the countdown timer for this event to be launched
@@ -159,6 +291,15 @@ private:
     **/
     std::vector<std::pair<int32_t, MapEvent*> > _paused_delayed_events;
 
+    //! \brief The coroutine events waiting for a time to elapse before being resumed.
+    DelayedEventWheel _waiting_coroutines;
+
+    //! \brief The coroutine events waiting for an event to end, indexed by the awaited event.
+    std::unordered_map<MapEvent*, std::vector<CoroutineEvent*> > _event_waiters;
+
+    //! \brief The coroutine events to resume, once the event update loop is done.
+    std::vector<CoroutineEvent*> _awake_coroutines;
+
     /** States whether the event supervisor is parsing the active events queue, thus any modifications
     *** there on active events should be avoided.
     **/
@@ -170,6 +311,47 @@ private:
     **/
     void _ExamineEventLinks(MapEvent* parent_event, bool event_start);
 
+    //! \brief Sets the child event of a link from its ID, returning it or nullptr if it doesn't exist.
+    MapEvent* _ResolveEventLink(EventLink& link);
+
+    //! \brief Adds an event to the active list, and removes it from there.
+    //! These keep the event active flag in sync with the active list.
+    //@{
+    void _AddActiveEvent(MapEvent* event) {
+        event->_active = true;
+        _active_events.push_back(event);
+    }
+
+    std::vector<MapEvent*>::iterator _RemoveActiveEvent(std::vector<MapEvent*>::iterator it) {
+        (*it)->_active = false;
+        return _active_events.erase(it);
+    }
+    //@}
+
+    //! \brief Resumes the coroutine event after the given time, in milliseconds.
+    void _WaitTime(CoroutineEvent* coroutine, uint32_t time) {
+        _waiting_coroutines.Add(coroutine, time);
+    }
+
+    /** \brief Resumes the coroutine event once the given event has ended.
+    *** \return false if the event isn't running, so that there is nothing to wait for.
+    **/
+    bool _WaitEventEnd(CoroutineEvent* coroutine, MapEvent* event);
+
+    //! \brief Resumes the coroutine event on the next update.
+    void _WakeCoroutine(CoroutineEvent* coroutine) {
+        _awake_coroutines.push_back(coroutine);
+    }
+
+    //! \brief Wakes the coroutine events waiting for the given event to end.
+    void _WakeEventWaiters(MapEvent* event);
+
+    //! \brief Resumes the awake coroutine events which aren't paused.
+    void _ResumeAwakeCoroutines();
+
+    //! \brief Forgets whatever the coroutine event waits for, and its coroutine.
+    void _StopCoroutine(CoroutineEvent* coroutine);
+
     /** \brief Registers a map event object with the event supervisor
     *** \param new_event A pointer to the new event
     *** \return whether the event was successfully registered.
@@ -23,6 +23,8 @@
 #include "modes/map/map_dialogues/map_sprite_dialogue.h"
 
 #include "modes/map/map_mode.h"
+
+#include "engine/script_profiler.h"
 #include "modes/map/map_sprites/map_sprite.h"
 
 #include "modes/shop/shop.h"
@@ -48,7 +50,9 @@ namespace private_map
 
 MapEvent::MapEvent(const std::string& id, EVENT_TYPE type):
     _event_id(id),
-    _event_type(type)
+    _event_type(type),
+    _event_handle(0),
+    _active(false)
 {
     vt_map::MapMode* map_mode = MapMode::CurrentInstance();
     if (!map_mode) {
@@ -196,6 +200,9 @@ void MapTransitionEvent::_Start()
 
     VideoManager->_StartTransitionFadeOut(Color::black, MAP_FADE_OUT_TIME);
     _done = false;
+
+    // Prepare the next map audio while the screen fades out.
+    MapMode::PreloadMapAudio(_transition_map_script_filename);
 }
 
 bool MapTransitionEvent::_Update()
@@ -318,6 +325,7 @@ void IfEvent::_Start()
     EventSupervisor* events = MapMode::CurrentInstance()->GetEventSupervisor();
 
     try {
+        ScriptProfileScope profile(_check_function, "IfEvent check", GetEventID());
         // We had a timer of 100ms her to avoid launching an event within an event
         // for the sake of the engine loop. That time is unnoticeable, anyway.
         if (luabind::call_function<bool>(_check_function)
@@ -376,6 +384,7 @@ void ScriptedEvent::_Start()
         return;
 
     try {
+        ScriptProfileScope profile(_start_function, "ScriptedEvent start", GetEventID());
         luabind::call_function<void>(_start_function);
     } catch(const luabind::error &e) {
         PRINT_ERROR << "Error while loading ScriptedEvent start function"
@@ -394,6 +403,7 @@ bool ScriptedEvent::_Update()
         return true;
 
     try {
+        ScriptProfileScope profile(_update_function, "ScriptedEvent update", GetEventID());
         return luabind::call_function<bool>(_update_function);
     } catch(const luabind::error &e) {
         PRINT_ERROR << "Error while loading ScriptedEvent update function"
@@ -407,6 +417,188 @@ bool ScriptedEvent::_Update()
     return true;
 }
 
+// -----------------------------------------------------------------------------
+// ---------- CoroutineEvent Class Methods
+// -----------------------------------------------------------------------------
+
+//! \brief The conditions a coroutine can wait for, yielded before the wait argument.
+enum COROUTINE_WAIT {
+    COROUTINE_WAIT_TIME = 0,
+    COROUTINE_WAIT_EVENT = 1,
+    COROUTINE_WAIT_SPRITE_ARRIVAL = 2
+};
+
+//! \brief Yields the running coroutine with the wait type, followed by the wait argument.
+static int _YieldWait(lua_State* lua_state, COROUTINE_WAIT wait_type)
+{
+    lua_settop(lua_state, 1);
+    lua_pushinteger(lua_state, wait_type);
+    lua_insert(lua_state, 1);
+    return lua_yield(lua_state, 2);
+}
+
+CoroutineEvent::CoroutineEvent(const std::string& event_id,
+                               const std::string& function) :
+    MapEvent(event_id, COROUTINE_EVENT),
+    _thread(nullptr),
+    _resuming(false),
+    _release_requested(false)
+{
+    ReadScriptDescriptor &map_script = MapMode::CurrentInstance()->GetMapScript();
+    if (!MapMode::CurrentInstance()->OpenMapTablespace(true))
+        return;
+    if (!map_script.OpenTable("map_functions"))
+        return;
+
+    if(!function.empty())
+        _function = map_script.ReadFunctionPointer(function);
+
+    map_script.CloseTable(); // map_functions
+    map_script.CloseTable(); // tablespace
+}
+
+CoroutineEvent* CoroutineEvent::Create(const std::string& event_id,
+                                       const std::string& function)
+{
+    return new CoroutineEvent(event_id, function);
+}
+
+int CoroutineEvent::LuaWait(lua_State* lua_state)
+{
+    luaL_checknumber(lua_state, 1);
+    return _YieldWait(lua_state, COROUTINE_WAIT_TIME);
+}
+
+int CoroutineEvent::LuaWaitEvent(lua_State* lua_state)
+{
+    luaL_checkstring(lua_state, 1);
+    return _YieldWait(lua_state, COROUTINE_WAIT_EVENT);
+}
+
+int CoroutineEvent::LuaWaitSpriteArrival(lua_State* lua_state)
+{
+    luaL_checkany(lua_state, 1);
+    return _YieldWait(lua_state, COROUTINE_WAIT_SPRITE_ARRIVAL);
+}
+
+void CoroutineEvent::_Start()
+{
+    // Forget the previous run, should the event have been ended while paused.
+    MapMode::CurrentInstance()->GetEventSupervisor()->_StopCoroutine(this);
+
+    if(!_function.is_valid())
+        return;
+
+    lua_State* lua_state = _function.interpreter();
+    _thread = lua_newthread(lua_state);
+    _thread_object = luabind::object(luabind::from_stack(lua_state, -1));
+    lua_pop(lua_state, 1);
+
+    _function.push(_thread);
+    _Resume();
+}
+
+void CoroutineEvent::_Resume()
+{
+    if(_thread == nullptr)
+        return;
+
+    int status = 0;
+    int number_values = 0;
+    _resuming = true;
+    {
+        ScriptProfileScope profile(_thread, "CoroutineEvent resume", GetEventID());
+#if LUA_VERSION_NUM >= 504
+        status = lua_resume(_thread, nullptr, 0, &number_values);
+#elif LUA_VERSION_NUM >= 502
+        status = lua_resume(_thread, nullptr, 0);
+        number_values = lua_gettop(_thread);
+#else
+        status = lua_resume(_thread, 0);
+        number_values = lua_gettop(_thread);
+#endif
+    }
+    _resuming = false;
+
+    if(status == LUA_YIELD && !_release_requested) {
+        _WaitFor(lua_gettop(_thread) - number_values + 1, number_values);
+        lua_settop(_thread, 0);
+        return;
+    }
+
+    if(status != LUA_YIELD && status != 0) {
+        const char* message = lua_tostring(_thread, -1);
+        PRINT_ERROR << "Error while running the CoroutineEvent function of event: '"
+                    << GetEventID() << "'" << std::endl
+                    << (message != nullptr ? message : "Unknown error") << std::endl;
+    }
+
+    // The function returned, failed, or the event was ended meanwhile.
+    _ReleaseThread();
+}
+
+void CoroutineEvent::_WaitFor(int32_t index, int32_t number_values)
+{
+    EventSupervisor* event_supervisor = MapMode::CurrentInstance()->GetEventSupervisor();
+
+    // A plain coroutine.yield() waits for the next update.
+    if(number_values < 2 || !lua_isnumber(_thread, index)) {
+        event_supervisor->_WakeCoroutine(this);
+        return;
+    }
+
+    switch(lua_tointeger(_thread, index)) {
+    case COROUTINE_WAIT_TIME: {
+        lua_Number time = lua_tonumber(_thread, index + 1);
+        event_supervisor->_WaitTime(this, time > 0 ? static_cast<uint32_t>(time) : 0);
+        return;
+    }
+    case COROUTINE_WAIT_EVENT: {
+        const char* event_id = lua_tostring(_thread, index + 1);
+        MapEvent* event = event_id != nullptr ? event_supervisor->GetEvent(event_id) : nullptr;
+        if(event == nullptr) {
+            PRINT_WARNING << "No event with this ID existed: '" << (event_id != nullptr ? event_id : "")
+                          << "' awaited by event: '" << GetEventID() << "' in map script: "
+                          << MapMode::CurrentInstance()->GetMapScriptFilename() << std::endl;
+        }
+        // An event which isn't running has already ended.
+        if(event == nullptr || !event_supervisor->_WaitEventEnd(this, event))
+            event_supervisor->_WakeCoroutine(this);
+        return;
+    }
+    case COROUTINE_WAIT_SPRITE_ARRIVAL: {
+        VirtualSprite* sprite = nullptr;
+        try {
+            sprite = luabind::object_cast<VirtualSprite*>(luabind::object(luabind::from_stack(_thread, index + 1)));
+        } catch(const luabind::cast_failed& e) {
+            PRINT_ERROR << "Invalid sprite awaited by event: '" << GetEventID() << "'" << std::endl;
+            ScriptManager->HandleCastError(e);
+        }
+        // The sprite has arrived once the event moving it has ended.
+        SpriteEvent* control_event = sprite != nullptr ? sprite->GetControlEvent() : nullptr;
+        if(control_event == nullptr || !event_supervisor->_WaitEventEnd(this, control_event))
+            event_supervisor->_WakeCoroutine(this);
+        return;
+    }
+    default:
+        event_supervisor->_WakeCoroutine(this);
+        return;
+    }
+}
+
+void CoroutineEvent::_ReleaseThread()
+{
+    // The running coroutine can't be released, so it is once it yields back.
+    if(_resuming) {
+        _release_requested = true;
+        return;
+    }
+
+    _release_requested = false;
+    _thread = nullptr;
+    _thread_object = luabind::object();
+}
+
 // -----------------------------------------------------------------------------
 // ---------- SpriteEvent Class Methods
 // -----------------------------------------------------------------------------
@@ -483,14 +675,17 @@ ScriptedSpriteEvent* ScriptedSpriteEvent::Create(const std::string& event_id,
 void ScriptedSpriteEvent::_Start()
 {
     SpriteEvent::_Start();
-    if(_start_function.is_valid())
+    if(_start_function.is_valid()) {
+        ScriptProfileScope profile(_start_function, "ScriptedSpriteEvent start", GetEventID());
         luabind::call_function<void>(_start_function, _sprite);
+    }
 }
 
 bool ScriptedSpriteEvent::_Update()
 {
     bool finished = false;
     if(_update_function.is_valid()) {
+        ScriptProfileScope profile(_update_function, "ScriptedSpriteEvent update", GetEventID());
         finished = luabind::call_function<bool>(_update_function, _sprite);
     } else {
         finished = true;
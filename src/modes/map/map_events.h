@@ -40,6 +40,7 @@ namespace vt_map
 namespace private_map
 {
 
+class MapEvent;
 class ContextZone;
 class MapSprite;
 class SpriteDialogue;
@@ -68,7 +69,7 @@ class EventLink
 {
 public:
     EventLink(const std::string &child_id, bool start, uint32_t time) :
-        child_event_id(child_id), launch_at_start(start), launch_timer(time) {}
+        child_event_id(child_id), child_event(nullptr), launch_at_start(start), launch_timer(time) {}
 
     ~EventLink()
     {}
@@ -76,6 +77,10 @@ public:
     //! \brief The ID of the child event in this link
     std::string child_event_id;
 
+    //! \brief The child event, resolved by the event supervisor from its ID once the map is loaded.
+    //! nullptr as long as the link hasn't been resolved.
+    MapEvent* child_event;
+
     //! \brief The event will launch relative to the parent event's start if true, or its finish if false
     bool launch_at_start;
 
@@ -120,6 +125,11 @@ public:
         return _event_type;
     }
 
+    //! \brief Returns the integer handle given to the event by the event supervisor at registration.
+    uint32_t GetEventHandle() const {
+        return _event_handle;
+    }
+
     /** \brief Declares a child event to be launched immediately at the start of this event
     *** \param child_event_id The event id of the child event
     **/
@@ -180,6 +190,12 @@ private:
     //! \brief Identifier for the class type of this event
     EVENT_TYPE _event_type;
 
+    //! \brief The event handle, used by the event supervisor to index the event.
+    uint32_t _event_handle;
+
+    //! \brief Tells whether the event is currently in the event supervisor active events list.
+    bool _active;
+
     //! \brief All child events of this class, represented by EventLink objects
     std::vector<EventLink> _event_links;
 }; // class MapEvent
@@ -616,6 +632,83 @@ protected:
     bool _Update() override;
 }; // class ScriptedEvent : public MapEvent
 
+/** ****************************************************************************
+*** \brief An event running a Lua function as a coroutine.
+***
+*** Instead of having an update function called every frame, the function waits
+*** for what it needs by calling vt_map.wait(milliseconds), vt_map.wait_event(event_id)
+*** or vt_map.wait_sprite_arrival(sprite), which yield the coroutine. The event
+*** supervisor only resumes it once the time has elapsed or the awaited event has
+*** ended, so that no Lua code runs while waiting. A sprite has arrived once the
+*** sprite event controlling it has ended. A plain coroutine.yield() waits for the
+*** next update. The event is finished when the function returns.
+***
+*** The coroutine is resumed outside of the event update loop, so it can start
+*** and end other events.
+*** ***************************************************************************/
+class CoroutineEvent : public MapEvent
+{
+    friend class EventSupervisor;
+public:
+    /** \param event_id The ID of this event
+    *** \param function the map file's function name to run as a coroutine
+    **/
+    CoroutineEvent(const std::string& event_id, const std::string& function);
+
+    virtual ~CoroutineEvent() override
+    {
+    }
+
+    //! \brief A C++ wrapper made to create a new object from scripting,
+    //! without letting Lua handling the object life-cycle.
+    //! \note We don't permit luabind to use constructors here as it can't currently
+    //! give the object ownership at construction time.
+    static CoroutineEvent* Create(const std::string& event_id, const std::string& function);
+
+    //! \brief The Lua functions yielding the coroutine, registered in the vt_map table.
+    //@{
+    static int LuaWait(lua_State* lua_state);
+    static int LuaWaitEvent(lua_State* lua_state);
+    static int LuaWaitSpriteArrival(lua_State* lua_state);
+    //@}
+
+protected:
+    //! \brief A pointer to the Lua function run as a coroutine
+    luabind::object _function;
+
+    //! \brief The Lua thread running the function, referenced as long as it runs.
+    luabind::object _thread_object;
+
+    //! \brief The Lua thread running the function, or nullptr once it has returned.
+    lua_State* _thread;
+
+    //! \brief Whether the coroutine is being resumed.
+    bool _resuming;
+
+    //! \brief Whether the event was ended while its coroutine was being resumed.
+    bool _release_requested;
+
+    //! \brief Starts the coroutine, up to its first wait
+    void _Start() override;
+
+    //! \brief Returns true once the coroutine has returned. The coroutine itself is resumed by the event supervisor.
+    bool _Update() override
+    { return _thread == nullptr; }
+
+private:
+    //! \brief Resumes the coroutine, until it waits again or returns.
+    void _Resume();
+
+    /** \brief Hands the condition the coroutine yielded for to the event supervisor.
+    *** \param index The thread stack index of the first yielded value
+    *** \param number_values The number of yielded values
+    **/
+    void _WaitFor(int32_t index, int32_t number_values);
+
+    //! \brief Forgets the coroutine, once it has returned or when the event is ended.
+    void _ReleaseThread();
+}; // class CoroutineEvent : public MapEvent
+
 
 /** ****************************************************************************
 *** \brief An abstract event class that represents an event controlling a sprite
@@ -15,15 +15,18 @@
 #include "modes/map/map_sprites/map_virtual_sprite.h"
 
 #include "engine/video/video.h"
+#include "common/app_settings.h"
 #include "common/gui/menu_window.h"
 
+#include "utils/utils_files.h"
+
 // Used for the collision to XPM dev function
 #ifdef DEBUG_FEATURES
 #include "script/script_write.h"
 #endif
 
-#include <SDL2/SDL_image.h>
-#include <SDL2/SDL_endian.h>
+#include <iomanip>
+#include <sstream>
 
 using namespace vt_common;
 
@@ -45,52 +48,128 @@ const float MINIMAP_POS_X = 775.0f;
 //! \brief The Y value for the minimap's position.
 const float MINIMAP_POS_Y = 545.0f;
 
-//! \brief Allows for scoped-based control of SDL Surfaces.
-struct SDLSurfaceController {
-    SDL_Surface* _surface;
+//! \brief The white noise image tiled over the unwalkable parts of the procedural minimaps.
+const std::string MINIMAP_COLLISION_IMAGE = "data/gui/map/minimap_collision.png";
 
-    explicit SDLSurfaceController(const char *str) :
-        _surface(IMG_Load(str))
-    {
-        if (!_surface)
-            PRINT_ERROR << "Couldn't create the white noise image for the collision map: " << SDL_GetError() << std::endl;
-    }
+//! \brief The user data sub-folder where generated minimaps are cached.
+const std::string MINIMAP_CACHE_FOLDER = "minimaps/";
 
-    ~SDLSurfaceController()
-    {
-        if (_surface)
-            SDL_FreeSurface(_surface);
+/** \brief A helper function filling a grid with the cells the minimap shows as unwalkable.
+*** A cell is unwalkable when its position collides statically, so that the cells
+*** only partially covered by a physical object are still shown as walkable.
+**/
+static void _GetMinimapCollisionGrid(ObjectSupervisor* map_object_supervisor, CollisionBitGrid& grid)
+{
+    uint32_t grid_width = 0;
+    uint32_t grid_height = 0;
+    map_object_supervisor->GetGridAxis(grid_width, grid_height);
+
+    grid.Resize(grid_width, grid_height);
+    for (uint32_t y = 0; y < grid_height; ++y) {
+        for (uint32_t x = 0; x < grid_width; ++x) {
+            if (map_object_supervisor->IsStaticCollision(x, y))
+                grid.SetCell(x, y, true);
+        }
     }
+}
 
-private:
-    //! \brief The copy constructor and assignment operator are hidden by design
-    //! to cause compilation errors when attempting to copy or assign this class.
-    SDLSurfaceController(const SDLSurfaceController&)
-    {
-        throw vt_utils::Exception("Not Implemented!", __FILE__, __LINE__, __FUNCTION__);
+/** \brief A helper function giving the cache filename of a procedural minimap.
+*** The key is a hash of the map filename and of the minimap collision grid content,
+*** followed by the minimap image size, so that any change in the map files,
+*** or in the static objects placed by the map script, will generate a new minimap.
+**/
+static std::string _GetMinimapCacheFilename(const CollisionBitGrid& grid,
+                                            const std::string& map_filename,
+                                            uint32_t image_width, uint32_t image_height)
+{
+    // 64-bit FNV-1a hash
+    const uint64_t FNV_PRIME = 1099511628211ULL;
+    uint64_t hash = 14695981039346656037ULL;
+
+    for (uint32_t i = 0; i < map_filename.size(); ++i) {
+        hash ^= static_cast<uint8_t>(map_filename[i]);
+        hash *= FNV_PRIME;
     }
-    SDLSurfaceController& operator=(const SDLSurfaceController&)
-    {
-        throw vt_utils::Exception("Not Implemented!", __FILE__, __LINE__, __FUNCTION__);
-        return *this;
+
+    const uint32_t words_per_row = (grid.GetWidth() + 63) / 64;
+    for (uint32_t y = 0; y < grid.GetHeight(); ++y) {
+        const uint64_t* row = grid.GetRow(y);
+        for (uint32_t w = 0; w < words_per_row; ++w) {
+            hash ^= row[w];
+            hash *= FNV_PRIME;
+        }
     }
-};
 
-//! \brief A helper function to prepare a SDL_Surface.
-static bool _PrepareSurface(SDL_Surface* temp_surface)
+    std::string cache_folder = vt_common::GetUserDataPath() + MINIMAP_CACHE_FOLDER;
+    if (!vt_utils::DoesFileExist(cache_folder))
+        vt_utils::MakeDirectory(cache_folder);
+
+    std::ostringstream filename;
+    filename << cache_folder << std::hex << std::setw(16) << std::setfill('0') << hash
+             << std::dec << "_" << image_width << "x" << image_height << ".png";
+    return filename.str();
+}
+
+/** \brief A helper function rasterizing the minimap collision grid into a RGBA buffer.
+*** Walkable grid elements are left fully transparent, while the unwalkable ones
+*** are filled with the tiled white noise image.
+**/
+static bool _RasterizeCollisionGrid(vt_video::private_video::ImageMemory& minimap_data,
+                                    const CollisionBitGrid& grid,
+                                    uint32_t box_x_length, uint32_t box_y_length)
 {
-    // A white noise texture.
-    const SDLSurfaceController WHITE_NOISE("data/gui/map/minimap_collision.png");
-    SDL_Rect r = { 0, 0, 0, 0 };
-
-    // Prepare the surface with the image.  Tile the white noise image onto the surface with full alpha.
-    for(int x = 0; x < temp_surface->w; x += WHITE_NOISE._surface->w) {
-        r.x = x;
-        for(int y = 0; y < temp_surface->h; y += WHITE_NOISE._surface->h) {
-            r.y = y;
-            if(SDL_BlitSurface(WHITE_NOISE._surface, nullptr, temp_surface, &r)) {
-                PRINT_ERROR << "Couldn't fill a rect on temp_surface: " << SDL_GetError() << std::endl;
-                return false;
+    vt_video::private_video::ImageMemory white_noise;
+    if (!white_noise.LoadImage(MINIMAP_COLLISION_IMAGE) ||
+            white_noise.GetWidth() == 0 || white_noise.GetHeight() == 0) {
+        PRINT_ERROR << "Couldn't load the white noise image for the collision map: "
+                    << MINIMAP_COLLISION_IMAGE << std::endl;
+        return false;
+    }
+
+    const uint32_t noise_width = white_noise.GetWidth();
+    const uint32_t noise_height = white_noise.GetHeight();
+    const uint32_t noise_bpp = white_noise.GetBytesPerPixel();
+    const uint8_t* noise_pixels = white_noise.GetPixels();
+
+    const uint32_t grid_width = grid.GetWidth();
+    const uint32_t grid_height = grid.GetHeight();
+    const uint32_t image_width = grid_width * box_x_length;
+
+    // The buffer is zeroed, thus fully transparent.
+    minimap_data.Resize(image_width, grid_height * box_y_length, false);
+    uint8_t* pixels = minimap_data.GetPixels();
+
+    for (uint32_t grid_y = 0; grid_y < grid_height; ++grid_y) {
+        const uint64_t* row = grid.GetRow(grid_y);
+
+        for (uint32_t pixel_y = grid_y * box_y_length; pixel_y < (grid_y + 1) * box_y_length; ++pixel_y) {
+            const uint8_t* noise_row = noise_pixels + (pixel_y % noise_height) * noise_width * noise_bpp;
+            uint8_t* dst_row = pixels + pixel_y * image_width * 4;
+
+            uint32_t grid_x = 0;
+            while (grid_x < grid_width) {
+                const uint64_t word = row[grid_x >> 6];
+                // Skip whole walkable words at once.
+                if (word == 0) {
+                    grid_x = (grid_x | 63) + 1;
+                    continue;
+                }
+                if (((word >> (grid_x & 63)) & 1) == 0) {
+                    ++grid_x;
+                    continue;
+                }
+
+                for (uint32_t pixel_x = grid_x * box_x_length; pixel_x < (grid_x + 1) * box_x_length; ++pixel_x) {
+                    const uint8_t* src = noise_row + (pixel_x % noise_width) * noise_bpp;
+                    uint8_t* dst = dst_row + pixel_x * 4;
+                    // Blend the noise over the transparent background, as an alpha blit would do.
+                    const uint32_t alpha = (noise_bpp == 4) ? src[3] : 255;
+                    dst[0] = static_cast<uint8_t>(src[0] * alpha / 255);
+                    dst[1] = static_cast<uint8_t>(src[1] * alpha / 255);
+                    dst[2] = static_cast<uint8_t>(src[2] * alpha / 255);
+                    dst[3] = static_cast<uint8_t>(alpha);
+                }
+                ++grid_x;
             }
         }
     }
@@ -135,82 +214,35 @@ Minimap::Minimap(const std::string& minimap_image_filename) :
 
 vt_video::StillImage Minimap::_CreateProcedurally()
 {
-    ObjectSupervisor *map_object_supervisor = MapMode::CurrentInstance()->GetObjectSupervisor();
-
-    float x, y, width, height;
-    vt_video::VideoManager->GetCurrentViewport(x, y, width, height);
-
-    //create a new SDL surface that is the rendering dimensions we want.
-    SDL_Surface *temp_surface = SDL_CreateRGBSurface(SDL_SWSURFACE,
-                                                     _grid_width * _box_x_length, _grid_height * _box_y_length, 32,
-#if SDL_BYTEORDER == SDL_BIG_ENDIAN
-                                                     0xff000000, 0x00ff0000, 0x0000ff00, 0x000000ff);
-#else
-                                                     0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000);
-#endif
-
-    if(!temp_surface) {
-        PRINT_ERROR << "Couldn't create temp_surface for collision map: " << SDL_GetError() << std::endl;
-        MapMode::CurrentInstance()->ShowMinimap(false);
-        return vt_video::StillImage();
-    }
-
-    //set the basic rect information
-    SDL_Rect r;
-    r.w = _box_x_length;
-    r.h = _box_y_length;
-    r.x = r.y = 0;
-
-    //very simple. Just go through the entire grid, checking the visible-character's
-    //context against the map-grid's collision context. if this is NOT a colidable location
-    //fill that square in with a full alpha block
-    //note that the ordering needs to be transposed for drawing
-    if (!_PrepareSurface(temp_surface)) {
-        SDL_FreeSurface(temp_surface);
-        MapMode::CurrentInstance()->ShowMinimap(false);
-        return vt_video::StillImage();
-    }
-
-    for(uint32_t row = 0; row < _grid_width; ++row)
-    {
-        r.y = 0;
-        for(uint32_t col = 0; col < _grid_height; ++col)
-        {
-            if(!map_object_supervisor->IsStaticCollision(row, col))
-            {
-
-                if(SDL_FillRect(temp_surface, &r, SDL_MapRGBA(temp_surface->format, 0x00, 0x00, 0x00, 0x00)))
-                {
-                    PRINT_ERROR << "Couldn't fill a rect on temp_surface: " << SDL_GetError() << std::endl;
-                    SDL_FreeSurface(temp_surface);
-                    return vt_video::StillImage();
-                }
-
-            }
-            r.y += _box_y_length;
-        }
-        r.x += _box_x_length;
+    MapMode* map_mode = MapMode::CurrentInstance();
+    CollisionBitGrid collision_grid;
+    _GetMinimapCollisionGrid(map_mode->GetObjectSupervisor(), collision_grid);
+
+    const uint32_t image_width = _grid_width * _box_x_length;
+    const uint32_t image_height = _grid_height * _box_y_length;
+
+    // Reuse the minimap generated on a previous visit, if any.
+    const std::string cache_filename = _GetMinimapCacheFilename(collision_grid, map_mode->GetMapScriptFilename(),
+                                                                image_width, image_height);
+    vt_video::StillImage minimap_image;
+    if (vt_utils::DoesFileExist(cache_filename) &&
+            minimap_image.Load(cache_filename, image_width, image_height)) {
+        return minimap_image;
     }
 
-    //TEST: flush the SDL surface. This forces any pending writes onto the surface to complete
-    //SDL_UpdateRect(temp_surface, 0, 0, 0, 0);
-
-    if (!temp_surface) {
-        MapMode::CurrentInstance()->ShowMinimap(false);
+    vt_video::private_video::ImageMemory minimap_data;
+    if (!_RasterizeCollisionGrid(minimap_data, collision_grid, _box_x_length, _box_y_length)) {
+        map_mode->ShowMinimap(false);
         return vt_video::StillImage();
     }
 
-    SDL_LockSurface(temp_surface);
-
-    // Setup a temporary memory space to copy the SDL data into
-    vt_video::private_video::ImageMemory temp_data(temp_surface);
+    // Keep the minimap for later visits. When it fails, the minimap will simply be generated again.
+    if (!minimap_data.SaveImage(cache_filename))
+        PRINT_WARNING << "Couldn't save the minimap cache file: " << cache_filename << std::endl;
 
-    SDL_UnlockSurface(temp_surface);
-    // At this point, the screen data is set up. We can get rid of unnecessary data here
-    SDL_FreeSurface(temp_surface);
     // Do the image file creation
-    std::string map_name_cmap = MapMode::CurrentInstance()->GetMapScriptFilename() + "_cmap";
-    vt_video::StillImage minimap_image = vt_video::VideoManager->CreateImage(&temp_data, map_name_cmap);
+    std::string map_name_cmap = map_mode->GetMapScriptFilename() + "_cmap";
+    minimap_image = vt_video::VideoManager->CreateImage(&minimap_data, map_name_cmap);
 
 #ifdef DEBUG_FEATURES
     // Uncomment and compile this to generate XPM minimaps.
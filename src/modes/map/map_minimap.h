@@ -94,7 +94,11 @@ private:
     //! \brief specifies the additive alpha we get from the map class
     float _map_alpha_scale;
 
-    //! \brief creates the procedural collision minimap image
+    /** \brief creates the procedural collision minimap image
+    *** The static collision grid is rasterized directly into a pixel buffer,
+    *** which is then cached as a png file in the user data folder. The cached file
+    *** is reused as long as the map collision data doesn't change.
+    **/
     vt_video::StillImage _CreateProcedurally();
 
 #ifdef DEBUG_FEATURES
@@ -41,6 +41,7 @@
 
 #include "engine/audio/audio.h"
 #include "engine/input.h"
+#include "engine/script_profiler.h"
 
 #include "common/global/global.h"
 #include "common/global/actors/global_character.h"
@@ -48,6 +49,8 @@
 // DEPRECATED: Used only to check old filenames
 #include "utils/utils_files.h"
 
+#include <fstream>
+
 using namespace vt_utils;
 using namespace vt_audio;
 using namespace vt_boot;
@@ -141,7 +144,12 @@ MapMode::MapMode(const std::string& data_filename, const std::string& script_fil
     _virtual_focus->SetCollisionMask(NO_COLLISION);
     _virtual_focus->SetVisible(false);
 
-    if(!_Load()) {
+    bool loaded = _Load();
+
+    // The audio prepared for this map which wasn't used by now won't be.
+    AudioManager->ClearPreloadedAudio();
+
+    if(!loaded) {
         BootMode *BM = new BootMode();
         ModeManager->PopAll();
         ModeManager->Push(BM);
@@ -360,8 +368,10 @@ void MapMode::Update()
     _dialogue_icon.Update();
 
     // Call the map script's update function
-    if(_update_function.is_valid())
+    if(_update_function.is_valid()) {
+        ScriptProfileScope profile(_update_function, "Update", _map_script_filename);
         luabind::call_function<void>(_update_function);
+    }
 
     // Update all animated tile images
     _tile_supervisor->Update();
@@ -491,6 +501,7 @@ void MapMode::ResetState()
 void MapMode::PushState(MAP_STATE state)
 {
     _state_stack.push_back(state);
+    GetScriptSupervisor().NotifyEvent("MapStateChange");
 }
 
 void MapMode::PopState()
@@ -502,6 +513,7 @@ void MapMode::PopState()
                 << std::endl;
         _state_stack.push_back(STATE_INVALID);
     }
+    GetScriptSupervisor().NotifyEvent("MapStateChange");
 }
 
 MAP_STATE MapMode::CurrentState()
@@ -650,6 +662,65 @@ void AddEp1ToMapPath(std::string& map_filename)
                          "data/story/ep1");
 }
 
+//! \brief Returns the string literal directly given after the '(' or '=' following the position, if any.
+static std::string _GetStringLiteral(const std::string& line, size_t position)
+{
+    size_t start = line.find_first_of("(=", position);
+    if(start == std::string::npos)
+        return std::string();
+    start = line.find_first_not_of(" \t", start + 1);
+    if(start == std::string::npos || (line[start] != '"' && line[start] != '\''))
+        return std::string();
+    size_t end = line.find(line[start], start + 1);
+    if(end == std::string::npos)
+        return std::string();
+    return line.substr(start + 1, end - start - 1);
+}
+
+void MapMode::GetMapAudioFiles(const std::string& map_script_filename,
+                               std::vector<std::string>& music_filenames,
+                               std::vector<std::string>& sound_filenames)
+{
+    std::ifstream script_file(map_script_filename.c_str());
+    if(!script_file.is_open())
+        return;
+
+    // Only the literal filenames given to the usual audio functions are predicted.
+    std::string line;
+    while(std::getline(script_file, line)) {
+        size_t start = line.find_first_not_of(" \t");
+        if(start == std::string::npos || line.compare(start, 2, "--") == 0)
+            continue;
+
+        // Filenames given through variables are ignored, as they come out empty.
+        size_t position;
+        std::string filename;
+        if(line.compare(start, 14, "music_filename") == 0) {
+            filename = _GetStringLiteral(line, start + 14);
+            if(!filename.empty())
+                music_filenames.push_back(filename);
+        } else if((position = line.find("LoadMusic(")) != std::string::npos) {
+            filename = _GetStringLiteral(line, position);
+            if(!filename.empty())
+                music_filenames.push_back(filename);
+        } else if((position = line.find("SoundObject.Create(")) != std::string::npos
+                  || (position = line.find("LoadSound(")) != std::string::npos) {
+            filename = _GetStringLiteral(line, position);
+            if(!filename.empty())
+                sound_filenames.push_back(filename);
+        }
+    }
+}
+
+void MapMode::PreloadMapAudio(const std::string& map_script_filename)
+{
+    std::vector<std::string> music_filenames;
+    std::vector<std::string> sound_filenames;
+    GetMapAudioFiles(map_script_filename, music_filenames, sound_filenames);
+
+    AudioManager->PreloadAudio(music_filenames, sound_filenames);
+}
+
 bool MapMode::_Load()
 {
     // Map data
@@ -739,6 +810,13 @@ bool MapMode::_Load()
         PRINT_ERROR << "Failed to load location graphic image: "
                     << map_image_filename << std::endl;
 
+    // Let the save menu show the location without opening the map script again.
+    SaveGameLocation location;
+    location.map_script_filename = _map_script_filename;
+    location.map_name = map_hud_name;
+    location.map_image_filename = map_image_filename;
+    GlobalManager->GetSaveGameIndex().SetLocation(location);
+
     // Load map default music
     // NOTE: Other audio handling will be handled through scripting
     _music_filename = _map_script.ReadString("music_filename");
@@ -776,6 +854,9 @@ bool MapMode::_Load()
         return false;
     }
 
+    // Now that every map event has been created, link the events to their children.
+    _event_supervisor->ResolveEventLinks();
+
     _update_function = _map_script.ReadFunctionPointer("Update");
 
     // If the "home map" flag is set, let's save the map as new home in case of escape.
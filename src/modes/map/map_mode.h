@@ -161,6 +161,23 @@ public:
     //! \brief Removes an object from memory
     void DeleteMapObject(private_map::MapObject* obj);
 
+    /** \brief Starts preparing the audio of a map before loading it
+    *** \param map_script_filename The script file of the map about to be loaded
+    ***
+    *** The script file is scanned for the map music and the ambient sounds it creates,
+    *** which are then opened and decoded by the audio engine in the background.
+    **/
+    static void PreloadMapAudio(const std::string& map_script_filename);
+
+    /** \brief Lists the music and sound files used by a map, as done to preload them
+    *** \param map_script_filename The script file of the map
+    *** \param music_filenames Receives the music files
+    *** \param sound_filenames Receives the sound files
+    **/
+    static void GetMapAudioFiles(const std::string& map_script_filename,
+                                 std::vector<std::string>& music_filenames,
+                                 std::vector<std::string>& sound_filenames);
+
     //! \brief Vectors containing the save points animations (when the character is in or not).
     std::vector<vt_video::AnimatedImage> active_save_point_animations;
     std::vector<vt_video::AnimatedImage> inactive_save_point_animations;
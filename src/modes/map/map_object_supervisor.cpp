@@ -27,6 +27,8 @@
 
 #include "utils/utils_numeric.h"
 
+#include <map>
+
 using namespace vt_common;
 
 namespace vt_map
@@ -35,11 +37,30 @@ namespace vt_map
 namespace private_map
 {
 
+//! \brief The length, in grid elements, of the square buckets used by the zone spatial index.
+const uint32_t ZONE_BUCKET_LENGTH = 16;
+
+//! \brief The length, in grid elements, of the square buckets used by the ambient sound spatial index.
+const uint32_t SOUND_BUCKET_LENGTH = 16;
+
+//! \brief The number of static collision grid changes kept to tell which areas changed.
+const uint32_t STATIC_COLLISION_CHANGES_KEPT = 32;
+
 ObjectSupervisor::ObjectSupervisor() :
     _num_grid_x_axis(0),
     _num_grid_y_axis(0),
     _last_id(1), //! Every object Id must be > 0 since 0 is reserved for speakerless dialogues.
-    _visible_party_member(nullptr)
+    _visible_party_member(nullptr),
+    _static_collision_dirty(true),
+    _static_collision_version(0),
+    _sound_buckets_x_axis(0),
+    _sound_index_dirty(true),
+    _zone_buckets_x_axis(0),
+    _zone_index_dirty(true),
+    _zone_tracked_camera(nullptr),
+    _zone_tracked_x(-1),
+    _zone_tracked_y(-1),
+    _zone_update_id(0)
 {}
 
 ObjectSupervisor::~ObjectSupervisor()
@@ -97,6 +118,9 @@ void ObjectSupervisor::RegisterObject(MapObject* object)
         break;
     case GROUND_OBJECT:
         _ground_objects.push_back(object);
+        // The object type isn't known yet at that point,
+        // so the static collision grid is rebuilt in any case.
+        _static_collision_dirty = true;
         break;
     case PASS_OBJECT:
         _pass_objects.push_back(object);
@@ -118,6 +142,7 @@ void ObjectSupervisor::AddAmbientSound(SoundObject* object)
     }
 
     _sound_objects.push_back(object);
+    _sound_index_dirty = true;
 }
 
 void ObjectSupervisor::AddLight(Light* light)
@@ -167,6 +192,7 @@ void ObjectSupervisor::AddZone(MapZone* zone)
         return;
     }
     _zones.push_back(zone);
+    _zone_index_dirty = true;
 }
 
 void ObjectSupervisor::DeleteObject(MapObject* object)
@@ -198,6 +224,8 @@ void ObjectSupervisor::DeleteObject(MapObject* object)
         it = _ground_objects.begin();
         it_end = _ground_objects.end();
         to_iterate = &_ground_objects;
+        if (object->GetObjectType() == PHYSICAL_TYPE)
+            _static_collision_dirty = true;
         break;
     case PASS_OBJECT:
         it = _pass_objects.begin();
@@ -242,12 +270,28 @@ bool ObjectSupervisor::Load(vt_script::ReadScriptDescriptor &map_file)
     // Construct the collision grid
     map_file.OpenTable("map_grid");
     _num_grid_y_axis = map_file.GetTableSize();
+    std::vector<std::vector<uint32_t> > collision_rows(_num_grid_y_axis);
     for(uint16_t y = 0; y < _num_grid_y_axis; ++y) {
-        _collision_grid.push_back(std::vector<uint32_t>());
-        map_file.ReadUIntVector(y, _collision_grid.back());
+        map_file.ReadUIntVector(y, collision_rows[y]);
     }
     map_file.CloseTable();
-    _num_grid_x_axis = _collision_grid[0].size();
+
+    if(collision_rows.empty() || collision_rows[0].empty()) {
+        PRINT_ERROR << "Empty map grid found in map file: " << map_file.GetFilename() << std::endl;
+        return false;
+    }
+    _num_grid_x_axis = collision_rows[0].size();
+
+    // Pack the walls, any collision context value being considered as a wall.
+    _wall_collision_grid.Resize(_num_grid_x_axis, _num_grid_y_axis);
+    for(uint16_t y = 0; y < _num_grid_y_axis; ++y) {
+        const std::vector<uint32_t>& row = collision_rows[y];
+        for(uint16_t x = 0; x < _num_grid_x_axis && x < row.size(); ++x) {
+            if(row[x] > 0)
+                _wall_collision_grid.SetCell(x, y, true);
+        }
+    }
+    _static_collision_dirty = true;
     return true;
 }
 
@@ -269,6 +313,9 @@ void ObjectSupervisor::Update()
         _halos[i]->Update();
     for(uint32_t i = 0; i < _lights.size(); ++i)
         _lights[i]->Update();
+
+    // Notify the zones the camera entered or left, before updating them.
+    _UpdateCameraZones();
     for(uint32_t i = 0; i < _zones.size(); ++i)
         _zones[i]->Update();
 
@@ -386,27 +433,51 @@ void ObjectSupervisor::_UpdateMapPoints()
 
 void ObjectSupervisor::_UpdateAmbientSounds()
 {
-    // Clear up objects volumes before new update
-    _sound_object_highest_volumes.clear();
+    _UpdateSoundIndex();
+
+    // Only the sounds which can be heard from the camera position are evaluated.
+    const MapFrame& frame = MapMode::CurrentInstance()->GetMapFrame();
+    float center_x = frame.screen_edges.left + (frame.screen_edges.right - frame.screen_edges.left) / 2.0f;
+    float center_y = frame.screen_edges.top + (frame.screen_edges.bottom - frame.screen_edges.top) / 2.0f;
+
+    std::vector<SoundObject *> sounds_in_range;
+    if(!_sound_buckets.empty() && center_x >= 0.0f && center_y >= 0.0f &&
+            center_x < static_cast<float>(_num_grid_x_axis) && center_y < static_cast<float>(_num_grid_y_axis)) {
+        uint32_t bucket_x = static_cast<uint32_t>(center_x) / SOUND_BUCKET_LENGTH;
+        uint32_t bucket_y = static_cast<uint32_t>(center_y) / SOUND_BUCKET_LENGTH;
+        sounds_in_range = _sound_buckets[bucket_y * _sound_buckets_x_axis + bucket_x];
+    }
 
-    for(std::vector<SoundObject *>::iterator it = _sound_objects.begin();
-            it != _sound_objects.end(); ++it) {
-        (*it)->UpdateVolume();
-
-        // Register the sound as highest if no other sound was already as high.
-        bool found = false;
-        for(auto it2 = _sound_object_highest_volumes.begin();
-                it2 != _sound_object_highest_volumes.end(); ++it2) {
-            if ((*it)->GetSoundDescriptor() == (*it2)->GetSoundDescriptor()) {
-                found = true;
-                // If we found a higher sound, we swap the reference.
-                if ((*it)->GetSoundVolume() > (*it2)->GetSoundVolume())
-                    *it2 = *it;
-            }
+    // The sounds getting out of range are silenced once more, so that they fade out
+    // and give their audio source back.
+    std::vector<SoundObject *> updated_sounds = sounds_in_range;
+    const uint32_t number_sounds_in_range = sounds_in_range.size();
+    for(SoundObject* sound : _sounds_in_range) {
+        if(std::find(sounds_in_range.begin(), sounds_in_range.end(), sound) == sounds_in_range.end()) {
+            sound->Silence();
+            updated_sounds.push_back(sound);
         }
-        if (!found) {
-            // If the sounds wasn't found, we add it.
-            _sound_object_highest_volumes.push_back(*it);
+    }
+    _sounds_in_range.swap(sounds_in_range);
+
+    // Clear up objects volumes before new update
+    _sound_object_highest_volumes.clear();
+    std::map<vt_audio::SoundDescriptor *, uint32_t> highest_volume_indices;
+
+    for(uint32_t i = 0; i < updated_sounds.size(); ++i) {
+        SoundObject* sound = updated_sounds[i];
+        if(i < number_sounds_in_range)
+            sound->UpdateVolume();
+
+        // Register the sound as highest if no other instance of the same sound was already as high.
+        std::map<vt_audio::SoundDescriptor *, uint32_t>::iterator it =
+            highest_volume_indices.find(sound->GetSoundDescriptor());
+        if(it == highest_volume_indices.end()) {
+            highest_volume_indices[sound->GetSoundDescriptor()] = _sound_object_highest_volumes.size();
+            _sound_object_highest_volumes.push_back(sound);
+        } else if(sound->GetSoundVolume() > _sound_object_highest_volumes[it->second]->GetSoundVolume()) {
+            // If we found a higher sound, we swap the reference.
+            _sound_object_highest_volumes[it->second] = sound;
         }
     }
 
@@ -421,6 +492,129 @@ void ObjectSupervisor::_UpdateAmbientSounds()
     }
 }
 
+void ObjectSupervisor::_UpdateSoundIndex()
+{
+    if(!_sound_index_dirty)
+        return;
+    _sound_index_dirty = false;
+
+    _sound_buckets.clear();
+    _sound_buckets_x_axis = (_num_grid_x_axis + SOUND_BUCKET_LENGTH - 1) / SOUND_BUCKET_LENGTH;
+    uint32_t sound_buckets_y_axis = (_num_grid_y_axis + SOUND_BUCKET_LENGTH - 1) / SOUND_BUCKET_LENGTH;
+    if(_sound_buckets_x_axis == 0 || sound_buckets_y_axis == 0)
+        return;
+    _sound_buckets.resize(_sound_buckets_x_axis * sound_buckets_y_axis);
+
+    for(SoundObject* sound : _sound_objects) {
+        // Sounds too weak to be heard are never evaluated.
+        float strength = sound->GetStrength();
+        if(strength < 1.0f)
+            continue;
+
+        // The sound can be heard within the square around it, clamped within the map bounds.
+        float left = std::max(sound->GetXPosition() - strength, 0.0f);
+        float top = std::max(sound->GetYPosition() - strength, 0.0f);
+        float right = std::min(sound->GetXPosition() + strength, static_cast<float>(_num_grid_x_axis - 1));
+        float bottom = std::min(sound->GetYPosition() + strength, static_cast<float>(_num_grid_y_axis - 1));
+        if(right < left || bottom < top)
+            continue;
+
+        for(uint32_t y = static_cast<uint32_t>(top) / SOUND_BUCKET_LENGTH; y <= static_cast<uint32_t>(bottom) / SOUND_BUCKET_LENGTH; ++y) {
+            for(uint32_t x = static_cast<uint32_t>(left) / SOUND_BUCKET_LENGTH; x <= static_cast<uint32_t>(right) / SOUND_BUCKET_LENGTH; ++x)
+                _sound_buckets[y * _sound_buckets_x_axis + x].push_back(sound);
+        }
+    }
+}
+
+void ObjectSupervisor::_UpdateZoneIndex()
+{
+    if(!_zone_index_dirty)
+        return;
+    _zone_index_dirty = false;
+
+    _zone_buckets.clear();
+    _zone_buckets_x_axis = (_num_grid_x_axis + ZONE_BUCKET_LENGTH - 1) / ZONE_BUCKET_LENGTH;
+    uint32_t zone_buckets_y_axis = (_num_grid_y_axis + ZONE_BUCKET_LENGTH - 1) / ZONE_BUCKET_LENGTH;
+    if(_zone_buckets_x_axis == 0 || zone_buckets_y_axis == 0)
+        return;
+    _zone_buckets.resize(_zone_buckets_x_axis * zone_buckets_y_axis);
+
+    for(MapZone* zone : _zones) {
+        for(const Rectangle2D& section : zone->GetSections()) {
+            if(section.right < 0.0f || section.bottom < 0.0f ||
+                    section.left >= static_cast<float>(_num_grid_x_axis) ||
+                    section.top >= static_cast<float>(_num_grid_y_axis))
+                continue;
+
+            // Clamp the section within the map bounds.
+            uint32_t left = section.left > 0.0f ? static_cast<uint32_t>(section.left) : 0;
+            uint32_t top = section.top > 0.0f ? static_cast<uint32_t>(section.top) : 0;
+            uint32_t right = std::min(static_cast<uint32_t>(section.right), static_cast<uint32_t>(_num_grid_x_axis - 1));
+            uint32_t bottom = std::min(static_cast<uint32_t>(section.bottom), static_cast<uint32_t>(_num_grid_y_axis - 1));
+
+            for(uint32_t y = top / ZONE_BUCKET_LENGTH; y <= bottom / ZONE_BUCKET_LENGTH; ++y) {
+                for(uint32_t x = left / ZONE_BUCKET_LENGTH; x <= right / ZONE_BUCKET_LENGTH; ++x) {
+                    std::vector<MapZone*>& bucket = _zone_buckets[y * _zone_buckets_x_axis + x];
+                    // Zones are indexed one after another, so a duplicate can only be the last one.
+                    if(bucket.empty() || bucket.back() != zone)
+                        bucket.push_back(zone);
+                }
+            }
+        }
+    }
+}
+
+void ObjectSupervisor::_UpdateCameraZones()
+{
+    ++_zone_update_id;
+
+    MapMode* map_mode = MapMode::CurrentInstance();
+    // The zones states are kept while the camera is on the virtual focus.
+    if(map_mode->IsCameraOnVirtualFocus())
+        return;
+
+    bool index_rebuilt = _zone_index_dirty;
+    _UpdateZoneIndex();
+
+    VirtualSprite* camera = map_mode->GetCamera();
+    int32_t camera_x = -1;
+    int32_t camera_y = -1;
+    if(camera != nullptr && IsWithinMapBounds(camera)) {
+        camera_x = static_cast<int32_t>(camera->GetXPosition());
+        camera_y = static_cast<int32_t>(camera->GetYPosition());
+    }
+
+    // Nothing can change while the camera stays on the same grid element.
+    if(!index_rebuilt && camera == _zone_tracked_camera &&
+            camera_x == _zone_tracked_x && camera_y == _zone_tracked_y)
+        return;
+
+    _zone_tracked_camera = camera;
+    _zone_tracked_x = camera_x;
+    _zone_tracked_y = camera_y;
+
+    std::vector<MapZone*> inside_zones;
+    if(camera_x >= 0 && camera_y >= 0 && !_zone_buckets.empty()) {
+        const std::vector<MapZone*>& bucket =
+            _zone_buckets[(camera_y / ZONE_BUCKET_LENGTH) * _zone_buckets_x_axis + camera_x / ZONE_BUCKET_LENGTH];
+        for(MapZone* zone : bucket) {
+            if(zone->IsInsideZone(camera->GetXPosition(), camera->GetYPosition()))
+                inside_zones.push_back(zone);
+        }
+    }
+
+    // Notify the zones left and entered
+    for(MapZone* zone : _camera_zones) {
+        if(std::find(inside_zones.begin(), inside_zones.end(), zone) == inside_zones.end())
+            zone->OnCameraExit(_zone_update_id);
+    }
+    for(MapZone* zone : inside_zones) {
+        if(std::find(_camera_zones.begin(), _camera_zones.end(), zone) == _camera_zones.end())
+            zone->OnCameraEnter(_zone_update_id);
+    }
+    _camera_zones.swap(inside_zones);
+}
+
 void ObjectSupervisor::_DrawMapZones()
 {
     for(uint32_t i = 0; i < _zones.size(); ++i)
@@ -630,19 +824,8 @@ COLLISION_TYPE ObjectSupervisor::DetectCollision(MapObject* object,
         return NO_COLLISION;
 
     // Check if the object's collision rectangle overlaps with any unwalkable elements on the collision grid
-    // Grid based collision is not done for objects in the sky layer
-    if(object->GetObjectDrawLayer() != vt_map::SKY_OBJECT && object->GetCollisionMask() & WALL_COLLISION) {
-        // Determine if the object's collision rectangle overlaps any unwalkable tiles
-        // Note that because the sprite's collision rectangle was previously determined to be within the map bounds,
-        // the map grid tile indeces referenced in this loop are all valid entries and do not need to be checked for out-of-bounds conditions
-        for(uint32_t y = static_cast<uint32_t>(sprite_rect.top); y <= static_cast<uint32_t>(sprite_rect.bottom); ++y) {
-            for(uint32_t x = static_cast<uint32_t>(sprite_rect.left); x <= static_cast<uint32_t>(sprite_rect.right); ++x) {
-                // Checks the collision grid at the row-column at the object's current context
-                if(_collision_grid[y][x] > 0)
-                    return WALL_COLLISION;
-            }
-        }
-    }
+    if(_IsWallCollision(object, sprite_rect))
+        return WALL_COLLISION;
 
     std::vector<MapObject *>* objects = &_GetObjectsFromDrawLayer(object->GetObjectDrawLayer());
 
@@ -765,9 +948,10 @@ Path ObjectSupervisor::FindPath(VirtualSprite *sprite, const Position2D& destina
             // ---------- (A): Check if all tiles are walkable
             // Don't use 0.0f here for both since errors at the border between
             // two positions may occure, especially when running.
-            COLLISION_TYPE collision_type = DetectCollision(sprite,
-                                            ((float)nodes[i].tile_x) + offset_x,
-                                            ((float)nodes[i].tile_y) + offset_y);
+            float node_x = ((float)nodes[i].tile_x) + offset_x;
+            float node_y = ((float)nodes[i].tile_y) + offset_y;
+
+            COLLISION_TYPE collision_type = DetectCollision(sprite, node_x, node_y);
 
             // Can't go through walls.
             if(collision_type == WALL_COLLISION)
@@ -902,7 +1086,7 @@ void ObjectSupervisor::DrawCollisionArea(const MapFrame *frame)
             x < static_cast<uint32_t>((frame->tile_x_start + frame->num_draw_x_axis) * 2); ++x) {
 
             // Draw the collision rectangle.
-            if (_collision_grid[y][x] > 0)
+            if (_wall_collision_grid.IsCellBlocked(x, y))
                 vt_video::VideoManager->DrawRectangle(GRID_LENGTH, GRID_LENGTH,
                                                       vt_video::Color(1.0f, 0.0f, 0.0f, 0.6f));
 
@@ -922,6 +1106,11 @@ bool ObjectSupervisor::IsStaticCollision(float x, float y)
     if (IsMapCollision(static_cast<uint32_t>(x), static_cast<uint32_t>(y)))
         return true;
 
+    // No physical object overlaps this grid element, so none can contain the position.
+    _UpdateStaticCollisionGrid();
+    if (!_static_collision_grid.IsCellBlocked(static_cast<uint32_t>(x), static_cast<uint32_t>(y)))
+        return false;
+
     std::vector<vt_map::private_map::MapObject *>::const_iterator it, it_end;
     for(it = _ground_objects.begin(), it_end = _ground_objects.end(); it != it_end; ++it) {
         MapObject *collision_object = *it;
@@ -943,6 +1132,100 @@ bool ObjectSupervisor::IsStaticCollision(float x, float y)
     return false;
 }
 
+bool ObjectSupervisor::IsStaticAreaCollision(const Rectangle2D& rect)
+{
+    if(rect.left < 0.0f || rect.right >= static_cast<float>(_num_grid_x_axis) ||
+            rect.top < 0.0f || rect.bottom >= static_cast<float>(_num_grid_y_axis)) {
+        return true;
+    }
+
+    _UpdateStaticCollisionGrid();
+    return _static_collision_grid.IsAreaBlocked(static_cast<uint32_t>(rect.left),
+                                                static_cast<uint32_t>(rect.top),
+                                                static_cast<uint32_t>(rect.right),
+                                                static_cast<uint32_t>(rect.bottom));
+}
+
+void ObjectSupervisor::_UpdateStaticCollisionGrid()
+{
+    if(!_static_collision_dirty)
+        return;
+    _static_collision_dirty = false;
+
+    CollisionBitGrid previous_grid;
+    previous_grid.Swap(_static_collision_grid);
+    _static_collision_grid = _wall_collision_grid;
+
+    for(MapObject* object : _ground_objects) {
+        // Only static physical objects are considered, as in IsStaticCollision().
+        if(!object || object->GetCollisionMask() == NO_COLLISION
+                || object->GetObjectType() != PHYSICAL_TYPE)
+            continue;
+
+        Rectangle2D rect = object->GetGridCollisionRectangle();
+        if(rect.right < 0.0f || rect.bottom < 0.0f ||
+                rect.left >= static_cast<float>(_num_grid_x_axis) ||
+                rect.top >= static_cast<float>(_num_grid_y_axis))
+            continue;
+
+        // Block every grid element the collision rectangle overlaps, even partly.
+        uint32_t left = rect.left > 0.0f ? static_cast<uint32_t>(rect.left) : 0;
+        uint32_t top = rect.top > 0.0f ? static_cast<uint32_t>(rect.top) : 0;
+        uint32_t right = std::min(static_cast<uint32_t>(rect.right), static_cast<uint32_t>(_num_grid_x_axis - 1));
+        uint32_t bottom = std::min(static_cast<uint32_t>(rect.bottom), static_cast<uint32_t>(_num_grid_y_axis - 1));
+        _static_collision_grid.BlockArea(left, top, right, bottom);
+    }
+
+    // Keep the changed area, so that the data computed elsewhere is only updated when concerned.
+    StaticCollisionChange change;
+    if(previous_grid.GetWidth() != _static_collision_grid.GetWidth()
+            || previous_grid.GetHeight() != _static_collision_grid.GetHeight()) {
+        change.area = Rectangle2D(0.0f, static_cast<float>(_num_grid_x_axis), 0.0f, static_cast<float>(_num_grid_y_axis));
+    } else {
+        uint32_t left, top, right, bottom;
+        if(!_static_collision_grid.GetChangedArea(previous_grid, left, top, right, bottom))
+            return;
+        change.area = Rectangle2D(static_cast<float>(left), static_cast<float>(right),
+                                  static_cast<float>(top), static_cast<float>(bottom));
+    }
+
+    change.version = ++_static_collision_version;
+    _static_collision_changes.push_back(change);
+    if(_static_collision_changes.size() > STATIC_COLLISION_CHANGES_KEPT)
+        _static_collision_changes.pop_front();
+}
+
+bool ObjectSupervisor::HasStaticCollisionChanged(const Rectangle2D& rect, uint32_t version)
+{
+    _UpdateStaticCollisionGrid();
+    if(version == _static_collision_version)
+        return false;
+
+    // The changes following the given version were forgotten.
+    if(version == 0 || _static_collision_changes.empty() || _static_collision_changes.front().version > version + 1)
+        return true;
+
+    for(const StaticCollisionChange& change : _static_collision_changes) {
+        if(change.version > version && change.area.IntersectsWith(rect))
+            return true;
+    }
+    return false;
+}
+
+bool ObjectSupervisor::_IsWallCollision(const MapObject* object, const Rectangle2D& rect) const
+{
+    // Grid based collision is not done for objects in the sky layer
+    if(object->GetObjectDrawLayer() == vt_map::SKY_OBJECT || !(object->GetCollisionMask() & WALL_COLLISION))
+        return false;
+
+    // Note that because the rectangle was previously determined to be within the map bounds,
+    // the grid indeces used here are all valid entries and do not need to be checked for out-of-bounds conditions
+    return _wall_collision_grid.IsAreaBlocked(static_cast<uint32_t>(rect.left),
+                                              static_cast<uint32_t>(rect.top),
+                                              static_cast<uint32_t>(rect.right),
+                                              static_cast<uint32_t>(rect.bottom));
+}
+
 void ObjectSupervisor::StopSoundObjects()
 {
     for (uint32_t i = 0; i < _sound_object_highest_volumes.size(); ++i) {
@@ -12,9 +12,12 @@
 #define __MAP_OBJECT_SUPERVISOR_HEADER__
 
 #include "modes/map/map_objects/map_object.h"
+#include "modes/map/map_collision_grid.h"
 
 #include "script/script_read.h"
 
+#include <deque>
+
 namespace vt_map
 {
 
@@ -98,6 +101,20 @@ public:
     // Called by the Mazone constructor.
     void AddZone(MapZone* zone);
 
+    //! \brief Tells the zone spatial index needs to be rebuilt before the next zone update.
+    //! Called whenever a zone section is added.
+    void InvalidateZoneIndex() {
+        _zone_index_dirty = true;
+    }
+
+    /** \brief Returns the id of the latest zone update.
+    *** Zones record the id at which the camera entered or left them,
+    *** so they can tell whether the event occurred during the latest update.
+    **/
+    uint32_t GetZoneUpdateId() const {
+        return _zone_update_id;
+    }
+
     //! \brief Sorts objects on all three layers according to their draw order
     void SortObjects();
 
@@ -250,10 +267,45 @@ public:
     //! \return whether the location would be a "wall" for the party or not
     bool IsStaticCollision(float x, float y);
 
+    /** \brief Tells whether any grid element of the given area is a wall or is overlapped
+    *** by a static physical object.
+    *** \param rect The area to check, in collision grid coordinates.
+    *** \return True if the area is blocked or is partly outside of the map.
+    *** \note Grid elements only partly covered by a physical object are considered blocked.
+    **/
+    bool IsStaticAreaCollision(const vt_common::Rectangle2D& rect);
+
+    //! \brief Returns the static collision grid, merging walls and static physical objects.
+    //! The grid is rebuilt beforehand if physical objects have changed since the last call.
+    const CollisionBitGrid& GetStaticCollisionGrid() {
+        _UpdateStaticCollisionGrid();
+        return _static_collision_grid;
+    }
+
+    //! \brief Returns the version of the static collision grid, incremented each time its content changes.
+    //! Permits to know whether data computed from the grid is still valid.
+    uint32_t GetStaticCollisionVersion() {
+        _UpdateStaticCollisionGrid();
+        return _static_collision_version;
+    }
+
+    /** \brief Tells whether the static collision grid changed within an area since the given version.
+    *** \param rect The area to check, in collision grid coordinates.
+    *** \param version A version given by GetStaticCollisionVersion(). 0 means never computed.
+    *** \note When the version is too old to know, the area is considered changed.
+    **/
+    bool HasStaticCollisionChanged(const vt_common::Rectangle2D& rect, uint32_t version);
+
+    //! \brief Tells the static collision grid needs to be rebuilt before the next static query.
+    //! Called whenever a static physical object is added, removed, moved or resized.
+    void InvalidateStaticCollision() {
+        _static_collision_dirty = true;
+    }
+
     //! \brief checks if the location on the grid has a simple map collision. This is different from
     //! IsStaticCollision, in that it DOES NOT check static objects, but only the collision value for the map
-    bool IsMapCollision(uint32_t x, uint32_t y)
-    { return (_collision_grid[y][x] > 0); }
+    bool IsMapCollision(uint32_t x, uint32_t y) const
+    { return _wall_collision_grid.IsCellBlocked(x, y); }
 
     //! \brief returns a const reference to the ground objects in
     const std::vector<MapObject *>& GetGroundObjects() const
@@ -277,12 +329,33 @@ private:
     //! \brief Updates the ambient sounds volume according to the camera distance.
     void _UpdateAmbientSounds();
 
+    //! \brief Rebuilds the ambient sound spatial index if needed.
+    void _UpdateSoundIndex();
+
+    //! \brief Rebuilds the zone spatial index when it was invalidated.
+    void _UpdateZoneIndex();
+
+    /** \brief Updates which zones the camera occupies and notifies the zones entered and left.
+    *** The zones are only checked when the camera changes of grid element,
+    *** and only the zones indexed in the camera bucket are tested.
+    **/
+    void _UpdateCameraZones();
+
     //! \brief Debug: Draws the map zones in orange
     void _DrawMapZones();
 
     //! \brief Returns the MapObject vector corresponding to the draw layer.
     std::vector<MapObject*>& _GetObjectsFromDrawLayer(MapObjectDrawLayer layer);
 
+    //! \brief Rebuilds the static collision grid from the walls and the ground physical objects
+    //! when it was invalidated.
+    void _UpdateStaticCollisionGrid();
+
+    /** \brief Tells whether the given area overlaps unwalkable grid elements for the given object.
+    *** \note The area must be within the map bounds.
+    **/
+    bool _IsWallCollision(const MapObject* object, const vt_common::Rectangle2D& rect) const;
+
     /** \brief The number of rows and columns in the collision grid
     *** The number of collision grid rows and columns is always equal to twice
     *** that of the number of rows and columns of tiles (stored in the TileManager).
@@ -299,13 +372,30 @@ private:
     **/
     private_map::MapSprite* _visible_party_member;
 
-    /** \brief A 2D vector indicating which grid element on the map sprites may be occupied by objects.
-    *** Each bit of each element in this grid corresponds to a context. So all together this entire grid
-    *** stores the collision information for all 32 possible map contexts.
-    *** \Note A position in this member is stored like this:
-    *** _collision_grid[y][x]
+    /** \brief A bit-packed grid indicating which grid elements of the map are walls.
+    *** Any non-zero value of the map file collision grid is considered a wall.
     **/
-    std::vector<std::vector<uint32_t> > _collision_grid;
+    CollisionBitGrid _wall_collision_grid;
+
+    /** \brief A bit-packed grid merging the walls with the grid elements overlapped by
+    *** physical objects of the ground layer. Lazily rebuilt when _static_collision_dirty is set.
+    **/
+    CollisionBitGrid _static_collision_grid;
+
+    //! \brief Tells whether the static collision grid must be rebuilt before being used.
+    bool _static_collision_dirty;
+
+    //! \brief Incremented each time the static collision grid content changes.
+    uint32_t _static_collision_version;
+
+    //! \brief The area changed by a static collision grid version.
+    struct StaticCollisionChange {
+        uint32_t version;
+        vt_common::Rectangle2D area;
+    };
+
+    //! \brief The areas changed by the latest static collision grid versions, oldest first.
+    std::deque<StaticCollisionChange> _static_collision_changes;
 
     /** \brief A map containing pointers to all of the sprites on a map.
     *** This map does not include a pointer to the _virtual_focus object. The
@@ -354,12 +444,52 @@ private:
     //! They are also used when restarting the MapMode.
     std::vector<SoundObject*> _sound_object_highest_volumes;
 
+    /** \brief The ambient sound spatial index.
+    *** The map is divided in square buckets of SOUND_BUCKET_LENGTH grid elements,
+    *** each one referencing the ambient sounds which can be heard from somewhere within it.
+    *** \Note A bucket is stored like this: _sound_buckets[bucket_y * _sound_buckets_x_axis + bucket_x]
+    **/
+    std::vector<std::vector<SoundObject *> > _sound_buckets;
+
+    //! \brief The number of bucket columns of the ambient sound spatial index.
+    uint32_t _sound_buckets_x_axis;
+
+    //! \brief Tells whether the ambient sound spatial index must be rebuilt before being used.
+    bool _sound_index_dirty;
+
+    //! \brief The ambient sounds in range of the camera during the latest update.
+    std::vector<SoundObject *> _sounds_in_range;
+
     //! \brief Containers for all of the map source of light, quite similar as the ground objects container.
     std::vector<Halo *> _halos;
     std::vector<Light *> _lights;
 
     //! \brief Container for all zones used in this map
     std::vector<MapZone *> _zones;
+
+    /** \brief The zone spatial index.
+    *** The map is divided in square buckets of ZONE_BUCKET_LENGTH grid elements,
+    *** each one referencing the zones having at least one section overlapping it.
+    *** \Note A bucket is stored like this: _zone_buckets[bucket_y * _zone_buckets_x_axis + bucket_x]
+    **/
+    std::vector<std::vector<MapZone *> > _zone_buckets;
+
+    //! \brief The number of bucket columns of the zone spatial index.
+    uint32_t _zone_buckets_x_axis;
+
+    //! \brief Tells whether the zone spatial index must be rebuilt before being used.
+    bool _zone_index_dirty;
+
+    //! \brief The zones the camera currently occupies.
+    std::vector<MapZone *> _camera_zones;
+
+    //! \brief The camera sprite and grid element used during the latest camera zones check.
+    VirtualSprite* _zone_tracked_camera;
+    int32_t _zone_tracked_x;
+    int32_t _zone_tracked_y;
+
+    //! \brief Incremented at each zone update. Used to date the camera enter/exit events.
+    uint32_t _zone_update_id;
 }; // class ObjectSupervisor
 
 } // namespace private_map
@@ -263,6 +263,11 @@ bool MapObject::IsCollidingWith(MapObject* other_object)
     return _collision_mask & other_object->GetCollisionMask();
 }
 
+void MapObject::_NotifyStaticCollisionChange()
+{
+    MapMode::CurrentInstance()->GetObjectSupervisor()->InvalidateStaticCollision();
+}
+
 } // namespace private_map
 
 } // namespace vt_map
@@ -185,14 +185,17 @@ public:
     void SetPosition(float x, float y) {
         _tile_position.x = x;
         _tile_position.y = y;
+        _InvalidateStaticCollision();
     }
 
     void SetXPosition(float x) {
         _tile_position.x = x;
+        _InvalidateStaticCollision();
     }
 
     void SetYPosition(float y) {
         _tile_position.y = y;
+        _InvalidateStaticCollision();
     }
 
     //! \brief Set the object image half width (in pixels).
@@ -215,12 +218,14 @@ public:
         _coll_pixel_half_width = collision;
         _coll_screen_half_width = collision * MAP_ZOOM_RATIO;
         _coll_grid_half_width = collision / GRID_LENGTH * MAP_ZOOM_RATIO;
+        _InvalidateStaticCollision();
     }
 
     void SetCollPixelHeight(float collision) {
         _coll_pixel_height = collision;
         _coll_screen_height = collision * MAP_ZOOM_RATIO;
         _coll_grid_height = collision / GRID_LENGTH * MAP_ZOOM_RATIO;
+        _InvalidateStaticCollision();
     }
 
     void SetUpdatable(bool update) {
@@ -234,6 +239,7 @@ public:
     // Use a set of COLLISION_TYPE bitmask values
     void SetCollisionMask(uint32_t collision_types) {
         _collision_mask = collision_types;
+        _InvalidateStaticCollision();
     }
 
     void SetDrawOnSecondPass(bool pass) {
@@ -422,6 +428,16 @@ protected:
 
     //! \brief Takes care of drawing the emote animation.
     void _DrawEmote();
+
+    //! \brief Tells the object supervisor to rebuild its static collision grid
+    //! when the collision area of a static physical object has changed.
+    void _InvalidateStaticCollision() {
+        if(_object_type == PHYSICAL_TYPE && _draw_layer == GROUND_OBJECT)
+            _NotifyStaticCollisionChange();
+    }
+
+    //! \brief Invalidates the object supervisor static collision grid.
+    void _NotifyStaticCollisionChange();
 }; // class MapObject
 
 
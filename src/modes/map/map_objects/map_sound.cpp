@@ -15,6 +15,8 @@
 
 #include "engine/audio/audio.h"
 
+#include <cmath>
+
 using namespace vt_common;
 
 namespace vt_map
@@ -30,6 +32,7 @@ SoundObject::SoundObject(const std::string& sound_filename, float x, float y, fl
     _max_sound_volume(1.0f),
     _time_remaining(0.0f),
     _activated(true),
+    _loop_start_time(SDL_GetTicks()),
     _playing(false)
 {
     _object_type = SOUND_TYPE;
@@ -41,6 +44,9 @@ SoundObject::SoundObject(const std::string& sound_filename, float x, float y, fl
     if (!loaded || _sound == nullptr) {
         PRINT_WARNING << "Couldn't load environmental sound file: "
             << sound_filename << std::endl;
+    } else {
+        // Ambient sounds are the first ones to give their source away.
+        _sound->SetPriority(vt_audio::AUDIO_PRIORITY_LOW);
     }
 
     // Invalidates negative or near 0 values.
@@ -150,11 +156,25 @@ void SoundObject::ApplyVolume()
 
     if (_sound->GetState() != vt_audio::AUDIO_STATE_PLAYING
             && _sound->GetState() != vt_audio::AUDIO_STATE_FADE_IN) {
+        // Resume the loop where it would be, had it kept on playing while out of range.
+        float play_time = _sound->GetPlayTime();
+        if (_sound->GetState() == vt_audio::AUDIO_STATE_STOPPED && play_time > 0.0f) {
+            float elapsed_time = static_cast<float>(SDL_GetTicks() - _loop_start_time) / 1000.0f;
+            _sound->SeekSecond(std::fmod(elapsed_time, play_time));
+        }
         _sound->FadeIn(1000.0f);
     }
     _sound->SetVolume(_sound_volume);
 }
 
+void SoundObject::Silence()
+{
+    _sound_volume = 0.0f;
+    _playing = false;
+    // Evaluate the volume as soon as the sound gets back in range.
+    _time_remaining = 0;
+}
+
 void SoundObject::Stop()
 {
     if (!_activated)
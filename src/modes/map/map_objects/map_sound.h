@@ -53,6 +53,10 @@ public:
     //! \brief Applies the object's currently desired volume.
     void ApplyVolume();
 
+    //! \brief Mutes the sound, when it is too far from the camera to be evaluated.
+    //! The sound then fades out when its volume is applied.
+    void Silence();
+
     //! \brief Does nothing
     void Draw() override
     {}
@@ -84,6 +88,11 @@ public:
         return (_activated && _playing) ? _sound_volume : 0.0f;
     }
 
+    //! \brief Gets the maximal distance in map tiles the sound can be heard within.
+    float GetStrength() const {
+        return _strength;
+    }
+
 private:
     //! \brief The sound object reference. Don't delete it.
     vt_audio::SoundDescriptor* _sound;
@@ -103,6 +112,10 @@ private:
     //! \brief Tells whether the sound is activated.
     bool _activated;
 
+    //! \brief The time the sound loop started, in milliseconds.
+    //! Used to resume the loop where it would be, had it kept on playing.
+    uint32_t _loop_start_time;
+
     //! \brief Tells whether the sound is currently playing or not
     //! This boolean is here to avoid calling fadeIn()/FadeOut()
     //! repeatedly on sounds.
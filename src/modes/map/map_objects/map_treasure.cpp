@@ -35,6 +35,7 @@ TreasureObject::TreasureObject(const std::string& treasure_name,
     _treasure_name = treasure_name;
     if(treasure_name.empty())
         PRINT_WARNING << "Empty treasure name found. The treasure won't function normally." << std::endl;
+    _treasure_event = vt_global::GlobalManager->GetGameEvents().GetEventHandle("treasures", _treasure_name);
 
     _treasure = new vt_map::private_map::MapTreasureContent();
 
@@ -82,7 +83,7 @@ void TreasureObject::_LoadState()
         return;
 
     // If the event exists, the treasure has already been opened
-    if(vt_global::GlobalManager->GetGameEvents().DoesEventExist("treasures", _treasure_name)) {
+    if(vt_global::GlobalManager->GetGameEvents().DoesEventExist(_treasure_event)) {
         SetCurrentAnimation(TREASURE_OPEN_ANIM);
         _treasure->SetTaken(true);
     }
@@ -146,7 +147,7 @@ void TreasureObject::Update()
         // Once all events are finished, we can open the treasure supervisor
         mm->GetTreasureSupervisor()->Initialize(this);
         // Add an event to the treasures group indicating that the treasure has now been opened
-        vt_global::GlobalManager->GetGameEvents().SetEventValue("treasures", _treasure_name, 1);
+        vt_global::GlobalManager->GetGameEvents().SetEventValue(_treasure_event, 1);
         // End the opening sequence
         _is_opening = false;
     }
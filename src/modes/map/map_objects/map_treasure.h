@@ -15,6 +15,8 @@
 
 #include "modes/map/map_treasure_content.h"
 
+#include "common/global/events/global_events.h"
+
 namespace vt_map
 {
 
@@ -114,6 +116,9 @@ private:
     //! \brief The treasure object name
     std::string _treasure_name;
 
+    //! \brief The handle of the treasure opened event, in the "treasures" group
+    vt_global::EventHandle _treasure_event;
+
     //! \brief Events triggered at the start of the treasure event.
     std::vector<std::string> _events;
 
@@ -34,6 +34,7 @@ TriggerObject::TriggerObject(const std::string &trigger_name,
     _object_type = TRIGGER_TYPE;
 
     _trigger_name = trigger_name;
+    _trigger_event = vt_global::GlobalManager->GetGameEvents().GetEventHandle("triggers", _trigger_name);
 
     _off_event = off_event_id;
     _on_event = on_event_id;
@@ -104,7 +105,7 @@ void TriggerObject::_LoadState()
         return;
 
     // If the event value is equal to 1, the trigger has been triggered.
-    if(vt_global::GlobalManager->GetGameEvents().GetEventValue("triggers", _trigger_name) == 1) {
+    if(vt_global::GlobalManager->GetGameEvents().GetEventValue(_trigger_event) == 1) {
         SetCurrentAnimation(TRIGGER_ON_ANIM);
         _trigger_state = true;
     }
@@ -127,13 +128,13 @@ void TriggerObject::SetState(bool state)
         SetCurrentAnimation(TRIGGER_ON_ANIM);
         if (!_on_event.empty())
             event_supervisor->StartEvent(_on_event);
-        vt_global::GlobalManager->GetGameEvents().SetEventValue("triggers", _trigger_name, 1);
+        vt_global::GlobalManager->GetGameEvents().SetEventValue(_trigger_event, 1);
     }
     else {
         SetCurrentAnimation(TRIGGER_OFF_ANIM);
         if (!_off_event.empty())
             event_supervisor->StartEvent(_off_event);
-        vt_global::GlobalManager->GetGameEvents().SetEventValue("triggers", _trigger_name, 0);
+        vt_global::GlobalManager->GetGameEvents().SetEventValue(_trigger_event, 0);
     }
 }
 
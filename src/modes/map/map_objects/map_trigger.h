@@ -12,6 +12,8 @@
 
 #include "modes/map/map_objects/map_physical_object.h"
 
+#include "common/global/events/global_events.h"
+
 namespace vt_map
 {
 
@@ -87,6 +89,9 @@ private:
     //! \brief The treasure object name
     std::string _trigger_name;
 
+    //! \brief The handle of the trigger state event, in the "triggers" group
+    vt_global::EventHandle _trigger_event;
+
     //! The trigger state (false == off)
     bool _trigger_state;
 
@@ -205,7 +205,8 @@ enum EVENT_TYPE {
     TREASURE_EVENT                  = 13,
     LOOK_AT_SPRITE_EVENT            = 14,
     IF_EVENT                        = 15,
-    TOTAL_EVENT                     = 16
+    COROUTINE_EVENT                 = 16,
+    TOTAL_EVENT                     = 17
 };
 
 //! \brief The number of milliseconds to take to fade out the map
@@ -21,6 +21,8 @@
 
 #include "utils/utils_random.h"
 
+#include <algorithm>
+
 using namespace vt_utils;
 using namespace vt_common;
 
@@ -70,6 +72,9 @@ void MapZone::AddSection(uint16_t left_col, uint16_t right_col, uint16_t top_row
     }
 
     _sections.push_back(Rectangle2D(left_col, right_col, top_row, bottom_row));
+
+    // The zone spatial index needs to know about the new section.
+    MapMode::CurrentInstance()->GetObjectSupervisor()->InvalidateZoneIndex();
 }
 
 bool MapZone::IsInsideZone(float pos_x, float pos_y) const
@@ -185,7 +190,7 @@ MapZone& MapZone::operator=(const MapZone&)
 CameraZone::CameraZone(uint16_t left_col, uint16_t right_col, uint16_t top_row, uint16_t bottom_row) :
     MapZone(left_col, right_col, top_row, bottom_row),
     _camera_inside(false),
-    _was_camera_inside(false)
+    _camera_event_id(0)
 {
 }
 
@@ -196,28 +201,6 @@ CameraZone* CameraZone::Create(uint16_t left_col, uint16_t right_col, uint16_t t
     return new CameraZone(left_col, right_col, top_row, bottom_row);
 }
 
-void CameraZone::Update()
-{
-    MapZone::Update();
-
-    _was_camera_inside = _camera_inside;
-
-    // Update only if camera is on a real sprite
-    if(MapMode::CurrentInstance()->IsCameraOnVirtualFocus())
-        return;
-
-    VirtualSprite *camera = MapMode::CurrentInstance()->GetCamera();
-    if(camera == nullptr) {
-        _camera_inside = false;
-    }
-    // Camera must share a context with the zone and be within its borders
-    else if(IsInsideZone(camera->GetXPosition(), camera->GetYPosition())) {
-        _camera_inside = true;
-    } else {
-        _camera_inside = false;
-    }
-}
-
 CameraZone::CameraZone(const CameraZone&) :
     MapZone(0, 0, 0, 0)
 {
@@ -243,7 +226,8 @@ EnemyZone::EnemyZone(uint16_t left_col, uint16_t right_col,
     _spawns_left(-1), // Infinite spawns permitted.
     _spawn_timer(STANDARD_ENEMY_FIRST_SPAWN_TIME),
     _dead_timer(STANDARD_ENEMY_DEAD_TIME),
-    _spawn_zone(nullptr)
+    _spawn_zone(nullptr),
+    _spawn_positions_version(0)
 {
     // Done so that when the zone updates for the first time, an inactive enemy will immediately be selected and begin spawning
     _dead_timer.Finish();
@@ -279,6 +263,9 @@ void EnemyZone::AddEnemy(EnemySprite* enemy, uint8_t enemy_number)
         return;
     }
 
+    // The spawn positions depend on the enemies collision area.
+    _spawn_positions_version = 0;
+
     // Prepare the first enemy
     enemy->SetZone(this);
     _enemies.push_back(enemy);
@@ -321,6 +308,8 @@ void EnemyZone::AddSpawnSection(uint16_t left_col, uint16_t right_col, uint16_t
         return;
     }
 
+    _spawn_positions_version = 0;
+
     // Create the spawn zone if it does not exist and add the new section
     if(_spawn_zone == nullptr) {
         _spawn_zone = new MapZone(left_col, right_col, top_row, bottom_row);
@@ -338,11 +327,63 @@ void EnemyZone::EnemyDead()
     }
 }
 
+void EnemyZone::_UpdateSpawnPositions()
+{
+    ObjectSupervisor* object_supervisor = MapMode::CurrentInstance()->GetObjectSupervisor();
+
+    // Use the biggest collision area of the zone enemies, so that any of them fits.
+    float half_width = 0.0f;
+    float height = 0.0f;
+    for(EnemySprite* enemy : _enemies) {
+        half_width = std::max(half_width, enemy->GetCollGridHalfWidth());
+        height = std::max(height, enemy->GetCollGridHeight());
+    }
+
+    // Only the static collision changes reaching the spawn sections concern the zone.
+    const std::vector<Rectangle2D>& sections = HasSeparateSpawnZone() ? _spawn_zone->GetSections() : _sections;
+    bool changed = false;
+    for(uint32_t i = 0; i < sections.size() && !changed; ++i) {
+        Rectangle2D area(sections[i].left - half_width, sections[i].right + half_width,
+                         sections[i].top - height, sections[i].bottom);
+        changed = object_supervisor->HasStaticCollisionChanged(area, _spawn_positions_version);
+    }
+    _spawn_positions_version = object_supervisor->GetStaticCollisionVersion();
+    if(!changed)
+        return;
+    _spawn_positions.clear();
+
+    for(uint32_t i = 0; i < sections.size(); ++i) {
+        const Rectangle2D& section = sections[i];
+        for(int32_t y = static_cast<int32_t>(section.top); y <= static_cast<int32_t>(section.bottom); ++y) {
+            for(int32_t x = static_cast<int32_t>(section.left); x <= static_cast<int32_t>(section.right); ++x) {
+                Position2D position(x, y);
+
+                // Don't add twice the positions of overlapping sections.
+                bool already_added = false;
+                for(uint32_t j = 0; j < i && !already_added; ++j)
+                    already_added = sections[j].Contains(position);
+                if(already_added)
+                    continue;
+
+                Rectangle2D rect(position.x - half_width, position.x + half_width,
+                                 position.y - height, position.y);
+                if(!object_supervisor->IsStaticAreaCollision(rect))
+                    _spawn_positions.push_back(position);
+            }
+        }
+    }
+
+    if(_spawn_positions.empty()) {
+        PRINT_WARNING << "No walkable spawn location in an enemy zone. Check the enemy zones of map script:"
+                      << MapMode::CurrentInstance()->GetMapScriptFilename() << std::endl;
+    }
+}
+
 void EnemyZone::Update()
 {
-    // When spawning an enemy in a random zone location, sometimes it is occupied by another
-    // object or that section is unwalkable. We try only a few different spawn locations before
-    // giving up and waiting for the next call to Update(). Otherwise this function could
+    // When spawning an enemy in a random statically walkable location, it can still be occupied by
+    // another sprite. We try only a few different spawn locations before giving up and waiting
+    // for the next call to Update(). Otherwise this function could
     // potentially take a noticable amount of time to complete
     const int8_t SPAWN_RETRIES = 50;
 
@@ -393,27 +434,26 @@ void EnemyZone::Update()
         }
     }
 
-    // Used to retain random position coordinates in the zone
-    float x = 0.0f;
-    float y = 0.0f;
+    // Nothing can spawn until the static collision changes.
+    _UpdateSpawnPositions();
+    if (_spawn_positions.empty())
+        return;
+
     // Number of times to try finding a valid spawning location
     int8_t retries = SPAWN_RETRIES;
     // Holds the result of a collision detection check
     uint32_t collision = NO_COLLISION;
 
-    // Select a random position inside the zone to place the spawning enemy
+    // Select a random walkable position of the zone to place the spawning enemy
     _enemies[index]->SetCollisionMask(WALL_COLLISION | CHARACTER_COLLISION);
-    MapZone* spawning_zone = nullptr;
-    if (!HasSeparateSpawnZone()) {
-        spawning_zone = this;
-    } else {
-        spawning_zone = _spawn_zone;
-    }
+    ObjectSupervisor* object_supervisor = MapMode::CurrentInstance()->GetObjectSupervisor();
+    // Walls and static objects are already excluded, so only the sprites can still be in the way.
     // If there is a collision, retry a different location
     do {
-        spawning_zone->RandomPosition(x, y);
-        _enemies[index]->SetPosition(x, y);
-        collision = MapMode::CurrentInstance()->GetObjectSupervisor()->DetectCollision(_enemies[index],
+        const Position2D& position = _spawn_positions[RandomBoundedInteger(0, _spawn_positions.size() - 1)];
+        _enemies[index]->SetPosition(position.x, position.y);
+
+        collision = object_supervisor->DetectCollision(_enemies[index],
                     _enemies[index]->GetXPosition(),
                     _enemies[index]->GetYPosition(),
                     nullptr);
@@ -104,6 +104,24 @@ public:
     //! \brief Draws the interaction icon at the top of the zone rectangle, if any.
     void DrawInteractionIcon();
 
+    //! \brief Returns the rectangular sections which compose the map zone.
+    const std::vector<vt_common::Rectangle2D>& GetSections() const {
+        return _sections;
+    }
+
+    /** \brief Called by the object supervisor when the camera enters or leaves the zone.
+    *** \param update_id The object supervisor zone update id at which the event occurred.
+    *** \note The object supervisor only checks the zones when the camera changes
+    *** of grid element, so these are the only place where to react to the camera position.
+    **/
+    //@{
+    virtual void OnCameraEnter(uint32_t /*update_id*/)
+    {}
+
+    virtual void OnCameraExit(uint32_t /*update_id*/)
+    {}
+    //@}
+
 protected:
     //! \brief The rectangular sections which compose the map zone
     std::vector<vt_common::Rectangle2D> _sections;
@@ -162,8 +180,16 @@ public:
     //! give the object ownership at construction time.
     static CameraZone* Create(uint16_t left_col, uint16_t right_col, uint16_t top_row, uint16_t bottom_row);
 
-    //! \brief Updates the state of the zone by checking the current camera position
-    virtual void Update() override;
+    //! \brief Updates the camera inside state when notified by the object supervisor.
+    virtual void OnCameraEnter(uint32_t update_id) override {
+        _camera_inside = true;
+        _camera_event_id = update_id;
+    }
+
+    virtual void OnCameraExit(uint32_t update_id) override {
+        _camera_inside = false;
+        _camera_event_id = update_id;
+    }
 
     //! \brief Returns true if the sprite pointed to by the camera is located within the zone
     bool IsCameraInside() const {
@@ -172,20 +198,26 @@ public:
 
     //! \brief Returns true if the sprite pointed to by the camera is entering the zone
     bool IsCameraEntering() const {
-        return ((_camera_inside) && (_was_camera_inside == false));
+        return (_camera_inside && _IsCameraEventRecent());
     }
 
     //! \brief Returns true if the sprite pointed to by the camera is leaving the zone
     bool IsCameraExiting() const {
-        return ((_camera_inside == false) && (_was_camera_inside));
+        return (!_camera_inside && _IsCameraEventRecent());
     }
 
 protected:
     //! \brief Set to true when the sprite pointed to by the camera is inside this zone
     bool _camera_inside;
 
-    //! \brief Holds the previous value of _camera_inside
-    bool _was_camera_inside;
+    //! \brief The object supervisor zone update id at which the camera last entered or left the zone.
+    uint32_t _camera_event_id;
+
+    //! \brief Tells whether the camera entered or left the zone during the latest zone update.
+    bool _IsCameraEventRecent() const {
+        return (_camera_event_id != 0 &&
+                _camera_event_id == MapMode::CurrentInstance()->GetObjectSupervisor()->GetZoneUpdateId());
+    }
 
 private:
     //
@@ -323,6 +355,13 @@ private:
     EnemyZone(const EnemyZone& enemy_zone);
     EnemyZone& operator=(const EnemyZone& enemy_zone);
 
+    /** \brief Computes the spawn positions where the zone enemies don't collide with walls or static objects.
+    *** The positions are computed for the biggest enemy collision area of the zone, and only
+    *** recomputed when enemies or spawn sections are added, or when the static collision grid
+    *** changes within the spawn sections.
+    **/
+    void _UpdateSpawnPositions();
+
     //! \brief Tells whether the zone is activated.
     bool _enabled;
 
@@ -348,6 +387,13 @@ private:
     //! \brief An optional zone which specifies where enemies may spawn
     MapZone *_spawn_zone;
 
+    //! \brief The statically walkable positions of the spawning zone, where enemies can be spawned.
+    std::vector<vt_common::Position2D> _spawn_positions;
+
+    //! \brief The static collision grid version used to compute the spawn positions.
+    //! 0 means the spawn positions must be recomputed.
+    uint32_t _spawn_positions_version;
+
     /** \brief Contains all of the enemies that may exist in this zone.
     *** \note These sprites will be deleted by the map object manager, not the destructor of this class.
     **/
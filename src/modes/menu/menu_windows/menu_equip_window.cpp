@@ -351,28 +351,14 @@ void EquipWindow::_UpdateEquipList()
     std::vector<ustring> options;
 
     if(_active_box == EQUIP_ACTIVE_LIST) {
-        std::vector<std::shared_ptr<GlobalObject>> equipment_list;
-
         EQUIP_CATEGORY category = static_cast<EQUIP_CATEGORY>(_equip_select.GetSelection());
         GLOBAL_OBJECT object_type = GetObjectTypeFromEquipCategory(category);
 
-        switch(_equip_select.GetSelection()) {
-            default:
-                break;
-            case EQUIP_WEAPON: {
-                auto inv = inventory_handler.GetInventoryWeapons();
-                equipment_list = std::vector<std::shared_ptr<GlobalObject>>(inv.begin(), inv.end());
-                break;
-            }
-            case EQUIP_HEAD:
-            case EQUIP_TORSO:
-            case EQUIP_ARMS:
-            case EQUIP_LEGS: {
-                auto inv = inventory_handler.GetInventoryArmors(object_type);
-                equipment_list = std::vector<std::shared_ptr<GlobalObject>>(inv.begin(), inv.end());
-                break;
-            }
-        }
+        // The equipment is listed straight from the inventory.
+        bool weapon_list = (category == EQUIP_WEAPON);
+        InventoryView<GlobalObject> equipment_list = weapon_list ?
+            InventoryView<GlobalObject>(inventory_handler.GetInventoryWeapons()) :
+            InventoryView<GlobalObject>(inventory_handler.GetInventoryArmors(object_type));
 
         // Clear the replacer ids
         _equip_list_inv_index.clear();
@@ -380,25 +366,21 @@ void EquipWindow::_UpdateEquipList()
         // Add the options
         uint32_t gear_size = equipment_list.size();
         for(uint32_t j = 0; j < gear_size; j++) {
+            const std::shared_ptr<GlobalObject>& equipment = equipment_list.GetObject(j);
             uint32_t usability_bitmask = 0;
-            if(_equip_select.GetSelection() == EQUIP_WEAPON) {
-                std::shared_ptr<GlobalWeapon> selected_weapon =
-                    std::dynamic_pointer_cast<GlobalWeapon>(equipment_list.at(j));
-                usability_bitmask = selected_weapon->GetUsableBy();
-            } else {
-                std::shared_ptr<GlobalArmor> selected_armor =
-                    std::dynamic_pointer_cast<GlobalArmor>(equipment_list.at(j));
-                usability_bitmask = selected_armor->GetUsableBy();
-            }
+            if(weapon_list)
+                usability_bitmask = static_cast<const GlobalWeapon*>(equipment.get())->GetUsableBy();
+            else
+                usability_bitmask = static_cast<const GlobalArmor*>(equipment.get())->GetUsableBy();
 
             // If the character can't equip the item, don't show it.
             if(_equip && !(usability_bitmask & _character->GetID()))
                 continue;
 
             options.push_back(MakeUnicodeString("<") +
-                              MakeUnicodeString(equipment_list.at(j)->GetIconImage().GetFilename()) +
+                              MakeUnicodeString(equipment->GetIconImage().GetFilename()) +
                               MakeUnicodeString("><70>") +
-                              equipment_list.at(j)->GetName());
+                              equipment->GetName());
 
             // Add the actual inventory index
             _equip_list_inv_index.push_back(j);
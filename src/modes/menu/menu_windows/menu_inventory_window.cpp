@@ -64,6 +64,7 @@ vt_global::GLOBAL_OBJECT GetObjectTypeFromItemCategory(ITEM_CATEGORY category)
 InventoryWindow::InventoryWindow(MenuMode* mm) :
     _menu_mode(mm),
     _active_box(ITEM_ACTIVE_NONE),
+    _item_objects(GlobalManager->GetInventoryHandler().GetInventory()),
     _previous_category(ITEM_ALL),
     _object(nullptr),
     _object_type(vt_global::GLOBAL_OBJECT_INVALID),
@@ -108,7 +109,7 @@ void InventoryWindow::_InitInventoryItems()
     _UpdateItemText();
     if(_inventory_items.GetNumberOptions() > 0) {
         _inventory_items.SetSelection(0);
-        _object = _item_objects[_inventory_items.GetSelection()];
+        _object = _item_objects.GetObject(_inventory_items.GetSelection());
         _object_type = _object->GetObjectType();
     }
     VideoManager->MoveRelative(-65, 20);
@@ -270,7 +271,7 @@ void InventoryWindow::Update()
                     _inventory_items.SetSelection(0);
                     _item_categories.SetCursorState(VIDEO_CURSOR_STATE_HIDDEN);
                     _inventory_items.SetCursorState(VIDEO_CURSOR_STATE_VISIBLE);
-                    _description.SetDisplayText(_item_objects[0]->GetDescription());
+                    _description.SetDisplayText(_item_objects.GetObject(0)->GetDescription());
                     _active_box = ITEM_ACTIVE_LIST;
                     media.PlaySound("confirm");
                 } // if _inventory_items.GetNumberOptions() > 0
@@ -566,7 +567,7 @@ void InventoryWindow::_UpdateSelection()
            >= _item_objects.size())
         _inventory_items.SetSelection(_item_objects.size() - 1);
 
-    _object = _item_objects[ _inventory_items.GetSelection() ];
+    _object = _item_objects.GetObject(_inventory_items.GetSelection());
     _object_type = _object->GetObjectType();
     _object_name.SetText(_object->GetName(), TextStyle("title22"));
 
@@ -621,47 +622,34 @@ void InventoryWindow::_UpdateItemText()
 {
     InventoryHandler& inventory_handler = GlobalManager->GetInventoryHandler();
 
-    _item_objects.clear();
     _inventory_items.ClearOptions();
 
     ITEM_CATEGORY current_selected_category = static_cast<ITEM_CATEGORY>(_item_categories.GetSelection());
     GLOBAL_OBJECT object_type = GetObjectTypeFromItemCategory(current_selected_category);
 
     switch(current_selected_category) {
-        case ITEM_ALL: {
-            auto inv = inventory_handler.GetInventory();
-            for (auto it = inv.begin(); it != inv.end(); ++it) {
-                _item_objects.push_back(it->second);
-            }
+        case ITEM_ALL:
+        default:
+            _item_objects = inventory_handler.GetInventory();
             break;
-        }
-        case ITEM_ITEM: {
-            auto inv = inventory_handler.GetInventoryItems();
-            _item_objects = std::vector<std::shared_ptr<GlobalObject>>(inv.begin(), inv.end());
+
+        case ITEM_ITEM:
+            _item_objects = inventory_handler.GetInventoryItems();
             break;
-        }
 
-        case ITEM_WEAPON: {
-            auto inv = inventory_handler.GetInventoryWeapons();
-            _item_objects = std::vector<std::shared_ptr<GlobalObject>>(inv.begin(), inv.end());
+        case ITEM_WEAPON:
+            _item_objects = inventory_handler.GetInventoryWeapons();
             break;
-        }
 
         case ITEM_HEAD_ARMOR:
         case ITEM_TORSO_ARMOR:
         case ITEM_ARMS_ARMOR:
-        case ITEM_LEGS_ARMOR: {
-            auto inv = inventory_handler.GetInventoryArmors(object_type);
-            _item_objects = std::vector<std::shared_ptr<GlobalObject>>(inv.begin(), inv.end());
+        case ITEM_LEGS_ARMOR:
+            _item_objects = inventory_handler.GetInventoryArmors(object_type);
             break;
-        }
 
-        case ITEM_KEY: {
-        auto inv = inventory_handler.GetInventoryKeyItems();
-            _item_objects = std::vector<std::shared_ptr<GlobalObject>>(inv.begin(), inv.end());
-            break;
-        }
-        default:
+        case ITEM_KEY:
+            _item_objects = inventory_handler.GetInventoryKeyItems();
             break;
     }
 
@@ -676,9 +664,10 @@ void InventoryWindow::_UpdateItemText()
     ustring text;
     std::vector<ustring> inv_names;
 
-    for(size_t ctr = 0; ctr < _item_objects.size(); ++ctr) {
-        text = MakeUnicodeString("<" + _item_objects[ctr]->GetIconImage().GetFilename() + "><20>     ") +
-               _item_objects[ctr]->GetName() + MakeUnicodeString("<R><350>" + NumberToString(_item_objects[ctr]->GetCount()) + "   ");
+    for(uint32_t ctr = 0; ctr < _item_objects.size(); ++ctr) {
+        const std::shared_ptr<GlobalObject>& object = _item_objects.GetObject(ctr);
+        text = MakeUnicodeString("<" + object->GetIconImage().GetFilename() + "><20>     ") +
+               object->GetName() + MakeUnicodeString("<R><350>" + NumberToString(object->GetCount()) + "   ");
         inv_names.push_back(text);
     }
 
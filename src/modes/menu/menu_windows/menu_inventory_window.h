@@ -103,8 +103,8 @@ private:
     //! Used to render the current object name.
     vt_video::TextImage _object_name;
 
-    //! Vector of GlobalObjects that corresponds to _inventory_items
-    std::vector<std::shared_ptr<vt_global::GlobalObject>> _item_objects;
+    //! View of the inventory category objects that corresponds to _inventory_items
+    vt_global::InventoryView<vt_global::GlobalObject> _item_objects;
 
     //! holds previous category. we were looking at
     vt_global::ITEM_CATEGORY _previous_category;
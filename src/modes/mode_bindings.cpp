@@ -515,7 +515,9 @@ void BindModeCode()
             .def("EndEvent", (void(EventSupervisor:: *)(const std::string &, bool))&EventSupervisor::EndEvent)
             .def("EndEvent", (void(EventSupervisor:: *)(MapEvent *, bool))&EventSupervisor::EndEvent)
             .def("EndAllEvents", &EventSupervisor::EndAllEvents)
-            .def("IsEventActive", &EventSupervisor::IsEventActive)
+            .def("IsEventActive", (bool(EventSupervisor:: *)(const std::string &) const)&EventSupervisor::IsEventActive)
+            .def("IsEventActiveHandle", (bool(EventSupervisor:: *)(uint32_t) const)&EventSupervisor::IsEventActive)
+            .def("GetEventHandle", &EventSupervisor::GetEventHandle)
             .def("HasActiveEvent", &EventSupervisor::HasActiveEvent)
             .def("HasActiveDelayedEvent", &EventSupervisor::HasActiveDelayedEvent)
             .def("GetEvent", &EventSupervisor::GetEvent)
@@ -526,6 +528,7 @@ void BindModeCode()
         [
             luabind::class_<MapEvent>("MapEvent")
             .def("GetEventID", &MapEvent::GetEventID)
+            .def("GetEventHandle", &MapEvent::GetEventHandle)
             .def("AddEventLinkAtStart", (void(MapEvent:: *)(const std::string &))&MapEvent::AddEventLinkAtStart)
             .def("AddEventLinkAtStart", (void(MapEvent:: *)(const std::string &, uint32_t))&MapEvent::AddEventLinkAtStart)
             .def("AddEventLinkAtEnd", (void(MapEvent:: *)(const std::string &))&MapEvent::AddEventLinkAtEnd)
@@ -579,6 +582,28 @@ void BindModeCode()
             ]
         ];
 
+        luabind::module(vt_script::ScriptManager->GetGlobalState(), "vt_map")
+        [
+            luabind::class_<CoroutineEvent, MapEvent>("CoroutineEvent")
+            .scope
+            [   // Used for static members and nested classes.
+                luabind::def("Create", &CoroutineEvent::Create)
+            ]
+        ];
+
+        // The coroutine event wait functions are plain Lua C functions, as they yield.
+        {
+            lua_State* lua_state = vt_script::ScriptManager->GetGlobalState();
+            lua_getglobal(lua_state, "vt_map");
+            lua_pushcfunction(lua_state, &CoroutineEvent::LuaWait);
+            lua_setfield(lua_state, -2, "wait");
+            lua_pushcfunction(lua_state, &CoroutineEvent::LuaWaitEvent);
+            lua_setfield(lua_state, -2, "wait_event");
+            lua_pushcfunction(lua_state, &CoroutineEvent::LuaWaitSpriteArrival);
+            lua_setfield(lua_state, -2, "wait_sprite_arrival");
+            lua_pop(lua_state, 1);
+        }
+
         luabind::module(vt_script::ScriptManager->GetGlobalState(), "vt_map")
         [
             luabind::class_<SpriteEvent, MapEvent>("SpriteEvent")
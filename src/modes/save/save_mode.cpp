@@ -26,6 +26,7 @@
 
 #include "common/app_settings.h"
 #include "common/global/global.h"
+#include "common/global/global_save.h"
 #include "common/global/actors/global_character.h"
 
 #include "utils/utils_files.h"
@@ -197,6 +198,9 @@ SaveMode::SaveMode(bool save_mode, uint32_t x_position, uint32_t y_position) :
     _drunes_icon = vt_global::GlobalManager->Media().GetDrunesIcon();
     _drunes_icon->SetWidthKeepRatio(30.0f);
 
+    // Show the latest autosave, even when still being written.
+    GlobalManager->WaitForSaveGames();
+
     if(_save_mode) {
         for (uint32_t i = 0; i < SystemManager->GetGameSaveSlots(); ++i) {
             _file_list.AddOption(MakeUnicodeString(VTranslate("Slot %d", i + 1)));
@@ -222,6 +226,9 @@ SaveMode::SaveMode(bool save_mode, uint32_t x_position, uint32_t y_position) :
 
 SaveMode::~SaveMode()
 {
+    // Keep the previews read while in the menu.
+    GlobalManager->WriteSaveGameIndex();
+
     _window.Destroy();
 
     _left_window.Destroy();
@@ -281,7 +288,7 @@ void SaveMode::Update()
                 GlobalManager->GetMapData().SetSaveStamina(stamina);
 
                 // Attempt to save the game
-                if(GlobalManager->SaveGame(_BuildSaveFilename(id), id, _x_position, _y_position)) {
+                if(GlobalManager->SaveGame(GetSaveGameFilename(id), id, _x_position, _y_position)) {
                     _current_state = SAVE_MODE_SAVE_COMPLETE;
                     AudioManager->PlaySound("data/sounds/save_successful_nick_bowler_oga.wav");
                     // Remove the autosave in that case.
@@ -543,29 +550,23 @@ bool SaveMode::_PreviewGame(const std::string& filename)
         return false;
     }
 
-    ReadScriptDescriptor file;
-
-    // Clear out the save data namespace to avoid loading false information
-    // when dealing with a save game that has an invalid namespace
-    ScriptManager->DropGlobalTable("save_game1");
+    SaveGameIndex& save_game_index = GlobalManager->GetSaveGameIndex();
 
-    if(!file.OpenFile(filename)) {
-        _ClearSaveData(true);
-        return false;
-    }
-
-    if(!file.DoesTableExist("save_game1")) {
-        file.CloseFile();
-        _ClearSaveData(true);
-        return false;
+    // Only the preview block of the binary save games is read, when not cached already.
+    SaveGamePreview preview;
+    if(!save_game_index.GetPreview(filename, preview)) {
+        bool preview_read = IsBinarySaveGame(filename) ? ReadSaveGamePreview(filename, preview)
+                                                       : _ReadLuaSavePreview(filename, preview);
+        if(!preview_read) {
+            _ClearSaveData(true);
+            return false;
+        }
+        save_game_index.SetPreview(filename, preview);
     }
 
-    // open the namespace that the save game is encapsulated in.
-    file.OpenTable("save_game1");
-
     // The map file, tested after the save game is closed.
-    std::string map_script_filename = file.ReadString("map_script_filename");
-    std::string map_data_filename = file.ReadString("map_data_filename");
+    std::string map_script_filename = preview.map_script_filename;
+    std::string map_data_filename = preview.map_data_filename;
 
     // DEPRECATED: Remove this after episode II release
     if (!vt_utils::DoesFileExist(map_data_filename)) {
@@ -575,117 +576,156 @@ bool SaveMode::_PreviewGame(const std::string& filename)
         AddEp1ToMapPath(map_script_filename);
     }
 
-    // Check whether the map data file is available
-    if (!vt_utils::DoesFileExist(map_data_filename)) {
-        file.CloseTable(); // save_game1
-        file.CloseFile();
-        _ClearSaveData(true);
-        return false;
-    }
-
-    // Used to store temp data to populate text boxes
-    int32_t hours = file.ReadInt("play_hours");
-    int32_t minutes = file.ReadInt("play_minutes");
-    int32_t seconds = file.ReadInt("play_seconds");
-    int32_t drunes = file.ReadInt("drunes");
-
-    if(!file.DoesTableExist("characters")) {
-        file.CloseTable(); // save_game1
-        file.CloseFile();
+    // Check whether the map files are available
+    if (!vt_utils::DoesFileExist(map_data_filename) || !vt_utils::DoesFileExist(map_script_filename)) {
         _ClearSaveData(true);
         return false;
     }
 
-    // Read characters table content
-    file.OpenTable("characters");
-    std::vector<uint32_t> char_ids;
-    file.ReadUIntVector("order", char_ids);
-
     // Loads only up to the first four slots (Visible battle characters)
-    // i < char_ids.size() &&
     for(uint32_t i = 0; i < CHARACTERS_SHOWN_SLOTS; ++i) {
-        // Create a new GlobalCharacter object using the provided id
-        // This loads all of the character's "static" data, such as their name, etc.
-
         // Don't show characters when there are none
-        if (i >= char_ids.size() || !file.DoesTableExist(char_ids[i])) {
+        if (i >= preview.characters.size()) {
             _character_window[i].SetCharacter(nullptr);
             continue;
         }
 
-        file.OpenTable(char_ids[i]);
-
-        // Read in all of the character's stats data
-        GlobalCharacter character = GlobalCharacter(char_ids[i], false);
-        character.SetExperienceLevel(file.ReadUInt("experience_level"));
-        character.SetTotalExperiencePoints(file.ReadUInt("total_experience_points"));
-        character.SetUnspentExperiencePoints(file.ReadUInt("unspent_experience_points"));
-        character.AddExperienceForNextLevel(file.ReadUInt("experience_points_next"));
-
-        character.SetMaxHitPoints(file.ReadUInt("max_hit_points"));
-        character.SetHitPoints(file.ReadUInt("hit_points"));
-        character.SetMaxSkillPoints(file.ReadUInt("max_skill_points"));
-        character.SetSkillPoints(file.ReadUInt("skill_points"));
+        // Create a new GlobalCharacter object using the provided id
+        // This loads all of the character's "static" data, such as their name, etc.
+        const SaveGamePreviewCharacter& preview_character = preview.characters[i];
+        GlobalCharacter character = GlobalCharacter(preview_character.id, false);
+        character.SetExperienceLevel(preview_character.experience_level);
+        character.SetTotalExperiencePoints(preview_character.total_experience_points);
+        character.SetUnspentExperiencePoints(preview_character.unspent_experience_points);
+        character.AddExperienceForNextLevel(preview_character.experience_points_next);
+
+        character.SetMaxHitPoints(preview_character.max_hit_points);
+        character.SetHitPoints(preview_character.hit_points);
+        character.SetMaxSkillPoints(preview_character.max_skill_points);
+        character.SetSkillPoints(preview_character.skill_points);
 
         _character_window[i].SetCharacter(&character);
-
-        file.CloseTable(); // character id
     }
-    file.CloseTable(); // characters
-
-    // Report any errors detected from the previous read operations
-    if(file.IsErrorDetected()) {
-        PRINT_WARNING << "One or more errors occurred while reading the save game file - they are listed below:"
-            << std::endl << file.GetErrorMessages() << std::endl;
-            file.ClearErrors();
-    }
-
-    file.CloseTable(); // save_game1
-    file.CloseFile();
 
     std::ostringstream time_text;
-    time_text << (hours < 10 ? "0" : "") << static_cast<uint32_t>(hours) << ":";
-    time_text << (minutes < 10 ? "0" : "") << static_cast<uint32_t>(minutes) << ":";
-    time_text << (seconds < 10 ? "0" : "") << static_cast<uint32_t>(seconds);
+    time_text << (preview.play_hours < 10 ? "0" : "") << preview.play_hours << ":";
+    time_text << (preview.play_minutes < 10 ? "0" : "") << preview.play_minutes << ":";
+    time_text << (preview.play_seconds < 10 ? "0" : "") << preview.play_seconds;
     _time_textbox.SetDisplayText(MakeUnicodeString(time_text.str()));
 
     std::ostringstream drunes_amount;
-    drunes_amount << drunes;
+    drunes_amount << preview.drunes;
     _drunes_textbox.SetDisplayText(MakeUnicodeString(drunes_amount.str()));
 
-    // Test the map file
+    // Read the in-game location of the save, from the map file when not cached already.
+    SaveGameLocation location;
+    if(!save_game_index.GetLocation(map_script_filename, location)) {
+        ReadScriptDescriptor map_file;
 
-    // Tests the map file and gets the untranslated map hud name from it.
-    ReadScriptDescriptor map_file;
+        if(!map_file.OpenFile(map_script_filename)) {
+            _ClearSaveData(true);
+            return false;
+        }
 
-    if(!map_file.OpenFile(map_script_filename)) {
-        _ClearSaveData(true);
-        return false;
-    }
+        if (map_file.OpenTablespace().empty()) {
+            _ClearSaveData(true);
+            map_file.CloseFile();
+            return false;
+        }
 
-    if (map_file.OpenTablespace().empty()) {
-        _ClearSaveData(true);
+        // Gets the untranslated map hud name.
+        location.map_script_filename = map_script_filename;
+        location.map_name = map_file.ReadString("map_name");
+        location.map_image_filename = map_file.ReadString("map_image_filename");
+
+        map_file.CloseTable(); // Tablespace
         map_file.CloseFile();
-        return false;
+
+        save_game_index.SetLocation(location);
     }
 
-    // Read the in-game location of the save
-    std::string map_hud_name = map_file.ReadString("map_name");
-    _map_name_textbox.SetDisplayText(UTranslate(map_hud_name));
+    _map_name_textbox.SetDisplayText(UTranslate(location.map_name));
 
     // Loads the potential location image
-    std::string map_image_filename = map_file.ReadString("map_image_filename");
-    if (map_image_filename.empty()) {
+    if (location.map_image_filename.empty()) {
         _location_image.Clear();
     }
     else {
-        if (_location_image.Load(map_image_filename))
+        if (_location_image.Load(location.map_image_filename))
             _location_image.SetHeightKeepRatio(105.0f);
     }
 
-    map_file.CloseTable(); // Tablespace
-    map_file.CloseFile();
+    return true;
+}
+
+bool SaveMode::_ReadLuaSavePreview(const std::string& filename, SaveGamePreview& preview)
+{
+    ReadScriptDescriptor file;
+
+    // Clear out the save data namespace to avoid loading false information
+    // when dealing with a save game that has an invalid namespace
+    ScriptManager->DropGlobalTable("save_game1");
+
+    if(!file.OpenFile(filename))
+        return false;
+
+    if(!file.DoesTableExist("save_game1")) {
+        file.CloseFile();
+        return false;
+    }
+
+    // open the namespace that the save game is encapsulated in.
+    file.OpenTable("save_game1");
 
+    preview.map_script_filename = file.ReadString("map_script_filename");
+    preview.map_data_filename = file.ReadString("map_data_filename");
+    preview.play_hours = file.ReadUInt("play_hours");
+    preview.play_minutes = file.ReadUInt("play_minutes");
+    preview.play_seconds = file.ReadUInt("play_seconds");
+    preview.drunes = file.ReadUInt("drunes");
+
+    if(!file.DoesTableExist("characters")) {
+        file.CloseTable(); // save_game1
+        file.CloseFile();
+        return false;
+    }
+
+    // Read characters table content
+    file.OpenTable("characters");
+    std::vector<uint32_t> char_ids;
+    file.ReadUIntVector("order", char_ids);
+
+    for(uint32_t i = 0; i < char_ids.size() && i < SAVE_PREVIEW_CHARACTERS; ++i) {
+        if (!file.DoesTableExist(char_ids[i]))
+            break;
+
+        file.OpenTable(char_ids[i]);
+
+        SaveGamePreviewCharacter character;
+        character.id = char_ids[i];
+        character.experience_level = file.ReadUInt("experience_level");
+        character.total_experience_points = file.ReadUInt("total_experience_points");
+        character.unspent_experience_points = file.ReadUInt("unspent_experience_points");
+        character.experience_points_next = file.ReadInt("experience_points_next");
+        character.max_hit_points = file.ReadUInt("max_hit_points");
+        character.hit_points = file.ReadUInt("hit_points");
+        character.max_skill_points = file.ReadUInt("max_skill_points");
+        character.skill_points = file.ReadUInt("skill_points");
+        preview.characters.push_back(character);
+
+        file.CloseTable(); // character id
+    }
+    file.CloseTable(); // characters
+
+    // Report any errors detected from the previous read operations
+    if(file.IsErrorDetected()) {
+        PRINT_WARNING << "One or more errors occurred while reading the save game file - they are listed below:"
+            << std::endl << file.GetErrorMessages() << std::endl;
+            file.ClearErrors();
+    }
+
+    file.CloseTable(); // save_game1
+    file.CloseFile();
     return true;
 }
 
@@ -743,19 +783,23 @@ void SaveMode::_InitSaveSlots()
 
 std::string SaveMode::_BuildSaveFilename(uint32_t id, bool autosave)
 {
-    std::ostringstream file;
-    file << GetUserDataPath() + "saved_game_" << id;
-    if (autosave)
-        file << "_autosave.lua";
-    else
-        file << ".lua";
-    return file.str();
+    return FindSaveGameFilename(id, autosave);
 }
 
 void SaveMode::_DeleteAutoSave(uint32_t id)
 {
-    std::string filename = _BuildSaveFilename(id, true);
+    std::string filename = GetSaveGameFilename(id, true);
     vt_utils::DeleteAFile(filename.c_str());
+
+    GlobalManager->GetSaveGameIndex().RemovePreview(filename);
+
+    // Also delete an autosave of the former versions, which would be found instead.
+    filename = FindSaveGameFilename(id, true);
+    if(vt_utils::DoesFileExist(filename))
+        vt_utils::DeleteAFile(filename.c_str());
+    GlobalManager->GetSaveGameIndex().RemovePreview(filename);
+
+    GlobalManager->WriteSaveGameIndex();
 }
 
 } // namespace vt_save
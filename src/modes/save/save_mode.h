@@ -27,6 +27,11 @@
 #include "common/gui/option.h"
 #include "common/character_window.h"
 
+namespace vt_global
+{
+struct SaveGamePreview;
+}
+
 //! \brief All calls to save mode are wrapped in this namespace.
 namespace vt_save
 {
@@ -67,6 +72,9 @@ private:
     //! \brief Loads preview data for the highlighted game
     bool _PreviewGame(const std::string& filename);
 
+    //! \brief Reads the preview data of a save game of the former versions, written in Lua.
+    bool _ReadLuaSavePreview(const std::string& filename, vt_global::SaveGamePreview& preview);
+
     //! \brief Clears out the data saves. Used especially when the data is invalid.
     //! \param selected_file_exists Tells whether the selected file exists.
     void _ClearSaveData(bool selected_file_exists);
@@ -1266,27 +1266,28 @@ void ShopMode::_UpdateAvailableObjectsToSell()
     if (!_sell_mode_enabled)
         return;
 
-    auto inventory = GlobalManager->GetInventoryHandler().GetInventory();
-    for (auto it = inventory.begin(); it != inventory.end(); ++it) {
+    InventoryView<GlobalObject> inventory = GlobalManager->GetInventoryHandler().GetInventory();
+    for (uint32_t i = 0; i < inventory.size(); ++i) {
+        const std::shared_ptr<GlobalObject>& object = inventory.GetObject(i);
         // Don't consider 0 worth objects.
-        if (it->second->GetPrice() == 0)
+        if (object->GetPrice() == 0)
             continue;
 
         // Don't show key items either.
-        if (it->second->IsKeyItem())
+        if (object->IsKeyItem())
             continue;
 
         // Check if the object already exists in the shop list and if so, set its ownership count
-        std::map<uint32_t, ShopObject *>::iterator shop_obj_iter = _available_sell.find(it->second->GetID());
+        std::map<uint32_t, ShopObject *>::iterator shop_obj_iter = _available_sell.find(object->GetID());
         if (shop_obj_iter != _available_sell.end()) {
-            shop_obj_iter->second->IncrementOwnCount(it->second->GetCount());
+            shop_obj_iter->second->IncrementOwnCount(object->GetCount());
         } else {
             // Otherwise, add the shop object to the list.
-            ShopObject *new_shop_object = new ShopObject(it->second);
-            new_shop_object->IncrementOwnCount(it->second->GetCount());
+            ShopObject *new_shop_object = new ShopObject(object);
+            new_shop_object->IncrementOwnCount(object->GetCount());
             new_shop_object->SetPricing(GetBuyPriceLevel(),
                                         GetSellPriceLevel());
-            _available_sell.insert(std::make_pair(it->second->GetID(), new_shop_object));
+            _available_sell.insert(std::make_pair(object->GetID(), new_shop_object));
         }
     }
 }